@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <mutex>
+#include <string>
+#include "query_cost.h"
+
+struct AdmissionOptions {
+    size_t memoryBytes = size_t{1} << 30;  // Estimated memory of all running queries
+    uint32_t threads = 0;                  // Threads of all running queries; 0: hardware threads
+    double maxWork = 1e10;                 // Queries estimated above this are rejected
+    size_t maxQueued = 64;                 // Queries waiting for budget; more are rejected
+    std::chrono::milliseconds maxQueueWait{1000};  // Then a waiting query is rejected
+};
+
+enum class AdmissionDecision : uint8_t {
+    Run,      // Fits in the free budget now
+    Degrade,  // Run degradePipeline() first; cost is what it may use then
+    Queue,    // Wait in acquire() for running queries to finish
+    Reject,
+};
+
+struct Admission {
+    AdmissionDecision decision = AdmissionDecision::Run;
+    QueryCost cost;      // To acquire() with
+    std::string reason;  // Why it was degraded or rejected
+};
+
+// Admission control for concurrent queries, so that overload shows up as
+// queueing and rejections rather than every query thrashing. Running
+// queries share a memory and a thread budget, charged with their estimated
+// cost. A query that does not fit is degraded when that makes it fit
+// (always, when nothing could ever fit it otherwise), and otherwise queued
+// in arrival order; the queue is bounded in length and in waiting time so
+// that latency stays predictable.
+class AdmissionController {
+public:
+    explicit AdmissionController(AdmissionOptions options = {});
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // What to do with a query of this cost; reserves nothing
+    Admission admit(const QueryCost& cost) const;
+    // Waits behind earlier callers until cost fits in the free budget, then
+    // charges it. The error says why the query was turned away instead.
+    std::expected<void, std::string> acquire(const QueryCost& cost);
+    void release(const QueryCost& cost);
+
+    size_t running() const;
+    size_t queued() const;
+    size_t memoryInUse() const;
+    uint32_t threadsInUse() const;
+    const AdmissionOptions& options() const { return opts; }
+
+private:
+    // Require mutex
+    bool fitsNow(const QueryCost& cost) const;
+    bool fitsEver(const QueryCost& cost) const;
+
+    AdmissionOptions opts;
+    mutable std::mutex mutex;
+    std::condition_variable released;  // Budget was freed or the queue head left
+    std::deque<uint64_t> waiting;      // Tickets, in arrival order
+    uint64_t nextTicket = 0;
+    size_t runningCount = 0;
+    size_t memoryUsed = 0;
+    uint32_t threadsUsed = 0;
+};
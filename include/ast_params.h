@@ -5,6 +5,12 @@
 #include "limit_params.h"
 #include "sort_params.h"
 #include "set_metadata_params.h"
+#include "group_params.h"
+#include "match_params.h"
+#include "project_params.h"
+#include "join_params.h"
+#include "window_params.h"
+#include "distinct_params.h"
 
 // Dummy type to handle trailing comma from X-macro
 // This should never be instantiated - it only exists to make the preprocessor happy
@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "packed_ints.h"
+#include "vector_kernels.h"
+#include "schema.h"
+
+// Row indices into a batch, ascending; restricts evaluation to those rows
+using SelectionVector = std::vector<uint32_t>;
+
+// Validity bitmaps: bit (row % 64) of word (row / 64) is set when the row is
+// non-null. An empty bitmap means the column has no nulls.
+using ValidityBitmap = std::vector<uint64_t>;
+
+inline size_t validityWords(size_t rows) { return (rows + 63) / 64; }
+
+// dst &= src over the first `rows` rows; an empty src leaves dst unchanged
+void andValidity(ValidityBitmap& dst, const ValidityBitmap& src, size_t rows);
+
+// Sorted, duplicate-free string values of a dictionary-encoded column
+using StringDictionary = std::vector<std::string>;
+
+// Per-block value ranges of a numeric column (a zone map). Built once when a
+// batch is loaded; filters use it to reject or accept whole blocks without
+// reading their values.
+struct ZoneMap {
+    static constexpr size_t kBlockRows = 1024;
+    std::vector<int64_t> intMin, intMax;       // Int64 columns
+    std::vector<double> doubleMin, doubleMax;  // Double columns
+    // 1 when every row of the block is non-null (and not NaN), so the range
+    // holds for each row rather than only bounding the valid ones
+    std::vector<uint8_t> exact;
+
+    size_t blocks() const { return exact.size(); }
+};
+
+// Approximate nearest-neighbour index over a Vector column (hnsw_index.h)
+struct HnswIndex;
+// Term postings of a String column, for BM25 ranking (inverted_index.h)
+struct InvertedIndex;
+
+// A single typed column of values. Only the vector matching `type` is used;
+// keeping them as plain vectors lets kernels run straight over contiguous
+// memory once the type has been resolved at bind time.
+//
+// Null rows still hold a (meaningless) value, so kernels compute every row
+// unconditionally and combine validity bitmaps separately.
+struct Column {
+    PhysicalType type = PhysicalType::Int64;
+    std::vector<uint8_t> bools;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+    std::vector<float> floats;  // Vector: `dimension` values per row, row-major
+    uint32_t dimension = 0;     // Vector only
+    ValidityBitmap validity;
+
+    // Dictionary encoding (String only). When set, `strings` is empty and
+    // row i is (*dictionary)[codes[i]]. The dictionary is sorted, so codes
+    // order rows exactly like the strings do.
+    std::shared_ptr<const StringDictionary> dictionary;
+    std::vector<uint32_t> codes;
+
+    // Frame-of-reference bit packing (Int64 only). When set, `ints` is empty
+    // and values are read through packed->unpack()/at().
+    std::shared_ptr<const PackedInts> packed;
+
+    // Int8 quantization (Vector only). When set, `floats` is empty and
+    // similarity kernels run on the codes.
+    std::shared_ptr<const QuantizedVectors> quantized;
+
+    // Optional block ranges (Int64 and Double only). Dropped by every
+    // operation that reorders, removes or nulls rows, so a present zone map
+    // always describes the current rows.
+    std::shared_ptr<const ZoneMap> zones;
+    // Optional HNSW index (Vector only), built once when a batch is loaded
+    // (buildHnswIndex()) and dropped like `zones`
+    std::shared_ptr<const HnswIndex> vectorIndex;
+    // Optional inverted index (String only), built with buildInvertedIndex()
+    // and dropped like `zones`
+    std::shared_ptr<const InvertedIndex> textIndex;
+
+    static Column ofBools(std::vector<uint8_t> values);
+    static Column ofInts(std::vector<int64_t> values);
+    static Column ofDoubles(std::vector<double> values);
+    static Column ofStrings(std::vector<std::string> values);
+    static Column ofDictionary(std::shared_ptr<const StringDictionary> dictionary,
+                               std::vector<uint32_t> codes);
+    // Dictionary-encodes plain strings; only distinct values are compared
+    static Column dictionaryEncode(const std::vector<std::string>& values);
+    static Column ofPacked(PackedInts values);
+    // Bit-packs integers with the narrowest frame that fits them
+    static Column packInts(const std::vector<int64_t>& values);
+    // `values` holds dimension floats per row
+    static Column ofVectors(uint32_t dimension, std::vector<float> values);
+    // Int8-quantizes vectors (see QuantizedVectors)
+    static Column quantizeVectors(uint32_t dimension, const std::vector<float>& values);
+
+    size_t size() const;
+    // Approximate memory held by the values, validity and encodings (shared
+    // dictionaries included; attached zone maps and indexes are not)
+    size_t byteSize() const;
+
+    bool isDictionary() const { return dictionary != nullptr; }
+    bool isPacked() const { return packed != nullptr; }
+    bool isQuantized() const { return quantized != nullptr; }
+    // Computes `zones` from the current values; a no-op for other types
+    void buildZoneMap();
+
+    // Plain copy of the column (dictionary, packed and quantized columns are
+    // expanded)
+    Column decoded() const;
+    // Appends src's rows (same type). Two dictionary columns are combined by
+    // merging their dictionaries; this is the only place codes are compared
+    // through their strings.
+    void append(const Column& src);
+
+    bool hasNulls() const { return !validity.empty(); }
+    bool isValid(size_t row) const {
+        return validity.empty() || ((validity[row / 64] >> (row % 64)) & 1);
+    }
+    // Sets one row's validity, materializing the bitmap on the first null
+    void setValid(size_t row, bool valid);
+    // Drops the bitmap if every row turned out valid
+    void compactValidity();
+
+    // Typed access for kernels: T is uint8_t (Bool), int64_t, double or
+    // std::string (plain columns only; see decoded())
+    template <typename T>
+    const std::vector<T>& values() const;
+    template <typename T>
+    std::vector<T>& values();
+
+    // Keeps rows[i] as the i-th row
+    void gather(const std::vector<uint32_t>& rows);
+    // Copy of the given rows, in order
+    Column select(const SelectionVector& rows) const;
+    void truncate(size_t rowCount);
+};
+
+template <> inline const std::vector<uint8_t>& Column::values<uint8_t>() const { return bools; }
+template <> inline const std::vector<int64_t>& Column::values<int64_t>() const { return ints; }
+template <> inline const std::vector<double>& Column::values<double>() const { return doubles; }
+template <> inline const std::vector<std::string>& Column::values<std::string>() const { return strings; }
+template <> inline std::vector<uint8_t>& Column::values<uint8_t>() { return bools; }
+template <> inline std::vector<int64_t>& Column::values<int64_t>() { return ints; }
+template <> inline std::vector<double>& Column::values<double>() { return doubles; }
+template <> inline std::vector<std::string>& Column::values<std::string>() { return strings; }
+
+// A set of equally sized columns described by a schema
+struct Batch {
+    Schema schema;
+    std::vector<Column> columns;
+
+    size_t rowCount() const { return columns.empty() ? 0 : columns.front().size(); }
+    size_t byteSize() const;
+
+    // Appends a column, or replaces an existing one with the same name
+    void setColumn(const Field& field, Column column);
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "batch.h"
+
+// Blocked ("split block") Bloom filter. A key picks one 256-bit block from
+// its high hash bits and sets one bit in each of the block's eight 32-bit
+// words, so every insert or lookup touches a single cache line. With the
+// default 10 bits per key the false positive rate is about 1%.
+struct BlockedBloomFilter {
+    using Block = std::array<uint32_t, 8>;
+    std::vector<Block> blocks;
+
+    // An empty filter sized for `keys` inserts
+    static BlockedBloomFilter withCapacity(size_t keys, size_t bitsPerKey = 10);
+
+    void insert(uint64_t hash);
+    bool mayContain(uint64_t hash) const;
+
+    size_t bytes() const { return blocks.size() * sizeof(Block); }
+};
+
+// Hashes every row's key value into hashes (resized to the column's rows).
+// Equal values hash equally whatever the encoding, so plain, dictionary
+// and packed columns can be matched against each other. Null rows get an
+// arbitrary hash; callers check validity separately.
+void hashKeyValues(const Column& column, std::vector<uint64_t>& hashes);
+
+// A Bloom filter over one join key, published by the join's build side at
+// bind time and read by filter stages that run before the probe
+struct RuntimeFilter {
+    bool published = false;
+    PhysicalType keyType = PhysicalType::Int64;
+    BlockedBloomFilter bloom;
+
+    // Rows whose key is non-null and may be in the filter, ascending.
+    // `hashes` must hold hashKeyValues() of key.
+    SelectionVector select(const Column& key, const std::vector<uint64_t>& hashes) const;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "schema.h"
+#include "symbol_table.h"
+
+struct Batch;
+class MetadataSink;
+class MetadataStore;
+
+// Per-catalog state shared by every pipeline planned against it
+struct Catalog {
+    SymbolTable symbols;  // Field names referenced by pipelines
+    // Named batches that stages can read besides their input (e.g. the build
+    // side of a join). Their schemas should come from makeSchema().
+    std::unordered_map<std::string, std::shared_ptr<const Batch>> tables;
+    // Bumped by every addTable(), so results computed from a replaced table
+    // are never reused (see result_cache.h)
+    std::unordered_map<std::string, uint64_t> tableVersions;
+    uint64_t nextTableVersion = 1;
+    // When set, set_metadata stages planned afterwards also write their
+    // values to disk (metadata_sink.h) and to a shared in-memory store
+    // (metadata_store.h), keyed by the Int64 input field metadataRowIdField
+    std::shared_ptr<MetadataSink> metadataSink;
+    std::shared_ptr<MetadataStore> metadataStore;
+    std::string metadataRowIdField = "id";
+
+    // Builds a schema whose field names are interned in this catalog
+    Schema makeSchema(const std::vector<std::pair<std::string, PhysicalType>>& columns) {
+        Schema schema;
+        for (const auto& [name, type] : columns) {
+            schema.fields.push_back(Field{name, symbols.intern(name), type});
+        }
+        return schema;
+    }
+
+    void addTable(const std::string& name, std::shared_ptr<const Batch> table) {
+        tables[name] = std::move(table);
+        tableVersions[name] = nextTableVersion++;
+    }
+
+    // Zero when no table was added under that name
+    uint64_t tableVersion(std::string_view name) const {
+        auto it = tableVersions.find(std::string(name));
+        return it == tableVersions.end() ? 0 : it->second;
+    }
+
+    // Null when no table has that name
+    std::shared_ptr<const Batch> findTable(std::string_view name) const {
+        auto it = tables.find(std::string(name));
+        return it == tables.end() ? nullptr : it->second;
+    }
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+struct Pipeline;
+
+// Column pruning. Walks the pipeline from the last stage back to the first,
+// tracking which fields are still needed: a project, group or distinct
+// defines the output outright, sorts add their keys, matches and
+// set_metadata stages add their expression inputs (and a set_metadata stage
+// stops its own output from being needed upstream). Along the way:
+//   - set_metadata stages whose output nothing reads are removed
+//   - project stages drop fields nothing reads
+//   - a project of just the needed source fields is put in front of the
+//     pipeline, so unused columns never reach a sort
+// Without a project, group or distinct to define the output, every field
+// is needed and the pipeline is left alone.
+void pruneColumns(Pipeline& pipeline);
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Error categories reported by the non-throwing (std::expected) APIs.
+// Messages are static strings so that reporting an error never allocates;
+// only formatDiagnostic() builds a human-readable string.
+enum class DiagnosticCode : uint8_t {
+    UnknownNodeType,
+    EmptyStage,
+    ExpectedInteger,
+    IntegerOutOfRange,
+    NegativeLimit,
+    UnexpectedCharacter,
+    ExpectedFieldName,
+    UnknownSortDirection,
+    EmptyMetadataName,
+    EmptyExpression,
+    UnsupportedParams,
+    ExpectedExpression,
+    UnterminatedString,
+    ExpectedClosingParen,
+    UnknownFunction,
+    WrongArgumentCount,
+    UnknownField,
+    TypeMismatch,
+    UnknownTable,
+    DuplicateField,
+    ExpectedClosingBracket,
+};
+
+// A parse/transform error with a location in the input text.
+// position/length are byte offsets into the string that was parsed: the
+// argument string for a single node, or the whole text for a pipeline.
+struct Diagnostic {
+    DiagnosticCode code = DiagnosticCode::UnexpectedCharacter;
+    uint32_t position = 0;
+    uint32_t length = 0;
+
+    const char* message() const;
+};
+
+// Returns the diagnostic with its position shifted by offset
+inline Diagnostic offsetBy(Diagnostic diag, size_t offset) {
+    diag.position += static_cast<uint32_t>(offset);
+    return diag;
+}
+
+// Renders "message at position N" followed by the input and a caret line
+std::string formatDiagnostic(const Diagnostic& diag, std::string_view input);
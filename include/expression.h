@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "diagnostic.h"
+#include "schema.h"
+#include "symbol_table.h"
+
+// Expression trees for SetMetadataParams::expression, e.g.
+//   sum(user_score, daily_bonus) * 2
+//   if(score > 10, score, 0)
+//   cosine(embedding, [0.5, -1, 2])
+//
+// parseExpression() builds an unbound tree from text. bindExpression()
+// resolves field references to column slots and assigns every node its
+// physical type, inserting explicit conversions, so evaluation never has to
+// inspect value types per row.
+
+enum class ExprKind : uint8_t {
+    Literal,
+    Field,
+    Call,
+};
+
+enum class ExprOp : uint8_t {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Sum,       // n-ary add
+    Min,
+    Max,
+    Abs,
+    Eq,
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    And,
+    Or,
+    Not,
+    If,
+    Coalesce,  // First non-null argument
+    IsNull,
+    ToDouble,  // Int64 -> Double, inserted by the binder
+    Dot,       // Dot product of two vectors
+    Cosine,    // Cosine similarity of two vectors
+    Bm25,      // BM25 relevance of a String field to a query string
+};
+
+struct Expr;
+using ExprPtr = std::shared_ptr<const Expr>;
+
+struct Expr {
+    ExprKind kind = ExprKind::Literal;
+    ExprOp op = ExprOp::Add;           // Call only
+    PhysicalType type = PhysicalType::Int64;  // Literals: from the text; others: set by binding
+
+    // Literal value; the member matching `type` is used (Bool uses intValue)
+    int64_t intValue = 0;
+    double doubleValue = 0;
+    std::string stringValue;
+    std::vector<float> vectorValue;
+
+    std::string name;                  // Field name
+    SymbolId fieldId = kInvalidSymbol; // Field: interned name (set by binding)
+    int32_t slot = -1;                 // Field: column index (set by binding)
+
+    std::vector<ExprPtr> args;         // Call arguments
+    uint32_t position = 0;             // Offset in the source text
+};
+
+ExprPtr makeLiteral(int64_t value);
+ExprPtr makeLiteral(double value);
+ExprPtr makeBoolLiteral(bool value);
+ExprPtr makeStringLiteral(std::string value);
+ExprPtr makeVectorLiteral(std::vector<float> value);
+ExprPtr makeField(std::string name);
+ExprPtr makeCall(ExprOp op, std::vector<ExprPtr> args, uint32_t position = 0);
+
+// Function name as written in expressions (e.g. "sum", "if")
+const char* exprOpName(ExprOp op);
+
+// Parses expression text; diagnostic positions index into text
+std::expected<ExprPtr, Diagnostic> parseExpression(std::string_view text);
+
+// Returns a bound copy of expr with slots and types resolved against schema
+std::expected<ExprPtr, Diagnostic> bindExpression(const ExprPtr& expr, const Schema& schema,
+                                                  const SymbolTable& symbols);
+
+// Canonical text form. Structurally equal expressions print identically.
+std::string toString(const Expr& expr);
+
+// Appends every distinct field name referenced by expr to names
+void collectFieldNames(const Expr& expr, std::vector<std::string>& names);
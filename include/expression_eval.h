@@ -0,0 +1,22 @@
+#pragma once
+#include "batch.h"
+#include "expression.h"
+
+// Vectorized interpreter for bound expressions (see bindExpression()).
+// Each tree node runs one type-specialized kernel over the whole batch; the
+// kernel is chosen from the node's bound type, never from the row values.
+//
+// Conditionals (if, and, or) short-circuit per row: each branch is evaluated
+// only for the rows that select it, either over a selection vector or, when
+// most rows select it, over every row followed by a blend.
+
+// Work done by one evaluation, for tests and tuning
+struct EvalStats {
+    uint64_t rowsComputed = 0;       // Rows processed by call kernels
+    uint32_t selectionBranches = 0;  // Branches evaluated over a selection vector
+    uint32_t denseBranches = 0;      // Branches evaluated over all rows, then blended
+};
+
+// With a selection, the result has one row per selected row, in order
+Column evaluateExpression(const Expr& expr, const Batch& batch,
+                          const SelectionVector* selection = nullptr, EvalStats* stats = nullptr);
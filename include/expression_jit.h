@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "batch.h"
+#include "expression.h"
+
+// Optional native tier for bound set_metadata expressions.
+//
+// Expressions start out interpreted (expression_eval.h). After
+// compileThreshold interpreted executions, the expression is translated to a
+// C++ loop, compiled by the local compiler into a shared object and loaded
+// with dlopen(). Shared objects are cached on disk by a hash of the generated
+// source and the compiler, so other processes (and restarts) skip straight to
+// native code. The cache directory and every object loaded from it must be
+// owned by the current user and not writable by anyone else.
+// Expressions over strings are not eligible and always stay interpreted.
+
+struct JitOptions {
+    bool enabled = false;
+    uint32_t compileThreshold = 64;    // Interpreted executions before compiling
+    bool compileInBackground = true;   // Keep interpreting while the compiler runs
+    std::string compiler = "c++";      // Run directly, not through a shell; may include arguments
+    std::string cacheDir;              // Default: $TMPDIR/toy_expr_jit-<uid>, created 0700
+};
+
+// Kernel ABI: one data pointer per input column (in inputSlots order), a
+// typed output array and the row count
+using ExprKernel = void (*)(const void* const* inputs, void* output, uint64_t rows);
+
+// Generates the kernel source for a bound expression, or std::nullopt if the
+// expression is not eligible. inputSlots receives the batch slots the kernel
+// reads, in argument order.
+std::optional<std::string> generateKernelSource(const Expr& bound, std::vector<int32_t>& inputSlots);
+
+class ExpressionJit {
+public:
+    // Tier state for one expression, shared by every plan that binds the
+    // same expression (keyed by generated source hash and input slots)
+    struct Entry {
+        uint64_t hash = 0;
+        std::string source;
+        std::vector<int32_t> inputSlots;
+        PhysicalType resultType = PhysicalType::Int64;
+        // No if/and/or: a row is null exactly when one of its inputs is, so
+        // the kernel also handles inputs with nulls
+        bool strict = true;
+
+        std::atomic<uint32_t> executions = 0;
+        std::atomic<ExprKernel> kernel = nullptr;
+        std::atomic<bool> compileStarted = false;
+        std::atomic<bool> failed = false;
+        std::future<void> pendingCompile;
+    };
+
+    static ExpressionJit& instance();
+
+    void configure(JitOptions options);
+    JitOptions options() const;
+
+    // Returns the shared tier state for a bound expression, or nullptr when
+    // the JIT is disabled or the expression is not eligible
+    std::shared_ptr<Entry> entryFor(const Expr& bound);
+
+    // Runs the native kernel when available and returns true. Otherwise
+    // counts an interpreted execution (triggering compilation at the
+    // threshold) and returns false, so the caller interprets.
+    bool tryExecute(Entry& entry, const Batch& batch, Column& result);
+
+    // Number of expressions currently running native code
+    size_t nativeCount() const;
+
+private:
+    ExpressionJit() = default;
+    ~ExpressionJit();
+
+    void compile(Entry& entry, const JitOptions& options);
+    std::string cacheDir(const JitOptions& options) const;
+
+    mutable std::mutex mutex;
+    JitOptions currentOptions;
+    std::unordered_map<uint64_t, std::shared_ptr<Entry>> entries;
+};
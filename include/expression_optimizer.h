@@ -0,0 +1,25 @@
+#pragma once
+#include "expression.h"
+
+struct Pipeline;
+class SymbolTable;
+
+// Folds constant subtrees and applies algebraic identities (x * 1, x + 0,
+// --x, not(not(x)), ...) to an unbound expression. Rewrites never change
+// the expression's bound type: where an identity would drop a Double
+// operand, the survivor is wrapped in to_double() instead.
+ExprPtr simplifyExpression(const ExprPtr& expr);
+
+// Optimizes the expressions of every set_metadata stage in the pipeline:
+//   1. simplifyExpression() on each expression
+//   2. reuse: a subexpression already computed by an earlier stage (and whose
+//      inputs have not been overwritten since) becomes a reference to that
+//      stage's column
+//   3. hoisting: a subexpression repeated across (or within) stages is
+//      computed once by a new "__cseN" set_metadata stage inserted before its
+//      first use. Only when a later project, group or distinct drops the
+//      column, so the output schema never changes, and never out of if()
+//      branches, and/or right-hand sides or coalesce() fallbacks, which
+//      only run for some rows.
+// New stages have their names interned into symbols.
+void optimizeSetMetadataExpressions(Pipeline& pipeline, SymbolTable& symbols);
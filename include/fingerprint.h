@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Small, stable 64-bit hashing helpers used for plan/shape fingerprints.
+// These values are persisted (e.g. by the plan cache), so the algorithm
+// must never depend on the standard library's std::hash implementation.
+
+inline constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+inline constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// FNV-1a over raw bytes
+inline constexpr uint64_t fnv1a64(std::string_view bytes, uint64_t seed = kFnvOffsetBasis) {
+    uint64_t hash = seed;
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// Order-dependent combination of two hashes (boost::hash_combine, widened to 64 bits)
+inline constexpr uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4));
+}
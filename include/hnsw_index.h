@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct Column;
+
+// Similarity an index is built for; matches dot() and cosine()
+enum class VectorMetric : uint8_t {
+    Dot,
+    Cosine,
+};
+
+// In-memory HNSW (hierarchical navigable small world) graph over the rows
+// of a Vector column, for approximate top-k by similarity. Every node is on
+// level 0 and on each higher level with probability 1/m; a search descends
+// greedily from the single top-level entry point, then runs a best-first
+// search of width `ef` on level 0. Cosine indexes store unit vectors, so
+// both metrics search by inner product.
+//
+// Built once per column (see buildHnswIndex()) and attached as
+// Column::vectorIndex. Null rows and, for cosine, zero vectors are not
+// indexed.
+struct HnswIndex {
+    struct Hit {
+        uint32_t row = 0;   // Row of the indexed column
+        float score = 0;    // Inner product (cosine: of the unit vectors)
+    };
+
+    VectorMetric metric = VectorMetric::Dot;
+    uint32_t dimension = 0;
+    uint32_t m = 16;  // Links per node above level 0; level 0 keeps 2 * m
+
+    std::vector<float> vectors;  // One row of `dimension` per node
+    std::vector<uint32_t> rows;  // Column row of each node
+    // links[level][node]: neighbours of node on that level (empty when the
+    // node is not on it)
+    std::vector<std::vector<std::vector<uint32_t>>> links;
+    uint32_t entryPoint = 0;
+
+    size_t size() const { return rows.size(); }
+
+    // Up to `ef` (at least k) nearest nodes to query by the index metric,
+    // best first. Approximate: a wider ef trades time for recall.
+    std::vector<Hit> search(const float* query, size_t k, size_t ef) const;
+};
+
+// Builds the graph over the column's rows, inserting them in row order with
+// levels drawn from a hash of the row number, so the same column always
+// yields the same index
+std::shared_ptr<const HnswIndex> buildHnswIndex(const Column& column, VectorMetric metric,
+                                                uint32_t m = 16, uint32_t efConstruction = 100);
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// HyperLogLog sketch for estimating the number of distinct 64-bit hashes.
+// The top `precision` bits of a hash pick a register, which keeps the
+// longest run of leading zeros seen in the remaining bits. With the
+// default precision of 14 the sketch is 16 KiB and the standard error is
+// about 0.8%. Hashes must be well mixed (e.g. from hashKeyValues()).
+struct HyperLogLog {
+    static constexpr uint8_t kDefaultPrecision = 14;
+
+    uint8_t precision = kDefaultPrecision;  // 4..18
+    std::vector<uint8_t> registers;
+
+    explicit HyperLogLog(uint8_t precision = kDefaultPrecision);
+
+    void insert(uint64_t hash) {
+        size_t index = static_cast<size_t>(hash >> (64 - precision));
+        // The guard bit bounds the rank when the remaining bits are all zero
+        uint64_t rest = (hash << precision) | (uint64_t{1} << (precision - 1));
+        auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > registers[index]) {
+            registers[index] = rank;
+        }
+    }
+
+    // Folds in another sketch of the same precision (register-wise max)
+    void merge(const HyperLogLog& other);
+
+    // Estimated distinct count, with linear counting for small cardinalities
+    double estimate() const;
+};
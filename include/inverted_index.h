@@ -0,0 +1,83 @@
+#pragma once
+#include "batch.h"
+#include "packed_ints.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// BM25 parameters: term-frequency saturation and length normalization
+inline constexpr double kBm25K1 = 1.2;
+inline constexpr double kBm25B = 0.75;
+
+// Lowercased runs of ASCII letters and digits; other ASCII bytes separate
+// tokens, and bytes >= 0x80 are kept, so UTF-8 words stay whole
+std::vector<std::string> tokenize(std::string_view text);
+
+// Query terms in the order scores are summed: sorted, without duplicates.
+// Both the scan and the index add term contributions in this order, so
+// they produce bit-identical scores.
+std::vector<std::string> queryTerms(std::string_view query);
+
+// Inverse document frequency of a term in docCount of `documents` rows
+double bm25Idf(size_t documents, size_t docCount);
+// Contribution of one term occurring tf times in a row of docLength tokens
+double bm25TermScore(uint32_t tf, uint32_t docLength, double idf, double averageLength);
+
+// Up to 64 postings (kPackedBlockRows) of one term, frame-of-reference
+// packed, with the bounds block-max WAND skips on
+struct PostingBlock {
+    PackedInts docs;   // Ascending rows
+    PackedInts freqs;  // Term frequency in each row
+    uint32_t lastDoc = 0;
+    double maxScore = 0;  // Largest contribution of any posting in the block
+};
+
+struct PostingList {
+    uint32_t docCount = 0;
+    double idf = 0;
+    std::vector<PostingBlock> blocks;
+    double maxScore = 0;  // Largest contribution in the whole list
+};
+
+// Work done by one InvertedIndex::topK() call
+struct WandStats {
+    uint64_t docsScored = 0;
+    uint64_t blocksDecoded = 0;
+    uint64_t blocksSkipped = 0;
+};
+
+// Term -> postings over the rows of a String column. Built once per column
+// (see buildInvertedIndex()) and attached as Column::textIndex. Statistics
+// are over the column's valid rows; null rows are not documents.
+struct InvertedIndex {
+    struct Hit {
+        uint32_t row = 0;
+        double score = 0;
+    };
+
+    std::unordered_map<std::string, PostingList> terms;
+    std::vector<uint32_t> docLengths;  // Tokens per row (0 for null rows)
+    size_t documents = 0;
+    double averageLength = 0;
+
+    const PostingList* find(const std::string& term) const;
+
+    // Exact top-k rows by BM25 over the (canonical) query terms, best first,
+    // ties to the lower row. Only rows containing a term are candidates, so
+    // fewer than k hits are returned when fewer rows match. Block-max WAND:
+    // rows whose score bound cannot beat the current k-th score are skipped,
+    // and whole blocks are passed over without being decoded.
+    std::vector<Hit> topK(const std::vector<std::string>& queryTerms, size_t k, WandStats* stats = nullptr) const;
+};
+
+std::shared_ptr<const InvertedIndex> buildInvertedIndex(const Column& column);
+
+// bm25(column, query) for every row (or the selected rows), null where the
+// column is. Statistics come from the column's index when it has one and
+// from a scan of all its rows otherwise; the scores are the same.
+Column bm25Scores(const Column& column, const std::vector<std::string>& queryTerms,
+                  const SelectionVector* selection);
@@ -3,11 +3,32 @@
 #include <functional>
 #include <memory>
 #include <concepts>
+#include <expected>
+#include "diagnostic.h"
+#include "schema.h"
+
+// Forward declarations
+struct Batch;
+struct Catalog;
+class SymbolTable;
 
 struct LogicalNode {
     virtual ~LogicalNode() = default;
     virtual std::string debugName() const = 0;
     virtual std::string explain() const = 0;  // Like EXPLAIN in SQL
+
+    // Planning phase: looks up catalog objects the node reads besides its
+    // input batch, such as a join's build table. Missing objects are
+    // reported by bind().
+    virtual void attachCatalog(const Catalog&) {}
+
+    // Binding phase: resolves every referenced field against the input schema
+    // to a column slot and physical type, and picks type-specialized kernels.
+    // Returns the schema this node produces.
+    virtual std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) = 0;
+
+    // Runs the node over a batch in place. Requires a successful bind().
+    virtual void execute(Batch& batch) const = 0;
 };
 
 // Generic create function that can work with any param type
@@ -0,0 +1,120 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "batch.h"
+
+struct MetadataSinkOptions {
+    // Commit as soon as this many rows are pending...
+    size_t maxBatchRows = 4096;
+    // ...or once the oldest pending write has waited this long
+    std::chrono::microseconds maxLatency{10000};
+    // Compact once the log reaches this size and has doubled since the last
+    // compaction, so rewriting it stays amortized O(1) per write
+    size_t compactBytes = 64 << 20;
+    // fdatasync() every commit; off only for tests and scratch stores
+    bool sync = true;
+};
+
+// The values one write() stored for one metadata name
+struct MetadataFrame {
+    std::string name;
+    std::vector<int64_t> rowIds;
+    Column values;  // Plain column, one row per row id
+};
+
+// Frames of a metadata log in write order, stopping at a torn tail (a crash
+// mid-commit). validBytes is the length of the intact prefix. Null when the
+// file cannot be read or is not a metadata log.
+struct MetadataLog {
+    std::vector<MetadataFrame> frames;
+    size_t validBytes = 0;
+};
+std::optional<MetadataLog> readMetadataLog(const std::string& path);
+
+// Write-behind store for set_metadata values: an append-only log on local
+// disk with periodic compaction.
+//
+// write() encodes a whole batch into one frame and queues it; it never
+// touches the disk. A single writer thread group-commits everything queued
+// by every worker with one write() and one fdatasync(), when maxBatchRows
+// rows are pending or the oldest has waited maxLatency. Disk syncs thus
+// scale with commits, not with rows or writers.
+//
+// File layout (native byte order, like the plan cache):
+//   header: magic u64
+//   frame:  payloadLen u32, checksum u64 (FNV-1a of the payload), payload
+//   payload: name, type u8, dimension u32, count u32, then per row
+//            rowId i64, valid u8, value (i64 / f64 bits / u8 / string /
+//            dimension f32s)
+// Compaction rewrites the log with the latest value of each (name, row id),
+// renames it over the old one and syncs the directory.
+class MetadataSink {
+public:
+    explicit MetadataSink(std::string path, MetadataSinkOptions options = {});
+    // Commits everything still queued
+    ~MetadataSink();
+
+    MetadataSink(const MetadataSink&) = delete;
+    MetadataSink& operator=(const MetadataSink&) = delete;
+
+    const MetadataSinkOptions& options() const { return opts; }
+    const std::string& path() const { return logPath; }
+
+    // Queues values[i] for rowIds[i] (both any encoding, same row count).
+    // Safe to call from any number of threads.
+    void write(std::string_view name, const Column& rowIds, const Column& values);
+    // Blocks until every write queued so far is committed; false if a
+    // commit failed (the sink then stops writing)
+    bool flush();
+    // Rewrites the log now, keeping the latest value per (name, row id)
+    bool compact();
+
+    size_t commits() const;
+    size_t rowsCommitted() const;
+    size_t compactions() const;
+    // Automatic compactions that failed; they are reported on stderr and
+    // retried once the log has doubled again, and never fail a commit
+    size_t compactionFailures() const;
+    size_t logBytes() const;
+
+private:
+    void run();
+    // Appends one group of frames; requires fileMutex
+    bool append(const std::string& frames);
+    bool compactLocked();
+    bool openLog();
+
+    std::string logPath;
+    MetadataSinkOptions opts;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;       // Writer: work or shutdown
+    std::condition_variable committed;  // flush(): a commit finished
+    std::string pending;                // Encoded frames not yet committed
+    size_t pendingRows = 0;
+    std::chrono::steady_clock::time_point oldestPending;
+    uint64_t queuedSequence = 0;     // Frames queued so far
+    uint64_t committedSequence = 0;  // Frames durable so far
+    bool flushRequested = false;
+    bool stopping = false;
+    bool failed = false;
+    size_t commitCount = 0;
+    size_t committedRows = 0;
+
+    mutable std::mutex fileMutex;  // Held by append and compaction
+    int fd = -1;
+    size_t fileBytes = 0;
+    size_t compactedBytes = 0;  // Log size right after the last compaction (or failed attempt)
+    size_t compactionCount = 0;
+    size_t compactionFailureCount = 0;
+
+    std::thread writer;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "batch.h"
+#include "symbol_id.h"
+
+// One stored metadata value; only the member matching `type` is used
+struct MetadataValue {
+    PhysicalType type = PhysicalType::Int64;
+    bool valid = true;
+    uint8_t boolValue = 0;
+    int64_t intValue = 0;
+    double doubleValue = 0;
+    std::string stringValue;
+    std::vector<float> vectorValue;
+};
+
+// In-memory map from (row id, interned metadata name) to the latest value
+// set_metadata computed for it, shared by concurrent pipelines.
+//
+// Reads never lock: find() and gather() probe an open-addressed table
+// (linear probing, at most half full) that writers never modify in place
+// except to publish a new slot or swap a slot's value pointer. A reader
+// announces the epoch it started in; replaced values and outgrown tables
+// are only freed once every reader that could still see them has left
+// (epoch-based reclamation). Each thread has its own reader record, so
+// entering and leaving is a single store unless more than kReaderRecords
+// reads are in progress at once; those take an idle record from a
+// lock-free overflow list, or push a new one, rather than wait.
+//
+// Writes are batched: insert() takes one writer lock for a whole column of
+// values and frees what earlier batches retired.
+class MetadataStore {
+public:
+    static constexpr size_t kReaderRecords = 128;
+
+    explicit MetadataStore(size_t initialCapacity = 1024);
+    ~MetadataStore();
+
+    MetadataStore(const MetadataStore&) = delete;
+    MetadataStore& operator=(const MetadataStore&) = delete;
+
+    // Stores values[i] for rowIds[i] (any encodings, same row count); rows
+    // with a null row id are skipped
+    void insert(SymbolId name, const Column& rowIds, const Column& values);
+
+    std::optional<MetadataValue> find(int64_t rowId, SymbolId name) const;
+    // Column of `type` with the value of each row id; rows without one (or
+    // with a value of another type) are null
+    Column gather(SymbolId name, PhysicalType type, const Column& rowIds) const;
+
+    size_t size() const;
+    size_t capacity() const;
+    // Replaced values and tables not yet freed
+    size_t retired() const;
+    // Reader records allocated so far, fixed and overflow
+    size_t readerRecords() const;
+
+private:
+    struct alignas(64) ReaderRecord {
+        std::atomic<uint64_t> epoch{0};  // 0 when no read is in progress
+        ReaderRecord* next = nullptr;    // Overflow list link, set before publishing
+    };
+
+public:
+    // Pins the current table and the values reachable from it; find() and
+    // gather() take their own, so holding one only delays reclamation
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const MetadataStore& store);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        ReaderRecord* record = nullptr;
+    };
+
+private:
+    struct Slot {
+        std::atomic<bool> used{false};  // Keys are set before it, and never change
+        int64_t rowId = 0;
+        SymbolId name = kInvalidSymbol;
+        std::atomic<const MetadataValue*> value{nullptr};
+    };
+    struct Table {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+    // The slot holding the key, or the empty slot where it would go
+    static Slot* probe(const Table& table, int64_t rowId, SymbolId name);
+    // Require writeMutex
+    void grow();
+    void reclaim();
+
+    std::atomic<Table*> table;
+    std::atomic<uint64_t> epoch{1};
+    mutable std::array<ReaderRecord, kReaderRecords> readers;
+    // Only ever pushed to; records are freed with the store
+    mutable std::atomic<ReaderRecord*> overflowReaders{nullptr};
+    mutable std::atomic<size_t> overflowCount{0};
+
+    mutable std::mutex writeMutex;
+    size_t used = 0;
+    std::vector<std::pair<uint64_t, std::unique_ptr<const MetadataValue>>> retiredValues;
+    std::vector<std::pair<uint64_t, std::unique_ptr<Table>>> retiredTables;
+};
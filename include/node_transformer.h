@@ -2,18 +2,37 @@
 
 #include <memory>
 #include <stdexcept>
+#include <expected>
 #include "param_type.h"
 #include "parse_node.h"
 #include "src/ast_nodes/limit_ast_node.h"
 #include "src/ast_nodes/sort_ast_node.h"
 #include "src/ast_nodes/set_metadata_ast_node.h"
 #include "ast_node.h"
+#include "diagnostic.h"
+#include "catalog.h"
 
 // Transforms a polymorphic ParseNode to its corresponding AstNode
 std::unique_ptr<AstNode> parseToAst(const ParseNode& parseNode);
+
+// Non-throwing variant of parseToAst
+std::expected<std::unique_ptr<AstNode>, Diagnostic> tryParseToAst(const ParseNode& parseNode);
+
+// Interns every field name referenced by params into symbols, filling the
+// params' SymbolId members
+void internSymbols(AstParams& params, SymbolTable& symbols);
+
+// Variants that intern field names into the catalog's symbol table, so the
+// AST and logical nodes carry SymbolIds alongside the names
+std::unique_ptr<AstNode> parseToAst(const ParseNode& parseNode, Catalog& catalog);
+std::expected<std::unique_ptr<AstNode>, Diagnostic> tryParseToAst(const ParseNode& parseNode,
+                                                                   Catalog& catalog);
+
+// Fallback for param types without an AST node (only reachable through the
+// variant's trailing sentinel). tryParseToAst reports this case as a Diagnostic.
 template <ParamType T>
 std::unique_ptr<AstNode> createAstNode(const T& params) {
-    throw std::runtime_error("hi");
+    throw std::runtime_error(Diagnostic{DiagnosticCode::UnsupportedParams}.message());
 }
 
 // Template specialization declarations (definitions in node_transformer.cpp)
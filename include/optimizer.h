@@ -0,0 +1,8 @@
+#pragma once
+
+struct Pipeline;
+struct Catalog;
+
+// Logical optimizer: runs every rewrite pass over an unbound pipeline.
+// Call between tryBuildPipeline() and bindPipeline().
+void optimizePipeline(Pipeline& pipeline, Catalog& catalog);
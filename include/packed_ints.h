@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frame-of-reference bit packing for Int64 columns: row i stores
+// value - base in bitWidth bits. Rows are grouped in blocks of 64, and a
+// block occupies exactly bitWidth words, so every block unpacks with the
+// same fixed-shape loop (instantiated per width) that the compiler unrolls
+// and vectorizes.
+struct PackedInts {
+    int64_t base = 0;
+    uint8_t bitWidth = 0;  // 0..64; 0 means every value equals base
+    size_t count = 0;
+    std::vector<uint64_t> words;
+
+    static PackedInts pack(const std::vector<int64_t>& values);
+    // Packs with a given frame; every value must lie in [base, base + 2^bitWidth)
+    static PackedInts packWithFrame(const int64_t* values, size_t count, int64_t base, uint8_t bitWidth);
+
+    // Largest storable delta
+    uint64_t maxDelta() const { return bitWidth == 64 ? ~uint64_t{0} : (uint64_t{1} << bitWidth) - 1; }
+
+    uint64_t deltaAt(size_t row) const;
+    int64_t at(size_t row) const { return static_cast<int64_t>(static_cast<uint64_t>(base) + deltaAt(row)); }
+
+    // Decodes rows [begin, begin + n) without touching other blocks
+    void unpackDeltas(size_t begin, size_t n, uint64_t* out) const;
+    void unpack(size_t begin, size_t n, int64_t* out) const;
+    std::vector<int64_t> unpackAll() const;
+
+    // Rows in the given order, keeping the frame
+    PackedInts select(const std::vector<uint32_t>& rows) const;
+    void truncate(size_t rows);
+
+    size_t byteSize() const { return words.size() * sizeof(uint64_t); }
+};
+
+inline constexpr size_t kPackedBlockRows = 64;
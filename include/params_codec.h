@@ -0,0 +1,16 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include "ast_params.h"
+
+// Compact binary encoding of AstParams.
+// The first byte is the variant index from ast_node_types.def, followed by
+// the fields of the concrete param struct. Strings are length-prefixed.
+// The layout is tied to the build, so persisted encodings must be guarded by
+// a build identifier (see plan_cache.h). SymbolIds are catalog-local and are
+// not encoded; decoded params must be re-interned against their catalog.
+std::string encodeParams(const AstParams& params);
+
+// Returns std::nullopt if the bytes are truncated or malformed
+std::optional<AstParams> decodeParams(std::string_view bytes);
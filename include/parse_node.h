@@ -1,9 +1,13 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <functional>
 #include <memory>
 #include <concepts>
+#include <expected>
+#include <vector>
 #include "ast_params.h"
+#include "diagnostic.h"
 
 // Forward declarations
 struct AstNode;
@@ -17,11 +21,35 @@ struct ParseNode {
     virtual AstParams astParams() const = 0;
 };
 
+// Result of parsing a node: never throws, errors carry a position in the input
+using ParseNodeResult = std::expected<std::unique_ptr<ParseNode>, Diagnostic>;
+
+// Boxes the result of a concrete node's tryParse() for the factory registry
+template <typename NodeT>
+ParseNodeResult toParseNodeResult(std::expected<NodeT, Diagnostic> parsed) {
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    return std::make_unique<NodeT>(std::move(*parsed));
+}
+
 // Factory registration for polymorphic usage
-using ParseNodeFactory = std::function<std::unique_ptr<ParseNode>(std::string)>;
+using ParseNodeFactory = std::function<ParseNodeResult(std::string_view)>;
 void registerParseNode(std::string name, ParseNodeFactory factory);
+
+// Non-throwing creation: diagnostic positions index into argString
+ParseNodeResult tryCreateParseNodeFromInput(std::string_view name, std::string_view argString);
+
+// Throwing convenience wrapper around tryCreateParseNodeFromInput
 std::unique_ptr<ParseNode> createParseNodeFromInput(std::string name, std::string argString);
 
+// Parses a whole pipeline such as "sort score:desc | limit 10".
+// Stages are separated by '|' outside string literals, parentheses and
+// brackets; each stage is "<node type> <arguments>".
+// Diagnostic positions index into text.
+std::expected<std::vector<std::unique_ptr<ParseNode>>, Diagnostic>
+tryParsePipeline(std::string_view text);
+
 // Helper class for automatic registration
 class ParseNodeRegistrar {
 public:
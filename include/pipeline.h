@@ -0,0 +1,34 @@
+#pragma once
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "catalog.h"
+#include "diagnostic.h"
+#include "logical_node.h"
+#include "schema.h"
+
+struct Batch;
+
+// An ordered chain of logical nodes, e.g. "set_metadata ... | sort ... | limit 10".
+// Each stage consumes the previous stage's output.
+struct Pipeline {
+    std::vector<std::unique_ptr<LogicalNode>> stages;
+};
+
+// Runs Parse → AST → Logical for every stage of text, interning field names
+// into the catalog and attaching the catalog tables stages read. Never
+// throws; parse diagnostics index into text.
+std::expected<Pipeline, Diagnostic> tryBuildPipeline(std::string_view text, Catalog& catalog);
+
+// Binding phase: binds each stage against the previous stage's output schema
+// and returns the schema the pipeline produces
+std::expected<Schema, Diagnostic> bindPipeline(Pipeline& pipeline, const Schema& input,
+                                               const SymbolTable& symbols);
+
+// Executes a bound pipeline over batch in place
+void executePipeline(const Pipeline& pipeline, Batch& batch);
+
+// Concatenated explain() of every stage
+std::string explainPipeline(const Pipeline& pipeline);
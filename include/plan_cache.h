@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "ast_params.h"
+
+// Forward declarations
+struct ParseNode;
+struct LogicalNode;
+
+// Identifies the build that wrote a plan cache file. Cached plans are only
+// trusted by the exact same build, since param layouts and planning rules can
+// change between builds. The build derives it from a hash of every source
+// file; override with -DTOY_BUILD_ID="..." (e.g. a release tag) to share a
+// cache across machines running the same release. Zero when the build set
+// no ID, which disables the persistent file.
+uint64_t planCacheBuildId();
+
+// Cache key for a parse node: its shape hash combined with its encoded params
+uint64_t planCacheKey(const ParseNode& parseNode, std::string_view encodedParams);
+
+// Persistent plan cache shared across worker process restarts.
+//
+// The file is memory-mapped read-only at construction, so a freshly started
+// worker can serve its common shapes without re-planning and without reading
+// or copying the whole file up front. Entries written by another build are
+// ignored. New plans are kept in memory until persist() rewrites the file.
+// With buildId 0 the file is neither read nor written.
+//
+// Only the per-stage Parse → AST → Logical step is cached: optimization and
+// binding depend on the whole pipeline, the catalog and the input schema,
+// so they run on every request.
+//
+// File layout (native byte order; the build ID pins the platform too):
+//   header: magic u64, buildId u64, entryCount u64
+//   entry:  key u64, inputLen u32, planLen u32, input bytes, plan bytes
+// "input" is the encoded parse-time params, compared on lookup so that a hash
+// collision can never return the wrong plan; "plan" is the encoded params the
+// AST node planned the logical node from (its logicalParams()).
+class PlanCache {
+public:
+    explicit PlanCache(std::string path, uint64_t buildId = planCacheBuildId());
+    ~PlanCache();
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    // Returns the logical plan for parseNode, planning (and caching) it on a miss
+    std::unique_ptr<LogicalNode> plan(const ParseNode& parseNode);
+
+    // Returns the cached logical params for the given encoded input params
+    std::optional<AstParams> lookup(uint64_t key, std::string_view encodedInput) const;
+    void insert(uint64_t key, std::string encodedInput, std::string encodedPlan);
+
+    // Atomically rewrites the cache file with all known entries; false
+    // without a build ID
+    bool persist() const;
+
+    size_t size() const;
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    struct Entry {
+        std::string_view input;
+        std::string_view plan;
+    };
+
+    void mapFile();
+
+    std::string path;
+    uint64_t buildId;
+
+    // Read-only mapping of the cache file; mapped entries point into it
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    // Backing storage for entries planned by this process
+    std::unordered_map<uint64_t, std::pair<std::string, std::string>> owned;
+    mutable std::atomic<size_t> hitCount = 0;
+    mutable std::atomic<size_t> missCount = 0;
+};
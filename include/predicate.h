@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "batch.h"
+#include "expression.h"
+
+// Filter predicates compiled from bound Bool expressions into selection
+// vectors. Comparisons of a column with a literal or with another column,
+// and and/or over them, run as branch-free byte-mask kernels over row
+// ranges; any other subtree is evaluated by the interpreter and turned into
+// a mask. A row is selected only when the predicate is true, so a null
+// comparison simply rejects the row.
+//
+// Column-vs-literal comparisons are also checked against zone maps, so whole
+// blocks are rejected or accepted without reading them.
+
+struct PredicateNode {
+    enum class Kind : uint8_t {
+        Compare,        // column <op> literal
+        CompareFields,  // column <op> column
+        And,
+        Or,
+        Interpreted,
+    };
+    Kind kind = Kind::Interpreted;
+    ExprOp op = ExprOp::Eq;  // Comparisons, with the (first) column on the left
+    uint32_t slot = 0;
+    uint32_t otherSlot = 0;  // CompareFields
+    PhysicalType type = PhysicalType::Int64;  // Type the comparison runs in
+    int64_t intValue = 0;     // Literal (Int64, Bool)
+    double doubleValue = 0;   // Literal (Double)
+    std::string stringValue;  // Literal (String)
+    ExprPtr expr;             // Bound subtree; evaluated directly when a kernel does not apply
+    std::vector<PredicateNode> children;  // And, Or
+};
+
+// Work done by one PredicatePlan::select()
+struct FilterStats {
+    uint64_t blocksSkipped = 0;   // Zone map proved no row matches
+    uint64_t blocksAccepted = 0;  // Zone map proved every row matches
+    uint64_t rowsEvaluated = 0;   // Rows run through kernels
+};
+
+struct PredicatePlan {
+    PredicateNode root;
+    uint32_t kernelLeaves = 0;       // Comparisons compiled to kernels
+    uint32_t interpretedLeaves = 0;  // Subtrees left to the interpreter
+
+    // Rows of batch for which the predicate is true, ascending
+    SelectionVector select(const Batch& batch, FilterStats* stats = nullptr) const;
+};
+
+// Compiles a bound Bool expression
+PredicatePlan compilePredicate(const ExprPtr& bound);
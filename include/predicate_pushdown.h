@@ -0,0 +1,18 @@
+#pragma once
+
+struct Pipeline;
+
+// Moves every match stage as early as it can go without changing the
+// result: ahead of sorts (filtering commutes with reordering) and ahead of
+// set_metadata stages that do not write a field the predicate reads. Limits,
+// groups and other matches stay where they are. A match that reaches the
+// front of the pipeline filters the source columns, where zone maps apply.
+// Each predicate is also simplified (see simplifyExpression()).
+void pushDownMatches(Pipeline& pipeline);
+
+// Gives every join's runtime Bloom filter to a RuntimeFilterLogicalNode
+// placed as early as a match on the probe key could go (also ahead of
+// matches and projects keeping the key), so non-matching probe rows are
+// dropped before the stages in between run. Joins whose filter cannot move
+// are left alone; they check it while probing.
+void pushDownJoinFilters(Pipeline& pipeline);
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct Batch;
+struct Pipeline;
+
+// What running a bound pipeline over an input is expected to need. Stages
+// are modeled from the input row count alone, so every estimate is an
+// upper bound: matches are assumed to keep every row and joins to find one
+// match per probe row.
+struct QueryCost {
+    size_t memoryBytes = 0;     // Peak bytes: a copy of the input plus the hungriest stage's working set
+    size_t minMemoryBytes = 0;  // Peak bytes once degraded (groups spill early)
+    double work = 0;            // Row operations over all stages, n log n for sorts
+    uint32_t threads = 1;       // Threads of the widest parallel stage
+};
+
+QueryCost estimatePipelineCost(const Pipeline& pipeline, const Batch& input);
+
+// Makes a bound pipeline cheaper to run without changing its output:
+// parallel stages (groups, joins, windows) run on one thread, and groups
+// spill what does not fit in memoryBytes beside the input copy (never less
+// than minMemoryBytes allows). Returns the new estimate.
+QueryCost degradePipeline(Pipeline& pipeline, const Batch& input, size_t memoryBytes);
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "admission_control.h"
+#include "query_cost.h"
+#include "shared_subplans.h"
+
+struct Batch;
+struct Catalog;
+
+struct QueryServerOptions {
+    AdmissionOptions admission;
+    uint32_t workers = 0;  // Worker pool size; 0: the admission thread budget
+    // Open socket connections; more are answered "rejected" and closed
+    // before any thread or parsing is spent on them
+    size_t maxConnections = 256;
+};
+
+enum class QueryOutcome : uint8_t {
+    Ok,
+    Degraded,  // Ran with less memory or fewer threads; same result
+    Rejected,  // Turned away by admission control
+    Failed,    // Unknown table, or the pipeline did not parse or bind
+};
+
+struct QueryResponse {
+    QueryOutcome outcome = QueryOutcome::Ok;
+    std::string message;  // Why it was degraded, rejected or failed
+    QueryCost cost;       // Estimate it was admitted with
+    std::shared_ptr<const Batch> result;  // Ok and Degraded only
+};
+
+// Long-running query service over the tables of a catalog. run() plans a
+// pipeline against one table, asks admission control (admission_control.h)
+// whether and how it may run, and executes it on a fixed worker pool.
+// Identical concurrent queries are coalesced and common prefixes shared
+// (shared_subplans.h); a query identical to one already running waits for
+// its result outside the worker pool, charged only a nominal cost. Tables
+// must not change while the server runs.
+//
+// listen() also serves a Unix socket, one thread per connection, one
+// request per line:
+//   <table> <pipeline>   e.g. "events match a > 2 | sort b:desc | limit 5"
+//   stats
+// and answers "ok <rows> <columns>" (or "degraded <rows> <columns> <why>")
+// followed by a tab-separated header line and one line per row, or a single
+// "rejected <why>" or "error <why>" line.
+class QueryServer {
+public:
+    explicit QueryServer(Catalog& catalog, QueryServerOptions options = {});
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Blocks until the query finished or was turned away
+    QueryResponse run(std::string_view table, std::string_view pipelineText);
+    // Response to one protocol line, without its trailing newline
+    std::string handleRequest(std::string_view line);
+
+    // Binds the socket (replacing a stale one) and starts accepting
+    bool listen(const std::string& socketPath);
+    // Stops accepting, closes connections and finishes running queries
+    void stop();
+
+    const AdmissionController& admission() const { return admissionControl; }
+    size_t completed() const { return completedCount; }
+    size_t degraded() const { return degradedCount; }
+    size_t rejected() const { return rejectedCount; }
+    size_t failed() const { return failedCount; }
+    size_t connections() const;
+
+private:
+    void work();
+    void submit(std::function<void()> task);
+    void acceptConnections();
+    void serveConnection(int fd);
+
+    Catalog& catalog;
+    size_t maxConnections;
+    AdmissionController admissionControl;
+    SharedSubplans subplans;
+
+    std::mutex poolMutex;
+    std::condition_variable poolChanged;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    std::string socketPath;
+    std::atomic<int> listenFd{-1};
+    std::thread acceptor;
+    mutable std::mutex connectionMutex;
+    std::condition_variable connectionClosed;
+    std::vector<int> connectionFds;  // Open connections, each served by a detached thread
+
+    std::atomic<size_t> completedCount{0};
+    std::atomic<size_t> degradedCount{0};
+    std::atomic<size_t> rejectedCount{0};
+    std::atomic<size_t> failedCount{0};
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+struct Batch;
+struct LogicalNode;
+struct Pipeline;
+
+// Structural 64-bit fingerprint of one stage: its kind and encoded params,
+// plus the version of any catalog table it reads. Nodes the optimizer
+// rewrites in place (bound expressions, sorted-input marks) keep their
+// fingerprint, since they still compute the same rows. Zero when the stage
+// cannot be fingerprinted.
+uint64_t stageFingerprint(const Pipeline& pipeline, size_t stage);
+
+// Fingerprint of stages [0, end): equal for subplans that produce the same
+// batch from the same input. Zero when any of those stages has none.
+uint64_t subplanFingerprint(const Pipeline& pipeline, size_t end);
+
+// Size-bounded cache of materialized subplan results, keyed by subplan
+// fingerprint and the version of the input they were computed from. A new
+// input version simply misses; invalidate() drops an old one eagerly.
+//
+// Besides full results it holds top-N windows: the first rows of an ordered
+// subplan's output (a sort, or a fused top-k's score and sort), as left by
+// a limit. A window of the first 1000 rows answers "limit 50" and
+// "limit 20 offset 40" over the same subplan without running it.
+//
+// Eviction is GreedyDual-Size-Frequency: each entry has priority
+// clock + hits * cost / bytes, where cost is the time its subplan took.
+// The lowest priority is evicted first and the clock rises to it, so
+// entries that are not hit again age out even if they were expensive.
+class ResultCache {
+public:
+    struct Hit {
+        std::shared_ptr<const Batch> result;
+        double cost = 0;  // Seconds the subplan took when it was computed
+    };
+
+    explicit ResultCache(size_t capacityBytes) : capacityBytes(capacityBytes) {}
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    std::optional<Hit> lookup(uint64_t fingerprint, uint64_t inputVersion);
+    // Replaces any entry with the same key; false when the result alone
+    // exceeds the capacity
+    bool insert(uint64_t fingerprint, uint64_t inputVersion, std::shared_ptr<const Batch> result, double cost);
+    // The first `rows` rows of a subplan's output, from a window holding at
+    // least that many, or from a complete one (the subplan produced fewer
+    // rows than the window asked for)
+    std::optional<Hit> lookupRows(uint64_t fingerprint, uint64_t inputVersion, size_t rows);
+    // Caches firstRows, the first `rows` rows of the subplan's output (all of
+    // them when it produced fewer). A wider window already cached is kept.
+    bool insertRows(uint64_t fingerprint, uint64_t inputVersion, std::shared_ptr<const Batch> firstRows, size_t rows,
+                    double cost);
+    // Drops every entry computed from inputVersion
+    void invalidate(uint64_t inputVersion);
+
+    size_t size() const;
+    size_t bytes() const;
+    size_t capacity() const { return capacityBytes; }
+    // Counted per lookup(), so a pipeline probing several prefixes may
+    // miss more than once before it hits
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+    size_t evictions() const { return evictionCount; }
+
+    // Stages faster than this (seconds) are not worth caching the output of
+    double minStageCost = 1e-3;
+
+private:
+    using Key = std::pair<uint64_t, uint64_t>;  // fingerprint, input version
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return key.first ^ (key.second * 0x9e3779b97f4a7c15ull); }
+    };
+    struct Entry {
+        std::shared_ptr<const Batch> result;
+        size_t bytes = 0;
+        double cost = 0;
+        uint64_t frequency = 1;
+        double priority = 0;
+        size_t windowRows = 0;  // Rows a top-N window asked for; 0 for full results
+    };
+
+    // Requires the lock
+    bool store(const Key& key, std::shared_ptr<const Batch> result, double cost, size_t windowRows);
+    void setPriority(const Key& key, Entry& entry);
+    void erase(std::unordered_map<Key, Entry, KeyHash>::iterator it);
+
+    size_t capacityBytes;
+    mutable std::mutex mutex;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    std::set<std::tuple<double, uint64_t, uint64_t>> byPriority;  // (priority, key), lowest first
+    size_t usedBytes = 0;
+    double clock = 0;  // GDSF inflation: priority of the last eviction
+    std::atomic<size_t> hitCount = 0;
+    std::atomic<size_t> missCount = 0;
+    std::atomic<size_t> evictionCount = 0;
+};
+
+// Executes a bound pipeline like executePipeline(), starting from the
+// longest prefix cached for inputVersion, and caches the output of every
+// stage that took at least cache.minStageCost. A limit (or fused top-k)
+// resumes from a cached top-N window of the ordered subplan before it, and
+// leaves one behind when that subplan took at least minStageCost. The
+// caller must change inputVersion whenever the input batch (or its schema)
+// changes.
+void executePipelineCached(const Pipeline& pipeline, Batch& batch, uint64_t inputVersion, ResultCache& cache);
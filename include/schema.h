@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "symbol_id.h"
+
+// Physical value types a column (or bound expression) can have
+enum class PhysicalType : uint8_t {
+    Bool,
+    Int64,
+    Double,
+    String,
+    Vector,  // Fixed-dimension float32 embedding per row
+};
+
+inline const char* physicalTypeName(PhysicalType type) {
+    switch (type) {
+        case PhysicalType::Bool: return "BOOL";
+        case PhysicalType::Int64: return "INT64";
+        case PhysicalType::Double: return "DOUBLE";
+        case PhysicalType::String: return "STRING";
+        case PhysicalType::Vector: return "VECTOR";
+    }
+    return "UNKNOWN";
+}
+
+inline bool isNumeric(PhysicalType type) {
+    return type == PhysicalType::Int64 || type == PhysicalType::Double;
+}
+
+// Types whose values can be compared, ordered and hashed, so they can be
+// sort, group, join and distinct keys
+inline bool isKeyType(PhysicalType type) {
+    return type != PhysicalType::Vector;
+}
+
+struct Field {
+    std::string name;
+    SymbolId id = kInvalidSymbol;  // Interned name (kInvalidSymbol if not interned)
+    PhysicalType type = PhysicalType::Int64;
+};
+
+// Ordered list of columns flowing between pipeline stages.
+// A field's position in `fields` is its column slot in a Batch.
+struct Schema {
+    std::vector<Field> fields;
+
+    // Resolves a field by interned ID, falling back to its name
+    std::optional<uint32_t> slotOf(SymbolId id, std::string_view name) const {
+        for (uint32_t i = 0; i < fields.size(); ++i) {
+            if (id != kInvalidSymbol && fields[i].id != kInvalidSymbol ? fields[i].id == id
+                                                                       : fields[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+struct Batch;
+struct Pipeline;
+
+// Subplans being computed right now, so that concurrent queries with a
+// common prefix compute it once. Unlike ResultCache (result_cache.h)
+// nothing outlives the computation: a query that arrives after the result
+// was published starts a new one.
+class SharedSubplans {
+public:
+    SharedSubplans() = default;
+    SharedSubplans(const SharedSubplans&) = delete;
+    SharedSubplans& operator=(const SharedSubplans&) = delete;
+
+    // The result of compute() for this key. The first caller runs it; callers
+    // arriving while it runs wait and receive the same batch. A follower whose
+    // leader threw runs compute() itself.
+    std::shared_ptr<const Batch> share(uint64_t fingerprint, uint64_t inputVersion,
+                                       const std::function<Batch()>& compute);
+    // Waits for the computation of this key that is running right now and
+    // returns its batch; null when none is running or its leader threw.
+    // Never computes anything itself.
+    std::shared_ptr<const Batch> join(uint64_t fingerprint, uint64_t inputVersion);
+    // Whether a computation of this key is running right now
+    bool computing(uint64_t fingerprint, uint64_t inputVersion) const;
+
+    size_t leaders() const;    // Computations run
+    size_t followers() const;  // Callers served by another caller's computation
+    size_t waiting() const;    // Followers blocked right now
+
+private:
+    using Key = std::pair<uint64_t, uint64_t>;  // fingerprint, input version
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return key.first ^ (key.second * 0x9e3779b97f4a7c15ull); }
+    };
+    struct Flight {
+        bool done = false;
+        std::shared_ptr<const Batch> result;  // Null when the leader threw
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable landed;  // Some flight finished
+    std::unordered_map<Key, std::shared_ptr<Flight>, KeyHash> flights;
+    size_t leaderCount = 0;
+    size_t followerCount = 0;
+    size_t waitingCount = 0;
+};
+
+// Stages [0, end) of a bound pipeline that concurrent queries can share:
+// everything up to and including the last sort before the first limit (or
+// fused top-k), or else the leading scan stages (matches, projects and
+// runtime filters). Zero when no such prefix has a fingerprint.
+size_t sharedPrefixLength(const Pipeline& pipeline);
+
+// Executes a bound pipeline like executePipeline(), computing its shared
+// prefix through subplans. Each query then applies the rest of its
+// pipeline to the shared result; a limit right after the prefix copies
+// only the rows it keeps. inputVersion identifies the input batch, as for
+// executePipelineCached().
+void executePipelineShared(const Pipeline& pipeline, Batch& batch, uint64_t inputVersion, SharedSubplans& subplans);
+
+// Key of a whole bound pipeline in SharedSubplans, kept apart from the keys
+// of its prefixes; 0 when a stage has no fingerprint (e.g. side effects)
+uint64_t planFingerprint(const Pipeline& pipeline);
+
+// Request coalescing: when an identical pipeline (same planFingerprint())
+// is already running over the same input version, waits for
+// its output instead of running a duplicate; otherwise runs it with
+// executePipelineShared() on a copy of input. Subscribers copy neither the
+// input nor the returned batch, which they share. Pipelines without a
+// fingerprint always run.
+std::shared_ptr<const Batch> executePipelineCoalesced(const Pipeline& pipeline, const Batch& input,
+                                                      uint64_t inputVersion, SharedSubplans& subplans);
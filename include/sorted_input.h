@@ -0,0 +1,11 @@
+#pragma once
+
+struct Pipeline;
+
+// Tracks the row order each stage produces (from sorts, including the sort
+// inside a window or fused top-k stage) through the stages that keep it: matches, limits,
+// runtime filters, joins, projects and set_metadata stages (up to the
+// first sort key they drop or overwrite) and exact distincts. A distinct
+// whose keys are exactly a prefix of that order, in any sequence, gets
+// sortedInput set, so equal keys arrive together and it can stream.
+void markSortedInputs(Pipeline& pipeline);
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+// Compact integer ID for an interned field name (see symbol_table.h).
+// Kept in its own header so param structs can carry IDs without depending
+// on the symbol table itself.
+using SymbolId = uint32_t;
+
+inline constexpr SymbolId kInvalidSymbol = std::numeric_limits<SymbolId>::max();
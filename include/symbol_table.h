@@ -0,0 +1,33 @@
+#pragma once
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "symbol_id.h"
+
+// Interns field names to dense SymbolIds so later phases compare and hash
+// integers instead of strings. IDs are only meaningful within the table
+// (i.e. the catalog) that issued them and are never persisted.
+//
+// Thread-safe: lookups of already interned names take a shared lock only.
+class SymbolTable {
+public:
+    // Returns the ID for name, assigning the next free ID on first use
+    SymbolId intern(std::string_view name);
+
+    // Returns the ID for name if it has been interned
+    std::optional<SymbolId> find(std::string_view name) const;
+
+    // Returns the name for an ID issued by this table
+    std::string_view name(SymbolId id) const;
+
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex mutex;
+    // deque keeps element addresses stable, so the map can key on views
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, SymbolId> ids;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+struct Pipeline;
+
+// Replaces every "set_metadata s:<expr> | sort s | limit k" run (a sort on
+// just the computed score) with one TopKLogicalNode, which keeps the best k
+// rows in a bounded heap instead of sorting them all. Run after column
+// pruning, so a set_metadata stage it absorbs is known to be needed.
+void fuseScoreTopK(Pipeline& pipeline);
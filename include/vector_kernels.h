@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Similarity kernels over embedding vectors (Vector columns). Written with
+// the GCC vector extension on 16-byte lanes, so they lower to SSE2, AVX or
+// NEON without target-specific intrinsics; other compilers get the scalar
+// loop.
+
+// Sum of a[i] * b[i]
+float dotF32(const float* a, const float* b, size_t n);
+// Dot product and the squared norm of `row`, in one pass (for cosine)
+void dotAndSquaredNormF32(const float* row, const float* query, size_t n, float& dot, float& rowNorm2);
+// Exact integer dot product of int8 codes (widened to int16, summed in int32)
+int32_t dotI8(const int8_t* a, const int8_t* b, size_t n);
+
+// Symmetric int8 quantization of fixed-dimension vectors: every row keeps
+// one scale, and element j of row i is approximately
+// codes[i * dimension + j] * scales[i]. A quarter of the fp32 size, and dot
+// products run on the codes with dotI8().
+struct QuantizedVectors {
+    uint32_t dimension = 0;
+    std::vector<int8_t> codes;
+    std::vector<float> scales;
+    std::vector<float> norms;  // Euclidean norm of each dequantized row
+
+    static QuantizedVectors quantize(uint32_t dimension, const std::vector<float>& values);
+    // Codes and scale for a single vector (e.g. a query)
+    static void quantizeOne(const float* values, size_t n, int8_t* codes, float& scale);
+
+    size_t count() const { return scales.size(); }
+    const int8_t* row(size_t i) const { return codes.data() + i * dimension; }
+
+    std::vector<float> dequantize() const;
+    // Rows in the given order
+    QuantizedVectors select(const std::vector<uint32_t>& rows) const;
+    void truncate(size_t rows);
+};
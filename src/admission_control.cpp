@@ -0,0 +1,128 @@
+#include "admission_control.h"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+std::string mebibytes(size_t bytes) {
+    std::ostringstream oss;
+    oss << (bytes + (size_t{1} << 20) - 1) / (size_t{1} << 20) << " MiB";
+    return oss.str();
+}
+
+} // namespace
+
+AdmissionController::AdmissionController(AdmissionOptions options) : opts(options) {
+    if (!opts.threads) opts.threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool AdmissionController::fitsEver(const QueryCost& cost) const {
+    return cost.memoryBytes <= opts.memoryBytes && cost.threads <= opts.threads;
+}
+
+bool AdmissionController::fitsNow(const QueryCost& cost) const {
+    return fitsEver(cost) && memoryUsed + cost.memoryBytes <= opts.memoryBytes &&
+           threadsUsed + cost.threads <= opts.threads;
+}
+
+Admission AdmissionController::admit(const QueryCost& cost) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Admission admission;
+    admission.cost = cost;
+    if (cost.work > opts.maxWork) {
+        std::ostringstream oss;
+        oss << "estimated " << cost.work << " row operations, more than the limit of " << opts.maxWork;
+        admission.decision = AdmissionDecision::Reject;
+        admission.reason = oss.str();
+        return admission;
+    }
+
+    // Degraded: one thread, and as much of `available` as the query could use
+    auto degraded = [&](size_t available, std::string reason) {
+        admission.decision = AdmissionDecision::Degrade;
+        admission.cost.threads = 1;
+        admission.cost.memoryBytes = std::clamp(available, cost.minMemoryBytes, cost.memoryBytes);
+        admission.reason = std::move(reason);
+        return admission;
+    };
+    QueryCost minimal = cost;
+    minimal.memoryBytes = cost.minMemoryBytes;
+    minimal.threads = 1;
+    if (!fitsEver(cost)) {
+        if (!fitsEver(minimal)) {
+            admission.decision = AdmissionDecision::Reject;
+            admission.reason = "needs at least " + mebibytes(cost.minMemoryBytes) + ", more than the budget of " +
+                               mebibytes(opts.memoryBytes);
+            return admission;
+        }
+        return degraded(opts.memoryBytes, "needs " + mebibytes(cost.memoryBytes) + " and " +
+                                              std::to_string(cost.threads) + " threads, more than the budget");
+    }
+    if (waiting.empty() && fitsNow(cost)) {
+        return admission;
+    }
+    // Overloaded: a smaller footprint now beats waiting for the full one
+    if (waiting.empty() && fitsNow(minimal)) {
+        return degraded(opts.memoryBytes - memoryUsed, "the server is busy");
+    }
+    if (waiting.size() >= opts.maxQueued) {
+        admission.decision = AdmissionDecision::Reject;
+        admission.reason = "the queue is full";
+        return admission;
+    }
+    admission.decision = AdmissionDecision::Queue;
+    return admission;
+}
+
+std::expected<void, std::string> AdmissionController::acquire(const QueryCost& cost) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!fitsEver(cost)) {
+        return std::unexpected("needs more than the whole budget");
+    }
+    if (waiting.size() >= opts.maxQueued && !(waiting.empty() && fitsNow(cost))) {
+        return std::unexpected("the queue is full");
+    }
+    uint64_t ticket = nextTicket++;
+    waiting.push_back(ticket);
+    auto deadline = std::chrono::steady_clock::now() + opts.maxQueueWait;
+    if (!released.wait_until(lock, deadline, [&] { return waiting.front() == ticket && fitsNow(cost); })) {
+        waiting.erase(std::find(waiting.begin(), waiting.end(), ticket));
+        released.notify_all();  // The next one may be the head now
+        return std::unexpected("waited " + std::to_string(opts.maxQueueWait.count()) + " ms without memory and threads");
+    }
+    waiting.pop_front();
+    ++runningCount;
+    memoryUsed += cost.memoryBytes;
+    threadsUsed += cost.threads;
+    released.notify_all();
+    return {};
+}
+
+void AdmissionController::release(const QueryCost& cost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    --runningCount;
+    memoryUsed -= cost.memoryBytes;
+    threadsUsed -= cost.threads;
+    released.notify_all();
+}
+
+size_t AdmissionController::running() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return runningCount;
+}
+
+size_t AdmissionController::queued() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waiting.size();
+}
+
+size_t AdmissionController::memoryInUse() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryUsed;
+}
+
+uint32_t AdmissionController::threadsInUse() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return threadsUsed;
+}
@@ -0,0 +1,10 @@
+#include "distinct_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> DistinctAstNode::createLogicalNode() const {
+    return ::createLogicalNode<DistinctParams>(logicalParams());
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "ast_node.h"
+#include "distinct_params.h"
+#include <string>
+#include <sstream>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct DistinctAstNode : public AstNode {
+    DistinctParams params;
+    
+    DistinctAstNode(const DistinctParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        std::ostringstream oss;
+        oss << "DistinctAstNode: (keys=" << params.keys.size() << ")";
+        return oss.str();
+    }
+    
+    // Distinct can use the same params for logical phase
+    DistinctParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
@@ -0,0 +1,10 @@
+#include "group_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> GroupAstNode::createLogicalNode() const {
+    return ::createLogicalNode<GroupParams>(logicalParams());
+}
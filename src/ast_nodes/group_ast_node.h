@@ -0,0 +1,32 @@
+#pragma once
+#include "ast_node.h"
+#include "group_params.h"
+#include <string>
+#include <sstream>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct GroupAstNode : public AstNode {
+    GroupParams params;
+    
+    GroupAstNode(const GroupParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        std::ostringstream oss;
+        oss << "GroupAstNode: (keys=" << params.groupKeys.size()
+            << ", aggregates=" << params.aggregates.size() << ")";
+        return oss.str();
+    }
+    
+    // Group can use the same params for logical phase
+    GroupParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
@@ -0,0 +1,10 @@
+#include "join_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> JoinAstNode::createLogicalNode() const {
+    return ::createLogicalNode<JoinParams>(logicalParams());
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "ast_node.h"
+#include "join_params.h"
+#include <string>
+#include <sstream>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct JoinAstNode : public AstNode {
+    JoinParams params;
+    
+    JoinAstNode(const JoinParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        std::ostringstream oss;
+        oss << "JoinAstNode: (table=" << params.table << ", key=" << params.probeKey << ")";
+        return oss.str();
+    }
+    
+    // Join can use the same params for logical phase
+    JoinParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
@@ -15,7 +15,8 @@ struct LimitAstNode : public AstNode {
         : params(params) {}
     
     std::string debugName() const override {
-        return "LimitAstNode: (limit=" + std::to_string(params.limitValue) + ")";
+        return "LimitAstNode: (limit=" + std::to_string(params.limitValue) +
+               (params.offset ? ", offset=" + std::to_string(params.offset) : "") + ")";
     }
     
     // Limit has its own logical params type
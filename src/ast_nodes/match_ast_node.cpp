@@ -0,0 +1,10 @@
+#include "match_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> MatchAstNode::createLogicalNode() const {
+    return ::createLogicalNode<MatchParams>(logicalParams());
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "ast_node.h"
+#include "match_params.h"
+#include <string>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct MatchAstNode : public AstNode {
+    MatchParams params;
+    
+    MatchAstNode(const MatchParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        return "MatchAstNode: (predicate=" + params.predicate + ")";
+    }
+    
+    // Match can use the same params for logical phase
+    MatchParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
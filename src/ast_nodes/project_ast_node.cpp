@@ -0,0 +1,10 @@
+#include "project_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> ProjectAstNode::createLogicalNode() const {
+    return ::createLogicalNode<ProjectParams>(logicalParams());
+}
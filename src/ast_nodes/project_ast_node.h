@@ -0,0 +1,31 @@
+#pragma once
+#include "ast_node.h"
+#include "project_params.h"
+#include <string>
+#include <sstream>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct ProjectAstNode : public AstNode {
+    ProjectParams params;
+    
+    ProjectAstNode(const ProjectParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        std::ostringstream oss;
+        oss << "ProjectAstNode: (fields=" << params.fields.size() << ")";
+        return oss.str();
+    }
+    
+    // Project can use the same params for logical phase
+    ProjectParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
@@ -18,7 +18,8 @@ struct SortAstNode : public AstNode {
     std::string debugName() const override {
         std::ostringstream oss;
         oss << "SortAstNode: (keys=" << params.sortKeys.size()
-            << ", direction=" << (params.ascending ? "ASC" : "DESC") << ")";
+            << ", direction=" << (params.ascending ? "ASC" : "DESC")
+            << ", nulls=" << (params.nullsFirst ? "FIRST" : "LAST") << ")";
         return oss.str();
     }
     
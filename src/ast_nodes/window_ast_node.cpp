@@ -0,0 +1,10 @@
+#include "window_ast_node.h"
+#include "ast_node.h"
+#include "logical_node.h"
+#include "src/logical_nodes/window_logical_node.h"
+#include <memory>
+
+// Implementation of createLogicalNode
+std::unique_ptr<LogicalNode> WindowAstNode::createLogicalNode() const {
+    return ::createLogicalNode<WindowParams>(logicalParams());
+}
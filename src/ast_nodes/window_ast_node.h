@@ -0,0 +1,32 @@
+#pragma once
+#include "ast_node.h"
+#include "window_params.h"
+#include <string>
+#include <sstream>
+
+// Forward declarations
+struct LogicalNode;
+template<typename ParamType>
+std::unique_ptr<LogicalNode> createLogicalNode(const ParamType& params);
+
+struct WindowAstNode : public AstNode {
+    WindowParams params;
+    
+    WindowAstNode(const WindowParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        std::ostringstream oss;
+        oss << "WindowAstNode: (partitionKeys=" << params.partitionKeys.size()
+            << ", functions=" << params.functions.size() << ")";
+        return oss.str();
+    }
+    
+    // Window can use the same params for logical phase
+    WindowParams logicalParams() const {
+        return params;
+    }
+    
+    // Implement createLogicalNode - declared in .cpp to avoid circular deps
+    std::unique_ptr<LogicalNode> createLogicalNode() const override;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+
+// Parameters for Distinct operations throughout the pipeline
+struct DistinctParams {
+    std::vector<std::string> keys;
+    // Output field of the approximate count of distinct keys; empty for an
+    // exact dedup that outputs one row per distinct key
+    std::string approxCountName;
+    std::vector<SymbolId> keyIds;                // Interned keys (empty until interned)
+    SymbolId approxCountNameId = kInvalidSymbol;  // Interned approxCountName
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+
+enum class AggregateOp : uint8_t {
+    Count,
+    Sum,
+    Min,
+    Max,
+    Avg,
+};
+
+// One output column of a group stage, e.g. "total:sum(score * 2)"
+struct AggregateSpec {
+    std::string name;        // Output field
+    AggregateOp op = AggregateOp::Count;
+    std::string argument;    // Expression text; empty for count()
+    SymbolId nameId = kInvalidSymbol;  // Interned name
+};
+
+// Parameters for Group (hash aggregation) operations throughout the pipeline
+struct GroupParams {
+    std::vector<std::string> groupKeys;     // Empty: one group over all rows
+    std::vector<AggregateSpec> aggregates;
+    std::vector<SymbolId> groupKeyIds;      // Interned groupKeys (empty until interned)
+};
+
+inline const char* aggregateOpName(AggregateOp op) {
+    switch (op) {
+        case AggregateOp::Count: return "count";
+        case AggregateOp::Sum: return "sum";
+        case AggregateOp::Min: return "min";
+        case AggregateOp::Max: return "max";
+        case AggregateOp::Avg: return "avg";
+    }
+    return "?";
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include "symbol_id.h"
+
+// Parameters for Join operations throughout the pipeline. The pipeline's
+// input is the probe side; the build side is a catalog table.
+struct JoinParams {
+    std::string table;      // Catalog table to build from
+    std::string probeKey;   // Key field of the input
+    std::string buildKey;   // Key field of the table
+    SymbolId probeKeyId = kInvalidSymbol;  // Interned keys (invalid until interned)
+    SymbolId buildKeyId = kInvalidSymbol;
+};
@@ -1,7 +1,12 @@
 #pragma once
+#include <cstddef>
 
 // Parameters for Limit operations throughout the pipeline
 struct LimitParams {
     int limitValue = 0;  // How many rows to limit
+    int offset = 0;      // Rows skipped before the kept ones
+
+    // Leading input rows the output is taken from
+    size_t rowsNeeded() const { return static_cast<size_t>(offset) + static_cast<size_t>(limitValue); }
 };
 
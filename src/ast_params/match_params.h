@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// Parameters for Match (filter) operations throughout the pipeline
+struct MatchParams {
+    std::string predicate;  // Bool expression; rows where it is true are kept
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+
+// Parameters for Project operations throughout the pipeline
+struct ProjectParams {
+    std::vector<std::string> fields;   // Output fields, in output order
+    // Keep the fields in input order instead (set on the stage the column
+    // pruning pass puts at the front of a pipeline)
+    bool inputOrder = false;
+    std::vector<SymbolId> fieldIds;    // Interned fields (empty until interned)
+};
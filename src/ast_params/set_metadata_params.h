@@ -1,9 +1,11 @@
 #pragma once
 #include <string>
+#include "symbol_id.h"
 
 // Parameters for SetMetadata operations throughout the pipeline
 struct SetMetadataParams {
     std::string metaName;     // Name of the metadata field
     std::string expression;   // Expression to compute the metadata value
+    SymbolId metaNameId = kInvalidSymbol;  // Interned metaName
 };
 
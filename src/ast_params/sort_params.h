@@ -1,10 +1,13 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "symbol_id.h"
 
 // Parameters for Sort operations throughout the pipeline
 struct SortParams {
     std::vector<std::string> sortKeys;  // Which fields to sort by
     bool ascending = true;               // Sort direction
+    bool nullsFirst = false;             // Null keys before (true) or after all values
+    std::vector<SymbolId> sortKeyIds;    // Interned sortKeys (empty until interned)
 };
 
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "symbol_id.h"
+
+enum class WindowOp : uint8_t {
+    RowNumber,
+    Rank,
+    DenseRank,
+    Count,
+    Sum,
+    Min,
+    Max,
+    Avg,
+};
+
+// One output column of a window stage, e.g. "moving:avg(score) rows(-2, 0)".
+// The frame is a range of rows relative to the current one (negative:
+// preceding), clamped to the partition; rank functions ignore it.
+struct WindowFunctionSpec {
+    std::string name;        // Output field
+    WindowOp op = WindowOp::RowNumber;
+    std::string argument;    // Expression text; empty for the rank functions and count()
+    bool startUnbounded = true;
+    bool endUnbounded = false;
+    int64_t frameStart = 0;  // Unless startUnbounded
+    int64_t frameEnd = 0;    // Unless endUnbounded
+    SymbolId nameId = kInvalidSymbol;  // Interned name
+};
+
+// Parameters for Window operations throughout the pipeline
+struct WindowParams {
+    std::vector<std::string> partitionKeys;  // Empty: the whole input is one partition
+    std::vector<std::string> orderKeys;      // Order within a partition
+    bool ascending = true;
+    std::vector<WindowFunctionSpec> functions;
+    std::vector<SymbolId> partitionKeyIds;   // Interned keys (empty until interned)
+    std::vector<SymbolId> orderKeyIds;
+};
+
+inline const char* windowOpName(WindowOp op) {
+    switch (op) {
+        case WindowOp::RowNumber: return "row_number";
+        case WindowOp::Rank: return "rank";
+        case WindowOp::DenseRank: return "dense_rank";
+        case WindowOp::Count: return "count";
+        case WindowOp::Sum: return "sum";
+        case WindowOp::Min: return "min";
+        case WindowOp::Max: return "max";
+        case WindowOp::Avg: return "avg";
+    }
+    return "?";
+}
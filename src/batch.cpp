@@ -0,0 +1,500 @@
+#include "batch.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+void andValidity(ValidityBitmap& dst, const ValidityBitmap& src, size_t rows) {
+    if (src.empty()) {
+        return;
+    }
+    size_t words = validityWords(rows);
+    if (dst.empty()) {
+        dst.assign(src.begin(), src.begin() + words);
+        return;
+    }
+    uint64_t* out = dst.data();
+    const uint64_t* in = src.data();
+    size_t w = 0;
+#if defined(__GNUC__)
+    // Four words per step through the portable vector extension; lowered to
+    // SSE2/AVX2/NEON ANDs depending on the target
+    typedef uint64_t Words4 __attribute__((vector_size(32)));
+    for (; w + 4 <= words; w += 4) {
+        Words4 a, b;
+        std::memcpy(&a, out + w, sizeof(a));
+        std::memcpy(&b, in + w, sizeof(b));
+        a &= b;
+        std::memcpy(out + w, &a, sizeof(a));
+    }
+#endif
+    for (; w < words; ++w) {
+        out[w] &= in[w];
+    }
+}
+
+void Column::setValid(size_t row, bool valid) {
+    if (!valid) {
+        zones.reset();
+        vectorIndex.reset();
+        textIndex.reset();
+    }
+    if (validity.empty()) {
+        if (valid) {
+            return;
+        }
+        validity.assign(validityWords(size()), ~uint64_t{0});
+    }
+    uint64_t bit = uint64_t{1} << (row % 64);
+    validity[row / 64] = valid ? (validity[row / 64] | bit) : (validity[row / 64] & ~bit);
+}
+
+void Column::compactValidity() {
+    size_t rows = size();
+    for (size_t w = 0; w < validity.size(); ++w) {
+        uint64_t expected = (w + 1) * 64 <= rows ? ~uint64_t{0} : (uint64_t{1} << (rows % 64)) - 1;
+        if ((validity[w] & expected) != expected) {
+            return;
+        }
+    }
+    validity.clear();
+}
+
+// Validity of rows[i] becomes bit i
+static ValidityBitmap gatherValidity(const ValidityBitmap& validity, const std::vector<uint32_t>& rows) {
+    if (validity.empty()) {
+        return {};
+    }
+    ValidityBitmap out(validityWords(rows.size()), 0);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        uint64_t bit = (validity[rows[i] / 64] >> (rows[i] % 64)) & 1;
+        out[i / 64] |= bit << (i % 64);
+    }
+    return out;
+}
+
+Column Column::ofBools(std::vector<uint8_t> values) {
+    Column column;
+    column.type = PhysicalType::Bool;
+    column.bools = std::move(values);
+    return column;
+}
+
+Column Column::ofInts(std::vector<int64_t> values) {
+    Column column;
+    column.type = PhysicalType::Int64;
+    column.ints = std::move(values);
+    return column;
+}
+
+Column Column::ofDoubles(std::vector<double> values) {
+    Column column;
+    column.type = PhysicalType::Double;
+    column.doubles = std::move(values);
+    return column;
+}
+
+Column Column::ofStrings(std::vector<std::string> values) {
+    Column column;
+    column.type = PhysicalType::String;
+    column.strings = std::move(values);
+    return column;
+}
+
+Column Column::ofDictionary(std::shared_ptr<const StringDictionary> dictionary,
+                           std::vector<uint32_t> codes) {
+    Column column;
+    column.type = PhysicalType::String;
+    column.dictionary = std::move(dictionary);
+    column.codes = std::move(codes);
+    return column;
+}
+
+Column Column::dictionaryEncode(const std::vector<std::string>& values) {
+    // Codes in first-seen order, then renumbered by sorted position
+    std::unordered_map<std::string_view, uint32_t> seen;
+    std::vector<uint32_t> codes;
+    codes.reserve(values.size());
+    StringDictionary distinct;
+    for (const auto& value : values) {
+        auto [it, inserted] = seen.emplace(value, static_cast<uint32_t>(distinct.size()));
+        if (inserted) {
+            distinct.push_back(value);
+        }
+        codes.push_back(it->second);
+    }
+
+    std::vector<uint32_t> order(distinct.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&distinct](uint32_t a, uint32_t b) { return distinct[a] < distinct[b]; });
+    std::vector<uint32_t> rank(distinct.size());
+    auto dictionary = std::make_shared<StringDictionary>();
+    dictionary->reserve(distinct.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        rank[order[i]] = i;
+        dictionary->push_back(std::move(distinct[order[i]]));
+    }
+    for (auto& code : codes) {
+        code = rank[code];
+    }
+    return ofDictionary(std::move(dictionary), std::move(codes));
+}
+
+Column Column::ofPacked(PackedInts values) {
+    Column column;
+    column.type = PhysicalType::Int64;
+    column.packed = std::make_shared<const PackedInts>(std::move(values));
+    return column;
+}
+
+Column Column::packInts(const std::vector<int64_t>& values) {
+    return ofPacked(PackedInts::pack(values));
+}
+
+Column Column::ofVectors(uint32_t dimension, std::vector<float> values) {
+    Column column;
+    column.type = PhysicalType::Vector;
+    column.dimension = dimension;
+    column.floats = std::move(values);
+    return column;
+}
+
+Column Column::quantizeVectors(uint32_t dimension, const std::vector<float>& values) {
+    Column column;
+    column.type = PhysicalType::Vector;
+    column.dimension = dimension;
+    column.quantized = std::make_shared<const QuantizedVectors>(QuantizedVectors::quantize(dimension, values));
+    return column;
+}
+
+size_t Column::size() const {
+    switch (type) {
+        case PhysicalType::Bool: return bools.size();
+        case PhysicalType::Int64: return packed ? packed->count : ints.size();
+        case PhysicalType::Double: return doubles.size();
+        case PhysicalType::String: return dictionary ? codes.size() : strings.size();
+        case PhysicalType::Vector:
+            return quantized ? quantized->count() : (dimension ? floats.size() / dimension : 0);
+    }
+    return 0;
+}
+
+size_t Column::byteSize() const {
+    size_t bytes = bools.size() + ints.size() * sizeof(int64_t) + doubles.size() * sizeof(double) +
+                   floats.size() * sizeof(float) + codes.size() * sizeof(uint32_t) +
+                   validity.size() * sizeof(uint64_t);
+    for (const auto& value : strings) {
+        bytes += sizeof(std::string) + value.size();
+    }
+    if (dictionary) {
+        for (const auto& value : *dictionary) {
+            bytes += sizeof(std::string) + value.size();
+        }
+    }
+    if (packed) {
+        bytes += packed->byteSize();
+    }
+    if (quantized) {
+        bytes += quantized->codes.size() + (quantized->scales.size() + quantized->norms.size()) * sizeof(float);
+    }
+    return bytes;
+}
+
+Column Column::decoded() const {
+    if (packed) {
+        Column plain = ofInts(packed->unpackAll());
+        plain.validity = validity;
+        plain.zones = zones;
+        return plain;
+    }
+    if (quantized) {
+        Column plain = ofVectors(dimension, quantized->dequantize());
+        plain.validity = validity;
+        plain.vectorIndex = vectorIndex;
+        return plain;
+    }
+    if (!dictionary) {
+        return *this;
+    }
+    Column plain;
+    plain.type = PhysicalType::String;
+    plain.validity = validity;
+    plain.textIndex = textIndex;
+    plain.strings.reserve(codes.size());
+    for (uint32_t code : codes) {
+        plain.strings.push_back((*dictionary)[code]);
+    }
+    return plain;
+}
+
+// Min/max over the valid rows of each block; NaNs widen a block to the
+// whole line and make it inexact
+template <typename T>
+static void buildZones(const Column& column, const T* values, size_t rows, std::vector<T>& mins,
+                       std::vector<T>& maxs, std::vector<uint8_t>& exact) {
+    size_t blocks = (rows + ZoneMap::kBlockRows - 1) / ZoneMap::kBlockRows;
+    mins.assign(blocks, std::numeric_limits<T>::max());
+    maxs.assign(blocks, std::numeric_limits<T>::lowest());
+    exact.assign(blocks, 1);
+    for (size_t b = 0; b < blocks; ++b) {
+        size_t begin = b * ZoneMap::kBlockRows;
+        size_t end = std::min(rows, begin + ZoneMap::kBlockRows);
+        T lo = mins[b];
+        T hi = maxs[b];
+        for (size_t r = begin; r < end; ++r) {
+            if (!column.isValid(r)) {
+                exact[b] = 0;
+                continue;
+            }
+            T v = values[r];
+            if constexpr (std::is_floating_point_v<T>) {
+                if (v != v) {
+                    exact[b] = 0;
+                    lo = -std::numeric_limits<T>::infinity();
+                    hi = std::numeric_limits<T>::infinity();
+                    continue;
+                }
+            }
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        mins[b] = lo;
+        maxs[b] = hi;
+    }
+}
+
+void Column::buildZoneMap() {
+    auto map = std::make_shared<ZoneMap>();
+    if (type == PhysicalType::Int64) {
+        std::vector<int64_t> unpacked;
+        const int64_t* values = ints.data();
+        if (packed) {
+            unpacked = packed->unpackAll();
+            values = unpacked.data();
+        }
+        buildZones(*this, values, size(), map->intMin, map->intMax, map->exact);
+    } else if (type == PhysicalType::Double) {
+        buildZones(*this, doubles.data(), size(), map->doubleMin, map->doubleMax, map->exact);
+    } else {
+        return;
+    }
+    zones = std::move(map);
+}
+
+// Merges two sorted dictionaries, filling the old-code -> merged-code maps
+static std::shared_ptr<const StringDictionary> mergeDictionaries(const StringDictionary& a,
+                                                                 const StringDictionary& b,
+                                                                 std::vector<uint32_t>& remapA,
+                                                                 std::vector<uint32_t>& remapB) {
+    auto merged = std::make_shared<StringDictionary>();
+    merged->reserve(a.size() + b.size());
+    remapA.resize(a.size());
+    remapB.resize(b.size());
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        auto code = static_cast<uint32_t>(merged->size());
+        if (j == b.size() || (i < a.size() && a[i] < b[j])) {
+            remapA[i] = code;
+            merged->push_back(a[i++]);
+        } else if (i == a.size() || b[j] < a[i]) {
+            remapB[j] = code;
+            merged->push_back(b[j++]);
+        } else {
+            remapA[i] = code;
+            remapB[j] = code;
+            merged->push_back(a[i++]);
+            ++j;
+        }
+    }
+    return merged;
+}
+
+void Column::append(const Column& src) {
+    zones.reset();
+    vectorIndex.reset();
+    textIndex.reset();
+    if (packed || quantized) {
+        *this = decoded();  // Appending would usually change the frame
+    }
+    size_t oldSize = size();
+    if (src.packed) {
+        ints.insert(ints.end(), src.packed->count, 0);
+        src.packed->unpack(0, src.packed->count, ints.data() + oldSize);
+    } else if (dictionary) {
+        Column encoded = src.dictionary ? Column{} : dictionaryEncode(src.strings);
+        const Column& other = src.dictionary ? src : encoded;
+        if (other.dictionary == dictionary) {
+            codes.insert(codes.end(), other.codes.begin(), other.codes.end());
+        } else {
+            std::vector<uint32_t> remapOld, remapNew;
+            dictionary = mergeDictionaries(*dictionary, *other.dictionary, remapOld, remapNew);
+            for (auto& code : codes) code = remapOld[code];
+            codes.reserve(codes.size() + other.codes.size());
+            for (uint32_t code : other.codes) codes.push_back(remapNew[code]);
+        }
+    } else if (src.dictionary) {
+        Column plain = src.decoded();
+        strings.insert(strings.end(), std::make_move_iterator(plain.strings.begin()),
+                       std::make_move_iterator(plain.strings.end()));
+    } else if (src.quantized) {
+        std::vector<float> values = src.quantized->dequantize();
+        floats.insert(floats.end(), values.begin(), values.end());
+    } else {
+        switch (type) {
+            case PhysicalType::Bool: bools.insert(bools.end(), src.bools.begin(), src.bools.end()); break;
+            case PhysicalType::Int64: ints.insert(ints.end(), src.ints.begin(), src.ints.end()); break;
+            case PhysicalType::Double: doubles.insert(doubles.end(), src.doubles.begin(), src.doubles.end()); break;
+            case PhysicalType::String: strings.insert(strings.end(), src.strings.begin(), src.strings.end()); break;
+            case PhysicalType::Vector: floats.insert(floats.end(), src.floats.begin(), src.floats.end()); break;
+        }
+    }
+
+    if (hasNulls()) {
+        validity.resize(validityWords(size()), ~uint64_t{0});
+    }
+    if (hasNulls() || src.hasNulls()) {
+        for (size_t i = 0; i < src.size(); ++i) {
+            setValid(oldSize + i, src.isValid(i));
+        }
+    }
+}
+
+// Rows of `dimension` floats in the given order
+static std::vector<float> selectVectors(const std::vector<float>& values, uint32_t dimension,
+                                        const std::vector<uint32_t>& rows) {
+    std::vector<float> out(rows.size() * dimension);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        std::copy_n(values.begin() + static_cast<ptrdiff_t>(rows[i]) * dimension, dimension,
+                    out.begin() + static_cast<ptrdiff_t>(i) * dimension);
+    }
+    return out;
+}
+
+template <typename T>
+static void gatherValues(std::vector<T>& values, const std::vector<uint32_t>& rows) {
+    std::vector<T> out;
+    out.reserve(rows.size());
+    for (uint32_t row : rows) {
+        out.push_back(std::move(values[row]));
+    }
+    values = std::move(out);
+}
+
+void Column::gather(const std::vector<uint32_t>& rows) {
+    zones.reset();
+    vectorIndex.reset();
+    textIndex.reset();
+    validity = gatherValidity(validity, rows);
+    if (dictionary) {
+        gatherValues(codes, rows);
+        return;
+    }
+    if (packed) {
+        packed = std::make_shared<const PackedInts>(packed->select(rows));
+        return;
+    }
+    if (quantized) {
+        quantized = std::make_shared<const QuantizedVectors>(quantized->select(rows));
+        return;
+    }
+    switch (type) {
+        case PhysicalType::Bool: gatherValues(bools, rows); break;
+        case PhysicalType::Int64: gatherValues(ints, rows); break;
+        case PhysicalType::Double: gatherValues(doubles, rows); break;
+        case PhysicalType::String: gatherValues(strings, rows); break;
+        case PhysicalType::Vector: floats = selectVectors(floats, dimension, rows); break;
+    }
+}
+
+template <typename T>
+static std::vector<T> selectValues(const std::vector<T>& values, const SelectionVector& rows) {
+    std::vector<T> out;
+    out.reserve(rows.size());
+    for (uint32_t row : rows) {
+        out.push_back(values[row]);
+    }
+    return out;
+}
+
+Column Column::select(const SelectionVector& rows) const {
+    Column out;
+    out.type = type;
+    out.validity = gatherValidity(validity, rows);
+    if (dictionary) {
+        out.dictionary = dictionary;
+        out.codes = selectValues(codes, rows);
+        return out;
+    }
+    if (packed) {
+        out.packed = std::make_shared<const PackedInts>(packed->select(rows));
+        return out;
+    }
+    out.dimension = dimension;
+    if (quantized) {
+        out.quantized = std::make_shared<const QuantizedVectors>(quantized->select(rows));
+        return out;
+    }
+    switch (type) {
+        case PhysicalType::Bool: out.bools = selectValues(bools, rows); break;
+        case PhysicalType::Int64: out.ints = selectValues(ints, rows); break;
+        case PhysicalType::Double: out.doubles = selectValues(doubles, rows); break;
+        case PhysicalType::String: out.strings = selectValues(strings, rows); break;
+        case PhysicalType::Vector: out.floats = selectVectors(floats, dimension, rows); break;
+    }
+    return out;
+}
+
+void Column::truncate(size_t rowCount) {
+    if (rowCount >= size()) {
+        return;
+    }
+    zones.reset();
+    vectorIndex.reset();
+    textIndex.reset();
+    if (dictionary) {
+        codes.resize(rowCount);
+    } else if (packed) {
+        auto shorter = std::make_shared<PackedInts>(*packed);
+        shorter->truncate(rowCount);
+        packed = std::move(shorter);
+    } else if (quantized) {
+        auto shorter = std::make_shared<QuantizedVectors>(*quantized);
+        shorter->truncate(rowCount);
+        quantized = std::move(shorter);
+    } else {
+        switch (type) {
+            case PhysicalType::Bool: bools.resize(rowCount); break;
+            case PhysicalType::Int64: ints.resize(rowCount); break;
+            case PhysicalType::Double: doubles.resize(rowCount); break;
+            case PhysicalType::String: strings.resize(rowCount); break;
+            case PhysicalType::Vector: floats.resize(rowCount * dimension); break;
+        }
+    }
+    if (hasNulls()) {
+        validity.resize(validityWords(rowCount));
+    }
+}
+
+size_t Batch::byteSize() const {
+    size_t bytes = 0;
+    for (const auto& column : columns) {
+        bytes += column.byteSize();
+    }
+    return bytes;
+}
+
+void Batch::setColumn(const Field& field, Column column) {
+    for (size_t i = 0; i < schema.fields.size(); ++i) {
+        if (schema.fields[i].name == field.name) {
+            schema.fields[i] = field;
+            columns[i] = std::move(column);
+            return;
+        }
+    }
+    schema.fields.push_back(field);
+    columns.push_back(std::move(column));
+}
@@ -0,0 +1,111 @@
+#include "bloom_filter.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+// One odd multiplier per word of a block (the Parquet SBBF salts)
+constexpr uint32_t kSalts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// MurmurHash3 fmix64
+inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hashDouble(double v) {
+    if (v != v) return mix(0x7ff8000000000000ULL);  // One hash for all NaNs
+    if (v == 0) v = 0;                              // -0.0 == 0.0
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return mix(bits);
+}
+
+inline uint64_t hashString(const std::string& v) {
+    return mix(std::hash<std::string>{}(v));
+}
+
+inline size_t blockIndex(uint64_t hash, size_t blocks) {
+    return static_cast<size_t>(((hash >> 32) * blocks) >> 32);
+}
+
+} // namespace
+
+BlockedBloomFilter BlockedBloomFilter::withCapacity(size_t keys, size_t bitsPerKey) {
+    BlockedBloomFilter filter;
+    size_t bits = std::max<size_t>(keys * bitsPerKey, 1);
+    filter.blocks.assign(std::bit_ceil((bits + 255) / 256), Block{});
+    return filter;
+}
+
+void BlockedBloomFilter::insert(uint64_t hash) {
+    Block& block = blocks[blockIndex(hash, blocks.size())];
+    auto key = static_cast<uint32_t>(hash);
+    for (size_t w = 0; w < 8; ++w) {
+        block[w] |= uint32_t{1} << ((key * kSalts[w]) >> 27);
+    }
+}
+
+bool BlockedBloomFilter::mayContain(uint64_t hash) const {
+    const Block& block = blocks[blockIndex(hash, blocks.size())];
+    auto key = static_cast<uint32_t>(hash);
+    uint32_t missing = 0;
+    for (size_t w = 0; w < 8; ++w) {
+        missing |= ~block[w] & (uint32_t{1} << ((key * kSalts[w]) >> 27));
+    }
+    return missing == 0;
+}
+
+void hashKeyValues(const Column& column, std::vector<uint64_t>& hashes) {
+    size_t rows = column.size();
+    hashes.resize(rows);
+    if (column.isDictionary()) {
+        // Each distinct string is hashed once
+        std::vector<uint64_t> entryHashes(column.dictionary->size());
+        for (size_t i = 0; i < entryHashes.size(); ++i) {
+            entryHashes[i] = hashString((*column.dictionary)[i]);
+        }
+        for (size_t r = 0; r < rows; ++r) hashes[r] = entryHashes[column.codes[r]];
+        return;
+    }
+    if (column.isPacked()) {
+        std::vector<int64_t> values = column.packed->unpackAll();
+        for (size_t r = 0; r < rows; ++r) hashes[r] = mix(static_cast<uint64_t>(values[r]));
+        return;
+    }
+    switch (column.type) {
+        case PhysicalType::Bool:
+            for (size_t r = 0; r < rows; ++r) hashes[r] = mix(column.bools[r]);
+            break;
+        case PhysicalType::Int64:
+            for (size_t r = 0; r < rows; ++r) hashes[r] = mix(static_cast<uint64_t>(column.ints[r]));
+            break;
+        case PhysicalType::Double:
+            for (size_t r = 0; r < rows; ++r) hashes[r] = hashDouble(column.doubles[r]);
+            break;
+        case PhysicalType::String:
+            for (size_t r = 0; r < rows; ++r) hashes[r] = hashString(column.strings[r]);
+            break;
+        case PhysicalType::Vector:
+            break;  // Not a key type
+    }
+}
+
+SelectionVector RuntimeFilter::select(const Column& key, const std::vector<uint64_t>& hashes) const {
+    SelectionVector rows(hashes.size());
+    size_t count = 0;
+    // Branch-free compaction: always write, advance only on a hit
+    for (uint32_t r = 0; r < hashes.size(); ++r) {
+        rows[count] = r;
+        count += static_cast<size_t>(key.isValid(r) && bloom.mayContain(hashes[r]));
+    }
+    rows.resize(count);
+    return rows;
+}
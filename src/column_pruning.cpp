@@ -0,0 +1,133 @@
+#include "column_pruning.h"
+#include "pipeline.h"
+#include "batch.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include <algorithm>
+#include <optional>
+
+// Fields needed at some point of the pipeline; nullopt means all of them
+using RequiredFields = std::optional<std::vector<std::string>>;
+
+static bool contains(const std::vector<std::string>& names, const std::string& name) {
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+static void addField(std::vector<std::string>& names, const std::string& name) {
+    if (!contains(names, name)) {
+        names.push_back(name);
+    }
+}
+
+// Adds the fields read by expression text; false if it does not parse
+static bool addExpressionFields(std::vector<std::string>& names, const std::expected<ExprPtr, Diagnostic>& parsed) {
+    if (!parsed) {
+        return false;
+    }
+    std::vector<std::string> fields;
+    collectFieldNames(**parsed, fields);
+    for (const auto& field : fields) {
+        addField(names, field);
+    }
+    return true;
+}
+
+// Keeps only the fields still needed downstream (always at least one, so
+// the batch keeps its row count)
+static void narrowProject(ProjectParams& params, const std::vector<std::string>& required) {
+    ProjectParams narrowed = params;
+    narrowed.fields.clear();
+    narrowed.fieldIds.clear();
+    for (size_t i = 0; i < params.fields.size(); ++i) {
+        if (contains(required, params.fields[i]) || (i + 1 == params.fields.size() && narrowed.fields.empty())) {
+            narrowed.fields.push_back(params.fields[i]);
+            if (i < params.fieldIds.size()) narrowed.fieldIds.push_back(params.fieldIds[i]);
+        }
+    }
+    params = std::move(narrowed);
+}
+
+void pruneColumns(Pipeline& pipeline) {
+    auto& stages = pipeline.stages;
+    RequiredFields required;
+    for (size_t i = stages.size(); i-- > 0;) {
+        LogicalNode* stage = stages[i].get();
+        if (auto* project = dynamic_cast<ProjectLogicalNode*>(stage)) {
+            if (required) {
+                narrowProject(project->params, *required);
+            }
+            required = project->params.fields;
+        } else if (auto* group = dynamic_cast<GroupLogicalNode*>(stage)) {
+            std::vector<std::string> inputs = group->params.groupKeys;
+            bool parsed = true;
+            for (const auto& agg : group->params.aggregates) {
+                if (!agg.argument.empty()) {
+                    parsed = parsed && addExpressionFields(inputs, parseExpression(agg.argument));
+                }
+            }
+            required = parsed ? RequiredFields(std::move(inputs)) : std::nullopt;
+        } else if (auto* distinct = dynamic_cast<DistinctLogicalNode*>(stage)) {
+            required = distinct->params.keys;
+        } else if (auto* sort = dynamic_cast<SortLogicalNode*>(stage)) {
+            if (required) {
+                for (const auto& key : sort->params.sortKeys) addField(*required, key);
+            }
+        } else if (auto* match = dynamic_cast<MatchLogicalNode*>(stage)) {
+            if (required && !addExpressionFields(*required, match->parsedExpression())) {
+                required.reset();
+            }
+        } else if (auto* setMetadata = dynamic_cast<SetMetadataLogicalNode*>(stage)) {
+            if (!required) {
+                continue;
+            }
+            const std::string& name = setMetadata->params.metaName;
+            if (contains(*required, name)) {
+                required->erase(std::find(required->begin(), required->end(), name));
+            } else if (!setMetadata->hasSideEffects()) {
+                stages.erase(stages.begin() + i);  // Nothing downstream reads it
+                continue;
+            }
+            if (setMetadata->hasSideEffects()) {
+                addField(*required, setMetadata->rowIdField);  // Read by the sink and store
+            }
+            if (!addExpressionFields(*required, setMetadata->parsedExpression())) {
+                required.reset();
+            }
+        } else if (auto* join = dynamic_cast<JoinLogicalNode*>(stage)) {
+            if (!required) {
+                continue;
+            }
+            if (!join->buildSide) {
+                required.reset();  // Reported when the pipeline is bound
+                continue;
+            }
+            // Table fields come from the build side, not the input
+            for (const auto& field : join->buildSide->schema.fields) {
+                if (auto it = std::find(required->begin(), required->end(), field.name); it != required->end()) {
+                    required->erase(it);
+                }
+            }
+            addField(*required, join->params.probeKey);
+        } else if (auto* filter = dynamic_cast<RuntimeFilterLogicalNode*>(stage)) {
+            if (required) {
+                addField(*required, filter->keyName);
+            }
+        } else if (!dynamic_cast<LimitLogicalNode*>(stage)) {
+            required.reset();  // Unknown stage: assume it reads everything
+        }
+    }
+
+    if (!required || required->empty() || (!stages.empty() && dynamic_cast<ProjectLogicalNode*>(stages[0].get()))) {
+        return;
+    }
+    ProjectParams source;
+    source.fields = std::move(*required);
+    source.inputOrder = true;
+    stages.insert(stages.begin(), createLogicalNode<ProjectParams>(source));
+}
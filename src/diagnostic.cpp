@@ -0,0 +1,61 @@
+#include "diagnostic.h"
+#include <algorithm>
+
+const char* Diagnostic::message() const {
+    switch (code) {
+        case DiagnosticCode::UnknownNodeType:
+            return "unknown parse node type";
+        case DiagnosticCode::EmptyStage:
+            return "empty pipeline stage";
+        case DiagnosticCode::ExpectedInteger:
+            return "expected an integer";
+        case DiagnosticCode::IntegerOutOfRange:
+            return "integer out of range";
+        case DiagnosticCode::NegativeLimit:
+            return "limit must not be negative";
+        case DiagnosticCode::UnexpectedCharacter:
+            return "unexpected character";
+        case DiagnosticCode::ExpectedFieldName:
+            return "expected a field name";
+        case DiagnosticCode::UnknownSortDirection:
+            return "sort option must be 'asc', 'desc', 'nulls_first' or 'nulls_last'";
+        case DiagnosticCode::EmptyMetadataName:
+            return "metadata name must not be empty";
+        case DiagnosticCode::EmptyExpression:
+            return "expression must not be empty";
+        case DiagnosticCode::UnsupportedParams:
+            return "no AST node registered for these params";
+        case DiagnosticCode::ExpectedExpression:
+            return "expected an expression";
+        case DiagnosticCode::UnterminatedString:
+            return "unterminated string literal";
+        case DiagnosticCode::ExpectedClosingParen:
+            return "expected ')'";
+        case DiagnosticCode::UnknownFunction:
+            return "unknown function";
+        case DiagnosticCode::WrongArgumentCount:
+            return "wrong number of arguments";
+        case DiagnosticCode::UnknownField:
+            return "field not found in input schema";
+        case DiagnosticCode::TypeMismatch:
+            return "operand types do not match";
+        case DiagnosticCode::UnknownTable:
+            return "table not found in catalog";
+        case DiagnosticCode::DuplicateField:
+            return "field name already in input schema";
+        case DiagnosticCode::ExpectedClosingBracket:
+            return "expected ']'";
+    }
+    return "unknown error";
+}
+
+std::string formatDiagnostic(const Diagnostic& diag, std::string_view input) {
+    std::string out = diag.message();
+    out += " at position " + std::to_string(diag.position) + "\n  ";
+    out.append(input);
+    out += "\n  ";
+    size_t position = std::min<size_t>(diag.position, input.size());
+    out.append(position, ' ');
+    out.append(std::max<size_t>(diag.length, 1), '^');
+    return out;
+}
@@ -0,0 +1,642 @@
+#include "expression.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+ExprPtr makeLiteral(int64_t value) {
+    auto expr = std::make_shared<Expr>();
+    expr->type = PhysicalType::Int64;
+    expr->intValue = value;
+    return expr;
+}
+
+ExprPtr makeLiteral(double value) {
+    auto expr = std::make_shared<Expr>();
+    expr->type = PhysicalType::Double;
+    expr->doubleValue = value;
+    return expr;
+}
+
+ExprPtr makeBoolLiteral(bool value) {
+    auto expr = std::make_shared<Expr>();
+    expr->type = PhysicalType::Bool;
+    expr->intValue = value ? 1 : 0;
+    return expr;
+}
+
+ExprPtr makeStringLiteral(std::string value) {
+    auto expr = std::make_shared<Expr>();
+    expr->type = PhysicalType::String;
+    expr->stringValue = std::move(value);
+    return expr;
+}
+
+ExprPtr makeVectorLiteral(std::vector<float> value) {
+    auto expr = std::make_shared<Expr>();
+    expr->type = PhysicalType::Vector;
+    expr->vectorValue = std::move(value);
+    return expr;
+}
+
+ExprPtr makeField(std::string name) {
+    auto expr = std::make_shared<Expr>();
+    expr->kind = ExprKind::Field;
+    expr->name = std::move(name);
+    return expr;
+}
+
+ExprPtr makeCall(ExprOp op, std::vector<ExprPtr> args, uint32_t position) {
+    auto expr = std::make_shared<Expr>();
+    expr->kind = ExprKind::Call;
+    expr->op = op;
+    expr->args = std::move(args);
+    expr->position = position;
+    return expr;
+}
+
+const char* exprOpName(ExprOp op) {
+    switch (op) {
+        case ExprOp::Add: return "+";
+        case ExprOp::Sub: return "-";
+        case ExprOp::Mul: return "*";
+        case ExprOp::Div: return "/";
+        case ExprOp::Neg: return "-";
+        case ExprOp::Sum: return "sum";
+        case ExprOp::Min: return "min";
+        case ExprOp::Max: return "max";
+        case ExprOp::Abs: return "abs";
+        case ExprOp::Eq: return "==";
+        case ExprOp::Ne: return "!=";
+        case ExprOp::Lt: return "<";
+        case ExprOp::Le: return "<=";
+        case ExprOp::Gt: return ">";
+        case ExprOp::Ge: return ">=";
+        case ExprOp::And: return "and";
+        case ExprOp::Or: return "or";
+        case ExprOp::Not: return "not";
+        case ExprOp::If: return "if";
+        case ExprOp::Coalesce: return "coalesce";
+        case ExprOp::IsNull: return "is_null";
+        case ExprOp::ToDouble: return "to_double";
+        case ExprOp::Dot: return "dot";
+        case ExprOp::Cosine: return "cosine";
+        case ExprOp::Bm25: return "bm25";
+    }
+    return "?";
+}
+
+static bool isInfix(ExprOp op) {
+    switch (op) {
+        case ExprOp::Add: case ExprOp::Sub: case ExprOp::Mul: case ExprOp::Div:
+        case ExprOp::Eq: case ExprOp::Ne: case ExprOp::Lt: case ExprOp::Le:
+        case ExprOp::Gt: case ExprOp::Ge: case ExprOp::And: case ExprOp::Or:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct NamedFunction {
+    const char* name;
+    ExprOp op;
+    size_t minArgs;
+    size_t maxArgs;
+};
+
+constexpr NamedFunction kFunctions[] = {
+    {"sum", ExprOp::Sum, 1, SIZE_MAX},
+    {"min", ExprOp::Min, 1, SIZE_MAX},
+    {"max", ExprOp::Max, 1, SIZE_MAX},
+    {"abs", ExprOp::Abs, 1, 1},
+    {"not", ExprOp::Not, 1, 1},
+    {"if", ExprOp::If, 3, 3},
+    {"coalesce", ExprOp::Coalesce, 1, SIZE_MAX},
+    {"is_null", ExprOp::IsNull, 1, 1},
+    {"to_double", ExprOp::ToDouble, 1, 1},
+    {"dot", ExprOp::Dot, 2, 2},
+    {"cosine", ExprOp::Cosine, 2, 2},
+    {"bm25", ExprOp::Bm25, 2, 2},
+};
+
+using ParseResult = std::expected<ExprPtr, Diagnostic>;
+
+struct ExpressionParser {
+    std::string_view text;
+    size_t pos = 0;
+
+    Diagnostic error(DiagnosticCode code, size_t at, size_t length = 1) const {
+        return Diagnostic{code, static_cast<uint32_t>(at), static_cast<uint32_t>(length)};
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+    }
+
+    bool consume(std::string_view token) {
+        skipSpace();
+        if (text.substr(pos, token.size()) == token) {
+            pos += token.size();
+            return true;
+        }
+        return false;
+    }
+
+    static bool isIdentStart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool isIdentChar(char c) {
+        return isIdentStart(c) || (c >= '0' && c <= '9') || c == '.';
+    }
+
+    // Consumes a keyword operator ("and", "or") only as a whole word
+    bool consumeKeyword(std::string_view word) {
+        skipSpace();
+        if (text.substr(pos, word.size()) == word &&
+            (pos + word.size() == text.size() || !isIdentChar(text[pos + word.size()]))) {
+            pos += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    ParseResult parse() {
+        auto expr = parseOr();
+        if (!expr) return expr;
+        skipSpace();
+        if (pos != text.size()) {
+            return std::unexpected(error(DiagnosticCode::UnexpectedCharacter, pos));
+        }
+        return expr;
+    }
+
+    template <typename Next>
+    ParseResult parseBinaryChain(Next next, std::initializer_list<std::pair<std::string_view, ExprOp>> ops,
+                                 bool keywords) {
+        auto lhs = (this->*next)();
+        if (!lhs) return lhs;
+        while (true) {
+            size_t at = (skipSpace(), pos);
+            bool matched = false;
+            for (const auto& [token, op] : ops) {
+                if (keywords ? consumeKeyword(token) : consume(token)) {
+                    auto rhs = (this->*next)();
+                    if (!rhs) return rhs;
+                    lhs = makeCall(op, {*lhs, *rhs}, static_cast<uint32_t>(at));
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched) return lhs;
+        }
+    }
+
+    ParseResult parseOr() {
+        return parseBinaryChain(&ExpressionParser::parseAnd, {{"or", ExprOp::Or}}, true);
+    }
+
+    ParseResult parseAnd() {
+        return parseBinaryChain(&ExpressionParser::parseComparison, {{"and", ExprOp::And}}, true);
+    }
+
+    ParseResult parseComparison() {
+        auto lhs = parseAdditive();
+        if (!lhs) return lhs;
+        skipSpace();
+        size_t at = pos;
+        // Two-character operators first so "<=" is not read as "<"
+        static constexpr std::pair<std::string_view, ExprOp> kComparisons[] = {
+            {"==", ExprOp::Eq}, {"!=", ExprOp::Ne}, {"<=", ExprOp::Le},
+            {">=", ExprOp::Ge}, {"<", ExprOp::Lt}, {">", ExprOp::Gt},
+        };
+        for (const auto& [token, op] : kComparisons) {
+            if (consume(token)) {
+                auto rhs = parseAdditive();
+                if (!rhs) return rhs;
+                return makeCall(op, {*lhs, *rhs}, static_cast<uint32_t>(at));
+            }
+        }
+        return lhs;
+    }
+
+    ParseResult parseAdditive() {
+        return parseBinaryChain(&ExpressionParser::parseMultiplicative,
+                                {{"+", ExprOp::Add}, {"-", ExprOp::Sub}}, false);
+    }
+
+    ParseResult parseMultiplicative() {
+        return parseBinaryChain(&ExpressionParser::parseUnary,
+                                {{"*", ExprOp::Mul}, {"/", ExprOp::Div}}, false);
+    }
+
+    ParseResult parseUnary() {
+        skipSpace();
+        size_t at = pos;
+        if (consume("-")) {
+            auto operand = parseUnary();
+            if (!operand) return operand;
+            return makeCall(ExprOp::Neg, {*operand}, static_cast<uint32_t>(at));
+        }
+        return parsePrimary();
+    }
+
+    ParseResult parsePrimary() {
+        skipSpace();
+        if (pos >= text.size()) {
+            return std::unexpected(error(DiagnosticCode::ExpectedExpression, pos, 0));
+        }
+        char c = text[pos];
+        if (c == '(') {
+            size_t open = pos++;
+            auto inner = parseOr();
+            if (!inner) return inner;
+            if (!consume(")")) {
+                return std::unexpected(error(DiagnosticCode::ExpectedClosingParen, open));
+            }
+            return inner;
+        }
+        if (c == '"') {
+            return parseString();
+        }
+        if (c == '[') {
+            return parseVector();
+        }
+        if ((c >= '0' && c <= '9') || c == '.') {
+            return parseNumber();
+        }
+        if (isIdentStart(c)) {
+            return parseIdentifier();
+        }
+        return std::unexpected(error(DiagnosticCode::ExpectedExpression, pos));
+    }
+
+    ParseResult parseString() {
+        size_t start = pos++;
+        std::string value;
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) ++pos;
+            value.push_back(text[pos++]);
+        }
+        if (pos >= text.size()) {
+            return std::unexpected(error(DiagnosticCode::UnterminatedString, start, pos - start));
+        }
+        ++pos;
+        auto expr = std::const_pointer_cast<Expr>(makeStringLiteral(std::move(value)));
+        expr->position = static_cast<uint32_t>(start);
+        return expr;
+    }
+
+    // "[1, -0.5, 2e3]": a vector literal of numeric constants
+    ParseResult parseVector() {
+        size_t open = pos++;
+        std::vector<float> value;
+        if (!consume("]")) {
+            while (true) {
+                skipSpace();
+                bool negative = consume("-");
+                skipSpace();
+                if (pos >= text.size() || !((text[pos] >= '0' && text[pos] <= '9') || text[pos] == '.')) {
+                    return std::unexpected(error(DiagnosticCode::ExpectedExpression, pos));
+                }
+                auto number = parseNumber();
+                if (!number) return number;
+                double element = (*number)->type == PhysicalType::Double
+                                     ? (*number)->doubleValue
+                                     : static_cast<double>((*number)->intValue);
+                value.push_back(static_cast<float>(negative ? -element : element));
+                if (consume(",")) continue;
+                if (consume("]")) break;
+                return std::unexpected(error(DiagnosticCode::ExpectedClosingBracket, open));
+            }
+        }
+        auto expr = std::const_pointer_cast<Expr>(makeVectorLiteral(std::move(value)));
+        expr->position = static_cast<uint32_t>(open);
+        return expr;
+    }
+
+    ParseResult parseNumber() {
+        size_t start = pos;
+        bool isDouble = false;
+        while (pos < text.size() &&
+               ((text[pos] >= '0' && text[pos] <= '9') || text[pos] == '.' || text[pos] == 'e' ||
+                ((text[pos] == '+' || text[pos] == '-') && pos > start && text[pos - 1] == 'e'))) {
+            isDouble |= text[pos] == '.' || text[pos] == 'e';
+            ++pos;
+        }
+        const char* begin = text.data() + start;
+        const char* end = text.data() + pos;
+        std::shared_ptr<Expr> expr;
+        std::from_chars_result parsed;
+        if (isDouble) {
+            double value = 0;
+            parsed = std::from_chars(begin, end, value);
+            expr = std::const_pointer_cast<Expr>(makeLiteral(value));
+        } else {
+            int64_t value = 0;
+            parsed = std::from_chars(begin, end, value);
+            if (parsed.ec == std::errc::result_out_of_range) {
+                return std::unexpected(error(DiagnosticCode::IntegerOutOfRange, start, pos - start));
+            }
+            expr = std::const_pointer_cast<Expr>(makeLiteral(value));
+        }
+        if (parsed.ec != std::errc() || parsed.ptr != end) {
+            return std::unexpected(error(DiagnosticCode::UnexpectedCharacter,
+                                         parsed.ptr - text.data()));
+        }
+        expr->position = static_cast<uint32_t>(start);
+        return expr;
+    }
+
+    ParseResult parseIdentifier() {
+        size_t start = pos;
+        while (pos < text.size() && isIdentChar(text[pos])) ++pos;
+        std::string_view ident = text.substr(start, pos - start);
+
+        skipSpace();
+        bool isCall = pos < text.size() && text[pos] == '(';
+        if (!isCall) {
+            std::shared_ptr<Expr> expr;
+            if (ident == "true" || ident == "false") {
+                expr = std::const_pointer_cast<Expr>(makeBoolLiteral(ident == "true"));
+            } else {
+                expr = std::const_pointer_cast<Expr>(makeField(std::string(ident)));
+            }
+            expr->position = static_cast<uint32_t>(start);
+            return expr;
+        }
+
+        const NamedFunction* function = nullptr;
+        for (const auto& candidate : kFunctions) {
+            if (ident == candidate.name) {
+                function = &candidate;
+            }
+        }
+        if (!function) {
+            return std::unexpected(error(DiagnosticCode::UnknownFunction, start, ident.size()));
+        }
+
+        size_t open = pos++;
+        std::vector<ExprPtr> args;
+        if (!consume(")")) {
+            while (true) {
+                auto arg = parseOr();
+                if (!arg) return arg;
+                args.push_back(*arg);
+                if (consume(",")) continue;
+                if (consume(")")) break;
+                return std::unexpected(error(DiagnosticCode::ExpectedClosingParen, open));
+            }
+        }
+        if (args.size() < function->minArgs || args.size() > function->maxArgs) {
+            return std::unexpected(error(DiagnosticCode::WrongArgumentCount, start, ident.size()));
+        }
+        return makeCall(function->op, std::move(args), static_cast<uint32_t>(start));
+    }
+};
+
+} // namespace
+
+std::expected<ExprPtr, Diagnostic> parseExpression(std::string_view text) {
+    ExpressionParser parser{text};
+    return parser.parse();
+}
+
+// ---------------------------------------------------------------------------
+// Binder
+// ---------------------------------------------------------------------------
+
+static ExprPtr toDouble(const ExprPtr& expr) {
+    if (expr->type == PhysicalType::Double) {
+        return expr;
+    }
+    auto cast = std::const_pointer_cast<Expr>(makeCall(ExprOp::ToDouble, {expr}, expr->position));
+    cast->type = PhysicalType::Double;
+    return cast;
+}
+
+// Unifies numeric arguments to a common type, inserting conversions
+static std::expected<PhysicalType, Diagnostic> unifyNumeric(std::vector<ExprPtr>& args, size_t from) {
+    bool anyDouble = false;
+    for (size_t i = from; i < args.size(); ++i) {
+        if (!isNumeric(args[i]->type)) {
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, args[i]->position, 1});
+        }
+        anyDouble |= args[i]->type == PhysicalType::Double;
+    }
+    if (!anyDouble) {
+        return PhysicalType::Int64;
+    }
+    for (size_t i = from; i < args.size(); ++i) {
+        args[i] = toDouble(args[i]);
+    }
+    return PhysicalType::Double;
+}
+
+// Unifies the arguments of a comparison or if() branch pair: both numeric
+// (promoted to a common type) or both the same non-numeric, non-vector type
+static std::expected<PhysicalType, Diagnostic> unifyAny(std::vector<ExprPtr>& args, size_t from) {
+    if (isNumeric(args[from]->type)) {
+        return unifyNumeric(args, from);
+    }
+    for (size_t i = from; i < args.size(); ++i) {
+        if (args[i]->type != args[from]->type || args[i]->type == PhysicalType::Vector) {
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, args[i]->position, 1});
+        }
+    }
+    return args[from]->type;
+}
+
+static std::expected<void, Diagnostic> requireBool(const ExprPtr& arg) {
+    if (arg->type != PhysicalType::Bool) {
+        return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, arg->position, 1});
+    }
+    return {};
+}
+
+std::expected<ExprPtr, Diagnostic> bindExpression(const ExprPtr& expr, const Schema& schema,
+                                                  const SymbolTable& symbols) {
+    switch (expr->kind) {
+        case ExprKind::Literal:
+            return expr;
+        case ExprKind::Field: {
+            auto bound = std::make_shared<Expr>(*expr);
+            bound->fieldId = symbols.find(expr->name).value_or(kInvalidSymbol);
+            auto slot = schema.slotOf(bound->fieldId, expr->name);
+            if (!slot) {
+                return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, expr->position,
+                                                  static_cast<uint32_t>(expr->name.size())});
+            }
+            bound->slot = static_cast<int32_t>(*slot);
+            bound->type = schema.fields[*slot].type;
+            return bound;
+        }
+        case ExprKind::Call:
+            break;
+    }
+
+    auto bound = std::make_shared<Expr>(*expr);
+    for (auto& arg : bound->args) {
+        auto boundArg = bindExpression(arg, schema, symbols);
+        if (!boundArg) return boundArg;
+        arg = *boundArg;
+    }
+
+    auto& args = bound->args;
+    std::expected<PhysicalType, Diagnostic> type = PhysicalType::Bool;
+    switch (bound->op) {
+        case ExprOp::Add: case ExprOp::Sub: case ExprOp::Mul:
+        case ExprOp::Sum: case ExprOp::Min: case ExprOp::Max:
+        case ExprOp::Neg: case ExprOp::Abs:
+            type = unifyNumeric(args, 0);
+            break;
+        case ExprOp::Div:
+        case ExprOp::ToDouble:
+            type = unifyNumeric(args, 0);
+            if (type) {
+                for (auto& arg : args) arg = toDouble(arg);
+                type = PhysicalType::Double;
+            }
+            if (type && bound->op == ExprOp::ToDouble) {
+                // The argument is already a double now; drop the redundant cast
+                return args[0];
+            }
+            break;
+        case ExprOp::Eq: case ExprOp::Ne: case ExprOp::Lt:
+        case ExprOp::Le: case ExprOp::Gt: case ExprOp::Ge:
+            type = unifyAny(args, 0);
+            if (type) type = PhysicalType::Bool;
+            break;
+        case ExprOp::And: case ExprOp::Or: case ExprOp::Not:
+            for (const auto& arg : args) {
+                if (auto ok = requireBool(arg); !ok) return std::unexpected(ok.error());
+            }
+            type = PhysicalType::Bool;
+            break;
+        case ExprOp::If:
+            if (auto ok = requireBool(args[0]); !ok) return std::unexpected(ok.error());
+            type = unifyAny(args, 1);
+            break;
+        case ExprOp::Coalesce:
+            type = unifyAny(args, 0);
+            break;
+        case ExprOp::IsNull:
+            type = PhysicalType::Bool;
+            break;
+        case ExprOp::Dot: case ExprOp::Cosine:
+            // Vectors of different dimensions are only detected per row (null)
+            for (const auto& arg : args) {
+                if (arg->type != PhysicalType::Vector) {
+                    return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, arg->position, 1});
+                }
+            }
+            type = PhysicalType::Double;
+            break;
+        case ExprOp::Bm25:
+            // Scored against the column's own statistics, so the text must be
+            // a field and the query a constant
+            if (args[0]->kind != ExprKind::Field || args[0]->type != PhysicalType::String) {
+                return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, args[0]->position, 1});
+            }
+            if (args[1]->kind != ExprKind::Literal || args[1]->type != PhysicalType::String) {
+                return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, args[1]->position, 1});
+            }
+            type = PhysicalType::Double;
+            break;
+    }
+    if (!type) {
+        return std::unexpected(type.error());
+    }
+    bound->type = *type;
+    return bound;
+}
+
+// ---------------------------------------------------------------------------
+// Printing
+// ---------------------------------------------------------------------------
+
+static void appendDouble(std::string& out, double value) {
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    std::string_view text(buf, ptr - buf);
+    out.append(text);
+    // Keep the literal a double when the text is parsed again
+    if (text.find_first_of(".e") == std::string_view::npos && text != "inf" && text != "nan") {
+        out.append(".0");
+    }
+}
+
+static void print(const Expr& expr, std::string& out) {
+    switch (expr.kind) {
+        case ExprKind::Literal:
+            switch (expr.type) {
+                case PhysicalType::Bool: out += expr.intValue ? "true" : "false"; break;
+                case PhysicalType::Int64: out += std::to_string(expr.intValue); break;
+                case PhysicalType::Double: appendDouble(out, expr.doubleValue); break;
+                case PhysicalType::String:
+                    out += '"';
+                    for (char c : expr.stringValue) {
+                        if (c == '"' || c == '\\') out += '\\';
+                        out += c;
+                    }
+                    out += '"';
+                    break;
+                case PhysicalType::Vector:
+                    out += '[';
+                    for (size_t i = 0; i < expr.vectorValue.size(); ++i) {
+                        if (i > 0) out += ", ";
+                        char buf[32];
+                        auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), expr.vectorValue[i]);
+                        out.append(buf, ptr);
+                    }
+                    out += ']';
+                    break;
+            }
+            return;
+        case ExprKind::Field:
+            out += expr.name;
+            return;
+        case ExprKind::Call:
+            break;
+    }
+    if (isInfix(expr.op)) {
+        out += '(';
+        print(*expr.args[0], out);
+        out += ' ';
+        out += exprOpName(expr.op);
+        out += ' ';
+        print(*expr.args[1], out);
+        out += ')';
+        return;
+    }
+    out += expr.op == ExprOp::Neg ? "-" : exprOpName(expr.op);
+    out += '(';
+    for (size_t i = 0; i < expr.args.size(); ++i) {
+        if (i > 0) out += ", ";
+        print(*expr.args[i], out);
+    }
+    out += ')';
+}
+
+std::string toString(const Expr& expr) {
+    std::string out;
+    print(expr, out);
+    return out;
+}
+
+void collectFieldNames(const Expr& expr, std::vector<std::string>& names) {
+    if (expr.kind == ExprKind::Field) {
+        if (std::find(names.begin(), names.end(), expr.name) == names.end()) {
+            names.push_back(expr.name);
+        }
+        return;
+    }
+    for (const auto& arg : expr.args) {
+        collectFieldNames(*arg, names);
+    }
+}
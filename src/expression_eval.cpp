@@ -0,0 +1,657 @@
+#include "expression_eval.h"
+#include "inverted_index.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Result of evaluating a node: field references borrow the batch column
+// instead of copying it
+struct EvalValue {
+    const Column* borrowed = nullptr;
+    Column owned;
+
+    const Column& get() const { return borrowed ? *borrowed : owned; }
+};
+
+// Integer arithmetic wraps around (through uint64_t, so overflow is not
+// undefined behaviour), like constant folding and the JIT
+template <typename T>
+T addValues(T a, T b) {
+    if constexpr (std::is_same_v<T, int64_t>) return static_cast<int64_t>(uint64_t(a) + uint64_t(b));
+    else return a + b;
+}
+template <typename T>
+T subValues(T a, T b) {
+    if constexpr (std::is_same_v<T, int64_t>) return static_cast<int64_t>(uint64_t(a) - uint64_t(b));
+    else return a - b;
+}
+template <typename T>
+T mulValues(T a, T b) {
+    if constexpr (std::is_same_v<T, int64_t>) return static_cast<int64_t>(uint64_t(a) * uint64_t(b));
+    else return a * b;
+}
+
+template <typename T>
+Column makeColumn(std::vector<T> values) {
+    if constexpr (std::is_same_v<T, uint8_t>) return Column::ofBools(std::move(values));
+    else if constexpr (std::is_same_v<T, int64_t>) return Column::ofInts(std::move(values));
+    else if constexpr (std::is_same_v<T, double>) return Column::ofDoubles(std::move(values));
+    else return Column::ofStrings(std::move(values));
+}
+
+Column broadcast(const Expr& literal, size_t rows) {
+    switch (literal.type) {
+        case PhysicalType::Bool:
+            return Column::ofBools(std::vector<uint8_t>(rows, static_cast<uint8_t>(literal.intValue)));
+        case PhysicalType::Int64:
+            return Column::ofInts(std::vector<int64_t>(rows, literal.intValue));
+        case PhysicalType::Double:
+            return Column::ofDoubles(std::vector<double>(rows, literal.doubleValue));
+        case PhysicalType::String:
+            return Column::ofStrings(std::vector<std::string>(rows, literal.stringValue));
+        case PhysicalType::Vector: {
+            std::vector<float> values;
+            values.reserve(rows * literal.vectorValue.size());
+            for (size_t i = 0; i < rows; ++i) {
+                values.insert(values.end(), literal.vectorValue.begin(), literal.vectorValue.end());
+            }
+            return Column::ofVectors(static_cast<uint32_t>(literal.vectorValue.size()), std::move(values));
+        }
+    }
+    return {};
+}
+
+template <typename T, typename Fn>
+Column binaryKernel(const Column& lhs, const Column& rhs, Fn fn) {
+    const auto& a = lhs.values<T>();
+    const auto& b = rhs.values<T>();
+    using R = decltype(fn(a[0], b[0]));
+    std::vector<R> out(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        out[i] = fn(a[i], b[i]);
+    }
+    return makeColumn(std::move(out));
+}
+
+template <typename T, typename Fn>
+Column unaryKernel(const Column& in, Fn fn) {
+    const auto& a = in.values<T>();
+    using R = decltype(fn(a[0]));
+    std::vector<R> out(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        out[i] = fn(a[i]);
+    }
+    return makeColumn(std::move(out));
+}
+
+// Dispatches once per node on the operand type
+template <typename Fn>
+Column numericBinary(const Column& lhs, const Column& rhs, Fn fn) {
+    if (lhs.type == PhysicalType::Double) {
+        return binaryKernel<double>(lhs, rhs, fn);
+    }
+    return binaryKernel<int64_t>(lhs, rhs, fn);
+}
+
+template <typename Fn>
+Column anyBinary(const Column& lhs, const Column& rhs, Fn fn) {
+    switch (lhs.type) {
+        case PhysicalType::Bool: return binaryKernel<uint8_t>(lhs, rhs, fn);
+        case PhysicalType::Int64: return binaryKernel<int64_t>(lhs, rhs, fn);
+        case PhysicalType::Double: return binaryKernel<double>(lhs, rhs, fn);
+        case PhysicalType::String: return binaryKernel<std::string>(lhs, rhs, fn);
+        case PhysicalType::Vector: break;  // Vectors are not comparable
+    }
+    return {};
+}
+
+struct EvalContext {
+    const Batch& batch;
+    EvalStats* stats;
+};
+
+// Above this fraction of selected rows, evaluating a branch over every row
+// and blending is cheaper than gathering and scattering the selected rows
+constexpr double kDenseBranchFraction = 0.5;
+
+EvalValue eval(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection);
+
+size_t rowCount(const EvalContext& ctx, const SelectionVector* selection) {
+    return selection ? selection->size() : ctx.batch.rowCount();
+}
+
+Column takeColumn(EvalValue value) {
+    return value.borrowed ? *value.borrowed : std::move(value.owned);
+}
+
+// Calls fn(outValues, inValues) with the vectors matching out.type
+template <typename Fn>
+void withValues(Column& out, const Column& in, Fn fn) {
+    switch (out.type) {
+        case PhysicalType::Bool: fn(out.bools, in.bools); break;
+        case PhysicalType::Int64: fn(out.ints, in.ints); break;
+        case PhysicalType::Double: fn(out.doubles, in.doubles); break;
+        case PhysicalType::String: fn(out.strings, in.strings); break;
+        case PhysicalType::Vector: break;  // Never the type of if() or coalesce()
+    }
+}
+
+Column emptyColumn(PhysicalType type, size_t rows) {
+    Column column;
+    column.type = type;
+    withValues(column, column, [rows](auto& out, const auto&) { out.resize(rows); });
+    return column;
+}
+
+// Written rows take their validity from the branch
+void copyValidity(Column& out, const Column& src, size_t outRow, size_t srcRow) {
+    if (src.hasNulls() || out.hasNulls()) {
+        out.setValid(outRow, src.isValid(srcRow));
+    }
+}
+
+// Writes `branch` into the rows of `out` where mask[i] == want (`count`
+// rows), values and validity. Sparse branches run over a selection vector of
+// just those rows and scatter; dense or trivial ones run over all rows and
+// blend.
+void evalBranch(Column& out, const Expr& branch, const std::vector<uint8_t>& mask, uint8_t want,
+                size_t count, const EvalContext& ctx, const SelectionVector* selection) {
+    size_t rows = mask.size();
+    bool dense = branch.kind != ExprKind::Call ||
+                 static_cast<double>(count) >= kDenseBranchFraction * static_cast<double>(rows);
+    if (dense) {
+        if (ctx.stats) ++ctx.stats->denseBranches;
+        EvalValue value = eval(branch, ctx, selection);
+        withValues(out, value.get(), [&](auto& dst, const auto& src) {
+            for (size_t i = 0; i < rows; ++i) {
+                if (mask[i] == want) dst[i] = src[i];
+            }
+        });
+        if (value.get().hasNulls() || out.hasNulls()) {
+            for (size_t i = 0; i < rows; ++i) {
+                if (mask[i] == want) copyValidity(out, value.get(), i, i);
+            }
+        }
+        return;
+    }
+
+    if (ctx.stats) ++ctx.stats->selectionBranches;
+    std::vector<uint32_t> positions;
+    SelectionVector subset;
+    positions.reserve(count);
+    subset.reserve(count);
+    for (size_t i = 0; i < rows; ++i) {
+        if (mask[i] == want) {
+            positions.push_back(static_cast<uint32_t>(i));
+            subset.push_back(selection ? (*selection)[i] : static_cast<uint32_t>(i));
+        }
+    }
+    EvalValue value = eval(branch, ctx, &subset);
+    withValues(out, value.get(), [&](auto& dst, const auto& src) {
+        for (size_t k = 0; k < positions.size(); ++k) {
+            dst[positions[k]] = src[k];
+        }
+    });
+    if (value.get().hasNulls() || out.hasNulls()) {
+        for (size_t k = 0; k < positions.size(); ++k) {
+            copyValidity(out, value.get(), positions[k], k);
+        }
+    }
+}
+
+size_t countEqual(const std::vector<uint8_t>& mask, uint8_t want) {
+    size_t count = 0;
+    for (uint8_t m : mask) {
+        count += m == want;
+    }
+    return count;
+}
+
+// Rows whose value is set and valid, as a 0/1 mask
+std::vector<uint8_t> trueMask(const Column& column) {
+    std::vector<uint8_t> mask = column.bools;
+    if (column.hasNulls()) {
+        for (size_t i = 0; i < mask.size(); ++i) {
+            mask[i] &= static_cast<uint8_t>(column.isValid(i));
+        }
+    }
+    return mask;
+}
+
+// A null condition selects the else branch
+Column evalIf(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    EvalValue cond = eval(*expr.args[0], ctx, selection);
+    std::vector<uint8_t> mask = trueMask(cond.get());
+    size_t trueRows = countEqual(mask, 1);
+    if (trueRows == mask.size()) {
+        return takeColumn(eval(*expr.args[1], ctx, selection));
+    }
+    if (trueRows == 0) {
+        return takeColumn(eval(*expr.args[2], ctx, selection));
+    }
+    Column out = emptyColumn(expr.type, mask.size());
+    evalBranch(out, *expr.args[1], mask, 1, trueRows, ctx, selection);
+    evalBranch(out, *expr.args[2], mask, 0, mask.size() - trueRows, ctx, selection);
+    out.compactValidity();
+    return out;
+}
+
+// Three-valued logic: `a and b` only needs b where a is true or null, `a or
+// b` only where a is false or null. A null `a` yields b if b decides the
+// result on its own (false for and, true for or), otherwise null.
+Column evalLogical(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    EvalValue lhs = eval(*expr.args[0], ctx, selection);
+    const Column& left = lhs.get();
+    uint8_t decided = expr.op == ExprOp::And ? 0 : 1;
+    std::vector<uint8_t> pendingMask(left.bools.size());
+    for (size_t i = 0; i < pendingMask.size(); ++i) {
+        pendingMask[i] = static_cast<uint8_t>(left.bools[i] != decided || !left.isValid(i));
+    }
+    size_t pending = countEqual(pendingMask, 1);
+    Column out = left;
+    if (pending > 0) {
+        evalBranch(out, *expr.args[1], pendingMask, 1, pending, ctx, selection);
+        if (left.hasNulls()) {
+            for (size_t i = 0; i < pendingMask.size(); ++i) {
+                if (!left.isValid(i) && out.isValid(i) && out.bools[i] != decided) {
+                    out.setValid(i, false);
+                }
+            }
+        }
+        out.compactValidity();
+    }
+    return out;
+}
+
+// Each argument is evaluated only for rows that are still null
+Column evalCoalesce(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    Column out = takeColumn(eval(*expr.args[0], ctx, selection));
+    for (size_t a = 1; a < expr.args.size() && out.hasNulls(); ++a) {
+        std::vector<uint8_t> nullMask(out.size());
+        for (size_t i = 0; i < nullMask.size(); ++i) {
+            nullMask[i] = static_cast<uint8_t>(!out.isValid(i));
+        }
+        size_t nulls = countEqual(nullMask, 1);
+        if (nulls == 0) {
+            break;
+        }
+        evalBranch(out, *expr.args[a], nullMask, 1, nulls, ctx, selection);
+        out.compactValidity();
+    }
+    return out;
+}
+
+Column evalIsNull(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    EvalValue value = eval(*expr.args[0], ctx, selection);
+    const Column& column = value.get();
+    std::vector<uint8_t> nulls(column.size(), 0);
+    if (column.hasNulls()) {
+        for (size_t i = 0; i < nulls.size(); ++i) {
+            nulls[i] = static_cast<uint8_t>(!column.isValid(i));
+        }
+    }
+    return Column::ofBools(std::move(nulls));
+}
+
+// Reads a packed column's rows straight into the kernel input, without
+// materializing the whole column first
+Column unpackRows(const Column& column, const SelectionVector* selection) {
+    std::vector<int64_t> values;
+    if (selection) {
+        values.resize(selection->size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = column.packed->at((*selection)[i]);
+        }
+    } else {
+        values = column.packed->unpackAll();
+    }
+    Column out = Column::ofInts(std::move(values));
+    if (!selection) {
+        out.validity = column.validity;
+    } else if (column.hasNulls()) {
+        for (size_t i = 0; i < selection->size(); ++i) {
+            out.setValid(i, column.isValid((*selection)[i]));
+        }
+    }
+    return out;
+}
+
+// Mirror of a comparison for swapped operands (a < b  <=>  b > a)
+ExprOp flipComparison(ExprOp op) {
+    switch (op) {
+        case ExprOp::Lt: return ExprOp::Gt;
+        case ExprOp::Le: return ExprOp::Ge;
+        case ExprOp::Gt: return ExprOp::Lt;
+        case ExprOp::Ge: return ExprOp::Le;
+        default: return op;
+    }
+}
+
+template <typename Cmp>
+void compareDeltas(const PackedInts& packed, uint64_t threshold, std::vector<uint8_t>& out, Cmp cmp) {
+    uint64_t deltas[kPackedBlockRows];
+    for (size_t row = 0; row < packed.count; row += kPackedBlockRows) {
+        size_t n = std::min(kPackedBlockRows, packed.count - row);
+        packed.unpackDeltas(row, n, deltas);
+        for (size_t i = 0; i < n; ++i) {
+            out[row + i] = static_cast<uint8_t>(cmp(deltas[i], threshold));
+        }
+    }
+}
+
+// `packed_field <cmp> int_literal` evaluated on the compressed data: the
+// literal is moved into the column's frame once, then each 64-row block is
+// unpacked into a stack buffer and compared as unsigned deltas. Returns false
+// if the call does not have that shape.
+bool comparePacked(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection,
+                   Column& result) {
+    if (selection || expr.args.size() != 2) {
+        return false;
+    }
+    ExprOp op = expr.op;
+    if (op != ExprOp::Eq && op != ExprOp::Ne && op != ExprOp::Lt && op != ExprOp::Le &&
+        op != ExprOp::Gt && op != ExprOp::Ge) {
+        return false;
+    }
+    const Expr* field = expr.args[0].get();
+    const Expr* literal = expr.args[1].get();
+    if (field->kind != ExprKind::Field) {
+        std::swap(field, literal);
+        op = flipComparison(op);
+    }
+    if (field->kind != ExprKind::Field || literal->kind != ExprKind::Literal ||
+        literal->type != PhysicalType::Int64) {
+        return false;
+    }
+    const Column& column = ctx.batch.columns[field->slot];
+    if (!column.isPacked()) {
+        return false;
+    }
+    const PackedInts& packed = *column.packed;
+    std::vector<uint8_t> out(packed.count);
+    if (literal->intValue < packed.base) {
+        // Every value is above the literal
+        bool value = op == ExprOp::Ne || op == ExprOp::Gt || op == ExprOp::Ge;
+        std::fill(out.begin(), out.end(), static_cast<uint8_t>(value));
+    } else {
+        uint64_t threshold = static_cast<uint64_t>(literal->intValue) - static_cast<uint64_t>(packed.base);
+        switch (op) {
+            case ExprOp::Eq: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d == t; }); break;
+            case ExprOp::Ne: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d != t; }); break;
+            case ExprOp::Lt: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d < t; }); break;
+            case ExprOp::Le: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d <= t; }); break;
+            case ExprOp::Gt: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d > t; }); break;
+            default: compareDeltas(packed, threshold, out, [](uint64_t d, uint64_t t) { return d >= t; }); break;
+        }
+    }
+    result = Column::ofBools(std::move(out));
+    result.validity = column.validity;
+    if (ctx.stats) ctx.stats->rowsComputed += packed.count;
+    return true;
+}
+
+// bm25(field, "query"): the binder guarantees this shape. The column is read
+// whole, since scores depend on statistics over all its rows.
+Column evalBm25(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    if (ctx.stats) ctx.stats->rowsComputed += rowCount(ctx, selection);
+    return bm25Scores(ctx.batch.columns[expr.args[0]->slot], queryTerms(expr.args[1]->stringValue), selection);
+}
+
+// dot() and cosine(). A literal query is used as is rather than broadcast,
+// and against an int8-quantized column it is quantized once so every row is
+// an integer dot product on the codes. Rows are null when either input is,
+// when the dimensions differ, and for cosine when either norm is zero.
+Column evalSimilarity(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    const Expr* lhsExpr = expr.args[0].get();
+    const Expr* rhsExpr = expr.args[1].get();
+    if (lhsExpr->kind == ExprKind::Literal) {
+        std::swap(lhsExpr, rhsExpr);  // Both are symmetric
+    }
+    size_t rows = rowCount(ctx, selection);
+    if (ctx.stats) ctx.stats->rowsComputed += rows;
+    bool cosine = expr.op == ExprOp::Cosine;
+    std::vector<double> out(rows);
+    Column result;
+
+    EvalValue lhs = eval(*lhsExpr, ctx, selection);
+    const Column& left = lhs.get();
+    uint32_t dimension = left.dimension;
+    auto finish = [&](std::vector<uint8_t> zeroNorm) {
+        result = Column::ofDoubles(std::move(out));
+        result.validity = left.validity;
+        for (size_t i = 0; i < zeroNorm.size(); ++i) {
+            if (zeroNorm[i]) result.setValid(i, false);
+        }
+    };
+    std::vector<uint8_t> undefined(cosine ? rows : 0);
+
+    if (rhsExpr->kind == ExprKind::Literal) {
+        const std::vector<float>& query = rhsExpr->vectorValue;
+        if (query.size() != dimension) {
+            finish(std::vector<uint8_t>(rows, 1));
+            return result;
+        }
+        float queryNorm = std::sqrt(dotF32(query.data(), query.data(), query.size()));
+        if (left.isQuantized()) {
+            const QuantizedVectors& quantized = *left.quantized;
+            std::vector<int8_t> codes(dimension);
+            float scale = 0;
+            QuantizedVectors::quantizeOne(query.data(), dimension, codes.data(), scale);
+            for (size_t i = 0; i < rows; ++i) {
+                double dot = static_cast<double>(dotI8(quantized.row(i), codes.data(), dimension)) *
+                             quantized.scales[i] * scale;
+                if (cosine) {
+                    double norms = static_cast<double>(quantized.norms[i]) * queryNorm;
+                    undefined[i] = norms == 0;
+                    dot = norms == 0 ? 0 : dot / norms;
+                }
+                out[i] = dot;
+            }
+        } else {
+            for (size_t i = 0; i < rows; ++i) {
+                const float* row = left.floats.data() + i * dimension;
+                if (!cosine) {
+                    out[i] = dotF32(row, query.data(), dimension);
+                    continue;
+                }
+                float dot = 0;
+                float rowNorm2 = 0;
+                dotAndSquaredNormF32(row, query.data(), dimension, dot, rowNorm2);
+                double norms = std::sqrt(static_cast<double>(rowNorm2)) * queryNorm;
+                undefined[i] = norms == 0;
+                out[i] = norms == 0 ? 0 : dot / norms;
+            }
+        }
+        finish(std::move(undefined));
+        return result;
+    }
+
+    EvalValue rhs = eval(*rhsExpr, ctx, selection);
+    if (rhs.get().dimension != dimension) {
+        finish(std::vector<uint8_t>(rows, 1));
+        andValidity(result.validity, rhs.get().validity, rows);
+        return result;
+    }
+    if (left.isQuantized() && rhs.get().isQuantized()) {
+        const QuantizedVectors& a = *left.quantized;
+        const QuantizedVectors& b = *rhs.get().quantized;
+        for (size_t i = 0; i < rows; ++i) {
+            double dot = static_cast<double>(dotI8(a.row(i), b.row(i), dimension)) * a.scales[i] * b.scales[i];
+            if (cosine) {
+                double norms = static_cast<double>(a.norms[i]) * b.norms[i];
+                undefined[i] = norms == 0;
+                dot = norms == 0 ? 0 : dot / norms;
+            }
+            out[i] = dot;
+        }
+    } else {
+        // Mixed encodings compare in fp32
+        Column a = left.isQuantized() ? left.decoded() : Column();
+        Column b = rhs.get().isQuantized() ? rhs.get().decoded() : Column();
+        const std::vector<float>& av = left.isQuantized() ? a.floats : left.floats;
+        const std::vector<float>& bv = rhs.get().isQuantized() ? b.floats : rhs.get().floats;
+        for (size_t i = 0; i < rows; ++i) {
+            const float* x = av.data() + i * dimension;
+            const float* y = bv.data() + i * dimension;
+            if (!cosine) {
+                out[i] = dotF32(x, y, dimension);
+                continue;
+            }
+            float dot = 0;
+            float xNorm2 = 0;
+            dotAndSquaredNormF32(x, y, dimension, dot, xNorm2);
+            double norms = std::sqrt(static_cast<double>(xNorm2) * dotF32(y, y, dimension));
+            undefined[i] = norms == 0;
+            out[i] = norms == 0 ? 0 : dot / norms;
+        }
+    }
+    finish(std::move(undefined));
+    andValidity(result.validity, rhs.get().validity, rows);
+    return result;
+}
+
+Column evalKernel(const Expr& expr, const std::vector<EvalValue>& args);
+
+Column evalCall(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    switch (expr.op) {
+        case ExprOp::If:
+            return evalIf(expr, ctx, selection);
+        case ExprOp::And:
+        case ExprOp::Or:
+            return evalLogical(expr, ctx, selection);
+        case ExprOp::Coalesce:
+            return evalCoalesce(expr, ctx, selection);
+        case ExprOp::IsNull:
+            return evalIsNull(expr, ctx, selection);
+        case ExprOp::Dot:
+        case ExprOp::Cosine:
+            return evalSimilarity(expr, ctx, selection);
+        case ExprOp::Bm25:
+            return evalBm25(expr, ctx, selection);
+        default:
+            break;
+    }
+
+    Column compressed;
+    if (comparePacked(expr, ctx, selection, compressed)) {
+        return compressed;
+    }
+
+    std::vector<EvalValue> args;
+    args.reserve(expr.args.size());
+    for (const auto& arg : expr.args) {
+        args.push_back(eval(*arg, ctx, selection));
+    }
+    size_t rows = rowCount(ctx, selection);
+    if (ctx.stats) ctx.stats->rowsComputed += rows;
+
+    // Values are computed for every row; a row is null when any input is
+    Column result = evalKernel(expr, args);
+    for (const auto& arg : args) {
+        andValidity(result.validity, arg.get().validity, rows);
+    }
+    return result;
+}
+
+// Runs the type-specialized kernel for a strict call over all rows
+Column evalKernel(const Expr& expr, const std::vector<EvalValue>& args) {
+    auto arg = [&args](size_t i) -> const Column& { return args[i].get(); };
+    switch (expr.op) {
+        case ExprOp::Add:
+            return numericBinary(arg(0), arg(1), [](auto a, auto b) { return addValues(a, b); });
+        case ExprOp::Sub:
+            return numericBinary(arg(0), arg(1), [](auto a, auto b) { return subValues(a, b); });
+        case ExprOp::Mul:
+            return numericBinary(arg(0), arg(1), [](auto a, auto b) { return mulValues(a, b); });
+        case ExprOp::Div:
+            return binaryKernel<double>(arg(0), arg(1), [](double a, double b) { return a / b; });
+        case ExprOp::Sum:
+        case ExprOp::Min:
+        case ExprOp::Max: {
+            Column acc = arg(0);
+            for (size_t i = 1; i < args.size(); ++i) {
+                if (expr.op == ExprOp::Sum) {
+                    acc = numericBinary(acc, arg(i), [](auto a, auto b) { return addValues(a, b); });
+                } else if (expr.op == ExprOp::Min) {
+                    acc = numericBinary(acc, arg(i), [](auto a, auto b) { return std::min(a, b); });
+                } else {
+                    acc = numericBinary(acc, arg(i), [](auto a, auto b) { return std::max(a, b); });
+                }
+            }
+            return acc;
+        }
+        case ExprOp::Neg:
+            if (arg(0).type == PhysicalType::Double) {
+                return unaryKernel<double>(arg(0), [](double a) { return -a; });
+            }
+            return unaryKernel<int64_t>(arg(0), [](int64_t a) { return subValues<int64_t>(0, a); });
+        case ExprOp::Abs:
+            if (arg(0).type == PhysicalType::Double) {
+                return unaryKernel<double>(arg(0), [](double a) { return std::fabs(a); });
+            }
+            return unaryKernel<int64_t>(arg(0), [](int64_t a) { return a < 0 ? subValues<int64_t>(0, a) : a; });
+        case ExprOp::ToDouble:
+            return unaryKernel<int64_t>(arg(0), [](int64_t a) { return static_cast<double>(a); });
+        case ExprOp::Eq:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a == b); });
+        case ExprOp::Ne:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a != b); });
+        case ExprOp::Lt:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a < b); });
+        case ExprOp::Le:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a <= b); });
+        case ExprOp::Gt:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a > b); });
+        case ExprOp::Ge:
+            return anyBinary(arg(0), arg(1), [](const auto& a, const auto& b) { return uint8_t(a >= b); });
+        case ExprOp::Not:
+            return unaryKernel<uint8_t>(arg(0), [](uint8_t a) { return uint8_t(!a); });
+        case ExprOp::And:
+        case ExprOp::Or:
+        case ExprOp::If:
+        case ExprOp::Coalesce:
+        case ExprOp::IsNull:
+        case ExprOp::Dot:
+        case ExprOp::Cosine:
+        case ExprOp::Bm25:
+            break;  // Handled by evalCall
+    }
+    return {};
+}
+
+EvalValue eval(const Expr& expr, const EvalContext& ctx, const SelectionVector* selection) {
+    EvalValue value;
+    switch (expr.kind) {
+        case ExprKind::Literal:
+            value.owned = broadcast(expr, rowCount(ctx, selection));
+            break;
+        case ExprKind::Field: {
+            const Column& column = ctx.batch.columns[expr.slot];
+            if (column.isDictionary()) {
+                // String kernels work on plain values
+                value.owned = selection ? column.select(*selection).decoded() : column.decoded();
+            } else if (column.isPacked()) {
+                value.owned = unpackRows(column, selection);
+            } else if (selection) {
+                value.owned = column.select(*selection);
+            } else {
+                value.borrowed = &column;
+            }
+            break;
+        }
+        case ExprKind::Call:
+            value.owned = evalCall(expr, ctx, selection);
+            break;
+    }
+    return value;
+}
+
+} // namespace
+
+Column evaluateExpression(const Expr& expr, const Batch& batch, const SelectionVector* selection,
+                          EvalStats* stats) {
+    EvalContext ctx{batch, stats};
+    return takeColumn(eval(expr, ctx, selection));
+}
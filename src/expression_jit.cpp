@@ -0,0 +1,531 @@
+#include "expression_jit.h"
+#include "fingerprint.h"
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Wrapping integer arithmetic and std::min/std::max semantics, so native
+// results match the interpreter bit for bit (including NaN handling)
+constexpr const char* kKernelPrelude = R"(#include <cstdint>
+static inline int64_t add_i(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static inline int64_t sub_i(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static inline int64_t mul_i(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+static inline int64_t neg_i(int64_t a) { return (int64_t)(0ull - (uint64_t)a); }
+static inline int64_t abs_i(int64_t a) { return a < 0 ? neg_i(a) : a; }
+static inline double abs_d(double a) { return __builtin_fabs(a); }
+template <typename T> static inline T min_v(T a, T b) { return b < a ? b : a; }
+template <typename T> static inline T max_v(T a, T b) { return a < b ? b : a; }
+)";
+
+const char* cType(PhysicalType type) {
+    switch (type) {
+        case PhysicalType::Bool: return "uint8_t";
+        case PhysicalType::Int64: return "int64_t";
+        case PhysicalType::Double: return "double";
+        case PhysicalType::String:
+        case PhysicalType::Vector: break;
+    }
+    return nullptr;
+}
+
+struct KernelWriter {
+    std::vector<int32_t>& inputSlots;
+    std::vector<PhysicalType> inputTypes;
+    std::string body;
+
+    explicit KernelWriter(std::vector<int32_t>& slots) : inputSlots(slots) {}
+
+    void literal(const Expr& expr) {
+        char buf[64];
+        switch (expr.type) {
+            case PhysicalType::Bool:
+                body += expr.intValue ? "(uint8_t)1" : "(uint8_t)0";
+                break;
+            case PhysicalType::Int64:
+                if (expr.intValue == INT64_MIN) {
+                    body += "(-9223372036854775807ll - 1)";
+                } else {
+                    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), expr.intValue);
+                    body += "(int64_t)";
+                    body.append(buf, ptr);
+                    body += "ll";
+                }
+                break;
+            case PhysicalType::Double:
+                if (expr.doubleValue != expr.doubleValue) {
+                    body += "__builtin_nan(\"\")";
+                } else if (expr.doubleValue == __builtin_inf() || expr.doubleValue == -__builtin_inf()) {
+                    body += expr.doubleValue > 0 ? "__builtin_inf()" : "(-__builtin_inf())";
+                } else {
+                    // Hex floats round-trip exactly
+                    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), expr.doubleValue,
+                                                   std::chars_format::hex);
+                    std::string_view text(buf, ptr - buf);
+                    body += '(';
+                    if (text.starts_with('-')) {
+                        body += '-';
+                        text.remove_prefix(1);
+                    }
+                    body += "0x";
+                    body += text;
+                    body += ')';
+                }
+                break;
+            case PhysicalType::String:
+            case PhysicalType::Vector:
+                break;
+        }
+    }
+
+    void field(const Expr& expr) {
+        size_t index = 0;
+        while (index < inputSlots.size() && inputSlots[index] != expr.slot) ++index;
+        if (index == inputSlots.size()) {
+            inputSlots.push_back(expr.slot);
+            inputTypes.push_back(expr.type);
+        }
+        body += "in" + std::to_string(index) + "[i]";
+    }
+
+    void call(const Expr& expr) {
+        bool isInt = !expr.args.empty() && expr.args[0]->type == PhysicalType::Int64;
+        auto binary = [&](const char* function, const char* infix) {
+            if (function) {
+                body += function;
+                body += '(';
+                write(*expr.args[0]);
+                body += ", ";
+                write(*expr.args[1]);
+                body += ')';
+            } else {
+                body += '(';
+                write(*expr.args[0]);
+                body += infix;
+                write(*expr.args[1]);
+                body += ')';
+            }
+        };
+        auto compare = [&](const char* infix) {
+            body += "(uint8_t)";
+            binary(nullptr, infix);
+        };
+        // Left fold, matching the interpreter's accumulation order
+        auto fold = [&](const char* function, const char* infix) {
+            for (size_t i = 1; i < expr.args.size(); ++i) {
+                body += function ? function : "";
+                body += '(';
+            }
+            write(*expr.args[0]);
+            for (size_t i = 1; i < expr.args.size(); ++i) {
+                body += function ? ", " : infix;
+                write(*expr.args[i]);
+                body += ')';
+            }
+        };
+
+        switch (expr.op) {
+            case ExprOp::Add: binary(isInt ? "add_i" : nullptr, " + "); break;
+            case ExprOp::Sub: binary(isInt ? "sub_i" : nullptr, " - "); break;
+            case ExprOp::Mul: binary(isInt ? "mul_i" : nullptr, " * "); break;
+            case ExprOp::Div: binary(nullptr, " / "); break;
+            case ExprOp::Sum: fold(isInt ? "add_i" : nullptr, " + "); break;
+            case ExprOp::Min: fold("min_v", nullptr); break;
+            case ExprOp::Max: fold("max_v", nullptr); break;
+            case ExprOp::Neg:
+                body += isInt ? "neg_i(" : "(-";
+                write(*expr.args[0]);
+                body += ')';
+                break;
+            case ExprOp::Abs:
+                body += isInt ? "abs_i(" : "abs_d(";
+                write(*expr.args[0]);
+                body += ')';
+                break;
+            case ExprOp::ToDouble:
+                body += "(double)(";
+                write(*expr.args[0]);
+                body += ')';
+                break;
+            case ExprOp::Eq: compare(" == "); break;
+            case ExprOp::Ne: compare(" != "); break;
+            case ExprOp::Lt: compare(" < "); break;
+            case ExprOp::Le: compare(" <= "); break;
+            case ExprOp::Gt: compare(" > "); break;
+            case ExprOp::Ge: compare(" >= "); break;
+            case ExprOp::And: body += "(uint8_t)"; binary(nullptr, " & "); break;
+            case ExprOp::Or: body += "(uint8_t)"; binary(nullptr, " | "); break;
+            case ExprOp::Not:
+                body += "(uint8_t)!(";
+                write(*expr.args[0]);
+                body += ')';
+                break;
+            case ExprOp::Coalesce:
+            case ExprOp::IsNull:
+            case ExprOp::Dot:
+            case ExprOp::Cosine:
+            case ExprOp::Bm25:
+                break;  // Not eligible, see isEligible()
+            case ExprOp::If:
+                body += "(";
+                write(*expr.args[0]);
+                body += " ? ";
+                write(*expr.args[1]);
+                body += " : ";
+                write(*expr.args[2]);
+                body += ')';
+                break;
+        }
+    }
+
+    void write(const Expr& expr) {
+        switch (expr.kind) {
+            case ExprKind::Literal: literal(expr); break;
+            case ExprKind::Field: field(expr); break;
+            case ExprKind::Call: call(expr); break;
+        }
+    }
+};
+
+bool isEligible(const Expr& expr) {
+    if (expr.type == PhysicalType::String || expr.type == PhysicalType::Vector) {
+        return false;
+    }
+    if (expr.kind == ExprKind::Field && expr.slot < 0) {
+        return false;
+    }
+    // These inspect validity, which kernels do not see
+    if (expr.kind == ExprKind::Call && (expr.op == ExprOp::Coalesce || expr.op == ExprOp::IsNull)) {
+        return false;
+    }
+    for (const auto& arg : expr.args) {
+        if (!isEligible(*arg)) return false;
+    }
+    return true;
+}
+
+bool isStrict(const Expr& expr) {
+    if (expr.kind == ExprKind::Call &&
+        (expr.op == ExprOp::If || expr.op == ExprOp::And || expr.op == ExprOp::Or)) {
+        return false;
+    }
+    for (const auto& arg : expr.args) {
+        if (!isStrict(*arg)) return false;
+    }
+    return true;
+}
+
+const void* columnData(const Column& column) {
+    switch (column.type) {
+        case PhysicalType::Bool: return column.bools.data();
+        case PhysicalType::Int64: return column.ints.data();
+        case PhysicalType::Double: return column.doubles.data();
+        case PhysicalType::String:
+        case PhysicalType::Vector: break;
+    }
+    return nullptr;
+}
+
+std::string hexHash(uint64_t hash) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+// Flags and the compiler are part of the cache key: a different compiler
+// setup produces a different shared object. -ffp-contract=off keeps a*b+c from being fused,
+// which would change results relative to the interpreter.
+constexpr const char* kCompileFlags = "-std=c++17 -O2 -march=native -ffp-contract=off -shared -fPIC";
+
+std::vector<std::string> splitWords(std::string_view text) {
+    std::vector<std::string> words;
+    std::istringstream in{std::string(text)};
+    for (std::string word; in >> word;) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Anything we dlopen() must be ours and writable only by us; otherwise
+// another user could plant a library in the cache
+bool ownedAndPrivate(const std::filesystem::path& path, bool directory) {
+    struct stat status;
+    if (::lstat(path.c_str(), &status) != 0) {
+        return false;
+    }
+    bool kindOk = directory ? S_ISDIR(status.st_mode) : S_ISREG(status.st_mode);
+    return kindOk && status.st_uid == ::geteuid() && (status.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// Runs the compiler without a shell, so no path or option is ever
+// interpreted; output is discarded. True when it exited with status 0.
+bool runCompiler(const std::string& compiler, const std::string& output, const std::string& source) {
+    std::vector<std::string> args = splitWords(compiler);
+    if (args.empty()) {
+        return false;
+    }
+    for (auto& flag : splitWords(kCompileFlags)) {
+        args.push_back(std::move(flag));
+    }
+    args.insert(args.end(), {"-o", output, source});
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    // Everything the child needs is prepared before fork(): only
+    // async-signal-safe calls are allowed in between fork() and exec()
+    int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (devNull < 0) {
+        return false;
+    }
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::dup2(devNull, STDOUT_FILENO);
+        ::dup2(devNull, STDERR_FILENO);
+        ::execvp(argv[0], argv.data());
+        ::_exit(127);
+    }
+    ::close(devNull);
+    if (pid < 0) {
+        return false;
+    }
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+std::optional<std::string> generateKernelSource(const Expr& bound, std::vector<int32_t>& inputSlots) {
+    inputSlots.clear();
+    if (!isEligible(bound)) {
+        return std::nullopt;
+    }
+    KernelWriter writer(inputSlots);
+    writer.write(bound);
+
+    std::ostringstream out;
+    out << kKernelPrelude
+        << "extern \"C\" void toy_expr_kernel(const void* const* inputs, void* output, uint64_t rows) {\n";
+    for (size_t i = 0; i < inputSlots.size(); ++i) {
+        const char* type = cType(writer.inputTypes[i]);
+        out << "    const " << type << "* __restrict in" << i << " = (const " << type
+            << "*)inputs[" << i << "];\n";
+    }
+    out << "    " << cType(bound.type) << "* __restrict out = (" << cType(bound.type) << "*)output;\n"
+        << "    for (uint64_t i = 0; i < rows; ++i) {\n"
+        << "        out[i] = " << writer.body << ";\n"
+        << "    }\n"
+        << "}\n";
+    return out.str();
+}
+
+ExpressionJit& ExpressionJit::instance() {
+    static ExpressionJit jit;
+    return jit;
+}
+
+ExpressionJit::~ExpressionJit() {
+    // Background compiles reference entries; let them finish before teardown
+    std::lock_guard lock(mutex);
+    for (auto& [hash, entry] : entries) {
+        if (entry->pendingCompile.valid()) {
+            entry->pendingCompile.wait();
+        }
+    }
+}
+
+void ExpressionJit::configure(JitOptions options) {
+    std::lock_guard lock(mutex);
+    currentOptions = std::move(options);
+}
+
+JitOptions ExpressionJit::options() const {
+    std::lock_guard lock(mutex);
+    return currentOptions;
+}
+
+std::string ExpressionJit::cacheDir(const JitOptions& options) const {
+    if (!options.cacheDir.empty()) {
+        return options.cacheDir;
+    }
+    // Per user: the directory is shared by that user's processes only
+    const char* tmp = std::getenv("TMPDIR");
+    return (std::filesystem::path(tmp && *tmp ? tmp : "/tmp") / ("toy_expr_jit-" + std::to_string(::geteuid())))
+        .string();
+}
+
+std::shared_ptr<ExpressionJit::Entry> ExpressionJit::entryFor(const Expr& bound) {
+    std::vector<int32_t> inputSlots;
+    std::string compiler;
+    {
+        std::lock_guard lock(mutex);
+        if (!currentOptions.enabled) {
+            return nullptr;
+        }
+        compiler = currentOptions.compiler;
+    }
+    auto source = generateKernelSource(bound, inputSlots);
+    if (!source) {
+        return nullptr;
+    }
+    // The source names inputs by position (with their types); the slots say
+    // which columns those are, so the same shape over other columns is a
+    // separate entry
+    uint64_t hash = fnv1a64(*source, fnv1a64(kCompileFlags, fnv1a64(compiler)));
+    for (int32_t slot : inputSlots) {
+        hash = hashCombine(hash, static_cast<uint64_t>(static_cast<uint32_t>(slot)));
+    }
+
+    std::lock_guard lock(mutex);
+    auto& entry = entries[hash];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+        entry->hash = hash;
+        entry->source = std::move(*source);
+        entry->inputSlots = std::move(inputSlots);
+        entry->resultType = bound.type;
+        entry->strict = isStrict(bound);
+    }
+    return entry;
+}
+
+bool ExpressionJit::tryExecute(Entry& entry, const Batch& batch, Column& result) {
+    bool inputNulls = false;
+    for (int32_t slot : entry.inputSlots) {
+        inputNulls |= batch.columns[slot].hasNulls();
+    }
+    if (inputNulls && !entry.strict) {
+        return false;  // Conditionals over nulls need the interpreter's branch handling
+    }
+
+    if (ExprKernel kernel = entry.kernel.load(std::memory_order_acquire)) {
+        std::vector<const void*> inputs;
+        std::vector<Column> unpacked;  // Kernels read plain arrays
+        unpacked.reserve(entry.inputSlots.size());
+        inputs.reserve(entry.inputSlots.size());
+        for (int32_t slot : entry.inputSlots) {
+            const Column& column = batch.columns[slot];
+            if (column.isPacked()) {
+                unpacked.push_back(column.decoded());
+                inputs.push_back(columnData(unpacked.back()));
+            } else {
+                inputs.push_back(columnData(column));
+            }
+        }
+        size_t rows = batch.rowCount();
+        result = Column{};
+        result.type = entry.resultType;
+        void* output = nullptr;
+        switch (entry.resultType) {
+            case PhysicalType::Bool: result.bools.resize(rows); output = result.bools.data(); break;
+            case PhysicalType::Int64: result.ints.resize(rows); output = result.ints.data(); break;
+            case PhysicalType::Double: result.doubles.resize(rows); output = result.doubles.data(); break;
+            case PhysicalType::String:
+            case PhysicalType::Vector: return false;
+        }
+        kernel(inputs.data(), output, rows);
+        for (int32_t slot : entry.inputSlots) {
+            andValidity(result.validity, batch.columns[slot].validity, rows);
+        }
+        return true;
+    }
+
+    if (entry.failed.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    JitOptions options = this->options();
+    uint32_t executions = entry.executions.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (executions >= options.compileThreshold && !entry.compileStarted.exchange(true)) {
+        if (options.compileInBackground) {
+            std::lock_guard lock(mutex);
+            entry.pendingCompile = std::async(std::launch::async,
+                                              [this, &entry, options] { compile(entry, options); });
+        } else {
+            compile(entry, options);
+            return tryExecute(entry, batch, result);
+        }
+    }
+    return false;
+}
+
+void ExpressionJit::compile(Entry& entry, const JitOptions& options) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path dir = cacheDir(options);
+    if (dir.has_parent_path()) {
+        fs::create_directories(dir.parent_path(), ec);
+    }
+    ::mkdir(dir.c_str(), 0700);  // An existing directory is checked below
+    if (!ownedAndPrivate(dir, true)) {
+        entry.failed = true;
+        return;
+    }
+    std::string stem = "expr_" + hexHash(entry.hash);
+    fs::path library = dir / (stem + ".so");
+
+    // A shared object from an earlier run (or another process) is reused as is
+    if (!fs::exists(library, ec)) {
+        // Unique temporaries, renamed into place, so concurrent compilers never
+        // observe a partially written file
+        std::string unique = stem + "." + std::to_string(::getpid()) + "." +
+                             hexHash(reinterpret_cast<uintptr_t>(&entry));
+        fs::path source = dir / (unique + ".cpp");
+        fs::path tmpLibrary = dir / (unique + ".so");
+        {
+            std::ofstream out(source);
+            out << entry.source;
+        }
+        bool compiled = runCompiler(options.compiler, tmpLibrary.string(), source.string());
+        fs::remove(source, ec);
+        if (!compiled) {
+            fs::remove(tmpLibrary, ec);
+            entry.failed = true;
+            return;
+        }
+        fs::rename(tmpLibrary, library, ec);
+        if (ec) {
+            fs::remove(tmpLibrary, ec);
+            entry.failed = true;
+            return;
+        }
+    }
+
+    // Loaded objects stay mapped for the life of the process
+    if (!ownedAndPrivate(library, false)) {
+        entry.failed = true;
+        return;
+    }
+    void* handle = ::dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    void* symbol = handle ? ::dlsym(handle, "toy_expr_kernel") : nullptr;
+    if (!symbol) {
+        entry.failed = true;
+        return;
+    }
+    entry.kernel.store(reinterpret_cast<ExprKernel>(symbol), std::memory_order_release);
+}
+
+size_t ExpressionJit::nativeCount() const {
+    std::lock_guard lock(mutex);
+    size_t count = 0;
+    for (const auto& [hash, entry] : entries) {
+        if (entry->kernel.load(std::memory_order_relaxed)) ++count;
+    }
+    return count;
+}
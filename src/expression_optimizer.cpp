@@ -0,0 +1,609 @@
+#include "expression_optimizer.h"
+#include "pipeline.h"
+#include "symbol_table.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include <cmath>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+// ---------------------------------------------------------------------------
+// Constant folding and algebraic simplification
+// ---------------------------------------------------------------------------
+
+namespace {
+
+bool isLiteral(const Expr& expr) {
+    return expr.kind == ExprKind::Literal;
+}
+
+bool isIntLiteral(const Expr& expr, int64_t value) {
+    return isLiteral(expr) && expr.type == PhysicalType::Int64 && expr.intValue == value;
+}
+
+bool isDoubleLiteral(const Expr& expr, double value) {
+    return isLiteral(expr) && expr.type == PhysicalType::Double && expr.doubleValue == value;
+}
+
+bool isBoolLiteral(const Expr& expr, bool value) {
+    return isLiteral(expr) && expr.type == PhysicalType::Bool && (expr.intValue != 0) == value;
+}
+
+bool isNumericLiteral(const Expr& expr) {
+    return isLiteral(expr) && isNumeric(expr.type);
+}
+
+double asDouble(const Expr& literal) {
+    return literal.type == PhysicalType::Int64 ? static_cast<double>(literal.intValue)
+                                               : literal.doubleValue;
+}
+
+// Integer arithmetic with defined wrap-around (matches two's complement kernels)
+int64_t wrapAdd(int64_t a, int64_t b) { return static_cast<int64_t>(uint64_t(a) + uint64_t(b)); }
+int64_t wrapSub(int64_t a, int64_t b) { return static_cast<int64_t>(uint64_t(a) - uint64_t(b)); }
+int64_t wrapMul(int64_t a, int64_t b) { return static_cast<int64_t>(uint64_t(a) * uint64_t(b)); }
+
+ExprPtr toDoubleCall(const ExprPtr& expr) {
+    if (isNumericLiteral(*expr)) {
+        return makeLiteral(asDouble(*expr));
+    }
+    return makeCall(ExprOp::ToDouble, {expr}, expr->position);
+}
+
+// Result type when it is known without a schema (literals and their combinations)
+std::optional<PhysicalType> staticType(const Expr& expr) {
+    switch (expr.kind) {
+        case ExprKind::Literal:
+            return expr.type;
+        case ExprKind::Field:
+            return std::nullopt;
+        case ExprKind::Call:
+            break;
+    }
+    switch (expr.op) {
+        case ExprOp::Eq: case ExprOp::Ne: case ExprOp::Lt: case ExprOp::Le:
+        case ExprOp::Gt: case ExprOp::Ge: case ExprOp::And: case ExprOp::Or: case ExprOp::Not:
+        case ExprOp::IsNull:
+            return PhysicalType::Bool;
+        case ExprOp::Div: case ExprOp::ToDouble: case ExprOp::Dot: case ExprOp::Cosine:
+        case ExprOp::Bm25:
+            return PhysicalType::Double;
+        case ExprOp::If: {
+            auto a = staticType(*expr.args[1]);
+            auto b = staticType(*expr.args[2]);
+            if (!a || !b) return std::nullopt;
+            if (*a == PhysicalType::Double || *b == PhysicalType::Double) return PhysicalType::Double;
+            return a;
+        }
+        default: {
+            bool allInt = true;
+            for (const auto& arg : expr.args) {
+                auto type = staticType(*arg);
+                if (type == PhysicalType::Double) return PhysicalType::Double;
+                allInt &= type == PhysicalType::Int64;
+            }
+            return allInt ? std::optional(PhysicalType::Int64) : std::nullopt;
+        }
+    }
+}
+
+// Evaluates a call whose arguments are all literals. Returns nullptr when the
+// operands are ill-typed, leaving the error for the binder to report.
+ExprPtr foldCall(const Expr& call) {
+    const auto& args = call.args;
+    bool allNumeric = true;
+    bool anyDouble = false;
+    for (const auto& arg : args) {
+        allNumeric &= isNumericLiteral(*arg);
+        anyDouble |= arg->type == PhysicalType::Double;
+    }
+
+    switch (call.op) {
+        case ExprOp::Add: case ExprOp::Sub: case ExprOp::Mul:
+        case ExprOp::Sum: case ExprOp::Min: case ExprOp::Max: {
+            if (!allNumeric) return nullptr;
+            if (anyDouble) {
+                double acc = asDouble(*args[0]);
+                for (size_t i = 1; i < args.size(); ++i) {
+                    double v = asDouble(*args[i]);
+                    switch (call.op) {
+                        case ExprOp::Add: case ExprOp::Sum: acc += v; break;
+                        case ExprOp::Sub: acc -= v; break;
+                        case ExprOp::Mul: acc *= v; break;
+                        case ExprOp::Min: acc = std::min(acc, v); break;
+                        default: acc = std::max(acc, v); break;
+                    }
+                }
+                return makeLiteral(acc);
+            }
+            int64_t acc = args[0]->intValue;
+            for (size_t i = 1; i < args.size(); ++i) {
+                int64_t v = args[i]->intValue;
+                switch (call.op) {
+                    case ExprOp::Add: case ExprOp::Sum: acc = wrapAdd(acc, v); break;
+                    case ExprOp::Sub: acc = wrapSub(acc, v); break;
+                    case ExprOp::Mul: acc = wrapMul(acc, v); break;
+                    case ExprOp::Min: acc = std::min(acc, v); break;
+                    default: acc = std::max(acc, v); break;
+                }
+            }
+            return makeLiteral(acc);
+        }
+        case ExprOp::Div:
+            if (!allNumeric) return nullptr;
+            return makeLiteral(asDouble(*args[0]) / asDouble(*args[1]));
+        case ExprOp::ToDouble:
+            if (!allNumeric) return nullptr;
+            return makeLiteral(asDouble(*args[0]));
+        case ExprOp::Neg:
+        case ExprOp::Abs:
+            if (!allNumeric) return nullptr;
+            if (anyDouble) {
+                double v = args[0]->doubleValue;
+                return makeLiteral(call.op == ExprOp::Neg ? -v : std::fabs(v));
+            } else {
+                int64_t v = args[0]->intValue;
+                bool negate = call.op == ExprOp::Neg || v < 0;
+                return makeLiteral(negate ? wrapSub(0, v) : v);
+            }
+        case ExprOp::Eq: case ExprOp::Ne: case ExprOp::Lt:
+        case ExprOp::Le: case ExprOp::Gt: case ExprOp::Ge: {
+            const Expr& a = *args[0];
+            const Expr& b = *args[1];
+            int cmp = 0;
+            if (allNumeric && anyDouble) {
+                double x = asDouble(a), y = asDouble(b);
+                if (std::isnan(x) || std::isnan(y)) return nullptr;
+                cmp = x < y ? -1 : (y < x ? 1 : 0);
+            } else if (allNumeric || (a.type == b.type && a.type == PhysicalType::Bool)) {
+                cmp = a.intValue < b.intValue ? -1 : (b.intValue < a.intValue ? 1 : 0);
+            } else if (a.type == b.type && a.type == PhysicalType::String) {
+                cmp = a.stringValue.compare(b.stringValue);
+            } else {
+                return nullptr;
+            }
+            switch (call.op) {
+                case ExprOp::Eq: return makeBoolLiteral(cmp == 0);
+                case ExprOp::Ne: return makeBoolLiteral(cmp != 0);
+                case ExprOp::Lt: return makeBoolLiteral(cmp < 0);
+                case ExprOp::Le: return makeBoolLiteral(cmp <= 0);
+                case ExprOp::Gt: return makeBoolLiteral(cmp > 0);
+                default: return makeBoolLiteral(cmp >= 0);
+            }
+        }
+        case ExprOp::And: case ExprOp::Or: case ExprOp::Not:
+            for (const auto& arg : args) {
+                if (arg->type != PhysicalType::Bool) return nullptr;
+            }
+            if (call.op == ExprOp::Not) return makeBoolLiteral(!args[0]->intValue);
+            if (call.op == ExprOp::And) return makeBoolLiteral(args[0]->intValue && args[1]->intValue);
+            return makeBoolLiteral(args[0]->intValue || args[1]->intValue);
+        case ExprOp::IsNull:
+            return makeBoolLiteral(false);  // Literals are never null
+        case ExprOp::If:
+        case ExprOp::Coalesce:
+            return nullptr;  // Handled by simplifyCall
+        case ExprOp::Dot:
+        case ExprOp::Cosine:
+        case ExprOp::Bm25:
+            return nullptr;  // Evaluated per batch
+    }
+    return nullptr;
+}
+
+// Folds if(<literal>, a, b) to the chosen branch while preserving the
+// unified result type
+ExprPtr foldIf(const ExprPtr& chosen, const ExprPtr& other) {
+    auto otherType = staticType(*other);
+    if (!otherType) {
+        return nullptr;  // Result type depends on the schema; keep the if
+    }
+    if (*otherType == PhysicalType::Double && staticType(*chosen) != PhysicalType::Double) {
+        return toDoubleCall(chosen);
+    }
+    return chosen;
+}
+
+ExprPtr simplifyCall(const ExprPtr& call) {
+    const auto& args = call->args;
+    bool allLiteral = true;
+    for (const auto& arg : args) {
+        allLiteral &= isLiteral(*arg);
+    }
+    if (allLiteral) {
+        if (auto folded = foldCall(*call)) {
+            return folded;
+        }
+    }
+
+    switch (call->op) {
+        case ExprOp::Add:
+            if (isIntLiteral(*args[1], 0)) return args[0];
+            if (isIntLiteral(*args[0], 0)) return args[1];
+            if (isDoubleLiteral(*args[1], 0)) return toDoubleCall(args[0]);
+            if (isDoubleLiteral(*args[0], 0)) return toDoubleCall(args[1]);
+            break;
+        case ExprOp::Sub:
+            if (isIntLiteral(*args[1], 0)) return args[0];
+            if (isDoubleLiteral(*args[1], 0)) return toDoubleCall(args[0]);
+            if (isIntLiteral(*args[0], 0)) return makeCall(ExprOp::Neg, {args[1]}, call->position);
+            break;
+        case ExprOp::Mul:
+            if (isIntLiteral(*args[1], 1)) return args[0];
+            if (isIntLiteral(*args[0], 1)) return args[1];
+            if (isDoubleLiteral(*args[1], 1)) return toDoubleCall(args[0]);
+            if (isDoubleLiteral(*args[0], 1)) return toDoubleCall(args[1]);
+            break;
+        case ExprOp::Div:
+            if (isIntLiteral(*args[1], 1) || isDoubleLiteral(*args[1], 1)) return toDoubleCall(args[0]);
+            break;
+        case ExprOp::Neg:
+            if (args[0]->kind == ExprKind::Call && args[0]->op == ExprOp::Neg) return args[0]->args[0];
+            break;
+        case ExprOp::Not:
+            if (args[0]->kind == ExprKind::Call && args[0]->op == ExprOp::Not) return args[0]->args[0];
+            break;
+        case ExprOp::ToDouble:
+            if (args[0]->kind == ExprKind::Call &&
+                (args[0]->op == ExprOp::ToDouble || args[0]->op == ExprOp::Div)) {
+                return args[0];
+            }
+            break;
+        case ExprOp::And:
+            if (isBoolLiteral(*args[0], false) || isBoolLiteral(*args[1], false)) return makeBoolLiteral(false);
+            if (isBoolLiteral(*args[0], true)) return args[1];
+            if (isBoolLiteral(*args[1], true)) return args[0];
+            break;
+        case ExprOp::Or:
+            if (isBoolLiteral(*args[0], true) || isBoolLiteral(*args[1], true)) return makeBoolLiteral(true);
+            if (isBoolLiteral(*args[0], false)) return args[1];
+            if (isBoolLiteral(*args[1], false)) return args[0];
+            break;
+        case ExprOp::If:
+            if (isBoolLiteral(*args[0], true)) {
+                if (auto folded = foldIf(args[1], args[2])) return folded;
+            } else if (isBoolLiteral(*args[0], false)) {
+                if (auto folded = foldIf(args[2], args[1])) return folded;
+            } else if (toString(*args[1]) == toString(*args[2])) {
+                return args[1];
+            }
+            break;
+        case ExprOp::Min:
+        case ExprOp::Max:
+        case ExprOp::Coalesce:
+            if (args.size() == 1) return args[0];
+            break;
+        case ExprOp::Sum: {
+            // Fold literal operands into one constant and drop an integer zero
+            std::vector<ExprPtr> terms;
+            std::vector<ExprPtr> constants;
+            for (const auto& arg : args) {
+                (isNumericLiteral(*arg) ? constants : terms).push_back(arg);
+            }
+            if (constants.size() <= 1 && !(constants.size() == 1 && isIntLiteral(*constants[0], 0))) {
+                if (args.size() == 1) return args[0];
+                break;
+            }
+            if (!constants.empty()) {
+                ExprPtr constant = foldCall(*makeCall(ExprOp::Sum, constants));
+                if (!isIntLiteral(*constant, 0)) terms.push_back(constant);
+            }
+            if (terms.empty()) return makeLiteral(int64_t(0));
+            if (terms.size() == 1) return terms[0];
+            return makeCall(ExprOp::Sum, std::move(terms), call->position);
+        }
+        default:
+            break;
+    }
+    return call;
+}
+
+} // namespace
+
+ExprPtr simplifyExpression(const ExprPtr& expr) {
+    if (expr->kind != ExprKind::Call) {
+        return expr;
+    }
+    std::vector<ExprPtr> args;
+    args.reserve(expr->args.size());
+    bool changed = false;
+    for (const auto& arg : expr->args) {
+        args.push_back(simplifyExpression(arg));
+        changed |= args.back() != arg;
+    }
+    ExprPtr call = changed ? makeCall(expr->op, std::move(args), expr->position) : expr;
+    ExprPtr simplified = simplifyCall(call);
+    // A rewrite can expose new opportunities one level up (e.g. --(--x))
+    return simplified != call ? simplifyExpression(simplified) : simplified;
+}
+
+// ---------------------------------------------------------------------------
+// Common subexpression elimination across set_metadata stages
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Fields are versioned by how many stages have written them so far, so a
+// subexpression over a field that was overwritten in between never matches.
+// The epoch advances at stages that replace the whole schema.
+struct FieldVersions {
+    std::unordered_map<std::string, uint32_t> versions;
+    uint32_t epoch = 0;
+
+    uint32_t of(const std::string& name) const {
+        auto it = versions.find(name);
+        return it == versions.end() ? 0 : it->second;
+    }
+
+    void write(const std::string& name) { ++versions[name]; }
+};
+
+void appendKey(const Expr& expr, const FieldVersions& fields, std::string& out) {
+    switch (expr.kind) {
+        case ExprKind::Literal:
+            out += toString(expr);
+            return;
+        case ExprKind::Field:
+            out += expr.name;
+            out += '#';
+            out += std::to_string(fields.of(expr.name));
+            return;
+        case ExprKind::Call:
+            out += '@';
+            out += std::to_string(static_cast<int>(expr.op));
+            out += '(';
+            for (const auto& arg : expr.args) {
+                appendKey(*arg, fields, out);
+                out += ',';
+            }
+            out += ')';
+            return;
+    }
+}
+
+std::string keyOf(const Expr& expr, const FieldVersions& fields) {
+    std::string key = std::to_string(fields.epoch) + ":";
+    appendKey(expr, fields, key);
+    return key;
+}
+
+size_t nodeCount(const Expr& expr) {
+    size_t count = 1;
+    for (const auto& arg : expr.args) count += nodeCount(*arg);
+    return count;
+}
+
+// Replaces every call subtree for which replacement() returns a field name
+template <typename Replacement>
+ExprPtr replaceSubexpressions(const ExprPtr& expr, const FieldVersions& fields, Replacement replacement) {
+    if (expr->kind != ExprKind::Call) {
+        return expr;
+    }
+    if (auto name = replacement(keyOf(*expr, fields))) {
+        auto field = std::const_pointer_cast<Expr>(makeField(*name));
+        field->position = expr->position;
+        return field;
+    }
+    std::vector<ExprPtr> args;
+    bool changed = false;
+    for (const auto& arg : expr->args) {
+        args.push_back(replaceSubexpressions(arg, fields, replacement));
+        changed |= args.back() != arg;
+    }
+    return changed ? makeCall(expr->op, std::move(args), expr->position) : expr;
+}
+
+// Sort, limit and match reorder/drop whole rows, which keeps every computed
+// column consistent with its inputs. Any other non-set_metadata stage is a
+// barrier.
+bool preservesColumns(const LogicalNode& stage) {
+    return dynamic_cast<const SortLogicalNode*>(&stage) || dynamic_cast<const LimitLogicalNode*>(&stage) ||
+           dynamic_cast<const MatchLogicalNode*>(&stage);
+}
+
+// Project, group and distinct output only the fields they name, so a column
+// computed before them never reaches the pipeline's output
+bool definesOutput(const LogicalNode& stage) {
+    return dynamic_cast<const ProjectLogicalNode*>(&stage) || dynamic_cast<const GroupLogicalNode*>(&stage) ||
+           dynamic_cast<const DistinctLogicalNode*>(&stage);
+}
+
+SetMetadataLogicalNode* asSetMetadata(std::unique_ptr<LogicalNode>& stage) {
+    return dynamic_cast<SetMetadataLogicalNode*>(stage.get());
+}
+
+// Pass 2: reference columns computed by earlier stages
+void reuseComputedColumns(Pipeline& pipeline) {
+    FieldVersions fields;
+    struct Computed {
+        std::string column;
+        uint32_t version;
+    };
+    std::unordered_map<std::string, Computed> computed;
+
+    for (auto& stage : pipeline.stages) {
+        auto* node = asSetMetadata(stage);
+        if (!node) {
+            if (!preservesColumns(*stage)) {
+                ++fields.epoch;
+                computed.clear();
+            }
+            continue;
+        }
+        if (!node->expression) {
+            fields.write(node->params.metaName);
+            continue;
+        }
+        node->expression = replaceSubexpressions(node->expression, fields,
+            [&](const std::string& key) -> std::optional<std::string> {
+                auto it = computed.find(key);
+                if (it != computed.end() && fields.of(it->second.column) == it->second.version) {
+                    return it->second.column;
+                }
+                return std::nullopt;
+            });
+        std::optional<std::string> key;
+        if (node->expression->kind == ExprKind::Call) {
+            key = keyOf(*node->expression, fields);
+        }
+        fields.write(node->params.metaName);
+        if (key) {
+            computed[*key] = Computed{node->params.metaName, fields.of(node->params.metaName)};
+        }
+    }
+}
+
+struct Candidate {
+    size_t count = 0;
+    size_t size = 0;
+    size_t firstStage = 0;
+    uint32_t epoch = 0;
+    ExprPtr expr;
+};
+
+// Arguments evaluated for every row: all but the branches of if(), the
+// right-hand sides of and/or and coalesce()'s fallbacks, which only see
+// the rows that need them
+size_t unconditionalArgs(const Expr& call) {
+    switch (call.op) {
+        case ExprOp::If:
+        case ExprOp::And:
+        case ExprOp::Or:
+        case ExprOp::Coalesce:
+            return std::min<size_t>(call.args.size(), 1);
+        default:
+            return call.args.size();
+    }
+}
+
+// Counts the call subtrees every row evaluates
+void countSubexpressions(const ExprPtr& expr, const FieldVersions& fields, size_t stage,
+                         std::unordered_map<std::string, Candidate>& candidates) {
+    if (expr->kind != ExprKind::Call) {
+        return;
+    }
+    auto& candidate = candidates[keyOf(*expr, fields)];
+    if (candidate.count++ == 0) {
+        candidate.size = nodeCount(*expr);
+        candidate.firstStage = stage;
+        candidate.epoch = fields.epoch;
+        candidate.expr = expr;
+    }
+    for (size_t i = 0; i < unconditionalArgs(*expr); ++i) {
+        countSubexpressions(expr->args[i], fields, stage, candidates);
+    }
+}
+
+std::string freshColumnName(const Pipeline& pipeline, size_t& next) {
+    std::unordered_set<std::string> used;
+    for (const auto& stage : pipeline.stages) {
+        if (auto* node = dynamic_cast<const SetMetadataLogicalNode*>(stage.get())) {
+            used.insert(node->params.metaName);
+        }
+    }
+    std::string name;
+    do {
+        name = "__cse" + std::to_string(next++);
+    } while (used.count(name));
+    return name;
+}
+
+// Pass 3: hoist repeated subexpressions into their own stage, largest first.
+// Only where the epoch ends at a stage that defines the output, so the
+// hoisted column never changes what the pipeline returns.
+void hoistRepeatedSubexpressions(Pipeline& pipeline, SymbolTable& symbols) {
+    size_t nextName = 0;
+    while (true) {
+        std::unordered_map<std::string, Candidate> candidates;
+        FieldVersions fields;
+        std::vector<bool> dropsColumns;  // Per epoch: it ends at a stage that defines the output
+        for (size_t i = 0; i < pipeline.stages.size(); ++i) {
+            auto* node = asSetMetadata(pipeline.stages[i]);
+            if (!node) {
+                if (!preservesColumns(*pipeline.stages[i])) {
+                    dropsColumns.push_back(definesOutput(*pipeline.stages[i]));
+                    ++fields.epoch;
+                }
+                continue;
+            }
+            if (node->expression) {
+                countSubexpressions(node->expression, fields, i, candidates);
+            }
+            fields.write(node->params.metaName);
+        }
+
+        const std::string* bestKey = nullptr;
+        const Candidate* best = nullptr;
+        for (const auto& [key, candidate] : candidates) {
+            if (candidate.count < 2 || candidate.epoch >= dropsColumns.size() || !dropsColumns[candidate.epoch]) {
+                continue;
+            }
+            if (!best || candidate.size > best->size ||
+                (candidate.size == best->size && candidate.firstStage < best->firstStage) ||
+                (candidate.size == best->size && candidate.firstStage == best->firstStage && key < *bestKey)) {
+                best = &candidate;
+                bestKey = &key;
+            }
+        }
+        if (!best) {
+            return;
+        }
+
+        SetMetadataParams params;
+        params.metaName = freshColumnName(pipeline, nextName);
+        params.metaNameId = symbols.intern(params.metaName);
+        params.expression = toString(*best->expr);
+        auto hoisted = std::make_unique<SetMetadataLogicalNode>(params);
+        hoisted->expression = best->expr;
+        std::string key = *bestKey;
+        size_t insertAt = best->firstStage;
+        pipeline.stages.insert(pipeline.stages.begin() + insertAt, std::move(hoisted));
+
+        // Rewrite every later occurrence to read the hoisted column
+        FieldVersions rewriteFields;
+        for (size_t i = 0; i < pipeline.stages.size(); ++i) {
+            auto* node = asSetMetadata(pipeline.stages[i]);
+            if (!node) {
+                if (!preservesColumns(*pipeline.stages[i])) ++rewriteFields.epoch;
+                continue;
+            }
+            if (i > insertAt && node->expression) {
+                node->expression = replaceSubexpressions(node->expression, rewriteFields,
+                    [&](const std::string& candidateKey) -> std::optional<std::string> {
+                        if (candidateKey == key) return params.metaName;
+                        return std::nullopt;
+                    });
+            }
+            rewriteFields.write(node->params.metaName);
+        }
+    }
+}
+
+} // namespace
+
+void optimizeSetMetadataExpressions(Pipeline& pipeline, SymbolTable& symbols) {
+    for (auto& stage : pipeline.stages) {
+        if (auto* node = asSetMetadata(stage)) {
+            auto parsed = node->parsedExpression();
+            if (parsed) {
+                node->expression = simplifyExpression(*parsed);
+            }
+        }
+    }
+
+    reuseComputedColumns(pipeline);
+    hoistRepeatedSubexpressions(pipeline, symbols);
+
+    // Keep params (explain, plan cache encoding) in sync with the rewritten trees
+    for (auto& stage : pipeline.stages) {
+        if (auto* node = asSetMetadata(stage); node && node->expression) {
+            node->params.expression = toString(*node->expression);
+        }
+    }
+}
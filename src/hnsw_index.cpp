@@ -0,0 +1,249 @@
+#include "hnsw_index.h"
+#include "batch.h"
+#include "vector_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+constexpr size_t kMaxLevel = 16;
+
+struct Candidate {
+    float score;
+    uint32_t node;
+};
+
+// Higher similarity first; ties go to the earlier node, so builds and
+// searches are deterministic
+bool better(const Candidate& a, const Candidate& b) {
+    return a.score > b.score || (a.score == b.score && a.node < b.node);
+}
+
+struct Better {
+    bool operator()(const Candidate& a, const Candidate& b) const { return better(a, b); }
+};
+struct Worse {
+    bool operator()(const Candidate& a, const Candidate& b) const { return better(b, a); }
+};
+
+// Level of the node inserted for `row`: geometric with ratio 1/m
+size_t levelFor(uint32_t row, uint32_t m) {
+    uint64_t h = row + 0x9e3779b97f4a7c15ULL;  // splitmix64
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    double u = static_cast<double>((h >> 11) + 1) * 0x1.0p-53;  // (0, 1]
+    double level = -std::log(u) / std::log(static_cast<double>(std::max<uint32_t>(m, 2)));
+    return std::min(static_cast<size_t>(level), kMaxLevel);
+}
+
+// Searches over one index; owns the visited marks
+struct GraphSearch {
+    const HnswIndex& index;
+    std::vector<uint32_t> marks;
+    uint32_t epoch = 0;
+
+    explicit GraphSearch(const HnswIndex& index) : index(index) {}
+
+    const float* vectorOf(uint32_t node) const {
+        return index.vectors.data() + static_cast<size_t>(node) * index.dimension;
+    }
+
+    float score(const float* query, uint32_t node) const {
+        return dotF32(query, vectorOf(node), index.dimension);
+    }
+
+    // Marks node visited; returns false if it already was in this search
+    bool visit(uint32_t node) {
+        if (marks.size() <= node) {
+            marks.resize(std::max<size_t>(node + 1, marks.size() * 2), 0);
+        }
+        if (marks[node] == epoch) return false;
+        marks[node] = epoch;
+        return true;
+    }
+
+    void beginSearch() {
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // Follows the best neighbour until none improves
+    uint32_t greedy(const float* query, uint32_t node, size_t level) const {
+        float best = score(query, node);
+        for (bool moved = true; moved;) {
+            moved = false;
+            for (uint32_t next : index.links[level][node]) {
+                float s = score(query, next);
+                if (better({s, next}, {best, node})) {
+                    best = s;
+                    node = next;
+                    moved = true;
+                }
+            }
+        }
+        return node;
+    }
+
+    // Best-first search of width ef on one level; results best first
+    std::vector<Candidate> searchLayer(const float* query, const std::vector<Candidate>& entries, size_t ef,
+                                       size_t level) {
+        beginSearch();
+        std::priority_queue<Candidate, std::vector<Candidate>, Worse> frontier;  // Best on top
+        std::priority_queue<Candidate, std::vector<Candidate>, Better> found;    // Worst on top
+        for (const Candidate& entry : entries) {
+            if (visit(entry.node)) {
+                frontier.push(entry);
+                found.push(entry);
+            }
+        }
+        while (found.size() > ef) found.pop();
+        while (!frontier.empty()) {
+            Candidate current = frontier.top();
+            if (found.size() >= ef && better(found.top(), current)) {
+                break;  // Nothing left in the frontier can improve the results
+            }
+            frontier.pop();
+            for (uint32_t next : index.links[level][current.node]) {
+                if (!visit(next)) continue;
+                Candidate candidate{score(query, next), next};
+                if (found.size() < ef || better(candidate, found.top())) {
+                    frontier.push(candidate);
+                    found.push(candidate);
+                    if (found.size() > ef) found.pop();
+                }
+            }
+        }
+        std::vector<Candidate> results(found.size());
+        for (size_t i = results.size(); i-- > 0;) {
+            results[i] = found.top();
+            found.pop();
+        }
+        return results;
+    }
+
+    // Neighbour selection heuristic: a candidate is kept only if it is more
+    // similar to the base than to any kept neighbour, which spreads links
+    // across clusters; skipped candidates fill any remaining slots
+    std::vector<uint32_t> selectNeighbours(const std::vector<Candidate>& candidates, size_t count) const {
+        std::vector<uint32_t> kept;
+        std::vector<uint32_t> skipped;
+        for (const Candidate& candidate : candidates) {
+            if (kept.size() == count) break;
+            bool diverse = std::none_of(kept.begin(), kept.end(), [&](uint32_t other) {
+                return score(vectorOf(candidate.node), other) > candidate.score;
+            });
+            (diverse ? kept : skipped).push_back(candidate.node);
+        }
+        for (size_t i = 0; i < skipped.size() && kept.size() < count; ++i) {
+            kept.push_back(skipped[i]);
+        }
+        return kept;
+    }
+};
+
+// Links the node into every level up to `level`
+void insertNode(HnswIndex& index, GraphSearch& searcher, uint32_t node, size_t level, uint32_t efConstruction) {
+    auto& links = index.links;
+    bool first = links.empty();
+    size_t top = first ? 0 : links.size() - 1;
+    if (links.size() <= level) links.resize(level + 1);
+    for (size_t l = 0; l <= level; ++l) links[l].resize(node + 1);
+    if (first) {
+        index.entryPoint = node;
+        return;
+    }
+
+    const float* query = searcher.vectorOf(node);
+    uint32_t entry = index.entryPoint;
+    for (size_t l = top; l > level; --l) {
+        entry = searcher.greedy(query, entry, l);
+    }
+    std::vector<Candidate> entries{{searcher.score(query, entry), entry}};
+    for (size_t l = std::min(level, top) + 1; l-- > 0;) {
+        std::vector<Candidate> found = searcher.searchLayer(query, entries, efConstruction, l);
+        size_t maxLinks = l == 0 ? 2 * index.m : index.m;
+        links[l][node] = searcher.selectNeighbours(found, index.m);
+        for (uint32_t neighbour : links[l][node]) {
+            auto& back = links[l][neighbour];
+            back.push_back(node);
+            if (back.size() > maxLinks) {
+                // Re-select the neighbour's links from its own point of view
+                std::vector<Candidate> ranked;
+                for (uint32_t other : back) {
+                    ranked.push_back({searcher.score(searcher.vectorOf(neighbour), other), other});
+                }
+                std::sort(ranked.begin(), ranked.end(), better);
+                back = searcher.selectNeighbours(ranked, maxLinks);
+            }
+        }
+        entries = std::move(found);
+    }
+    if (level > top) {
+        index.entryPoint = node;
+    }
+}
+
+} // namespace
+
+std::vector<HnswIndex::Hit> HnswIndex::search(const float* query, size_t k, size_t ef) const {
+    if (rows.empty()) {
+        return {};
+    }
+    std::vector<float> unit;
+    if (metric == VectorMetric::Cosine) {
+        float norm = std::sqrt(dotF32(query, query, dimension));
+        if (norm == 0) {
+            return {};
+        }
+        unit.resize(dimension);
+        for (uint32_t i = 0; i < dimension; ++i) unit[i] = query[i] / norm;
+        query = unit.data();
+    }
+    GraphSearch searcher(*this);
+    uint32_t entry = entryPoint;
+    for (size_t l = links.size() - 1; l > 0; --l) {
+        entry = searcher.greedy(query, entry, l);
+    }
+    std::vector<Candidate> found =
+        searcher.searchLayer(query, {{searcher.score(query, entry), entry}}, std::max(k, ef), 0);
+    std::vector<Hit> hits;
+    hits.reserve(found.size());
+    for (const Candidate& candidate : found) {
+        hits.push_back(Hit{rows[candidate.node], candidate.score});
+    }
+    return hits;
+}
+
+std::shared_ptr<const HnswIndex> buildHnswIndex(const Column& column, VectorMetric metric, uint32_t m,
+                                                uint32_t efConstruction) {
+    auto index = std::make_shared<HnswIndex>();
+    index->metric = metric;
+    index->dimension = column.dimension;
+    index->m = std::max<uint32_t>(m, 2);
+    Column plain = column.decoded();
+    size_t dimension = column.dimension;
+    for (size_t row = 0; row < plain.size(); ++row) {
+        if (!plain.isValid(row)) continue;
+        const float* values = plain.floats.data() + row * dimension;
+        float scale = 1;
+        if (metric == VectorMetric::Cosine) {
+            float norm = std::sqrt(dotF32(values, values, dimension));
+            if (norm == 0) continue;
+            scale = 1 / norm;
+        }
+        for (size_t i = 0; i < dimension; ++i) {
+            index->vectors.push_back(values[i] * scale);
+        }
+        index->rows.push_back(static_cast<uint32_t>(row));
+    }
+
+    GraphSearch builder(*index);
+    for (uint32_t node = 0; node < index->rows.size(); ++node) {
+        insertNode(*index, builder, node, levelFor(index->rows[node], index->m), std::max(efConstruction, index->m));
+    }
+    return index;
+}
@@ -0,0 +1,34 @@
+#include "hyperloglog.h"
+#include <algorithm>
+#include <cmath>
+
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : precision(std::clamp<uint8_t>(precision, 4, 18)), registers(size_t{1} << this->precision, 0) {}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision != precision) {
+        return;
+    }
+    for (size_t i = 0; i < registers.size(); ++i) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+}
+
+double HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers.size());
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -r);
+        zeros += r == 0;
+    }
+    double alpha = registers.size() == 16   ? 0.673
+                   : registers.size() == 32 ? 0.697
+                   : registers.size() == 64 ? 0.709
+                                            : 0.7213 / (1 + 1.079 / m);
+    double raw = alpha * m * m / sum;
+    if (raw <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / static_cast<double>(zeros));
+    }
+    return raw;
+}
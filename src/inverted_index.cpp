@@ -0,0 +1,407 @@
+#include "inverted_index.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kEndDoc = std::numeric_limits<uint32_t>::max();
+
+// Bounds summed in a different order than the score may round below it
+constexpr double kBoundSlack = 1 + 1e-9;
+
+bool isTokenByte(unsigned char c) {
+    return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+char lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Tokens of one row, and how often each query term occurs among them
+struct TermCounts {
+    uint32_t length = 0;
+    std::vector<uint32_t> tf;
+};
+
+TermCounts countTerms(std::string_view text, const std::vector<std::string>& queryTerms) {
+    TermCounts counts;
+    counts.tf.assign(queryTerms.size(), 0);
+    for (const std::string& token : tokenize(text)) {
+        ++counts.length;
+        auto it = std::lower_bound(queryTerms.begin(), queryTerms.end(), token);
+        if (it != queryTerms.end() && *it == token) {
+            ++counts.tf[it - queryTerms.begin()];
+        }
+    }
+    return counts;
+}
+
+std::string_view textAt(const Column& column, size_t row) {
+    return column.isDictionary() ? std::string_view((*column.dictionary)[column.codes[row]])
+                                 : std::string_view(column.strings[row]);
+}
+
+// Counts for every row of the column (zero for null rows); a dictionary
+// column tokenizes each distinct value once
+std::vector<TermCounts> countAllRows(const Column& column, const std::vector<std::string>& queryTerms) {
+    size_t rows = column.size();
+    std::vector<TermCounts> counts(rows);
+    if (column.isDictionary()) {
+        std::vector<TermCounts> perValue;
+        perValue.reserve(column.dictionary->size());
+        for (const std::string& value : *column.dictionary) {
+            perValue.push_back(countTerms(value, queryTerms));
+        }
+        for (size_t row = 0; row < rows; ++row) {
+            if (column.isValid(row)) counts[row] = perValue[column.codes[row]];
+        }
+        return counts;
+    }
+    for (size_t row = 0; row < rows; ++row) {
+        if (column.isValid(row)) counts[row] = countTerms(column.strings[row], queryTerms);
+    }
+    return counts;
+}
+
+// Position in one posting list during topK()
+struct Cursor {
+    const PostingList* list = nullptr;
+    size_t term = 0;  // Index in the canonical query terms
+    size_t block = 0;
+    size_t pos = 0;
+    size_t decodedBlock = std::numeric_limits<size_t>::max();
+    std::array<int64_t, kPackedBlockRows> docs{};
+    std::array<int64_t, kPackedBlockRows> freqs{};
+    uint32_t doc = 0;
+
+    void decode(WandStats& stats) {
+        if (decodedBlock == block) return;
+        const PostingBlock& current = list->blocks[block];
+        current.docs.unpack(0, current.docs.count, docs.data());
+        current.freqs.unpack(0, current.freqs.count, freqs.data());
+        decodedBlock = block;
+        pos = 0;
+        ++stats.blocksDecoded;
+    }
+
+    // Moves to the first posting at or after target; blocks that end
+    // before it are passed over without decoding
+    void seek(uint32_t target, WandStats& stats) {
+        if (doc >= target) return;
+        while (block < list->blocks.size() && list->blocks[block].lastDoc < target) {
+            if (block != decodedBlock) ++stats.blocksSkipped;
+            ++block;
+        }
+        if (block == list->blocks.size()) {
+            doc = kEndDoc;
+            return;
+        }
+        decode(stats);
+        while (static_cast<uint32_t>(docs[pos]) < target) ++pos;
+        doc = static_cast<uint32_t>(docs[pos]);
+    }
+
+    // Block that would hold target (the bound for rows up to its lastDoc);
+    // null when the list ends before it
+    const PostingBlock* blockFor(uint32_t target) const {
+        for (size_t b = block; b < list->blocks.size(); ++b) {
+            if (list->blocks[b].lastDoc >= target) return &list->blocks[b];
+        }
+        return nullptr;
+    }
+};
+
+// Heap order keeping the worst hit on top: lower score, then higher row
+struct WorseHitOnTop {
+    bool operator()(const InvertedIndex::Hit& a, const InvertedIndex::Hit& b) const {
+        return a.score > b.score || (a.score == b.score && a.row < b.row);
+    }
+};
+
+} // namespace
+
+std::vector<std::string> tokenize(std::string_view text) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && !isTokenByte(static_cast<unsigned char>(text[i]))) ++i;
+        size_t begin = i;
+        while (i < text.size() && isTokenByte(static_cast<unsigned char>(text[i]))) ++i;
+        if (i > begin) {
+            std::string token(text.substr(begin, i - begin));
+            std::transform(token.begin(), token.end(), token.begin(), lower);
+            tokens.push_back(std::move(token));
+        }
+    }
+    return tokens;
+}
+
+std::vector<std::string> queryTerms(std::string_view query) {
+    std::vector<std::string> terms = tokenize(query);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
+
+double bm25Idf(size_t documents, size_t docCount) {
+    double n = static_cast<double>(documents);
+    double df = static_cast<double>(docCount);
+    return std::log(1 + (n - df + 0.5) / (df + 0.5));
+}
+
+double bm25TermScore(uint32_t tf, uint32_t docLength, double idf, double averageLength) {
+    double f = static_cast<double>(tf);
+    double relativeLength = averageLength > 0 ? docLength / averageLength : 0;
+    return idf * (f * (kBm25K1 + 1)) / (f + kBm25K1 * (1 - kBm25B + kBm25B * relativeLength));
+}
+
+const PostingList* InvertedIndex::find(const std::string& term) const {
+    auto it = terms.find(term);
+    return it == terms.end() ? nullptr : &it->second;
+}
+
+std::vector<InvertedIndex::Hit> InvertedIndex::topK(const std::vector<std::string>& queryTerms, size_t k,
+                                                    WandStats* stats) const {
+    WandStats local;
+    WandStats& counters = stats ? *stats : local;
+    if (k == 0) {
+        return {};
+    }
+    std::vector<Cursor> cursors;
+    cursors.reserve(queryTerms.size());
+    for (size_t t = 0; t < queryTerms.size(); ++t) {
+        if (const PostingList* list = find(queryTerms[t])) {
+            Cursor& cursor = cursors.emplace_back();
+            cursor.list = list;
+            cursor.term = t;
+            cursor.decode(counters);
+            cursor.doc = static_cast<uint32_t>(cursor.docs[0]);
+        }
+    }
+    std::vector<Cursor*> order;
+    for (Cursor& cursor : cursors) order.push_back(&cursor);
+
+    std::priority_queue<Hit, std::vector<Hit>, WorseHitOnTop> heap;
+    // Ties lose to the hit already kept, which is on a lower row
+    auto canEnter = [&](double bound) { return heap.size() < k || bound * kBoundSlack > heap.top().score; };
+    std::vector<std::pair<size_t, double>> contributions;
+
+    while (true) {
+        std::erase_if(order, [](const Cursor* c) { return c->doc == kEndDoc; });
+        if (order.empty()) break;
+        std::sort(order.begin(), order.end(), [](const Cursor* a, const Cursor* b) {
+            return a->doc < b->doc || (a->doc == b->doc && a->term < b->term);
+        });
+
+        // Pivot: the first row where the lists so far could beat the k-th score
+        size_t n = order.size();
+        size_t pivot = n;
+        double bound = 0;
+        for (size_t i = 0; i < n; ++i) {
+            bound += order[i]->list->maxScore;
+            if (canEnter(bound)) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == n) break;
+        uint32_t pivotDoc = order[pivot]->doc;
+        while (pivot + 1 < n && order[pivot + 1]->doc == pivotDoc) ++pivot;
+
+        // Tighter bound from the blocks that hold the pivot row
+        double blockBound = 0;
+        uint32_t blocksEnd = kEndDoc;
+        for (size_t i = 0; i <= pivot; ++i) {
+            const PostingBlock* block = order[i]->blockFor(pivotDoc);
+            if (!block) continue;  // The list ends before the pivot row
+            blockBound += block->maxScore;
+            blocksEnd = std::min(blocksEnd, block->lastDoc);
+        }
+
+        if (!canEnter(blockBound)) {
+            // No row before the end of those blocks (or the next list's row)
+            // can enter
+            uint32_t next = blocksEnd + 1;
+            if (pivot + 1 < n) next = std::min(next, order[pivot + 1]->doc);
+            for (size_t i = 0; i <= pivot; ++i) order[i]->seek(next, counters);
+            continue;
+        }
+        if (order[0]->doc != pivotDoc) {
+            for (size_t i = 0; i < pivot && order[i]->doc < pivotDoc; ++i) order[i]->seek(pivotDoc, counters);
+            continue;
+        }
+
+        // Every list up to the pivot is on the pivot row: score it in
+        // canonical term order, as bm25Scores() does
+        contributions.clear();
+        for (size_t i = 0; i <= pivot; ++i) {
+            const Cursor& cursor = *order[i];
+            contributions.emplace_back(cursor.term,
+                                       bm25TermScore(static_cast<uint32_t>(cursor.freqs[cursor.pos]),
+                                                     docLengths[pivotDoc], cursor.list->idf, averageLength));
+        }
+        std::sort(contributions.begin(), contributions.end());
+        double score = 0;
+        for (const auto& [term, contribution] : contributions) score += contribution;
+        ++counters.docsScored;
+        if (heap.size() < k) {
+            heap.push({pivotDoc, score});
+        } else if (score > heap.top().score) {
+            heap.pop();
+            heap.push({pivotDoc, score});
+        }
+        for (size_t i = 0; i <= pivot; ++i) order[i]->seek(pivotDoc + 1, counters);
+    }
+
+    std::vector<Hit> hits(heap.size());
+    for (size_t i = hits.size(); i-- > 0;) {
+        hits[i] = heap.top();
+        heap.pop();
+    }
+    return hits;
+}
+
+std::shared_ptr<const InvertedIndex> buildInvertedIndex(const Column& column) {
+    auto index = std::make_shared<InvertedIndex>();
+    size_t rows = column.size();
+    index->docLengths.assign(rows, 0);
+
+    // (row, tf) per term, in row order
+    std::unordered_map<std::string, std::vector<std::pair<uint32_t, uint32_t>>> postings;
+    auto addRow = [&](uint32_t row, std::vector<std::string> tokens) {
+        index->docLengths[row] = static_cast<uint32_t>(tokens.size());
+        std::sort(tokens.begin(), tokens.end());
+        for (size_t i = 0; i < tokens.size();) {
+            size_t j = i;
+            while (j < tokens.size() && tokens[j] == tokens[i]) ++j;
+            postings[tokens[i]].emplace_back(row, static_cast<uint32_t>(j - i));
+            i = j;
+        }
+    };
+    std::vector<std::vector<std::string>> perValue;
+    if (column.isDictionary()) {
+        for (const std::string& value : *column.dictionary) perValue.push_back(tokenize(value));
+    }
+    uint64_t totalLength = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        if (!column.isValid(row)) continue;
+        ++index->documents;
+        addRow(static_cast<uint32_t>(row),
+               column.isDictionary() ? perValue[column.codes[row]] : tokenize(textAt(column, row)));
+        totalLength += index->docLengths[row];
+    }
+    index->averageLength =
+        index->documents ? static_cast<double>(totalLength) / static_cast<double>(index->documents) : 0;
+
+    std::vector<int64_t> docs;
+    std::vector<int64_t> freqs;
+    for (auto& [term, entries] : postings) {
+        PostingList& list = index->terms[term];
+        list.docCount = static_cast<uint32_t>(entries.size());
+        list.idf = bm25Idf(index->documents, entries.size());
+        for (size_t begin = 0; begin < entries.size(); begin += kPackedBlockRows) {
+            size_t end = std::min(entries.size(), begin + kPackedBlockRows);
+            PostingBlock block;
+            docs.clear();
+            freqs.clear();
+            for (size_t i = begin; i < end; ++i) {
+                auto [row, tf] = entries[i];
+                docs.push_back(row);
+                freqs.push_back(tf);
+                block.maxScore = std::max(block.maxScore,
+                                          bm25TermScore(tf, index->docLengths[row], list.idf, index->averageLength));
+            }
+            block.docs = PackedInts::pack(docs);
+            block.freqs = PackedInts::pack(freqs);
+            block.lastDoc = entries[end - 1].first;
+            list.maxScore = std::max(list.maxScore, block.maxScore);
+            list.blocks.push_back(std::move(block));
+        }
+    }
+    return index;
+}
+
+Column bm25Scores(const Column& column, const std::vector<std::string>& queryTerms,
+                  const SelectionVector* selection) {
+    size_t rows = selection ? selection->size() : column.size();
+    auto rowAt = [&](size_t i) -> size_t { return selection ? (*selection)[i] : i; };
+    std::vector<double> out(rows, 0);
+
+    // Per-term idf and the length normalization, from the index or a scan
+    std::vector<double> idf(queryTerms.size(), 0);
+    double averageLength = 0;
+    const std::vector<uint32_t>* docLengths = nullptr;
+    std::vector<uint32_t> scannedLengths;
+    std::vector<TermCounts> scanned;
+    if (column.textIndex) {
+        const InvertedIndex& index = *column.textIndex;
+        for (size_t t = 0; t < queryTerms.size(); ++t) {
+            if (const PostingList* list = index.find(queryTerms[t])) idf[t] = list->idf;
+        }
+        averageLength = index.averageLength;
+        docLengths = &index.docLengths;
+        if (!selection) {
+            // Scatter the postings; each row gets its terms added in order
+            std::array<int64_t, kPackedBlockRows> docs;
+            std::array<int64_t, kPackedBlockRows> freqs;
+            for (size_t t = 0; t < queryTerms.size(); ++t) {
+                const PostingList* list = index.find(queryTerms[t]);
+                if (!list) continue;
+                for (const PostingBlock& block : list->blocks) {
+                    block.docs.unpack(0, block.docs.count, docs.data());
+                    block.freqs.unpack(0, block.freqs.count, freqs.data());
+                    for (size_t i = 0; i < block.docs.count; ++i) {
+                        out[docs[i]] += bm25TermScore(static_cast<uint32_t>(freqs[i]), index.docLengths[docs[i]],
+                                                      list->idf, averageLength);
+                    }
+                }
+            }
+        }
+    } else {
+        scanned = countAllRows(column, queryTerms);
+        size_t documents = 0;
+        uint64_t totalLength = 0;
+        std::vector<size_t> docCount(queryTerms.size(), 0);
+        scannedLengths.resize(scanned.size());
+        for (size_t row = 0; row < scanned.size(); ++row) {
+            scannedLengths[row] = scanned[row].length;
+            if (!column.isValid(row)) continue;
+            ++documents;
+            totalLength += scanned[row].length;
+            for (size_t t = 0; t < queryTerms.size(); ++t) docCount[t] += scanned[row].tf[t] > 0;
+        }
+        for (size_t t = 0; t < queryTerms.size(); ++t) idf[t] = bm25Idf(documents, docCount[t]);
+        averageLength = documents ? static_cast<double>(totalLength) / static_cast<double>(documents) : 0;
+        docLengths = &scannedLengths;
+    }
+
+    bool scattered = column.textIndex && !selection;
+    if (!scattered) {
+        for (size_t i = 0; i < rows; ++i) {
+            size_t row = rowAt(i);
+            if (!column.isValid(row)) continue;
+            TermCounts selected;
+            const TermCounts* counts = &selected;
+            if (scanned.empty()) {
+                selected = countTerms(textAt(column, row), queryTerms);
+            } else {
+                counts = &scanned[row];
+            }
+            for (size_t t = 0; t < queryTerms.size(); ++t) {
+                if (counts->tf[t] > 0) {
+                    out[i] += bm25TermScore(counts->tf[t], (*docLengths)[row], idf[t], averageLength);
+                }
+            }
+        }
+    }
+
+    Column result = Column::ofDoubles(std::move(out));
+    for (size_t i = 0; i < rows; ++i) {
+        if (!column.isValid(rowAt(i))) result.setValid(i, false);
+    }
+    return result;
+}
@@ -0,0 +1,316 @@
+#include "distinct_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "bloom_filter.h"
+#include "hyperloglog.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <memory>
+
+// The createLogicalNode<DistinctParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> DistinctLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    keySlots.clear();
+    outputSchema = Schema{};
+    streaming = false;
+
+    Schema output;
+    for (size_t i = 0; i < params.keys.size(); ++i) {
+        const std::string& name = params.keys[i];
+        SymbolId id = i < params.keyIds.size() ? params.keyIds[i] : symbols.find(name).value_or(kInvalidSymbol);
+        auto slot = input.slotOf(id, name);
+        if (!slot) {
+            keySlots.clear();
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0, static_cast<uint32_t>(name.size())});
+        }
+        if (!isKeyType(input.fields[*slot].type)) {
+            keySlots.clear();
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0, static_cast<uint32_t>(name.size())});
+        }
+        keySlots.push_back(*slot);
+        output.fields.push_back(input.fields[*slot]);
+    }
+
+    if (approximate()) {
+        SymbolId id = params.approxCountNameId != kInvalidSymbol
+                          ? params.approxCountNameId
+                          : symbols.find(params.approxCountName).value_or(kInvalidSymbol);
+        output.fields = {Field{params.approxCountName, id, PhysicalType::Int64}};
+    } else {
+        // NaNs do not sort consistently, so a sorted Double key may still
+        // have equal values apart
+        streaming = sortedInput && std::none_of(output.fields.begin(), output.fields.end(), [](const Field& f) {
+                        return f.type == PhysicalType::Double;
+                    });
+    }
+    outputSchema = output;
+    return output;
+}
+
+namespace {
+
+constexpr uint64_t kNullHash = 0x6e756c6c6e756c6cULL;
+// A hash table entry plus its two slots at the maximum load factor
+constexpr size_t kHashBytesPerKey = 16 + 2 * sizeof(uint32_t);
+
+// MurmurHash3 fmix64
+inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// One key column with its null-aware equality (NaN equals NaN)
+struct KeyColumn {
+    const Column* column;
+    bool (*equal)(const Column&, uint32_t, uint32_t);
+};
+
+template <typename T>
+bool equalValues(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    return !valid || column.values<T>()[lhs] == column.values<T>()[rhs];
+}
+
+bool equalDoubles(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    double a = column.doubles[lhs];
+    double b = column.doubles[rhs];
+    return !valid || a == b || (a != a && b != b);
+}
+
+bool equalCodes(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    return !valid || column.codes[lhs] == column.codes[rhs];
+}
+
+auto equalityFor(const Column& column) -> bool (*)(const Column&, uint32_t, uint32_t) {
+    if (column.isDictionary()) {
+        return &equalCodes;
+    }
+    switch (column.type) {
+        case PhysicalType::Bool: return &equalValues<uint8_t>;
+        case PhysicalType::Int64: return &equalValues<int64_t>;
+        case PhysicalType::Double: return &equalDoubles;
+        case PhysicalType::String: return &equalValues<std::string>;
+        case PhysicalType::Vector: break;  // Rejected by bind()
+    }
+    return nullptr;
+}
+
+bool rowsEqual(const std::vector<KeyColumn>& keys, uint32_t lhs, uint32_t rhs) {
+    for (const auto& key : keys) {
+        if (!key.equal(*key.column, lhs, rhs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Combined hash of every row's key; `anyNull` marks rows with a null key
+void hashKeys(const Batch& batch, const std::vector<uint32_t>& slots, std::vector<uint64_t>& hashes,
+              std::vector<uint8_t>& anyNull) {
+    size_t rows = batch.rowCount();
+    hashes.assign(rows, 0);
+    anyNull.assign(rows, 0);
+    std::vector<uint64_t> columnHashes;
+    for (uint32_t slot : slots) {
+        const Column& column = batch.columns[slot];
+        hashKeyValues(column, columnHashes);
+        for (size_t r = 0; r < rows; ++r) {
+            bool valid = column.isValid(r);
+            uint64_t v = valid ? columnHashes[r] : kNullHash;
+            hashes[r] = (std::rotl(hashes[r], 23) ^ v) * 0x9e3779b97f4a7c15ULL;
+            anyNull[r] |= static_cast<uint8_t>(!valid);
+        }
+    }
+    for (auto& h : hashes) {
+        h = mix(h);
+    }
+}
+
+// First row of each distinct key, in row order, via an open-addressing
+// (linear probing) table presized for the estimate
+std::vector<uint32_t> dedupByHash(const std::vector<KeyColumn>& keys, const std::vector<uint64_t>& hashes,
+                                  size_t estimate) {
+    struct Entry {
+        uint64_t hash;
+        uint32_t row;
+    };
+    std::vector<Entry> entries;
+    std::vector<uint32_t> slots(std::bit_ceil(std::max<size_t>(64, estimate * 2)), 0);  // Entry + 1
+    auto grow = [&] {
+        slots.assign(slots.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t e = 0; e < entries.size(); ++e) {
+            size_t i = entries[e].hash & mask;
+            while (slots[i] != 0) i = (i + 1) & mask;
+            slots[i] = e + 1;
+        }
+    };
+    entries.reserve(estimate);
+    for (uint32_t r = 0; r < hashes.size(); ++r) {
+        uint64_t hash = hashes[r];
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            uint32_t slot = slots[i];
+            if (slot == 0) {
+                entries.push_back(Entry{hash, r});
+                slots[i] = static_cast<uint32_t>(entries.size());
+                if (entries.size() * 2 > slots.size()) {
+                    grow();
+                }
+                break;
+            }
+            const Entry& candidate = entries[slot - 1];
+            if (candidate.hash == hash && rowsEqual(keys, candidate.row, r)) {
+                break;
+            }
+        }
+    }
+    std::vector<uint32_t> firstRows;
+    firstRows.reserve(entries.size());
+    for (const auto& entry : entries) {
+        firstRows.push_back(entry.row);
+    }
+    return firstRows;
+}
+
+// First row of each distinct key, in row order. Rows are radix-sorted by
+// hash (stable, 16 bits per pass), so equal keys end up in one run of
+// equal hashes with their first occurrence leading; only rows within a
+// run are compared.
+std::vector<uint32_t> dedupBySort(const std::vector<KeyColumn>& keys, const std::vector<uint64_t>& hashes) {
+    std::vector<uint32_t> order(hashes.size());
+    std::vector<uint32_t> scratch(hashes.size());
+    for (uint32_t r = 0; r < order.size(); ++r) order[r] = r;
+    std::vector<size_t> counts(65537);
+    for (unsigned shift = 0; shift < 64; shift += 16) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (uint32_t row : order) {
+            ++counts[((hashes[row] >> shift) & 0xffff) + 1];
+        }
+        for (size_t d = 1; d < counts.size(); ++d) {
+            counts[d] += counts[d - 1];
+        }
+        for (uint32_t row : order) {
+            scratch[counts[(hashes[row] >> shift) & 0xffff]++] = row;
+        }
+        order.swap(scratch);
+    }
+
+    std::vector<uint32_t> firstRows;
+    std::vector<uint32_t> runFirsts;  // Distinct keys of the current run (hash collisions)
+    for (size_t begin = 0; begin < order.size();) {
+        size_t end = begin + 1;
+        while (end < order.size() && hashes[order[end]] == hashes[order[begin]]) ++end;
+        runFirsts.assign(1, order[begin]);
+        for (size_t i = begin + 1; i < end; ++i) {
+            uint32_t row = order[i];
+            if (std::none_of(runFirsts.begin(), runFirsts.end(),
+                             [&](uint32_t first) { return rowsEqual(keys, first, row); })) {
+                runFirsts.push_back(row);
+            }
+        }
+        firstRows.insert(firstRows.end(), runFirsts.begin(), runFirsts.end());
+        begin = end;
+    }
+    std::sort(firstRows.begin(), firstRows.end());
+    return firstRows;
+}
+
+} // namespace
+
+void DistinctLogicalNode::execute(Batch& batch) const {
+    size_t rows = batch.rowCount();
+
+    if (approximate()) {
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> anyNull;
+        hashKeys(batch, keySlots, hashes, anyNull);
+        HyperLogLog sketch;
+        for (size_t r = 0; r < rows; ++r) {
+            if (!anyNull[r]) {
+                sketch.insert(hashes[r]);
+            }
+        }
+        auto estimate = static_cast<int64_t>(std::llround(sketch.estimate()));
+        lastStrategy.store(static_cast<uint8_t>(DistinctStrategy::Sketch));
+        lastEstimate.store(static_cast<uint64_t>(estimate));
+        lastRowsOutput.store(1);
+        executed.store(true);
+        batch.schema = outputSchema;
+        batch.columns.clear();
+        batch.columns.push_back(Column::ofInts({estimate}));
+        return;
+    }
+
+    // Packed keys are compared through plain copies
+    std::vector<Column> unpacked;
+    unpacked.reserve(keySlots.size());
+    std::vector<KeyColumn> keys;
+    for (uint32_t slot : keySlots) {
+        const Column* column = &batch.columns[slot];
+        if (column->isPacked()) {
+            unpacked.push_back(column->decoded());
+            column = &unpacked.back();
+        }
+        keys.push_back(KeyColumn{column, equalityFor(*column)});
+    }
+
+    std::vector<uint32_t> firstRows;
+    DistinctStrategy strategy = DistinctStrategy::Streaming;
+    uint64_t estimate = 0;
+    if (streaming) {
+        for (uint32_t r = 0; r < rows; ++r) {
+            if (r == 0 || !rowsEqual(keys, r - 1, r)) {
+                firstRows.push_back(r);
+            }
+        }
+    } else {
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> anyNull;
+        hashKeys(batch, keySlots, hashes, anyNull);
+        HyperLogLog sketch;
+        for (uint64_t hash : hashes) {
+            sketch.insert(hash);
+        }
+        estimate = static_cast<uint64_t>(std::llround(sketch.estimate()));
+        if (estimate * kHashBytesPerKey <= hashTableBudget) {
+            strategy = DistinctStrategy::Hash;
+            firstRows = dedupByHash(keys, hashes, std::min<size_t>(estimate, rows));
+        } else {
+            strategy = DistinctStrategy::Sort;
+            firstRows = dedupBySort(keys, hashes);
+        }
+    }
+    lastStrategy.store(static_cast<uint8_t>(strategy));
+    lastEstimate.store(estimate);
+    lastRowsOutput.store(firstRows.size());
+    executed.store(true);
+
+    std::vector<Column> columns;
+    columns.reserve(keySlots.size());
+    for (uint32_t slot : keySlots) {
+        Column column = batch.columns[slot];
+        column.gather(firstRows);
+        columns.push_back(std::move(column));
+    }
+    batch.schema = outputSchema;
+    batch.columns = std::move(columns);
+}
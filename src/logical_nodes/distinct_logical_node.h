@@ -0,0 +1,100 @@
+#pragma once
+#include "logical_node.h"
+#include "distinct_params.h"
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <vector>
+
+enum class DistinctStrategy : uint8_t {
+    Streaming,  // Input already ordered on the keys: compare neighbours
+    Hash,       // Open-addressing table of the distinct keys
+    Sort,       // Radix sort of rows by key hash, then compare neighbours
+    Sketch,     // HyperLogLog estimate (approx_count)
+};
+
+inline const char* distinctStrategyName(DistinctStrategy strategy) {
+    switch (strategy) {
+        case DistinctStrategy::Streaming: return "Streaming";
+        case DistinctStrategy::Hash: return "Hash";
+        case DistinctStrategy::Sort: return "Sort";
+        case DistinctStrategy::Sketch: return "HyperLogLog";
+    }
+    return "?";
+}
+
+// Duplicate elimination on a set of keys. The output is the key fields,
+// one row per distinct key in order of first occurrence; nulls compare
+// equal to each other, as do NaNs. The strategy is picked per batch:
+//  - When markSortedInputs() found that an upstream sort already groups
+//    equal keys together, rows are compared with their predecessor only.
+//  - Otherwise every row's key is hashed and the number of distinct keys
+//    estimated with a HyperLogLog sketch. If the hash table for that many
+//    keys fits in hashTableBudget the keys are hashed into one; if not,
+//    rows are radix-sorted by hash instead, which needs no table and only
+//    makes sequential passes.
+// With an approx_count output the stage returns a single row holding the
+// sketch's estimate; rows with a null key are not counted.
+struct DistinctLogicalNode : public LogicalNode {
+    DistinctParams params;
+    bool sortedInput = false;  // Set by markSortedInputs()
+
+    std::vector<uint32_t> keySlots;  // Filled by bind()
+    Schema outputSchema;             // Filled by bind()
+    bool streaming = false;          // Filled by bind(): sortedInput, and no key is a Double
+
+    size_t hashTableBudget = size_t{32} << 20;  // Bytes of hash table before sorting instead
+
+    // Shape of the last execution, for explain() and tests
+    mutable std::atomic<uint8_t> lastStrategy{0};
+    mutable std::atomic<uint64_t> lastEstimate{0};  // Sketch estimate (0 when streaming)
+    mutable std::atomic<uint64_t> lastRowsOutput{0};
+    mutable std::atomic<bool> executed{false};
+
+    DistinctLogicalNode(const DistinctParams& params)
+        : params(params) {}
+
+    bool approximate() const {
+        return !params.approxCountName.empty();
+    }
+
+    std::string debugName() const override {
+        return "DistinctLogicalNode";
+    }
+
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Distinct\n"
+            << "  Keys: [";
+        for (size_t i = 0; i < params.keys.size(); ++i) {
+            if (i > 0) oss << ", ";
+            oss << params.keys[i];
+        }
+        oss << "]\n";
+        if (approximate()) {
+            oss << "  Output: " << params.approxCountName << " (approximate count)\n"
+                << "  Algorithm: HyperLogLog\n";
+        } else {
+            oss << "  Algorithm: " << (sortedInput ? "Streaming (sorted input)" : "Adaptive Hash/Sort") << "\n";
+        }
+        oss << "  Estimated Cost: " << (sortedInput ? 50 : 50 + params.keys.size() * 100) << " units";
+        if (executed.load()) {
+            oss << "\n  Last Execution: " << distinctStrategyName(static_cast<DistinctStrategy>(lastStrategy.load()))
+                << ", ~" << lastEstimate.load() << " distinct keys estimated, " << lastRowsOutput.load()
+                << " rows out";
+        }
+        return oss.str();
+    }
+
+    // Resolves the keys. The output schema is the key fields, or the
+    // approximate count alone.
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
+};
+
+// Specialize the create function for DistinctParams
+template<>
+inline std::unique_ptr<LogicalNode> createLogicalNode<DistinctParams>(const DistinctParams& params) {
+    return std::make_unique<DistinctLogicalNode>(params);
+}
@@ -0,0 +1,709 @@
+#include "group_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "expression_eval.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+// The createLogicalNode<GroupParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> GroupLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    keySlots.clear();
+    boundAggregates.clear();
+    outputSchema = Schema{};
+    auto fail = [this](Diagnostic diag) -> std::expected<Schema, Diagnostic> {
+        keySlots.clear();
+        boundAggregates.clear();
+        return std::unexpected(diag);
+    };
+
+    Schema output;
+    for (size_t i = 0; i < params.groupKeys.size(); ++i) {
+        const std::string& name = params.groupKeys[i];
+        SymbolId id = i < params.groupKeyIds.size() ? params.groupKeyIds[i]
+                                                    : symbols.find(name).value_or(kInvalidSymbol);
+        auto slot = input.slotOf(id, name);
+        if (!slot) {
+            return fail(Diagnostic{DiagnosticCode::UnknownField, 0, static_cast<uint32_t>(name.size())});
+        }
+        if (!isKeyType(input.fields[*slot].type)) {
+            return fail(Diagnostic{DiagnosticCode::TypeMismatch, 0, static_cast<uint32_t>(name.size())});
+        }
+        keySlots.push_back(*slot);
+        output.fields.push_back(input.fields[*slot]);
+    }
+
+    for (const auto& agg : params.aggregates) {
+        BoundAggregate bound;
+        bound.op = agg.op;
+        if (!agg.argument.empty()) {
+            auto parsed = parseExpression(agg.argument);
+            if (!parsed) {
+                return fail(parsed.error());
+            }
+            auto boundArg = bindExpression(*parsed, input, symbols);
+            if (!boundArg) {
+                return fail(boundArg.error());
+            }
+            bound.argument = *boundArg;
+        } else if (agg.op != AggregateOp::Count) {
+            return fail(Diagnostic{DiagnosticCode::EmptyExpression, 0, 0});
+        }
+
+        PhysicalType argType = bound.argument ? bound.argument->type : PhysicalType::Int64;
+        bool numeric = isNumeric(argType);
+        switch (agg.op) {
+            case AggregateOp::Count: bound.outputField.type = PhysicalType::Int64; numeric = true; break;
+            case AggregateOp::Sum: bound.outputField.type = argType; break;
+            case AggregateOp::Avg: bound.outputField.type = PhysicalType::Double; break;
+            case AggregateOp::Min:
+            case AggregateOp::Max: bound.outputField.type = argType; numeric = isKeyType(argType); break;
+        }
+        if (!numeric) {
+            return fail(Diagnostic{DiagnosticCode::TypeMismatch, 0,
+                                   static_cast<uint32_t>(agg.argument.size())});
+        }
+        bound.outputField.name = agg.name;
+        bound.outputField.id = agg.nameId != kInvalidSymbol
+                                   ? agg.nameId
+                                   : symbols.find(agg.name).value_or(kInvalidSymbol);
+        output.fields.push_back(bound.outputField);
+        boundAggregates.push_back(std::move(bound));
+    }
+    outputSchema = output;
+    return output;
+}
+
+namespace {
+
+constexpr uint32_t kNoRow = UINT32_MAX;
+constexpr size_t kMiniBatchRows = 1024;    // Rows probed before aggregates are updated
+constexpr size_t kMinRowsPerThread = 8192;
+constexpr uint32_t kMaxPartitions = 256;
+constexpr size_t kHashSampleRows = 1024;
+
+// Running state of one aggregate for one group. Plain data, so whole tables
+// can be spilled and reloaded with fwrite/fread.
+struct AggState {
+    int64_t i = 0;       // Integer sum
+    double d = 0;        // Double sum (sum of doubles, avg)
+    uint64_t count = 0;  // Non-null inputs seen
+    uint32_t row = kNoRow;  // Current min/max row
+};
+
+struct GroupEntry {
+    uint64_t hash;
+    uint32_t firstRow;  // Earliest row with this key; also the key's representative
+};
+
+// One group-by key column with its null-aware equality
+struct KeyColumn {
+    const Column* column;
+    bool (*equal)(const Column&, uint32_t, uint32_t);
+};
+
+// An aggregate's evaluated argument and the kernels picked for its type
+struct AggregateInput {
+    AggregateOp op = AggregateOp::Count;
+    PhysicalType type = PhysicalType::Int64;
+    const Column* argument = nullptr;  // Null for count()
+    bool (*less)(const Column&, uint32_t, uint32_t) = nullptr;
+};
+
+template <typename T>
+bool equalValues(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    return !valid || column.values<T>()[lhs] == column.values<T>()[rhs];
+}
+
+bool equalDoubles(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    double a = column.doubles[lhs];
+    double b = column.doubles[rhs];
+    // NaNs form one group, like nulls
+    return !valid || a == b || (a != a && b != b);
+}
+
+bool equalCodes(const Column& column, uint32_t lhs, uint32_t rhs) {
+    bool valid = column.isValid(lhs);
+    if (valid != column.isValid(rhs)) {
+        return false;
+    }
+    return !valid || column.codes[lhs] == column.codes[rhs];
+}
+
+template <typename T>
+bool lessValues(const Column& column, uint32_t lhs, uint32_t rhs) {
+    return column.values<T>()[lhs] < column.values<T>()[rhs];
+}
+
+auto equalityFor(const Column& column) -> bool (*)(const Column&, uint32_t, uint32_t) {
+    if (column.isDictionary()) {
+        return &equalCodes;
+    }
+    switch (column.type) {
+        case PhysicalType::Bool: return &equalValues<uint8_t>;
+        case PhysicalType::Int64: return &equalValues<int64_t>;
+        case PhysicalType::Double: return &equalDoubles;
+        case PhysicalType::String: return &equalValues<std::string>;
+        case PhysicalType::Vector: break;  // Rejected by bind()
+    }
+    return nullptr;
+}
+
+auto lessFor(PhysicalType type) -> bool (*)(const Column&, uint32_t, uint32_t) {
+    switch (type) {
+        case PhysicalType::Bool: return &lessValues<uint8_t>;
+        case PhysicalType::Int64: return &lessValues<int64_t>;
+        case PhysicalType::Double: return &lessValues<double>;
+        case PhysicalType::String: return &lessValues<std::string>;
+        case PhysicalType::Vector: break;  // Rejected by bind()
+    }
+    return nullptr;
+}
+
+inline uint64_t combineHash(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Final avalanche (MurmurHash3 fmix64), so both the top bits (partition) and
+// the low bits (table slot) are well mixed
+inline uint64_t finalizeHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+constexpr uint64_t kNullHash = 0x6e756c6c6e756c6cULL;
+
+template <typename T, typename ValueHash>
+void hashValues(const Column& column, const std::vector<T>& values, std::vector<uint64_t>& hashes,
+                ValueHash valueHash) {
+    for (size_t r = 0; r < hashes.size(); ++r) {
+        uint64_t v = column.isValid(r) ? valueHash(values[r]) : kNullHash;
+        hashes[r] = combineHash(hashes[r], v);
+    }
+}
+
+// Mixes one key column into every row's hash, one typed pass per column
+void hashKeyColumn(const Column& column, std::vector<uint64_t>& hashes) {
+    auto identity = [](auto v) { return static_cast<uint64_t>(v); };
+    if (column.isDictionary()) {
+        hashValues(column, column.codes, hashes, identity);
+        return;
+    }
+    switch (column.type) {
+        case PhysicalType::Bool: hashValues(column, column.bools, hashes, identity); break;
+        case PhysicalType::Int64: hashValues(column, column.ints, hashes, identity); break;
+        case PhysicalType::Double:
+            hashValues(column, column.doubles, hashes, [](double v) {
+                if (v != v) return uint64_t{0x7ff8000000000000ULL};  // One hash for all NaNs
+                return std::bit_cast<uint64_t>(v == 0 ? 0.0 : v);     // -0.0 groups with 0.0
+            });
+            break;
+        case PhysicalType::String:
+            hashValues(column, column.strings, hashes,
+                       [](const std::string& v) { return uint64_t{std::hash<std::string>{}(v)}; });
+            break;
+        case PhysicalType::Vector:
+            break;  // Rejected by bind()
+    }
+}
+
+// Open-addressing (linear probing) table of groups; slots hold entry
+// indices so growing only rehashes 4-byte slots
+struct GroupTable {
+    size_t aggregateCount = 0;
+    std::vector<uint32_t> slots;  // Entry index + 1; 0 marks an empty slot
+    std::vector<GroupEntry> entries;
+    std::vector<AggState> states;  // aggregateCount per entry
+
+    explicit GroupTable(size_t aggregateCount) : aggregateCount(aggregateCount), slots(64, 0) {}
+
+    AggState* statesOf(uint32_t entry) { return states.data() + entry * aggregateCount; }
+
+    // Bytes of group state held (the slot array is not spilled)
+    size_t stateBytes() const {
+        return entries.size() * (sizeof(GroupEntry) + aggregateCount * sizeof(AggState));
+    }
+
+    // Index of the group whose key equals `row`'s, inserting it if new
+    template <typename Equal>
+    uint32_t findOrInsert(uint64_t hash, uint32_t row, const Equal& equal) {
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            uint32_t slot = slots[i];
+            if (slot == 0) {
+                auto entry = static_cast<uint32_t>(entries.size());
+                entries.push_back(GroupEntry{hash, row});
+                states.resize(states.size() + aggregateCount);
+                slots[i] = entry + 1;
+                if (entries.size() * 2 > slots.size()) {
+                    grow();
+                }
+                return entry;
+            }
+            const GroupEntry& candidate = entries[slot - 1];
+            if (candidate.hash == hash && equal(candidate.firstRow, row)) {
+                return slot - 1;
+            }
+        }
+    }
+
+    void grow() {
+        slots.assign(slots.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t e = 0; e < entries.size(); ++e) {
+            size_t i = entries[e].hash & mask;
+            while (slots[i] != 0) i = (i + 1) & mask;
+            slots[i] = e + 1;
+        }
+    }
+
+    void clear() {
+        entries.clear();
+        states.clear();
+        std::fill(slots.begin(), slots.end(), 0);
+    }
+};
+
+// A table flushed to a temporary file: its entries, then its states
+struct SpillRun {
+    std::unique_ptr<FILE, int (*)(FILE*)> file{nullptr, &std::fclose};
+    size_t entries = 0;
+};
+
+// Writes the table out and clears it once the data is flushed; on any I/O
+// failure the table is left in memory
+bool spillTable(GroupTable& table, std::vector<SpillRun>& runs) {
+    SpillRun run;
+    run.file.reset(std::tmpfile());
+    if (!run.file) {
+        return false;
+    }
+    run.entries = table.entries.size();
+    if (std::fwrite(table.entries.data(), sizeof(GroupEntry), run.entries, run.file.get()) != run.entries ||
+        std::fwrite(table.states.data(), sizeof(AggState), table.states.size(), run.file.get()) !=
+            table.states.size() ||
+        std::fflush(run.file.get()) != 0 || std::ferror(run.file.get())) {
+        return false;
+    }
+    runs.push_back(std::move(run));
+    table.clear();
+    return true;
+}
+
+struct GroupRef {
+    uint32_t partition;
+    uint32_t entry;
+};
+
+// Thread-local tables, one per radix partition
+struct WorkerState {
+    std::vector<GroupTable> partitions;
+    std::vector<std::vector<SpillRun>> spills;  // Per partition
+    uint32_t spillCount = 0;
+};
+
+// Applies update(state, row) for each non-null argument row of [begin, end)
+template <typename Update>
+void forValidRows(const AggregateInput& input, size_t aggregate, size_t begin, size_t end,
+                  const GroupRef* refs, std::vector<GroupTable>& tables, Update update) {
+    for (size_t r = begin; r < end; ++r) {
+        if (input.argument && !input.argument->isValid(r)) {
+            continue;
+        }
+        const GroupRef& ref = refs[r - begin];
+        update(tables[ref.partition].statesOf(ref.entry)[aggregate], static_cast<uint32_t>(r));
+    }
+}
+
+// Folds rows [begin, end) into their groups' states for one aggregate. The
+// op and type are resolved once per call, outside the row loop.
+void accumulate(const AggregateInput& input, size_t aggregate, size_t begin, size_t end,
+                const GroupRef* refs, std::vector<GroupTable>& tables) {
+    auto run = [&](auto update) { forValidRows(input, aggregate, begin, end, refs, tables, update); };
+    const Column* arg = input.argument;
+    switch (input.op) {
+        case AggregateOp::Count:
+            run([](AggState& s, uint32_t) { ++s.count; });
+            break;
+        case AggregateOp::Sum:
+        case AggregateOp::Avg:
+            if (input.type == PhysicalType::Int64 && input.op == AggregateOp::Sum) {
+                const auto& values = arg->ints;
+                run([&values](AggState& s, uint32_t r) {
+                    // Wrapping add: overflow is not undefined behaviour
+                    s.i = static_cast<int64_t>(static_cast<uint64_t>(s.i) + static_cast<uint64_t>(values[r]));
+                    ++s.count;
+                });
+            } else if (input.type == PhysicalType::Int64) {
+                const auto& values = arg->ints;
+                run([&values](AggState& s, uint32_t r) {
+                    s.d += static_cast<double>(values[r]);
+                    ++s.count;
+                });
+            } else {
+                const auto& values = arg->doubles;
+                run([&values](AggState& s, uint32_t r) {
+                    s.d += values[r];
+                    ++s.count;
+                });
+            }
+            break;
+        case AggregateOp::Min:
+        case AggregateOp::Max: {
+            auto less = input.less;
+            bool min = input.op == AggregateOp::Min;
+            run([arg, less, min](AggState& s, uint32_t r) {
+                if (s.row == kNoRow || (min ? less(*arg, r, s.row) : less(*arg, s.row, r))) {
+                    s.row = r;
+                }
+                ++s.count;
+            });
+            break;
+        }
+    }
+}
+
+void mergeState(const AggregateInput& input, AggState& dst, const AggState& src) {
+    dst.i = static_cast<int64_t>(static_cast<uint64_t>(dst.i) + static_cast<uint64_t>(src.i));
+    dst.d += src.d;
+    dst.count += src.count;
+    if (src.row != kNoRow &&
+        (dst.row == kNoRow ||
+         (input.op == AggregateOp::Min ? input.less(*input.argument, src.row, dst.row)
+                                       : input.less(*input.argument, dst.row, src.row)))) {
+        dst.row = src.row;
+    }
+}
+
+template <typename Equal>
+void mergeEntries(GroupTable& dst, const GroupEntry* entries, const AggState* states, size_t count,
+                  const std::vector<AggregateInput>& inputs, const Equal& equal) {
+    for (size_t e = 0; e < count; ++e) {
+        uint32_t index = dst.findOrInsert(entries[e].hash, entries[e].firstRow, equal);
+        GroupEntry& entry = dst.entries[index];
+        entry.firstRow = std::min(entry.firstRow, entries[e].firstRow);
+        AggState* target = dst.statesOf(index);
+        for (size_t a = 0; a < inputs.size(); ++a) {
+            mergeState(inputs[a], target[a], states[e * inputs.size() + a]);
+        }
+    }
+}
+
+size_t l2CacheBytes() {
+    static const size_t bytes = [] {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0) {
+            return static_cast<size_t>(size);
+        }
+#endif
+        return size_t{1} << 20;
+    }();
+    return bytes;
+}
+
+// Rough distinct-key count from a strided sample of row hashes. A sample
+// with many repeats means the key domain is already saturated.
+size_t estimateGroups(const std::vector<uint64_t>& hashes) {
+    size_t rows = hashes.size();
+    size_t sampleSize = std::min(rows, kHashSampleRows);
+    if (sampleSize == 0) {
+        return 0;
+    }
+    std::vector<uint64_t> sample;
+    sample.reserve(sampleSize);
+    for (size_t i = 0; i < sampleSize; ++i) {
+        sample.push_back(hashes[i * rows / sampleSize]);
+    }
+    std::sort(sample.begin(), sample.end());
+    size_t distinct = std::unique(sample.begin(), sample.end()) - sample.begin();
+    if (distinct * 2 < sampleSize) {
+        return distinct;
+    }
+    return distinct * rows / sampleSize;
+}
+
+template <typename T>
+Column pickRows(const Column& argument, PhysicalType type, const std::vector<const AggState*>& groups,
+                size_t aggregate) {
+    Column out;
+    out.type = type;
+    auto& values = out.values<T>();
+    values.resize(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        uint32_t row = groups[g][aggregate].row;
+        if (row == kNoRow) {
+            out.setValid(g, false);
+        } else {
+            values[g] = argument.values<T>()[row];
+        }
+    }
+    return out;
+}
+
+// Builds one aggregate's output column from the final group states
+Column finishAggregate(const AggregateInput& input, const std::vector<const AggState*>& groups,
+                       size_t aggregate) {
+    size_t count = groups.size();
+    Column out;
+    switch (input.op) {
+        case AggregateOp::Count: {
+            std::vector<int64_t> counts(count);
+            for (size_t g = 0; g < count; ++g) counts[g] = static_cast<int64_t>(groups[g][aggregate].count);
+            return Column::ofInts(std::move(counts));
+        }
+        case AggregateOp::Sum:
+            if (input.type == PhysicalType::Int64) {
+                std::vector<int64_t> sums(count);
+                for (size_t g = 0; g < count; ++g) sums[g] = groups[g][aggregate].i;
+                out = Column::ofInts(std::move(sums));
+            } else {
+                std::vector<double> sums(count);
+                for (size_t g = 0; g < count; ++g) sums[g] = groups[g][aggregate].d;
+                out = Column::ofDoubles(std::move(sums));
+            }
+            break;
+        case AggregateOp::Avg: {
+            std::vector<double> averages(count);
+            for (size_t g = 0; g < count; ++g) {
+                const AggState& s = groups[g][aggregate];
+                averages[g] = s.count ? s.d / static_cast<double>(s.count) : 0.0;
+            }
+            out = Column::ofDoubles(std::move(averages));
+            break;
+        }
+        case AggregateOp::Min:
+        case AggregateOp::Max:
+            switch (input.type) {
+                case PhysicalType::Bool: return pickRows<uint8_t>(*input.argument, input.type, groups, aggregate);
+                case PhysicalType::Int64: return pickRows<int64_t>(*input.argument, input.type, groups, aggregate);
+                case PhysicalType::Double: return pickRows<double>(*input.argument, input.type, groups, aggregate);
+                case PhysicalType::String:
+                    return pickRows<std::string>(*input.argument, input.type, groups, aggregate);
+                case PhysicalType::Vector:
+                    break;  // Rejected by bind()
+            }
+            break;
+    }
+    // Sum and avg of no inputs are null
+    for (size_t g = 0; g < count; ++g) {
+        if (groups[g][aggregate].count == 0) {
+            out.setValid(g, false);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+void GroupLogicalNode::execute(Batch& batch) const {
+    size_t rows = batch.rowCount();
+    size_t aggregateCount = boundAggregates.size();
+
+    // Key columns: dictionary columns are compared by code, packed ones are
+    // expanded once up front
+    std::vector<Column> decodedStore;
+    decodedStore.reserve(keySlots.size() + aggregateCount);
+    std::vector<KeyColumn> keys;
+    for (uint32_t slot : keySlots) {
+        const Column* column = &batch.columns[slot];
+        if (column->isPacked()) {
+            decodedStore.push_back(column->decoded());
+            column = &decodedStore.back();
+        }
+        keys.push_back(KeyColumn{column, equalityFor(*column)});
+    }
+    auto equal = [&keys](uint32_t lhs, uint32_t rhs) {
+        for (const auto& key : keys) {
+            if (!key.equal(*key.column, lhs, rhs)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<AggregateInput> inputs;
+    for (const auto& agg : boundAggregates) {
+        AggregateInput input;
+        input.op = agg.op;
+        if (agg.argument) {
+            Column argument = evaluateExpression(*agg.argument, batch);
+            decodedStore.push_back(argument.isDictionary() || argument.isPacked() ? argument.decoded()
+                                                                                 : std::move(argument));
+            input.argument = &decodedStore.back();
+            input.type = agg.argument->type;
+            input.less = lessFor(input.type);
+        }
+        inputs.push_back(input);
+    }
+
+    std::vector<uint64_t> hashes(rows, 0);
+    for (const auto& key : keys) {
+        hashKeyColumn(*key.column, hashes);
+    }
+    for (auto& h : hashes) {
+        h = finalizeHash(h);
+    }
+
+    // Threads and partitions: enough partitions that one thread's share of
+    // the expected groups fits in L2
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t threadLimit = maxThreads ? maxThreads : hardware;
+    auto threads = static_cast<uint32_t>(
+        std::clamp<size_t>(rows / kMinRowsPerThread, 1, threadLimit));
+    size_t rowsPerThread = (rows + threads - 1) / threads;
+    size_t entryBytes = sizeof(GroupEntry) + aggregateCount * sizeof(AggState) + 2 * sizeof(uint32_t);
+    size_t tableBytes = std::min(estimateGroups(hashes), rowsPerThread) * entryBytes;
+    auto partitions = static_cast<uint32_t>(std::min<size_t>(
+        std::bit_ceil((tableBytes + l2CacheBytes() - 1) / l2CacheBytes()), kMaxPartitions));
+    partitions = std::max(partitions, 1u);
+    int partitionShift = 64 - std::countr_zero(partitions);
+    auto partitionOf = [partitions, partitionShift](uint64_t hash) {
+        return partitions == 1 ? 0u : static_cast<uint32_t>(hash >> partitionShift);
+    };
+    size_t tableBudget = std::max<size_t>(memoryBudget / (size_t{threads} * partitions), 1);
+
+    // Phase 1: thread-local pre-aggregation
+    std::vector<WorkerState> workers(threads);
+    auto aggregateRange = [&](uint32_t worker, size_t begin, size_t end) {
+        WorkerState& state = workers[worker];
+        state.partitions.assign(partitions, GroupTable(aggregateCount));
+        state.spills.resize(partitions);
+        std::vector<GroupRef> refs(kMiniBatchRows);
+        for (size_t chunk = begin; chunk < end; chunk += kMiniBatchRows) {
+            size_t chunkEnd = std::min(end, chunk + kMiniBatchRows);
+            for (size_t r = chunk; r < chunkEnd; ++r) {
+                uint32_t p = partitionOf(hashes[r]);
+                refs[r - chunk] = GroupRef{p, state.partitions[p].findOrInsert(
+                                                  hashes[r], static_cast<uint32_t>(r), equal)};
+            }
+            for (size_t a = 0; a < aggregateCount; ++a) {
+                accumulate(inputs[a], a, chunk, chunkEnd, refs.data(), state.partitions);
+            }
+            for (uint32_t p = 0; p < partitions; ++p) {
+                if (state.partitions[p].stateBytes() > tableBudget &&
+                    spillTable(state.partitions[p], state.spills[p])) {
+                    ++state.spillCount;
+                }
+            }
+        }
+    };
+    {
+        std::vector<std::thread> pool;
+        for (uint32_t t = 1; t < threads; ++t) {
+            pool.emplace_back(aggregateRange, t, std::min(rows, t * rowsPerThread),
+                              std::min(rows, (t + 1) * rowsPerThread));
+        }
+        aggregateRange(0, 0, std::min(rows, rowsPerThread));
+        for (auto& thread : pool) thread.join();
+    }
+
+    // Phase 2: merge each partition across threads (and its spill runs)
+    std::vector<GroupTable> merged(partitions, GroupTable(aggregateCount));
+    std::atomic<uint32_t> nextPartition{0};
+    std::atomic<bool> spillLost{false};
+    auto mergePartitions = [&]() {
+        for (uint32_t p = nextPartition++; p < partitions && !spillLost; p = nextPartition++) {
+            GroupTable& target = merged[p];
+            for (auto& worker : workers) {
+                std::vector<GroupEntry> entries;
+                std::vector<AggState> states;
+                for (auto& run : worker.spills[p]) {
+                    entries.resize(run.entries);
+                    states.resize(run.entries * aggregateCount);
+                    std::rewind(run.file.get());
+                    if (std::fread(entries.data(), sizeof(GroupEntry), entries.size(), run.file.get()) !=
+                            entries.size() ||
+                        std::fread(states.data(), sizeof(AggState), states.size(), run.file.get()) !=
+                            states.size()) {
+                        spillLost = true;  // Its groups are gone; a partial result would be wrong
+                        return;
+                    }
+                    mergeEntries(target, entries.data(), states.data(), entries.size(), inputs, equal);
+                }
+                worker.spills[p].clear();
+                GroupTable& local = worker.partitions[p];
+                if (target.entries.empty()) {
+                    std::swap(target, local);
+                } else {
+                    mergeEntries(target, local.entries.data(), local.states.data(), local.entries.size(),
+                                 inputs, equal);
+                }
+            }
+        }
+    };
+    {
+        std::vector<std::thread> pool;
+        for (uint32_t t = 1; t < std::min(threads, partitions); ++t) {
+            pool.emplace_back(mergePartitions);
+        }
+        mergePartitions();
+        for (auto& thread : pool) thread.join();
+    }
+    if (spillLost) {
+        throw std::runtime_error("group: could not read back a spilled partition");
+    }
+
+    // Groups in first-seen order
+    std::vector<std::pair<uint32_t, const AggState*>> order;
+    for (auto& table : merged) {
+        for (uint32_t e = 0; e < table.entries.size(); ++e) {
+            order.emplace_back(table.entries[e].firstRow, table.statesOf(e));
+        }
+    }
+    std::sort(order.begin(), order.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    // A global aggregate over no rows still produces its one row
+    std::vector<AggState> emptyStates;
+    if (keySlots.empty() && order.empty()) {
+        emptyStates.resize(aggregateCount);
+        order.emplace_back(0, emptyStates.data());
+    }
+
+    SelectionVector firstRows;
+    std::vector<const AggState*> groups;
+    firstRows.reserve(order.size());
+    groups.reserve(order.size());
+    for (const auto& [row, states] : order) {
+        firstRows.push_back(row);
+        groups.push_back(states);
+    }
+
+    std::vector<Column> columns;
+    for (uint32_t slot : keySlots) {
+        columns.push_back(batch.columns[slot].select(firstRows));
+    }
+    for (size_t a = 0; a < aggregateCount; ++a) {
+        columns.push_back(finishAggregate(inputs[a], groups, a));
+    }
+
+    uint32_t spills = 0;
+    for (const auto& worker : workers) spills += worker.spillCount;
+    lastThreads = threads;
+    lastPartitions = partitions;
+    lastSpills = spills;
+
+    batch.schema = outputSchema;
+    batch.columns = std::move(columns);
+}
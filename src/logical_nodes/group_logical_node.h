@@ -0,0 +1,90 @@
+#pragma once
+#include "logical_node.h"
+#include "group_params.h"
+#include "expression.h"
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <vector>
+
+// An aggregate resolved against the input schema
+struct BoundAggregate {
+    AggregateOp op = AggregateOp::Count;
+    ExprPtr argument;  // Bound argument; null for count()
+    Field outputField;
+};
+
+// Hash aggregation. Execution is two-phase:
+//  1. Worker threads each take a contiguous range of rows and pre-aggregate
+//     into thread-local tables, radix-partitioned on the top hash bits so
+//     that every partition's linear-probing table fits in L2.
+//  2. Partitions are merged across threads in parallel; each partition is
+//     owned by exactly one merger, so no locking is needed.
+// A thread-local partition whose state outgrows its share of memoryBudget
+// is spilled to a temporary file and folded back in during the merge; a
+// spill that cannot be read back fails the query with std::runtime_error.
+struct GroupLogicalNode : public LogicalNode {
+    GroupParams params;
+    std::vector<uint32_t> keySlots;             // Filled by bind()
+    std::vector<BoundAggregate> boundAggregates;  // Filled by bind()
+    Schema outputSchema;                         // Filled by bind()
+
+    size_t memoryBudget = size_t{256} << 20;  // Bytes of group state before spilling
+    uint32_t maxThreads = 0;                  // 0: one per hardware thread
+
+    // Shape of the last execution, for explain() and tests
+    mutable std::atomic<uint32_t> lastThreads{0};
+    mutable std::atomic<uint32_t> lastPartitions{0};
+    mutable std::atomic<uint32_t> lastSpills{0};
+
+    GroupLogicalNode(const GroupParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        return "GroupLogicalNode";
+    }
+    
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Group\n"
+            << "  Group Keys: [";
+        for (size_t i = 0; i < params.groupKeys.size(); ++i) {
+            if (i > 0) oss << ", ";
+            oss << params.groupKeys[i];
+        }
+        oss << "]\n"
+            << "  Aggregates: [";
+        for (size_t i = 0; i < params.aggregates.size(); ++i) {
+            const auto& agg = params.aggregates[i];
+            if (i > 0) oss << ", ";
+            oss << agg.name << ":" << aggregateOpName(agg.op) << "(" << agg.argument << ")";
+        }
+        oss << "]\n"
+            << "  Algorithm: Partitioned Hash Aggregation\n"
+            << "  Estimated Cost: " << ((params.groupKeys.size() + params.aggregates.size()) * 150)
+            << " units";
+        for (const auto& agg : boundAggregates) {
+            oss << "\n  Bound Aggregate: " << agg.outputField.name << " ("
+                << physicalTypeName(agg.outputField.type) << ")";
+        }
+        if (uint32_t threads = lastThreads.load()) {
+            oss << "\n  Last Execution: " << threads << " threads, " << lastPartitions.load()
+                << " partitions, " << lastSpills.load() << " spills";
+        }
+        return oss.str();
+    }
+
+    // Resolves the keys and binds every aggregate argument. The output schema
+    // is the key fields followed by one field per aggregate.
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    // Replaces the batch with one row per group, ordered by each group's
+    // first row in the input
+    void execute(Batch& batch) const override;
+};
+
+// Specialize the create function for GroupParams
+template<>
+inline std::unique_ptr<LogicalNode> createLogicalNode<GroupParams>(const GroupParams& params) {
+    return std::make_unique<GroupLogicalNode>(params);
+}
@@ -0,0 +1,338 @@
+#include "join_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "catalog.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <unistd.h>
+
+// The createLogicalNode<JoinParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+namespace {
+
+constexpr uint32_t kNoRow = UINT32_MAX;
+constexpr size_t kMinRowsPerThread = 8192;
+constexpr uint32_t kMaxPartitions = 256;
+
+size_t l2CacheBytes() {
+    static const size_t bytes = [] {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0) {
+            return static_cast<size_t>(size);
+        }
+#endif
+        return size_t{1} << 20;
+    }();
+    return bytes;
+}
+
+} // namespace
+
+// Chained hash table over the build rows. Every partition owns the rows
+// whose top hash bits select it; its buckets are indexed by the low bits.
+struct JoinHashTable {
+    // Owned, so the address cannot be reused by another table while it is compared
+    std::shared_ptr<const Batch> source;
+    uint64_t buildVersion = 0;  // Catalog::tableVersion() it was built from
+    size_t partitionBytes = 0;
+    Column key;                   // Plain copy of the build key
+    std::vector<uint64_t> hashes;  // Per build row
+    std::vector<uint32_t> next;    // Next build row in the same bucket, ascending
+    std::vector<std::vector<uint32_t>> heads;  // Per partition: first build row of each bucket
+    int partitionShift = 64;
+
+    uint32_t partitionOf(uint64_t hash) const {
+        return heads.size() == 1 ? 0u : static_cast<uint32_t>(hash >> partitionShift);
+    }
+    uint32_t firstRow(uint64_t hash) const {
+        const auto& buckets = heads[partitionOf(hash)];
+        return buckets[hash & (buckets.size() - 1)];
+    }
+};
+
+namespace {
+
+// Bytes of table per build row: its hash, chain link and bucket head
+constexpr size_t kBytesPerBuildRow = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+
+std::shared_ptr<const JoinHashTable> buildHashTable(std::shared_ptr<const Batch> source, uint64_t buildVersion,
+                                                    uint32_t slot, size_t partitionBytes, BlockedBloomFilter& bloom) {
+    auto table = std::make_shared<JoinHashTable>();
+    table->source = std::move(source);
+    table->buildVersion = buildVersion;
+    table->partitionBytes = partitionBytes;
+    const Column& column = table->source->columns[slot];
+    table->key = column.isDictionary() || column.isPacked() ? column.decoded() : column;
+    hashKeyValues(table->key, table->hashes);
+    size_t rows = table->hashes.size();
+
+    size_t keyed = 0;
+    for (size_t r = 0; r < rows; ++r) keyed += table->key.isValid(r);
+    size_t budget = std::max<size_t>(partitionBytes ? partitionBytes : l2CacheBytes(), 1);
+    auto partitions = static_cast<uint32_t>(std::clamp<size_t>(
+        std::bit_ceil((keyed * kBytesPerBuildRow + budget - 1) / budget), 1, kMaxPartitions));
+    table->partitionShift = 64 - std::countr_zero(partitions);
+    table->heads.resize(partitions);
+
+    std::vector<size_t> partitionRows(partitions, 0);
+    for (size_t r = 0; r < rows; ++r) {
+        if (table->key.isValid(r)) ++partitionRows[table->partitionOf(table->hashes[r])];
+    }
+    for (uint32_t p = 0; p < partitions; ++p) {
+        table->heads[p].assign(std::bit_ceil(std::max<size_t>(partitionRows[p] * 2, 2)), kNoRow);
+    }
+
+    // Inserting in reverse leaves every chain in ascending row order
+    bloom = BlockedBloomFilter::withCapacity(keyed);
+    table->next.assign(rows, kNoRow);
+    for (size_t r = rows; r-- > 0;) {
+        if (!table->key.isValid(r)) {
+            continue;
+        }
+        uint64_t hash = table->hashes[r];
+        auto& buckets = table->heads[table->partitionOf(hash)];
+        uint32_t& head = buckets[hash & (buckets.size() - 1)];
+        table->next[r] = head;
+        head = static_cast<uint32_t>(r);
+        bloom.insert(hash);
+    }
+    return table;
+}
+
+// Appends (probe row << 32 | build row) for every match of the given probe rows
+template <typename Equal>
+void probeRows(const JoinHashTable& table, const std::vector<uint64_t>& hashes, const uint32_t* rows, size_t n,
+               const Equal& equal, std::vector<uint64_t>& matches) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = rows[i];
+        uint64_t hash = hashes[r];
+        for (uint32_t b = table.firstRow(hash); b != kNoRow; b = table.next[b]) {
+            if (table.hashes[b] == hash && equal(r, b)) {
+                matches.push_back(uint64_t{r} << 32 | b);
+            }
+        }
+    }
+}
+
+// Calls fn with a typed (probe row, build row) key comparison
+template <typename Fn>
+void withKeyEquality(const Column& probe, const Column& build, Fn&& fn) {
+    if (probe.isDictionary()) {
+        const auto& dictionary = *probe.dictionary;
+        fn([&](uint32_t r, uint32_t b) { return dictionary[probe.codes[r]] == build.strings[b]; });
+        return;
+    }
+    switch (probe.type) {
+        case PhysicalType::Bool:
+            fn([&](uint32_t r, uint32_t b) { return probe.bools[r] == build.bools[b]; });
+            break;
+        case PhysicalType::Int64:
+            fn([&](uint32_t r, uint32_t b) { return probe.ints[r] == build.ints[b]; });
+            break;
+        case PhysicalType::Double:
+            fn([&](uint32_t r, uint32_t b) { return probe.doubles[r] == build.doubles[b]; });
+            break;
+        case PhysicalType::String:
+            fn([&](uint32_t r, uint32_t b) { return probe.strings[r] == build.strings[b]; });
+            break;
+        case PhysicalType::Vector:
+            break;  // Rejected by bind()
+    }
+}
+
+// Runs work(worker) on `workers` threads, the calling thread included
+template <typename Work>
+void runWorkers(uint32_t workers, const Work& work) {
+    std::vector<std::thread> pool;
+    for (uint32_t t = 1; t < workers; ++t) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : pool) thread.join();
+}
+
+} // namespace
+
+void JoinLogicalNode::attachCatalog(const Catalog& catalog) {
+    buildSide = catalog.findTable(params.table);
+    buildVersion = catalog.tableVersion(params.table);
+}
+
+uint32_t JoinLogicalNode::partitions() const {
+    return hashTable ? static_cast<uint32_t>(hashTable->heads.size()) : 0;
+}
+
+std::expected<Schema, Diagnostic> JoinLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    buildOutputSlots.clear();
+    outputSchema = Schema{};
+    if (!buildSide) {
+        return std::unexpected(Diagnostic{DiagnosticCode::UnknownTable, 0,
+                                          static_cast<uint32_t>(params.table.size())});
+    }
+    auto resolve = [&symbols](const Schema& schema, SymbolId id, const std::string& name) {
+        if (id == kInvalidSymbol) id = symbols.find(name).value_or(kInvalidSymbol);
+        return schema.slotOf(id, name);
+    };
+    auto probe = resolve(input, params.probeKeyId, params.probeKey);
+    if (!probe) {
+        return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0,
+                                          static_cast<uint32_t>(params.probeKey.size())});
+    }
+    const Schema& buildSchema = buildSide->schema;
+    auto build = resolve(buildSchema, params.buildKeyId, params.buildKey);
+    if (!build) {
+        return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0,
+                                          static_cast<uint32_t>(params.buildKey.size())});
+    }
+    PhysicalType keyType = input.fields[*probe].type;
+    if (buildSchema.fields[*build].type != keyType || !isKeyType(keyType)) {
+        return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0,
+                                          static_cast<uint32_t>(params.buildKey.size())});
+    }
+
+    Schema output = input;
+    std::vector<uint32_t> appended;
+    for (uint32_t c = 0; c < buildSchema.fields.size(); ++c) {
+        const Field& field = buildSchema.fields[c];
+        if (c == *build) {
+            continue;
+        }
+        if (input.slotOf(field.id, field.name)) {
+            return std::unexpected(Diagnostic{DiagnosticCode::DuplicateField, 0,
+                                              static_cast<uint32_t>(field.name.size())});
+        }
+        output.fields.push_back(field);
+        appended.push_back(c);
+    }
+
+    // The build side is immutable, so its table is only rebuilt when the
+    // table (its catalog version) or the partitioning changes
+    if (!hashTable || hashTable->buildVersion != buildVersion || hashTable->source != buildSide ||
+        hashTable->partitionBytes != partitionBytes || buildSlot != *build) {
+        runtimeFilter->published = false;
+        hashTable = buildHashTable(buildSide, buildVersion, *build, partitionBytes, runtimeFilter->bloom);
+    }
+    runtimeFilter->keyType = keyType;
+    runtimeFilter->published = true;
+
+    probeSlot = *probe;
+    buildSlot = *build;
+    buildOutputSlots = std::move(appended);
+    outputSchema = output;
+    return output;
+}
+
+void JoinLogicalNode::execute(Batch& batch) const {
+    const JoinHashTable& table = *hashTable;
+    const Column& probeColumn = batch.columns[probeSlot];
+    size_t rows = probeColumn.size();
+
+    // 1. Bloom filter
+    std::vector<uint64_t> hashes;
+    hashKeyValues(probeColumn, hashes);
+    SelectionVector candidates = runtimeFilter->select(probeColumn, hashes);
+    lastRowsFiltered = rows - candidates.size();
+
+    // 2. Probe, in parallel
+    Column unpacked;
+    const Column* key = &probeColumn;
+    if (key->isPacked()) {
+        unpacked = key->decoded();
+        key = &unpacked;
+    }
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t threadLimit = maxThreads ? maxThreads : hardware;
+    uint32_t partitionCount = partitions();
+    std::vector<uint64_t> matches;
+
+    withKeyEquality(*key, table.key, [&](const auto& equal) {
+        if (partitionCount == 1) {
+            // Contiguous ranges; concatenating them keeps the probe order
+            auto threads = static_cast<uint32_t>(
+                std::clamp<size_t>(candidates.size() / kMinRowsPerThread, 1, threadLimit));
+            size_t perThread = (candidates.size() + threads - 1) / threads;
+            std::vector<std::vector<uint64_t>> results(threads);
+            runWorkers(threads, [&](uint32_t t) {
+                size_t begin = std::min(candidates.size(), t * perThread);
+                size_t end = std::min(candidates.size(), begin + perThread);
+                probeRows(table, hashes, candidates.data() + begin, end - begin, equal, results[t]);
+            });
+            lastThreads = threads;
+            for (auto& result : results) matches.insert(matches.end(), result.begin(), result.end());
+            return;
+        }
+
+        // Scatter candidates by partition, so each worker probes one
+        // cache-sized table at a time
+        std::vector<std::vector<uint32_t>> partitionRows(partitionCount);
+        for (uint32_t r : candidates) partitionRows[table.partitionOf(hashes[r])].push_back(r);
+        auto threads = static_cast<uint32_t>(std::clamp<size_t>(
+            candidates.size() / kMinRowsPerThread, 1, std::min(threadLimit, partitionCount)));
+        std::vector<std::vector<uint64_t>> results(partitionCount);
+        std::atomic<uint32_t> nextPartition{0};
+        runWorkers(threads, [&](uint32_t) {
+            for (uint32_t p = nextPartition++; p < partitionCount; p = nextPartition++) {
+                probeRows(table, hashes, partitionRows[p].data(), partitionRows[p].size(), equal, results[p]);
+            }
+        });
+        lastThreads = threads;
+        for (auto& result : results) matches.insert(matches.end(), result.begin(), result.end());
+        // Back to probe order, then build order within a probe row
+        std::sort(matches.begin(), matches.end());
+    });
+    lastRowsOutput = matches.size();
+
+    SelectionVector probeRowsOut(matches.size());
+    SelectionVector buildRowsOut(matches.size());
+    bool identity = matches.size() == rows;
+    for (size_t i = 0; i < matches.size(); ++i) {
+        probeRowsOut[i] = static_cast<uint32_t>(matches[i] >> 32);
+        buildRowsOut[i] = static_cast<uint32_t>(matches[i]);
+        identity = identity && probeRowsOut[i] == i;
+    }
+
+    std::vector<Column> columns;
+    columns.reserve(outputSchema.fields.size());
+    for (auto& column : batch.columns) {
+        // Every probe row matched exactly once: the input columns stay as they are
+        columns.push_back(identity ? std::move(column) : column.select(probeRowsOut));
+    }
+    for (uint32_t slot : buildOutputSlots) {
+        columns.push_back(buildSide->columns[slot].select(buildRowsOut));
+    }
+    batch.schema = outputSchema;
+    batch.columns = std::move(columns);
+}
+
+std::expected<Schema, Diagnostic> RuntimeFilterLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    SymbolId id = keyId != kInvalidSymbol ? keyId : symbols.find(keyName).value_or(kInvalidSymbol);
+    auto slot = input.slotOf(id, keyName);
+    if (!slot) {
+        return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0,
+                                          static_cast<uint32_t>(keyName.size())});
+    }
+    keySlot = *slot;
+    return input;
+}
+
+void RuntimeFilterLogicalNode::execute(Batch& batch) const {
+    const Column& key = batch.columns[keySlot];
+    if (!filter || !filter->published || filter->keyType != key.type) {
+        return;
+    }
+    std::vector<uint64_t> hashes;
+    hashKeyValues(key, hashes);
+    SelectionVector rows = filter->select(key, hashes);
+    lastRowsIn = hashes.size();
+    lastRowsDropped = hashes.size() - rows.size();
+    if (rows.size() == hashes.size()) {
+        return;
+    }
+    for (auto& column : batch.columns) {
+        column = column.select(rows);
+    }
+}
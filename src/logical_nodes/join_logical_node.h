@@ -0,0 +1,128 @@
+#pragma once
+#include "logical_node.h"
+#include "join_params.h"
+#include "bloom_filter.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <vector>
+
+// Build-side hash table (defined in join_logical_node.cpp)
+struct JoinHashTable;
+
+// Inner equi-join of the input (probe side) with a catalog table (build
+// side). The build side is hashed once at bind time into chained tables,
+// radix-partitioned on the top hash bits when one table would not fit in
+// L2, and its keys are published as a blocked Bloom filter. Execution:
+//  1. Probe keys are hashed and checked against the Bloom filter, so most
+//     non-matching rows never touch the hash table.
+//  2. Surviving rows are probed in parallel: by contiguous row ranges, or
+//     by partition when the table is partitioned.
+// Output rows follow the probe order; a probe row matching several build
+// rows repeats once per match, in build order. Null keys never match.
+//
+// The optimizer can copy the Bloom filter into a RuntimeFilterLogicalNode
+// placed before earlier stages, so rows are dropped before any other work.
+struct JoinLogicalNode : public LogicalNode {
+    JoinParams params;
+    std::shared_ptr<const Batch> buildSide;  // Set by attachCatalog()
+    uint64_t buildVersion = 0;               // Catalog::tableVersion(), likewise
+    // Published by bind(); shared with the filters the optimizer places
+    std::shared_ptr<RuntimeFilter> runtimeFilter = std::make_shared<RuntimeFilter>();
+
+    uint32_t probeSlot = 0;                  // Filled by bind()
+    uint32_t buildSlot = 0;                  // Filled by bind()
+    std::vector<uint32_t> buildOutputSlots;  // Filled by bind(): build columns appended to the output
+    Schema outputSchema;                     // Filled by bind()
+    std::shared_ptr<const JoinHashTable> hashTable;  // Filled by bind()
+
+    bool filterPushedDown = false;  // Set by pushDownJoinFilters()
+    size_t partitionBytes = 0;      // Hash table bytes per partition; 0: the L2 cache size
+    uint32_t maxThreads = 0;        // 0: one per hardware thread
+
+    // Shape of the last execution, for explain() and tests
+    mutable std::atomic<uint32_t> lastThreads{0};
+    mutable std::atomic<uint64_t> lastRowsFiltered{0};  // Probe rows rejected by the Bloom filter
+    mutable std::atomic<uint64_t> lastRowsOutput{0};
+
+    JoinLogicalNode(const JoinParams& params)
+        : params(params) {}
+
+    std::string debugName() const override {
+        return "JoinLogicalNode";
+    }
+
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Join\n"
+            << "  Table: " << params.table << "\n"
+            << "  Keys: " << params.probeKey << " = " << params.table << "." << params.buildKey << "\n"
+            << "  Algorithm: " << (partitions() > 1 ? "Radix-Partitioned " : "") << "Hash Join\n"
+            << "  Estimated Cost: " << (buildSide ? buildSide->rowCount() / 10 + 50 : 50) << " units";
+        if (partitions() > 0) {
+            oss << "\n  Build Side: " << buildSide->rowCount() << " rows, " << partitions()
+                << " partitions, " << runtimeFilter->bloom.bytes() << " byte Bloom filter";
+        }
+        if (uint32_t threads = lastThreads.load()) {
+            oss << "\n  Last Execution: " << threads << " threads, " << lastRowsFiltered.load()
+                << " rows dropped by the Bloom filter, " << lastRowsOutput.load() << " rows out";
+        }
+        return oss.str();
+    }
+
+    void attachCatalog(const Catalog& catalog) override;
+
+    // Resolves both keys (which must have the same type), builds the hash
+    // table and publishes the Bloom filter. The output schema is the input
+    // followed by every table field except the build key.
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
+
+    // Partitions of the bound hash table (0 before bind)
+    uint32_t partitions() const;
+};
+
+// Drops rows whose key is not in a join's published Bloom filter. Placed
+// by the optimizer ahead of the stages preceding the join; a no-op until
+// the filter is published.
+struct RuntimeFilterLogicalNode : public LogicalNode {
+    std::string keyName;
+    SymbolId keyId = kInvalidSymbol;
+    std::shared_ptr<const RuntimeFilter> filter;
+    uint32_t keySlot = 0;  // Filled by bind()
+
+    // Work done by the last execution, for explain() and tests
+    mutable std::atomic<uint64_t> lastRowsIn{0};
+    mutable std::atomic<uint64_t> lastRowsDropped{0};
+
+    RuntimeFilterLogicalNode(std::string keyName, SymbolId keyId, std::shared_ptr<const RuntimeFilter> filter)
+        : keyName(std::move(keyName)), keyId(keyId), filter(std::move(filter)) {}
+
+    std::string debugName() const override {
+        return "RuntimeFilterLogicalNode";
+    }
+
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Runtime Filter\n"
+            << "  Key: " << keyName << " (Bloom filter from a later join)\n"
+            << "  Estimated Cost: 2 units";
+        if (uint64_t rows = lastRowsIn.load()) {
+            oss << "\n  Last Execution: " << lastRowsDropped.load() << " of " << rows << " rows dropped";
+        }
+        return oss.str();
+    }
+
+    // Resolves the key; the schema passes through unchanged
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
+};
+
+// Specialize the create function for JoinParams
+template<>
+inline std::unique_ptr<LogicalNode> createLogicalNode<JoinParams>(const JoinParams& params) {
+    return std::make_unique<JoinLogicalNode>(params);
+}
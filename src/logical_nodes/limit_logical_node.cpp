@@ -1,6 +1,30 @@
 #include "limit_logical_node.h"
 #include "logical_node.h"
+#include "batch.h"
+#include <algorithm>
 #include <memory>
 
 // The createLogicalNode<LimitParams> specialization is already in the header
 // No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> LimitLogicalNode::bind(const Schema& input, const SymbolTable&) {
+    return input;
+}
+
+void LimitLogicalNode::execute(Batch& batch) const {
+    if (params.offset == 0) {
+        for (auto& column : batch.columns) {
+            column.truncate(static_cast<size_t>(params.limitValue));
+        }
+        return;
+    }
+    size_t rows = batch.rowCount();
+    size_t begin = std::min(rows, static_cast<size_t>(params.offset));
+    SelectionVector kept;
+    for (size_t row = begin; row < std::min(rows, params.rowsNeeded()); ++row) {
+        kept.push_back(static_cast<uint32_t>(row));
+    }
+    for (auto& column : batch.columns) {
+        column.gather(kept);
+    }
+}
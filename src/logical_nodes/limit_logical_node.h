@@ -18,14 +18,22 @@ struct LimitLogicalNode : public LogicalNode {
         std::ostringstream oss;
         oss << "LOGICAL_PLAN:\n"
             << "  Operation: Limit\n"
-            << "  Row Limit: " << params.limitValue << "\n"
-            << "  Estimated Memory: " << (params.limitValue * 100) << " bytes";
+            << "  Row Limit: " << params.limitValue << "\n";
+        if (params.offset > 0) {
+            oss << "  Row Offset: " << params.offset << "\n";
+        }
+        oss << "  Estimated Memory: " << (params.limitValue * 100) << " bytes";
         return oss.str();
     }
+
+    // Limit references no fields: the schema passes through unchanged
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
 };
 
 
 // Specialize the create function for LimitParams
 template<>
-std::unique_ptr<LogicalNode> createLogicalNode<LimitParams>(const LimitParams& params);
-
+inline std::unique_ptr<LogicalNode> createLogicalNode<LimitParams>(const LimitParams& params) {
+    return std::make_unique<LimitLogicalNode>(params);
+}
@@ -0,0 +1,42 @@
+#include "match_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "symbol_table.h"
+#include <memory>
+
+// The createLogicalNode<MatchParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> MatchLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    boundPredicate.reset();
+    plan = PredicatePlan{};
+    auto parsed = parsedExpression();
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    auto bound = bindExpression(*parsed, input, symbols);
+    if (!bound) {
+        return std::unexpected(bound.error());
+    }
+    if ((*bound)->type != PhysicalType::Bool) {
+        return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0,
+                                          static_cast<uint32_t>(params.predicate.size())});
+    }
+    boundPredicate = *bound;
+    plan = compilePredicate(boundPredicate);
+    return input;
+}
+
+void MatchLogicalNode::execute(Batch& batch) const {
+    FilterStats stats;
+    SelectionVector selection = plan.select(batch, &stats);
+    lastBlocksSkipped = stats.blocksSkipped;
+    lastBlocksAccepted = stats.blocksAccepted;
+    lastRowsEvaluated = stats.rowsEvaluated;
+    if (selection.size() == batch.rowCount()) {
+        return;
+    }
+    for (auto& column : batch.columns) {
+        column = column.select(selection);
+    }
+}
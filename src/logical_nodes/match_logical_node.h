@@ -0,0 +1,65 @@
+#pragma once
+#include "logical_node.h"
+#include "match_params.h"
+#include "expression.h"
+#include "predicate.h"
+#include <atomic>
+#include <string>
+#include <sstream>
+
+struct MatchLogicalNode : public LogicalNode {
+    MatchParams params;
+    ExprPtr expression;      // Unbound tree; set by the optimizer, else parsed from params
+    ExprPtr boundPredicate;  // Filled by bind()
+    PredicatePlan plan;      // Filled by bind()
+
+    // Work done by the last execution, for explain() and tests
+    mutable std::atomic<uint64_t> lastBlocksSkipped{0};
+    mutable std::atomic<uint64_t> lastBlocksAccepted{0};
+    mutable std::atomic<uint64_t> lastRowsEvaluated{0};
+    
+    MatchLogicalNode(const MatchParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        return "MatchLogicalNode";
+    }
+    
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Match\n"
+            << "  Predicate: " << params.predicate << "\n"
+            << "  Estimated Cost: 5 units";
+        if (boundPredicate) {
+            oss << "\n  Bound Predicate: " << toString(*boundPredicate)
+                << "\n  Kernels: " << plan.kernelLeaves << " compiled, " << plan.interpretedLeaves
+                << " interpreted";
+        }
+        if (uint64_t rows = lastRowsEvaluated.load(); rows || lastBlocksSkipped.load() || lastBlocksAccepted.load()) {
+            oss << "\n  Last Execution: " << rows << " rows evaluated, " << lastBlocksSkipped.load()
+                << " blocks skipped, " << lastBlocksAccepted.load() << " blocks accepted by zone maps";
+        }
+        return oss.str();
+    }
+
+    // Returns `expression` if set, otherwise parses params.predicate
+    std::expected<ExprPtr, Diagnostic> parsedExpression() const {
+        if (expression) {
+            return expression;
+        }
+        return parseExpression(params.predicate);
+    }
+
+    // Binds the predicate (which must be Bool) and compiles it; the schema
+    // passes through unchanged
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    // Keeps only the rows where the predicate is true
+    void execute(Batch& batch) const override;
+};
+
+// Specialize the create function for MatchParams
+template<>
+inline std::unique_ptr<LogicalNode> createLogicalNode<MatchParams>(const MatchParams& params) {
+    return std::make_unique<MatchLogicalNode>(params);
+}
@@ -0,0 +1,45 @@
+#include "project_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <memory>
+
+// The createLogicalNode<ProjectParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> ProjectLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    slots.clear();
+    outputSchema = Schema{};
+    for (size_t i = 0; i < params.fields.size(); ++i) {
+        const std::string& name = params.fields[i];
+        SymbolId id = i < params.fieldIds.size() ? params.fieldIds[i]
+                                                 : symbols.find(name).value_or(kInvalidSymbol);
+        auto slot = input.slotOf(id, name);
+        if (!slot) {
+            slots.clear();
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0,
+                                              static_cast<uint32_t>(name.size())});
+        }
+        slots.push_back(*slot);
+    }
+    if (params.inputOrder) {
+        std::sort(slots.begin(), slots.end());
+    }
+    for (uint32_t slot : slots) {
+        outputSchema.fields.push_back(input.fields[slot]);
+    }
+    return outputSchema;
+}
+
+void ProjectLogicalNode::execute(Batch& batch) const {
+    std::vector<Column> columns;
+    columns.reserve(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        // A field listed twice is copied; otherwise the column is moved
+        bool usedAgain = std::find(slots.begin() + i + 1, slots.end(), slots[i]) != slots.end();
+        columns.push_back(usedAgain ? batch.columns[slots[i]] : std::move(batch.columns[slots[i]]));
+    }
+    batch.schema = outputSchema;
+    batch.columns = std::move(columns);
+}
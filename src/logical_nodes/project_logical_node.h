@@ -0,0 +1,47 @@
+#pragma once
+#include "logical_node.h"
+#include "project_params.h"
+#include <string>
+#include <sstream>
+#include <vector>
+
+struct ProjectLogicalNode : public LogicalNode {
+    ProjectParams params;
+    std::vector<uint32_t> slots;  // Input slot of each output column, filled by bind()
+    Schema outputSchema;          // Filled by bind()
+    
+    ProjectLogicalNode(const ProjectParams& params)
+        : params(params) {}
+    
+    std::string debugName() const override {
+        return "ProjectLogicalNode";
+    }
+    
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Project\n"
+            << "  Fields: [";
+        for (size_t i = 0; i < params.fields.size(); ++i) {
+            if (i > 0) oss << ", ";
+            oss << params.fields[i];
+        }
+        oss << "]\n"
+            << "  Order: " << (params.inputOrder ? "INPUT (source pruning)" : "AS LISTED") << "\n"
+            << "  Estimated Cost: 1 units";
+        for (size_t i = 0; i < slots.size(); ++i) {
+            oss << "\n  Bound Field: " << outputSchema.fields[i].name << " -> slot " << slots[i];
+        }
+        return oss.str();
+    }
+
+    // Resolves every field; the output schema holds just those fields
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
+};
+
+// Specialize the create function for ProjectParams
+template<>
+inline std::unique_ptr<LogicalNode> createLogicalNode<ProjectParams>(const ProjectParams& params) {
+    return std::make_unique<ProjectLogicalNode>(params);
+}
@@ -1,6 +1,73 @@
 #include "set_metadata_logical_node.h"
 #include "logical_node.h"
+#include "batch.h"
+#include "catalog.h"
+#include "expression_eval.h"
+#include "metadata_sink.h"
+#include "metadata_store.h"
+#include "symbol_table.h"
 #include <memory>
 
 // The createLogicalNode<SetMetadataParams> specialization is already in the header
 // No static registration needed since we use template specialization
+
+void SetMetadataLogicalNode::attachCatalog(const Catalog& catalog) {
+    sink = catalog.metadataSink;
+    store = catalog.metadataStore;
+    rowIdField = catalog.metadataRowIdField;
+}
+
+std::expected<Schema, Diagnostic> SetMetadataLogicalNode::bind(const Schema& input,
+                                                               const SymbolTable& symbols) {
+    boundExpression.reset();
+    jitEntry.reset();
+    rowIdSlot = -1;
+    if (hasSideEffects()) {
+        auto slot = input.slotOf(symbols.find(rowIdField).value_or(kInvalidSymbol), rowIdField);
+        if (!slot) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0, 0});
+        }
+        if (input.fields[*slot].type != PhysicalType::Int64) {
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0, 0});
+        }
+        rowIdSlot = static_cast<int>(*slot);
+    }
+    auto parsed = parsedExpression();
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    auto bound = bindExpression(*parsed, input, symbols);
+    if (!bound) {
+        return std::unexpected(bound.error());
+    }
+    boundExpression = *bound;
+    jitEntry = ExpressionJit::instance().entryFor(*boundExpression);
+
+    outputField.name = params.metaName;
+    outputField.id = params.metaNameId != kInvalidSymbol
+                         ? params.metaNameId
+                         : symbols.find(params.metaName).value_or(kInvalidSymbol);
+    outputField.type = boundExpression->type;
+
+    Schema output = input;
+    if (auto slot = output.slotOf(outputField.id, outputField.name)) {
+        output.fields[*slot] = outputField;
+    } else {
+        output.fields.push_back(outputField);
+    }
+    return output;
+}
+
+void SetMetadataLogicalNode::execute(Batch& batch) const {
+    Column result;
+    if (!jitEntry || !ExpressionJit::instance().tryExecute(*jitEntry, batch, result)) {
+        result = evaluateExpression(*boundExpression, batch);
+    }
+    if (sink) {
+        sink->write(params.metaName, batch.columns[rowIdSlot], result);
+    }
+    if (store) {
+        store->insert(outputField.id, batch.columns[rowIdSlot], result);
+    }
+    batch.setColumn(outputField, std::move(result));
+}
@@ -1,11 +1,26 @@
 #pragma once
 #include "logical_node.h"
 #include "set_metadata_params.h"
+#include "expression.h"
+#include "expression_jit.h"
+#include <memory>
 #include <string>
 #include <sstream>
 
+class MetadataSink;
+class MetadataStore;
+
 struct SetMetadataLogicalNode : public LogicalNode {
     SetMetadataParams params;
+    ExprPtr expression;       // Unbound tree; set by the optimizer, else parsed from params
+    ExprPtr boundExpression;  // Filled by bind()
+    Field outputField;        // Column written by execute(), filled by bind()
+    std::shared_ptr<ExpressionJit::Entry> jitEntry;  // Native tier state; null when interpreted only
+    // Set by attachCatalog(); each receives every computed value
+    std::shared_ptr<MetadataSink> sink;
+    std::shared_ptr<MetadataStore> store;
+    std::string rowIdField;  // Identifies rows to the sink and store
+    int rowIdSlot = -1;      // Filled by bind() when there is a sink or store
     
     SetMetadataLogicalNode(const SetMetadataParams& params)
         : params(params) {}
@@ -20,10 +35,36 @@ struct SetMetadataLogicalNode : public LogicalNode {
             << "  Operation: SetMetadata\n"
             << "  Metadata Name: " << params.metaName << "\n"
             << "  Expression: " << params.expression << "\n"
-            << "  Side Effects: Yes (metadata write)\n"
+            << "  Side Effects: Yes (metadata write" << (sink ? ", group-committed to the metadata sink" : "")
+            << (store ? ", published to the metadata store" : "") << ")\n"
             << "  Estimated Cost: 10 units";
+        if (boundExpression) {
+            oss << "\n  Bound Expression: " << toString(*boundExpression)
+                << "\n  Result Type: " << physicalTypeName(outputField.type)
+                << "\n  Execution Tier: "
+                << (!jitEntry ? "interpreted" : jitEntry->kernel.load() ? "native" : "interpreted (jit candidate)");
+        }
         return oss.str();
     }
+
+    // Returns `expression` if set, otherwise parses params.expression
+    std::expected<ExprPtr, Diagnostic> parsedExpression() const {
+        if (expression) {
+            return expression;
+        }
+        return parseExpression(params.expression);
+    }
+
+    // True when executing it writes outside the batch, so rewrites must not
+    // drop it, fuse it or change which rows reach it
+    bool hasSideEffects() const { return sink || store; }
+
+    void attachCatalog(const Catalog& catalog) override;
+    // Parses and binds the expression, and appends (or replaces) the
+    // metaName column in the output schema. With a sink or store, the input
+    // must also have the Int64 row id field.
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
 };
 
 // Specialize the create function for SetMetadataParams
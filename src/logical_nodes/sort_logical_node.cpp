@@ -1,6 +1,205 @@
 #include "sort_logical_node.h"
 #include "logical_node.h"
+#include "batch.h"
+#include "symbol_table.h"
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
 // The createLogicalNode<SortParams> specialization is already in the header
 // No static registration needed since we use template specialization
+
+template <typename T>
+static int compareValues(const Column& column, uint32_t lhs, uint32_t rhs) {
+    const auto& values = column.values<T>();
+    return values[lhs] < values[rhs] ? -1 : (values[rhs] < values[lhs] ? 1 : 0);
+}
+
+static int (*comparatorFor(PhysicalType type))(const Column&, uint32_t, uint32_t) {
+    switch (type) {
+        case PhysicalType::Bool: return &compareValues<uint8_t>;
+        case PhysicalType::Int64: return &compareValues<int64_t>;
+        case PhysicalType::Double: return &compareValues<double>;
+        case PhysicalType::String: return &compareValues<std::string>;
+        case PhysicalType::Vector: break;  // Rejected by bind()
+    }
+    return nullptr;
+}
+
+std::expected<Schema, Diagnostic> SortLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    boundKeys.clear();
+    for (size_t i = 0; i < params.sortKeys.size(); ++i) {
+        const std::string& name = params.sortKeys[i];
+        SymbolId id = i < params.sortKeyIds.size() ? params.sortKeyIds[i]
+                                                   : symbols.find(name).value_or(kInvalidSymbol);
+        auto slot = input.slotOf(id, name);
+        if (!slot) {
+            boundKeys.clear();
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownField, 0,
+                                              static_cast<uint32_t>(name.size())});
+        }
+        PhysicalType type = input.fields[*slot].type;
+        if (!isKeyType(type)) {
+            boundKeys.clear();
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0,
+                                              static_cast<uint32_t>(name.size())});
+        }
+        boundKeys.push_back(BoundSortKey{*slot, type, comparatorFor(type)});
+    }
+    return input;
+}
+
+// Single-key fast path: compares the typed values directly
+template <typename T>
+static void sortBySingleKey(std::vector<uint32_t>& rows, const Column& column, bool ascending) {
+    const auto& values = column.values<T>();
+    if (ascending) {
+        std::stable_sort(rows.begin(), rows.end(),
+                         [&values](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+    } else {
+        std::stable_sort(rows.begin(), rows.end(),
+                         [&values](uint32_t a, uint32_t b) { return values[b] < values[a]; });
+    }
+}
+
+// Dictionary codes compare like the strings they encode
+static int compareCodes(const Column& column, uint32_t lhs, uint32_t rhs) {
+    uint32_t a = column.codes[lhs];
+    uint32_t b = column.codes[rhs];
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Packed deltas compare like the values they encode
+static int comparePackedValues(const Column& column, uint32_t lhs, uint32_t rhs) {
+    uint64_t a = column.packed->deltaAt(lhs);
+    uint64_t b = column.packed->deltaAt(rhs);
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Stable LSD radix sort of rows by an unsigned key (indexed by row), one byte
+// per pass and only as many passes as maxKey needs
+template <typename Key>
+static void radixSortByKey(std::vector<uint32_t>& rows, const std::vector<Key>& keys, Key maxKey,
+                           bool ascending) {
+    auto key = [&](uint32_t row) { return ascending ? keys[row] : maxKey - keys[row]; };
+
+    std::vector<uint32_t> scratch(rows.size());
+    for (unsigned shift = 0; shift < sizeof(Key) * 8 && (maxKey >> shift) != 0; shift += 8) {
+        size_t counts[257] = {};
+        for (uint32_t row : rows) {
+            ++counts[((key(row) >> shift) & 0xff) + 1];
+        }
+        for (size_t d = 1; d < 257; ++d) {
+            counts[d] += counts[d - 1];
+        }
+        for (uint32_t row : rows) {
+            scratch[counts[(key(row) >> shift) & 0xff]++] = row;
+        }
+        rows.swap(scratch);
+    }
+}
+
+// Stable split of rows into [nulls | values] or [values | nulls]. Each row
+// is written to one of two cursors chosen arithmetically from its validity
+// bit, so there is no data-dependent branch. Returns the value range.
+static std::pair<size_t, size_t> partitionNulls(std::vector<uint32_t>& rows, const Column& column,
+                                                bool nullsFirst) {
+    size_t n = rows.size();
+    size_t validCount = 0;
+    for (size_t w = 0; w < column.validity.size(); ++w) {
+        uint64_t bits = column.validity[w];
+        if ((w + 1) * 64 > n) {
+            bits &= (n % 64 == 0) ? ~uint64_t{0} : ((uint64_t{1} << (n % 64)) - 1);
+        }
+        validCount += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+    size_t valueBegin = nullsFirst ? n - validCount : 0;
+    size_t nullBegin = nullsFirst ? 0 : validCount;
+
+    std::vector<uint32_t> out(n);
+    size_t cursor[2] = {nullBegin, valueBegin};
+    for (size_t i = 0; i < n; ++i) {
+        size_t valid = (column.validity[i / 64] >> (i % 64)) & 1;
+        out[cursor[valid]++] = rows[i];
+    }
+    rows = std::move(out);
+    return {valueBegin, valueBegin + validCount};
+}
+
+void SortLogicalNode::execute(Batch& batch) const {
+    std::vector<uint32_t> rows(batch.rowCount());
+    std::iota(rows.begin(), rows.end(), 0u);
+
+    if (boundKeys.size() == 1) {
+        const BoundSortKey& key = boundKeys.front();
+        const Column& column = batch.columns[key.slot];
+        // Nulls all compare equal, so only the value range needs sorting
+        std::vector<uint32_t> values;
+        std::pair<size_t, size_t> range{0, rows.size()};
+        if (column.hasNulls()) {
+            range = partitionNulls(rows, column, params.nullsFirst);
+            values.assign(rows.begin() + range.first, rows.begin() + range.second);
+        } else {
+            values.swap(rows);
+        }
+        if (column.isDictionary()) {
+            uint32_t maxCode = column.dictionary->empty() ? 0 : uint32_t(column.dictionary->size() - 1);
+            radixSortByKey(values, column.codes, maxCode, params.ascending);
+        } else if (column.isPacked()) {
+            // Sort keys are the packed deltas, unpacked block-wise; the
+            // column is never expanded to int64 values
+            std::vector<uint64_t> deltas(column.packed->count);
+            column.packed->unpackDeltas(0, deltas.size(), deltas.data());
+            radixSortByKey(values, deltas, column.packed->maxDelta(), params.ascending);
+        } else {
+            switch (key.type) {
+                case PhysicalType::Bool: sortBySingleKey<uint8_t>(values, column, params.ascending); break;
+                case PhysicalType::Int64: sortBySingleKey<int64_t>(values, column, params.ascending); break;
+                case PhysicalType::Double: sortBySingleKey<double>(values, column, params.ascending); break;
+                case PhysicalType::String: sortBySingleKey<std::string>(values, column, params.ascending); break;
+                case PhysicalType::Vector: break;  // Rejected by bind()
+            }
+        }
+        if (column.hasNulls()) {
+            std::copy(values.begin(), values.end(), rows.begin() + range.first);
+        } else {
+            rows.swap(values);
+        }
+    } else if (!boundKeys.empty()) {
+        int direction = params.ascending ? 1 : -1;
+        // Null rank ordered before (nulls first) or after every value
+        int nullRank = params.nullsFirst ? -1 : 1;
+        // Encoding is a property of the batch, so comparators are finalized here
+        std::vector<int (*)(const Column&, uint32_t, uint32_t)> compares;
+        for (const auto& key : boundKeys) {
+            const Column& column = batch.columns[key.slot];
+            compares.push_back(column.isDictionary() ? &compareCodes
+                               : column.isPacked()   ? &comparePackedValues
+                                                     : key.compare);
+        }
+        std::stable_sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+            for (size_t k = 0; k < boundKeys.size(); ++k) {
+                const BoundSortKey& key = boundKeys[k];
+                const Column& column = batch.columns[key.slot];
+                if (column.hasNulls()) {
+                    int nullA = !column.isValid(a);
+                    int nullB = !column.isValid(b);
+                    if (nullA | nullB) {
+                        int cmp = (nullA - nullB) * nullRank;
+                        if (cmp != 0) return cmp < 0;
+                        continue;  // Both null
+                    }
+                }
+                int cmp = compares[k](column, a, b);
+                if (cmp != 0) {
+                    return cmp * direction < 0;
+                }
+            }
+            return false;
+        });
+    }
+
+    for (auto& column : batch.columns) {
+        column.gather(rows);
+    }
+}
@@ -3,9 +3,23 @@
 #include "sort_params.h"
 #include <string>
 #include <sstream>
+#include <vector>
+
+struct Column;
+
+// A sort key resolved against the input schema. The comparator is picked
+// from the column type at bind time, so sorting never dispatches on types
+// per row.
+struct BoundSortKey {
+    uint32_t slot = 0;
+    PhysicalType type = PhysicalType::Int64;
+    // Three-way comparison of two rows of the key column (ascending order)
+    int (*compare)(const Column& column, uint32_t lhs, uint32_t rhs) = nullptr;
+};
 
 struct SortLogicalNode : public LogicalNode {
     SortParams params;
+    std::vector<BoundSortKey> boundKeys;  // Filled by bind()
     
     SortLogicalNode(const SortParams& params)
         : params(params) {}
@@ -25,10 +39,18 @@ struct SortLogicalNode : public LogicalNode {
         }
         oss << "]\n"
             << "  Direction: " << (params.ascending ? "ASCENDING" : "DESCENDING") << "\n"
+            << "  Nulls: " << (params.nullsFirst ? "FIRST" : "LAST") << "\n"
             << "  Algorithm: " << (params.sortKeys.size() > 3 ? "External Sort" : "QuickSort") << "\n"
             << "  Estimated Cost: " << (params.sortKeys.size() * 200) << " units";
+        for (size_t i = 0; i < boundKeys.size(); ++i) {
+            oss << "\n  Bound Key: " << params.sortKeys[i] << " -> slot " << boundKeys[i].slot
+                << " (" << physicalTypeName(boundKeys[i].type) << ")";
+        }
         return oss.str();
     }
+
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
 };
 
 // Specialize the create function for SortParams
@@ -0,0 +1,199 @@
+#include "top_k_logical_node.h"
+#include "batch.h"
+#include "expression_eval.h"
+#include "hnsw_index.h"
+#include "inverted_index.h"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <queue>
+
+namespace {
+
+// Positions of the first k rows of a stable sort of the scores, in sort
+// order, with a heap of at most k rows. Nullopt when a score is NaN, since
+// the sort gives NaN no consistent place.
+template <typename T>
+std::optional<SelectionVector> firstRows(const Column& scores, const std::vector<T>& values, size_t k,
+                                         bool ascending, bool nullsFirst) {
+    if (k == 0) {
+        return SelectionVector{};
+    }
+    auto before = [&](uint32_t a, uint32_t b) {
+        if (values[a] != values[b]) return ascending ? values[a] < values[b] : values[b] < values[a];
+        return a < b;
+    };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(before)> heap(before);  // Last kept on top
+    SelectionVector nulls;
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        if (!scores.isValid(i)) {
+            if (nulls.size() < k) nulls.push_back(i);
+            continue;
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            if (std::isnan(values[i])) return std::nullopt;
+        }
+        if (heap.size() < k) {
+            heap.push(i);
+        } else if (before(i, heap.top())) {
+            heap.pop();
+            heap.push(i);
+        }
+    }
+    SelectionVector kept(heap.size());
+    for (size_t i = kept.size(); i-- > 0;) {
+        kept[i] = heap.top();
+        heap.pop();
+    }
+    SelectionVector rows = nullsFirst ? nulls : kept;
+    const SelectionVector& rest = nullsFirst ? kept : nulls;
+    rows.insert(rows.end(), rest.begin(), rest.end());
+    rows.resize(std::min(rows.size(), k));
+    return rows;
+}
+
+std::optional<SelectionVector> firstRows(const Column& scores, size_t k, bool ascending, bool nullsFirst) {
+    if (scores.type == PhysicalType::Double) {
+        return firstRows(scores, scores.doubles, k, ascending, nullsFirst);
+    }
+    if (scores.type == PhysicalType::Int64 && !scores.isPacked()) {
+        return firstRows(scores, scores.ints, k, ascending, nullsFirst);
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::expected<Schema, Diagnostic> TopKLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    vectorSlot = -1;
+    query.reset();
+    textSlot = -1;
+    textTerms.clear();
+    auto scored = score->bind(input, symbols);
+    if (!scored) {
+        return scored;
+    }
+    auto sorted = sort->bind(*scored, symbols);
+    if (!sorted) {
+        return sorted;
+    }
+    auto limited = limit->bind(*sorted, symbols);
+    if (!limited) {
+        return limited;
+    }
+    const Expr& expr = *score->boundExpression;
+    if (expr.kind == ExprKind::Call && (expr.op == ExprOp::Dot || expr.op == ExprOp::Cosine)) {
+        const ExprPtr* field = &expr.args[0];
+        const ExprPtr* literal = &expr.args[1];
+        if ((*field)->kind != ExprKind::Field) std::swap(field, literal);
+        if ((*field)->kind == ExprKind::Field && (*literal)->kind == ExprKind::Literal) {
+            vectorSlot = (*field)->slot;
+            query = *literal;
+        }
+    }
+    if (expr.kind == ExprKind::Call && expr.op == ExprOp::Bm25) {
+        textSlot = expr.args[0]->slot;
+        textTerms = queryTerms(expr.args[1]->stringValue);
+    }
+    return limited;
+}
+
+bool TopKLogicalNode::executeFromIndex(Batch& batch, size_t k) const {
+    if (vectorSlot < 0 || sort->params.ascending || sort->params.nullsFirst || k == 0) {
+        return false;
+    }
+    const HnswIndex* index = batch.columns[vectorSlot].vectorIndex.get();
+    VectorMetric metric = score->boundExpression->op == ExprOp::Cosine ? VectorMetric::Cosine : VectorMetric::Dot;
+    if (!index || index->metric != metric || index->dimension != query->vectorValue.size() || k > index->size()) {
+        return false;
+    }
+
+    SelectionVector candidates;
+    for (const auto& hit : index->search(query->vectorValue.data(), k, std::max<size_t>(indexEf, k))) {
+        candidates.push_back(hit.row);
+    }
+    if (!keepCandidates(batch, std::move(candidates), k)) {
+        return false;
+    }
+    lastUsedIndex = true;
+    return true;
+}
+
+bool TopKLogicalNode::executeFromTextIndex(Batch& batch, size_t k) const {
+    if (textSlot < 0 || sort->params.ascending || sort->params.nullsFirst || k == 0) {
+        return false;
+    }
+    const InvertedIndex* index = batch.columns[textSlot].textIndex.get();
+    if (!index) {
+        return false;
+    }
+    WandStats stats;
+    std::vector<InvertedIndex::Hit> hits = index->topK(textTerms, k, &stats);
+    if (hits.size() < k) {
+        return false;  // Rows without any term tie at zero; the full path orders them
+    }
+    SelectionVector candidates;
+    for (const auto& hit : hits) {
+        candidates.push_back(hit.row);
+    }
+    if (!keepCandidates(batch, std::move(candidates), k)) {
+        return false;
+    }
+    lastRowsScored = stats.docsScored;
+    lastBlocksSkipped = stats.blocksSkipped;
+    lastUsedTextIndex = true;
+    return true;
+}
+
+bool TopKLogicalNode::keepCandidates(Batch& batch, SelectionVector candidates, size_t k) const {
+    std::sort(candidates.begin(), candidates.end());  // Ties resolve in row order
+    Column scores = evaluateExpression(*score->boundExpression, batch, &candidates);
+    auto positions = firstRows(scores, k, false, false);
+    if (!positions || positions->size() < k ||
+        !std::all_of(positions->begin(), positions->end(), [&](uint32_t p) { return scores.isValid(p); })) {
+        return false;
+    }
+    dropOffset(*positions);
+
+    SelectionVector rows;
+    for (uint32_t p : *positions) rows.push_back(candidates[p]);
+    Column top = scores.select(*positions);
+    for (auto& column : batch.columns) {
+        column.gather(rows);
+    }
+    batch.setColumn(score->outputField, std::move(top));
+    lastRowsScored = candidates.size();
+    return true;
+}
+
+void TopKLogicalNode::execute(Batch& batch) const {
+    executed = true;
+    lastUsedIndex = false;
+    lastUsedTextIndex = false;
+    lastFellBack = false;
+    lastBlocksSkipped = 0;
+    size_t k = limit->params.rowsNeeded();
+    if (executeFromIndex(batch, k) || executeFromTextIndex(batch, k)) {
+        return;
+    }
+
+    score->execute(batch);
+    lastRowsScored = batch.rowCount();
+    auto rows = firstRows(batch.columns[sort->boundKeys.front().slot], k, sort->params.ascending,
+                          sort->params.nullsFirst);
+    if (!rows) {
+        lastFellBack = true;
+        sort->execute(batch);
+        limit->execute(batch);
+        return;
+    }
+    dropOffset(*rows);
+    for (auto& column : batch.columns) {
+        column.gather(*rows);
+    }
+}
+
+void TopKLogicalNode::dropOffset(SelectionVector& rows) const {
+    size_t offset = std::min(rows.size(), static_cast<size_t>(limit->params.offset));
+    rows.erase(rows.begin(), rows.begin() + static_cast<ptrdiff_t>(offset));
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "logical_node.h"
+#include "limit_logical_node.h"
+#include "set_metadata_logical_node.h"
+#include "sort_logical_node.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <vector>
+
+// "set_metadata s:<expr> | sort s | limit k" fused into one stage by
+// fuseScoreTopK(). The score is computed as the set_metadata stage would,
+// then a bounded heap of k rows replaces the full sort: O(n log k) instead
+// of O(n log n), and only the k winning rows are gathered. The output is
+// identical to the three stages run in sequence: ties keep input order and
+// nulls go where the sort puts them. Scores that are not numbers, or
+// contain NaN, fall back to the original sort and limit. A limit offset m
+// keeps k + m rows and drops the first m.
+//
+// When the score is dot() or cosine() of a Vector field and a literal, the
+// sort is descending and the field's column carries an HNSW index for that
+// metric (Column::vectorIndex), only the index's candidates are scored.
+// This makes the result approximate, so it is only used when an index was
+// built for the column.
+//
+// When the score is bm25() of a String field whose column carries an
+// inverted index (Column::textIndex) and the sort is descending, block-max
+// WAND finds the k best rows without scoring rows that cannot enter. That
+// search is exact, so the output is unchanged.
+struct TopKLogicalNode : public LogicalNode {
+    std::unique_ptr<SetMetadataLogicalNode> score;
+    std::unique_ptr<SortLogicalNode> sort;
+    std::unique_ptr<LimitLogicalNode> limit;
+
+    uint32_t indexEf = 64;  // HNSW search width (at least k)
+
+    // Filled by bind(): the Vector field and query of a dot()/cosine()
+    // score, when it has that shape
+    int32_t vectorSlot = -1;
+    ExprPtr query;
+    // Filled by bind(): the String field and query terms of a bm25() score
+    int32_t textSlot = -1;
+    std::vector<std::string> textTerms;
+
+    // Shape of the last execution, for explain() and tests
+    mutable std::atomic<bool> executed{false};
+    mutable std::atomic<bool> lastUsedIndex{false};
+    mutable std::atomic<bool> lastUsedTextIndex{false};
+    mutable std::atomic<bool> lastFellBack{false};
+    mutable std::atomic<uint64_t> lastRowsScored{0};
+    mutable std::atomic<uint64_t> lastBlocksSkipped{0};
+
+    TopKLogicalNode(std::unique_ptr<SetMetadataLogicalNode> score, std::unique_ptr<SortLogicalNode> sort,
+                    std::unique_ptr<LimitLogicalNode> limit)
+        : score(std::move(score)), sort(std::move(sort)), limit(std::move(limit)) {}
+
+    std::string debugName() const override {
+        return "TopKLogicalNode";
+    }
+
+    std::string explain() const override {
+        std::ostringstream oss;
+        oss << "LOGICAL_PLAN:\n"
+            << "  Operation: Top-K (fused set_metadata, sort, limit)\n"
+            << "  Score: " << score->params.metaName << " = " << score->params.expression << "\n"
+            << "  Direction: " << (sort->params.ascending ? "ASCENDING" : "DESCENDING") << "\n"
+            << "  Row Limit: " << limit->params.limitValue << "\n"
+            << (limit->params.offset > 0 ? "  Row Offset: " + std::to_string(limit->params.offset) + "\n" : "")
+            << "  Algorithm: " << (vectorSlot >= 0 ? "HNSW Index (when attached) + " : "")
+            << (textSlot >= 0 ? "Block-Max WAND (when indexed) + " : "") << "Bounded Heap\n"
+            << "  Estimated Cost: " << (10 + limit->params.limitValue) << " units";
+        if (executed.load()) {
+            oss << "\n  Last Execution: " << lastRowsScored.load() << " rows scored"
+                << (lastUsedIndex.load() ? ", from the HNSW index" : "")
+                << (lastUsedTextIndex.load()
+                        ? ", from the inverted index (" + std::to_string(lastBlocksSkipped.load()) + " blocks skipped)"
+                        : "")
+                << (lastFellBack.load() ? ", fell back to a full sort" : "");
+        }
+        return oss.str();
+    }
+
+    // Binds the three stages in sequence; the schema is the set_metadata
+    // stage's output
+    std::expected<Schema, Diagnostic> bind(const Schema& input, const SymbolTable& symbols) override;
+    void execute(Batch& batch) const override;
+
+private:
+    // Scores only the HNSW candidates; false when the index does not apply
+    // or yields fewer than k scored rows
+    bool executeFromIndex(Batch& batch, size_t k) const;
+    // Top k by block-max WAND over the inverted index; false when it does
+    // not apply or fewer than k rows contain a query term
+    bool executeFromTextIndex(Batch& batch, size_t k) const;
+    // Scores the candidate rows and keeps the best k of them; false when
+    // fewer than k have a score
+    bool keepCandidates(Batch& batch, SelectionVector candidates, size_t k) const;
+    // Removes the limit's offset rows from the front of the first k
+    void dropOffset(SelectionVector& rows) const;
+};
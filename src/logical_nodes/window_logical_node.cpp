@@ -0,0 +1,364 @@
+#include "window_logical_node.h"
+#include "logical_node.h"
+#include "batch.h"
+#include "expression_eval.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+// The createLogicalNode<WindowParams> specialization is already in the header
+// No static registration needed since we use template specialization
+
+std::expected<Schema, Diagnostic> WindowLogicalNode::bind(const Schema& input, const SymbolTable& symbols) {
+    partitionSlots.clear();
+    orderSlots.clear();
+    boundFunctions.clear();
+    outputSchema = Schema{};
+    auto sorted = sorter.bind(input, symbols);
+    if (!sorted) {
+        return std::unexpected(sorted.error());
+    }
+    for (size_t k = 0; k < sorter.boundKeys.size(); ++k) {
+        (k < params.partitionKeys.size() ? partitionSlots : orderSlots).push_back(sorter.boundKeys[k].slot);
+    }
+
+    Schema output = input;
+    std::vector<BoundWindowFunction> functions;
+    for (const auto& fn : params.functions) {
+        BoundWindowFunction bound;
+        bound.spec = fn;
+        PhysicalType argType = PhysicalType::Int64;
+        if (!fn.argument.empty()) {
+            auto parsed = parseExpression(fn.argument);
+            if (!parsed) {
+                return std::unexpected(parsed.error());
+            }
+            auto boundArg = bindExpression(*parsed, input, symbols);
+            if (!boundArg) {
+                return std::unexpected(boundArg.error());
+            }
+            bound.argument = *boundArg;
+            argType = bound.argument->type;
+        }
+        bool numeric = argType == PhysicalType::Int64 || argType == PhysicalType::Double;
+        switch (fn.op) {
+            case WindowOp::RowNumber:
+            case WindowOp::Rank:
+            case WindowOp::DenseRank:
+            case WindowOp::Count: bound.outputField.type = PhysicalType::Int64; numeric = true; break;
+            case WindowOp::Sum:
+            case WindowOp::Min:
+            case WindowOp::Max: bound.outputField.type = argType; break;
+            case WindowOp::Avg: bound.outputField.type = PhysicalType::Double; break;
+        }
+        if (!numeric) {
+            return std::unexpected(Diagnostic{DiagnosticCode::TypeMismatch, 0,
+                                              static_cast<uint32_t>(fn.argument.size())});
+        }
+        bound.outputField.name = fn.name;
+        bound.outputField.id = fn.nameId != kInvalidSymbol ? fn.nameId
+                                                           : symbols.find(fn.name).value_or(kInvalidSymbol);
+        if (auto slot = output.slotOf(bound.outputField.id, bound.outputField.name)) {
+            output.fields[*slot] = bound.outputField;
+        } else {
+            output.fields.push_back(bound.outputField);
+        }
+        functions.push_back(std::move(bound));
+    }
+    boundFunctions = std::move(functions);
+    outputSchema = output;
+    return output;
+}
+
+namespace {
+
+constexpr size_t kMinRowsPerTask = 4096;
+
+// changed[r] |= 1 when row r's key differs from row r - 1's (nulls are
+// equal to each other and to nothing else)
+template <typename T>
+void markValueChanges(const Column& column, const std::vector<T>& values, std::vector<uint8_t>& changed) {
+    for (size_t r = 1; r < changed.size(); ++r) {
+        bool validA = column.isValid(r - 1);
+        bool validB = column.isValid(r);
+        bool differs = validA != validB || (validA && !(values[r - 1] == values[r]));
+        if constexpr (std::is_same_v<T, double>) {
+            differs = differs && !(values[r - 1] != values[r - 1] && values[r] != values[r]);  // NaNs are peers
+        }
+        changed[r] |= static_cast<uint8_t>(differs);
+    }
+}
+
+void markChanges(const Column& column, std::vector<uint8_t>& changed) {
+    if (column.isDictionary()) {
+        markValueChanges(column, column.codes, changed);
+        return;
+    }
+    if (column.isPacked()) {
+        markValueChanges(column, column.packed->unpackAll(), changed);
+        return;
+    }
+    switch (column.type) {
+        case PhysicalType::Bool: markValueChanges(column, column.bools, changed); break;
+        case PhysicalType::Int64: markValueChanges(column, column.ints, changed); break;
+        case PhysicalType::Double: markValueChanges(column, column.doubles, changed); break;
+        case PhysicalType::String: markValueChanges(column, column.strings, changed); break;
+        case PhysicalType::Vector: break;  // Rejected by the sorter's bind()
+    }
+}
+
+// Aggregate of a set of rows; count == 0 means no non-null value
+template <typename T>
+struct FrameState {
+    T sum = 0;
+    T min = 0;
+    T max = 0;
+    uint64_t count = 0;
+
+    // Int64 sums wrap around like the group stage's, instead of overflowing
+    static T plus(T a, T b) {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+        } else {
+            return a + b;
+        }
+    }
+
+    void add(T value) {
+        sum = plus(sum, value);
+        min = count == 0 || value < min ? value : min;
+        max = count == 0 || max < value ? value : max;
+        ++count;
+    }
+    void merge(const FrameState& other) {
+        if (other.count == 0) return;
+        sum = plus(sum, other.sum);
+        min = count == 0 || other.min < min ? other.min : min;
+        max = count == 0 || max < other.max ? other.max : max;
+        count += other.count;
+    }
+};
+
+// Bottom-up segment tree over one partition's values: leaf i is row
+// begin + i, and every inner node aggregates its two children
+template <typename T>
+struct SegmentTree {
+    std::vector<FrameState<T>> nodes;
+    size_t leaves = 0;
+
+    void build(const T* values, const Column& argument, size_t begin, size_t count) {
+        leaves = count;
+        nodes.assign(2 * count, FrameState<T>{});
+        for (size_t i = 0; i < count; ++i) {
+            if (argument.isValid(begin + i)) nodes[count + i].add(values[begin + i]);
+        }
+        for (size_t i = count; i-- > 1;) {
+            nodes[i] = nodes[2 * i];
+            nodes[i].merge(nodes[2 * i + 1]);
+        }
+    }
+
+    // Aggregate of leaves [lo, hi)
+    FrameState<T> query(size_t lo, size_t hi) const {
+        FrameState<T> result;
+        for (lo += leaves, hi += leaves; lo < hi; lo /= 2, hi /= 2) {
+            if (lo & 1) result.merge(nodes[lo++]);
+            if (hi & 1) result.merge(nodes[--hi]);
+        }
+        return result;
+    }
+};
+
+// Output values of one function, written per row by whichever worker owns
+// the row's partition
+struct FunctionOutput {
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<uint8_t> valid;
+};
+
+template <typename T>
+void emit(WindowOp op, const FrameState<T>& state, size_t row, FunctionOutput& out) {
+    if (op == WindowOp::Count) {
+        out.ints[row] = static_cast<int64_t>(state.count);
+        return;
+    }
+    out.valid[row] = state.count != 0;
+    if (state.count == 0) {
+        return;
+    }
+    T value = op == WindowOp::Sum ? state.sum : op == WindowOp::Min ? state.min : state.max;
+    if (op == WindowOp::Avg) {
+        out.doubles[row] = static_cast<double>(state.sum) / static_cast<double>(state.count);
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        out.ints[row] = value;
+    } else {
+        out.doubles[row] = value;
+    }
+}
+
+// Evaluates an aggregate over every row of the partition [begin, end)
+template <typename T>
+void evaluateFrames(const WindowFunctionSpec& spec, const T* values, const Column& argument, size_t begin,
+                    size_t end, FunctionOutput& out, SegmentTree<T>& tree, uint64_t& trees) {
+    auto frameEnd = [&](size_t row) -> size_t {  // Exclusive
+        if (spec.endUnbounded) return end;
+        int64_t last = static_cast<int64_t>(row) + spec.frameEnd + 1;
+        return static_cast<size_t>(std::clamp<int64_t>(last, static_cast<int64_t>(begin), static_cast<int64_t>(end)));
+    };
+    if (spec.startUnbounded) {
+        // Streaming: the frame only ever grows
+        FrameState<T> running;
+        size_t next = begin;
+        for (size_t row = begin; row < end; ++row) {
+            for (size_t stop = frameEnd(row); next < stop; ++next) {
+                if (argument.isValid(next)) running.add(values[next]);
+            }
+            emit(spec.op, running, row, out);
+        }
+        return;
+    }
+    tree.build(values, argument, begin, end - begin);
+    ++trees;
+    for (size_t row = begin; row < end; ++row) {
+        int64_t first = static_cast<int64_t>(row) + spec.frameStart;
+        size_t lo = static_cast<size_t>(std::clamp<int64_t>(first, static_cast<int64_t>(begin),
+                                                             static_cast<int64_t>(end)));
+        size_t hi = std::max(lo, frameEnd(row));
+        emit(spec.op, tree.query(lo - begin, hi - begin), row, out);
+    }
+}
+
+void evaluateRanks(WindowOp op, const std::vector<uint8_t>& newPeer, size_t begin, size_t end, FunctionOutput& out) {
+    int64_t rank = 0;
+    int64_t dense = 0;
+    for (size_t row = begin; row < end; ++row) {
+        if (row == begin || newPeer[row]) {
+            rank = static_cast<int64_t>(row - begin) + 1;
+            ++dense;
+        }
+        out.ints[row] = op == WindowOp::RowNumber ? static_cast<int64_t>(row - begin) + 1
+                        : op == WindowOp::Rank    ? rank
+                                                  : dense;
+    }
+}
+
+// Per-worker scratch
+struct WindowWorker {
+    SegmentTree<int64_t> intTree;
+    SegmentTree<double> doubleTree;
+    uint64_t trees = 0;
+};
+
+} // namespace
+
+void WindowLogicalNode::execute(Batch& batch) const {
+    if (!sorter.boundKeys.empty()) {
+        sorter.execute(batch);
+    }
+    size_t rows = batch.rowCount();
+
+    // Partition and peer boundaries of the sorted rows
+    std::vector<uint8_t> newPartition(rows, 0);
+    for (uint32_t slot : partitionSlots) markChanges(batch.columns[slot], newPartition);
+    std::vector<uint8_t> newPeer = newPartition;
+    for (uint32_t slot : orderSlots) markChanges(batch.columns[slot], newPeer);
+    std::vector<size_t> starts;
+    for (size_t r = 0; r < rows; ++r) {
+        if (r == 0 || newPartition[r]) starts.push_back(r);
+    }
+    starts.push_back(rows);
+    size_t partitionCount = starts.size() - 1;
+
+    // Arguments are evaluated once over the whole batch, as plain columns
+    std::vector<Column> arguments(boundFunctions.size());
+    std::vector<FunctionOutput> outputs(boundFunctions.size());
+    std::vector<int64_t> zeros;
+    for (size_t f = 0; f < boundFunctions.size(); ++f) {
+        const auto& fn = boundFunctions[f];
+        if (fn.argument) {
+            arguments[f] = evaluateExpression(*fn.argument, batch);
+            if (arguments[f].isPacked() || arguments[f].isDictionary()) arguments[f] = arguments[f].decoded();
+        }
+        if (fn.outputField.type == PhysicalType::Double) {
+            outputs[f].doubles.resize(rows);
+        } else {
+            outputs[f].ints.resize(rows);
+        }
+        outputs[f].valid.assign(rows, 1);
+        if (fn.spec.op == WindowOp::Count && (!fn.argument || arguments[f].type != PhysicalType::Int64)) {
+            zeros.resize(rows);  // count() only reads validity
+        }
+    }
+
+    auto evaluatePartition = [&](size_t begin, size_t end, WindowWorker& worker) {
+        for (size_t f = 0; f < boundFunctions.size(); ++f) {
+            const WindowFunctionSpec& spec = boundFunctions[f].spec;
+            const Column& argument = arguments[f];
+            switch (spec.op) {
+                case WindowOp::RowNumber:
+                case WindowOp::Rank:
+                case WindowOp::DenseRank:
+                    evaluateRanks(spec.op, newPeer, begin, end, outputs[f]);
+                    break;
+                default:
+                    if (boundFunctions[f].argument && argument.type == PhysicalType::Double) {
+                        evaluateFrames(spec, argument.doubles.data(), argument, begin, end, outputs[f],
+                                       worker.doubleTree, worker.trees);
+                    } else {
+                        bool ints = boundFunctions[f].argument && argument.type == PhysicalType::Int64;
+                        evaluateFrames(spec, ints ? argument.ints.data() : zeros.data(), argument, begin, end,
+                                       outputs[f], worker.intTree, worker.trees);
+                    }
+                    break;
+            }
+        }
+    };
+
+    // Tasks of whole, consecutive partitions, spread over the workers
+    std::vector<size_t> taskStarts;
+    for (size_t p = 0; p < partitionCount; ++p) {
+        if (taskStarts.empty() || starts[p] - starts[taskStarts.back()] >= kMinRowsPerTask) {
+            taskStarts.push_back(p);
+        }
+    }
+    taskStarts.push_back(partitionCount);
+    size_t taskCount = taskStarts.size() - 1;
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    auto threads = static_cast<uint32_t>(std::clamp<size_t>(taskCount, 1, maxThreads ? maxThreads : hardware));
+    std::vector<WindowWorker> workers(threads);
+    std::atomic<size_t> nextTask{0};
+    auto work = [&](uint32_t worker) {
+        for (size_t t = nextTask++; t < taskCount; t = nextTask++) {
+            for (size_t p = taskStarts[t]; p < taskStarts[t + 1]; ++p) {
+                evaluatePartition(starts[p], starts[p + 1], workers[worker]);
+            }
+        }
+    };
+    {
+        std::vector<std::thread> pool;
+        for (uint32_t t = 1; t < threads; ++t) {
+            pool.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& thread : pool) thread.join();
+    }
+    uint64_t trees = 0;
+    for (const auto& worker : workers) trees += worker.trees;
+    lastThreads = threads;
+    lastPartitions = partitionCount;
+    lastSegmentTrees = trees;
+
+    for (size_t f = 0; f < boundFunctions.size(); ++f) {
+        const Field& field = boundFunctions[f].outputField;
+        FunctionOutput& out = outputs[f];
+        Column column = field.type == PhysicalType::Double ? Column::ofDoubles(std::move(out.doubles))
+                                                           : Column::ofInts(std::move(out.ints));
+        for (size_t r = 0; r < rows; ++r) {
+            if (!out.valid[r]) column.setValid(r, false);
+        }
+        batch.setColumn(field, std::move(column));
+    }
+}
@@ -1,5 +1,14 @@
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "lib.h"
+#include "batch.h"
+#include "catalog.h"
+#include "query_server.h"
 #include "parse_node.h"
 #include "ast_node.h"
 #include "logical_node.h"
@@ -37,7 +46,60 @@ void processNode(const std::string& nodeType, const std::string& inputData) {
     std::cout << logicalNode->explain() << std::endl;
 }
 
-int main() {
+// Synthetic "events" table served by --serve:
+//   id: r   a: r % 13   b: r * 7919 % 10007   kind: one of 5 strings
+std::shared_ptr<const Batch> makeEvents(Catalog& catalog, size_t rows) {
+    static const char* kinds[] = {"click", "view", "purchase", "share", "search"};
+    auto events = std::make_shared<Batch>();
+    events->schema = catalog.makeSchema({{"id", PhysicalType::Int64},
+                                         {"a", PhysicalType::Int64},
+                                         {"b", PhysicalType::Int64},
+                                         {"kind", PhysicalType::String}});
+    std::vector<int64_t> id(rows), a(rows), b(rows);
+    std::vector<std::string> kind(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        id[r] = static_cast<int64_t>(r);
+        a[r] = static_cast<int64_t>(r % 13);
+        b[r] = static_cast<int64_t>(r * 7919 % 10007);
+        kind[r] = kinds[r % 5];
+    }
+    events->columns = {Column::ofInts(std::move(id)), Column::ofInts(std::move(a)), Column::ofInts(std::move(b)),
+                       Column::dictionaryEncode(kind)};
+    return events;
+}
+
+// toy_app --serve <socket> [rows]: serves the events table until SIGINT or SIGTERM
+int serve(const std::string& socketPath, size_t rows) {
+    // Blocked before any thread starts, so only sigwait() sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Catalog catalog;
+    catalog.addTable("events", makeEvents(catalog, rows));
+    QueryServer server(catalog);
+    if (!server.listen(socketPath)) {
+        std::cerr << "cannot listen on " << socketPath << std::endl;
+        return 1;
+    }
+    std::cout << "Serving table \"events\" (" << rows << " rows) on " << socketPath << std::endl;
+    std::cout << "Send lines like: events match a > 2 | sort b:desc | limit 5" << std::endl;
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server.stop();
+    std::cout << "Served " << server.completed() + server.degraded() << " queries (" << server.degraded()
+              << " degraded), rejected " << server.rejected() << ", failed " << server.failed() << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::string_view(argv[1]) == "--serve") {
+        return serve(argv[2], argc >= 4 ? std::strtoull(argv[3], nullptr, 10) : 1000000);
+    }
+
     std::cout << "╔════════════════════════════════════════════╗" << std::endl;
     std::cout << "║  Multi-Type Node Pipeline Demonstration   ║" << std::endl;
     std::cout << "╚════════════════════════════════════════════╝" << std::endl;
@@ -53,7 +115,7 @@ int main() {
     std::cout << "\n✅ All three node types processed successfully!" << std::endl;
     std::cout << "\nKey observations:" << std::endl;
     std::cout << "  • LimitNode: Single int parameter" << std::endl;
-    std::cout << "    - LimitParams { limitValue: int }" << std::endl;
+    std::cout << "    - LimitParams { limitValue: int, offset: int }" << std::endl;
     std::cout << "  • SortNode: Vector of strings + bool" << std::endl;
     std::cout << "    - SortParams { sortKeys: vector<string>, ascending: bool }" << std::endl;
     std::cout << "  • SetMetadataNode: Two strings" << std::endl;
@@ -0,0 +1,407 @@
+#include "metadata_sink.h"
+#include "fingerprint.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr uint64_t kMetadataLogMagic = 0x314c4154454d594full;  // "OYMETAL1"
+constexpr size_t kFrameHeaderSize = sizeof(uint32_t) + sizeof(uint64_t);
+
+template <typename T>
+void storeRaw(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+// Bounds-checked reads over a frame payload
+struct Cursor {
+    std::string_view in;
+    bool ok = true;
+
+    template <typename T>
+    T read() {
+        T v{};
+        if (in.size() < sizeof(T)) {
+            ok = false;
+            return v;
+        }
+        std::memcpy(&v, in.data(), sizeof(T));
+        in.remove_prefix(sizeof(T));
+        return v;
+    }
+
+    std::string_view bytes(size_t n) {
+        if (in.size() < n) {
+            ok = false;
+            return {};
+        }
+        std::string_view v = in.substr(0, n);
+        in.remove_prefix(n);
+        return v;
+    }
+};
+
+// Appends the value of a plain column's row
+void encodeValue(std::string& out, const Column& values, size_t row) {
+    switch (values.type) {
+        case PhysicalType::Bool: storeRaw<uint8_t>(out, values.bools[row]); break;
+        case PhysicalType::Int64: storeRaw<int64_t>(out, values.ints[row]); break;
+        case PhysicalType::Double: storeRaw<double>(out, values.doubles[row]); break;
+        case PhysicalType::String:
+            storeRaw<uint32_t>(out, static_cast<uint32_t>(values.strings[row].size()));
+            out.append(values.strings[row]);
+            break;
+        case PhysicalType::Vector:
+            out.append(reinterpret_cast<const char*>(values.floats.data() + row * values.dimension),
+                       values.dimension * sizeof(float));
+            break;
+    }
+}
+
+// One framed, checksummed write: rows with a null row id are skipped
+std::string encodeFrame(std::string_view name, const Column& rowIds, const Column& values, size_t& rows) {
+    Column ids = rowIds.decoded();
+    Column plain = values.decoded();
+    rows = 0;
+    for (size_t r = 0; r < ids.size(); ++r) rows += ids.isValid(r);
+
+    std::string payload;
+    storeRaw<uint32_t>(payload, static_cast<uint32_t>(name.size()));
+    payload.append(name);
+    storeRaw<uint8_t>(payload, static_cast<uint8_t>(plain.type));
+    storeRaw<uint32_t>(payload, plain.dimension);
+    storeRaw<uint32_t>(payload, static_cast<uint32_t>(rows));
+    for (size_t r = 0; r < ids.size(); ++r) {
+        if (!ids.isValid(r)) continue;
+        storeRaw<int64_t>(payload, ids.ints[r]);
+        storeRaw<uint8_t>(payload, plain.isValid(r));
+        encodeValue(payload, plain, r);
+    }
+
+    std::string frame;
+    frame.reserve(kFrameHeaderSize + payload.size());
+    storeRaw<uint32_t>(frame, static_cast<uint32_t>(payload.size()));
+    storeRaw<uint64_t>(frame, fnv1a64(payload));
+    frame += payload;
+    return frame;
+}
+
+bool decodeFrame(std::string_view payload, MetadataFrame& frame) {
+    Cursor in{payload};
+    frame.name = std::string(in.bytes(in.read<uint32_t>()));
+    auto type = in.read<uint8_t>();
+    uint32_t dimension = in.read<uint32_t>();
+    uint32_t count = in.read<uint32_t>();
+    if (!in.ok || type > static_cast<uint8_t>(PhysicalType::Vector)) {
+        return false;
+    }
+    Column& values = frame.values;
+    values.type = static_cast<PhysicalType>(type);
+    values.dimension = values.type == PhysicalType::Vector ? dimension : 0;
+    std::vector<uint32_t> nulls;
+    for (uint32_t r = 0; r < count && in.ok; ++r) {
+        frame.rowIds.push_back(in.read<int64_t>());
+        if (!in.read<uint8_t>()) nulls.push_back(r);
+        switch (values.type) {
+            case PhysicalType::Bool: values.bools.push_back(in.read<uint8_t>()); break;
+            case PhysicalType::Int64: values.ints.push_back(in.read<int64_t>()); break;
+            case PhysicalType::Double: values.doubles.push_back(in.read<double>()); break;
+            case PhysicalType::String: values.strings.emplace_back(in.bytes(in.read<uint32_t>())); break;
+            case PhysicalType::Vector: {
+                std::string_view raw = in.bytes(size_t{dimension} * sizeof(float));
+                size_t at = values.floats.size();
+                values.floats.resize(at + (in.ok ? dimension : 0));
+                std::memcpy(values.floats.data() + at, raw.data(), raw.size());
+                break;
+            }
+        }
+    }
+    if (!in.ok || !in.in.empty()) {
+        return false;
+    }
+    for (uint32_t r : nulls) values.setValid(r, false);
+    return true;
+}
+
+bool writeAll(int fd, std::string_view bytes) {
+    while (!bytes.empty()) {
+        ssize_t n = ::write(fd, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+}
+
+bool syncParentDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(dirFd) == 0;
+    ::close(dirFd);
+    return ok;
+}
+
+} // namespace
+
+std::optional<MetadataLog> readMetadataLog(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return std::nullopt;
+    }
+    std::string bytes;
+    char buf[1 << 16];
+    for (size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0;) bytes.append(buf, n);
+    std::fclose(f);
+
+    uint64_t magic = 0;
+    if (bytes.size() < sizeof(magic) || (std::memcpy(&magic, bytes.data(), sizeof(magic)), magic != kMetadataLogMagic)) {
+        return std::nullopt;
+    }
+    MetadataLog log;
+    size_t offset = sizeof(magic);
+    while (bytes.size() - offset >= kFrameHeaderSize) {
+        uint32_t length;
+        uint64_t checksum;
+        std::memcpy(&length, bytes.data() + offset, sizeof(length));
+        std::memcpy(&checksum, bytes.data() + offset + sizeof(length), sizeof(checksum));
+        if (bytes.size() - offset - kFrameHeaderSize < length) break;
+        std::string_view payload(bytes.data() + offset + kFrameHeaderSize, length);
+        MetadataFrame frame;
+        if (fnv1a64(payload) != checksum || !decodeFrame(payload, frame)) break;
+        log.frames.push_back(std::move(frame));
+        offset += kFrameHeaderSize + length;
+    }
+    log.validBytes = offset;
+    return log;
+}
+
+MetadataSink::MetadataSink(std::string path, MetadataSinkOptions options)
+    : logPath(std::move(path)), opts(std::move(options)) {
+    if (!openLog()) {
+        failed = true;
+    }
+    writer = std::thread(&MetadataSink::run, this);
+}
+
+MetadataSink::~MetadataSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    if (fd >= 0) ::close(fd);
+}
+
+bool MetadataSink::openLog() {
+    auto log = readMetadataLog(logPath);
+    fd = ::open(logPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        return false;
+    }
+    if (st.st_size == 0) {
+        std::string header;
+        storeRaw<uint64_t>(header, kMetadataLogMagic);
+        if (!writeAll(fd, header)) return false;
+        fileBytes = header.size();
+    } else if (!log) {
+        ::close(fd);  // Not a metadata log: never append to it
+        fd = -1;
+        return false;
+    } else {
+        // Drop a torn tail so new frames follow an intact one
+        if (log->validBytes < static_cast<size_t>(st.st_size) &&
+            ::ftruncate(fd, static_cast<off_t>(log->validBytes)) != 0) {
+            return false;
+        }
+        fileBytes = log->validBytes;
+    }
+    compactedBytes = fileBytes;
+    return ::lseek(fd, 0, SEEK_END) >= 0;
+}
+
+void MetadataSink::write(std::string_view name, const Column& rowIds, const Column& values) {
+    size_t rows = 0;
+    std::string frame = encodeFrame(name, rowIds, values, rows);
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) {
+            oldestPending = std::chrono::steady_clock::now();
+        }
+        notify = pending.empty() || (pendingRows < opts.maxBatchRows && pendingRows + rows >= opts.maxBatchRows);
+        pending += frame;
+        pendingRows += rows;
+        ++queuedSequence;
+    }
+    // The writer needs waking to start its latency timer or to commit early
+    if (notify) wake.notify_one();
+}
+
+bool MetadataSink::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = queuedSequence;
+    if (committedSequence < target) {
+        flushRequested = true;
+        wake.notify_one();
+        committed.wait(lock, [&] { return committedSequence >= target; });
+    }
+    return !failed;
+}
+
+bool MetadataSink::compact() {
+    if (!flush()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> file(fileMutex);
+    return compactLocked();
+}
+
+size_t MetadataSink::commits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return commitCount;
+}
+
+size_t MetadataSink::rowsCommitted() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return committedRows;
+}
+
+size_t MetadataSink::compactions() const {
+    std::lock_guard<std::mutex> file(fileMutex);
+    return compactionCount;
+}
+
+size_t MetadataSink::compactionFailures() const {
+    std::lock_guard<std::mutex> file(fileMutex);
+    return compactionFailureCount;
+}
+
+size_t MetadataSink::logBytes() const {
+    std::lock_guard<std::mutex> file(fileMutex);
+    return fileBytes;
+}
+
+void MetadataSink::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (pending.empty()) {
+            if (stopping) break;
+            wake.wait(lock, [&] { return stopping || !pending.empty(); });
+            continue;
+        }
+        // Returns early for a full group, a flush or shutdown; otherwise
+        // the oldest write has waited long enough
+        wake.wait_until(lock, oldestPending + opts.maxLatency,
+                        [&] { return stopping || flushRequested || pendingRows >= opts.maxBatchRows; });
+
+        std::string frames;
+        frames.swap(pending);
+        size_t rows = std::exchange(pendingRows, 0);
+        uint64_t sequence = queuedSequence;
+        flushRequested = false;
+        bool ok = !failed;
+        lock.unlock();
+
+        if (ok) {
+            std::lock_guard<std::mutex> file(fileMutex);
+            ok = append(frames);
+            // The group is durable by now: a failed compaction only delays
+            // the next attempt until the log has doubled again
+            if (ok && fileBytes >= opts.compactBytes && fileBytes >= 2 * compactedBytes && !compactLocked()) {
+                std::fprintf(stderr, "metadata sink: compacting %s failed, retrying when the log doubles\n",
+                             logPath.c_str());
+                compactedBytes = fileBytes;
+                ++compactionFailureCount;
+            }
+        }
+
+        lock.lock();
+        if (ok) {
+            ++commitCount;
+            committedRows += rows;
+        } else {
+            failed = true;
+        }
+        committedSequence = sequence;
+        committed.notify_all();
+    }
+}
+
+bool MetadataSink::append(const std::string& frames) {
+    if (fd < 0 || !writeAll(fd, frames)) {
+        return false;
+    }
+    fileBytes += frames.size();
+    return !opts.sync || ::fdatasync(fd) == 0;
+}
+
+bool MetadataSink::compactLocked() {
+    auto log = readMetadataLog(logPath);
+    if (fd < 0 || !log) {
+        return false;
+    }
+    // Latest (frame, row) of every (name, row id)
+    std::unordered_map<std::string, std::unordered_map<int64_t, std::pair<uint32_t, uint32_t>>> latest;
+    for (uint32_t f = 0; f < log->frames.size(); ++f) {
+        auto& rows = latest[log->frames[f].name];
+        for (uint32_t r = 0; r < log->frames[f].rowIds.size(); ++r) {
+            rows[log->frames[f].rowIds[r]] = {f, r};
+        }
+    }
+    std::vector<SelectionVector> live(log->frames.size());
+    for (const auto& [name, rows] : latest) {
+        for (const auto& [rowId, at] : rows) live[at.first].push_back(at.second);
+    }
+
+    std::string out;
+    storeRaw<uint64_t>(out, kMetadataLogMagic);
+    for (size_t f = 0; f < log->frames.size(); ++f) {
+        if (live[f].empty()) continue;
+        std::sort(live[f].begin(), live[f].end());
+        const MetadataFrame& frame = log->frames[f];
+        std::vector<int64_t> ids;
+        for (uint32_t r : live[f]) ids.push_back(frame.rowIds[r]);
+        size_t rows = 0;
+        out += encodeFrame(frame.name, Column::ofInts(std::move(ids)), frame.values.select(live[f]), rows);
+    }
+
+    // Write aside and rename, so a crash leaves either log intact
+    std::string tmpPath = logPath + ".compact";
+    int tmp = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (tmp < 0) {
+        return false;
+    }
+    bool ok = writeAll(tmp, out) && (!opts.sync || ::fdatasync(tmp) == 0);
+    if (!ok || std::rename(tmpPath.c_str(), logPath.c_str()) != 0) {
+        ::close(tmp);
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    ::close(fd);
+    fd = tmp;
+    fileBytes = out.size();
+    compactedBytes = fileBytes;
+    ++compactionCount;
+    // The rename is only durable once the directory entry is
+    return !opts.sync || syncParentDirectory(logPath);
+}
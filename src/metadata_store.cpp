@@ -0,0 +1,242 @@
+#include "metadata_store.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+
+// splitmix64 finalizer over both key parts
+uint64_t slotHash(int64_t rowId, SymbolId name) {
+    uint64_t x = static_cast<uint64_t>(rowId) ^ (uint64_t{name} << 40) ^ 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Value of one row of a plain column
+MetadataValue valueAt(const Column& column, size_t row) {
+    MetadataValue value;
+    value.type = column.type;
+    value.valid = column.isValid(row);
+    switch (column.type) {
+        case PhysicalType::Bool: value.boolValue = column.bools[row]; break;
+        case PhysicalType::Int64: value.intValue = column.ints[row]; break;
+        case PhysicalType::Double: value.doubleValue = column.doubles[row]; break;
+        case PhysicalType::String: value.stringValue = column.strings[row]; break;
+        case PhysicalType::Vector:
+            value.vectorValue.assign(column.floats.begin() + row * column.dimension,
+                                     column.floats.begin() + (row + 1) * column.dimension);
+            break;
+    }
+    return value;
+}
+
+// Each thread starts looking for a free reader record at its own index, so
+// with fewer threads than records the first attempt always succeeds
+std::atomic<size_t> nextReaderHint{0};
+
+size_t readerHint() {
+    thread_local size_t hint = nextReaderHint.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+} // namespace
+
+MetadataStore::MetadataStore(size_t initialCapacity)
+    : table(new Table(std::bit_ceil(std::max<size_t>(initialCapacity, 16)))) {}
+
+MetadataStore::~MetadataStore() {
+    Table* current = table.load();
+    for (size_t i = 0; i <= current->mask; ++i) {
+        delete current->slots[i].value.load();
+    }
+    delete current;
+    for (ReaderRecord* record = overflowReaders.load(); record;) {
+        delete std::exchange(record, record->next);
+    }
+}
+
+MetadataStore::ReadGuard::ReadGuard(const MetadataStore& store) {
+    // seq_cst: a writer that then scans the records either sees this epoch
+    // or retired what it replaced before this read began
+    auto claim = [&](ReaderRecord& candidate) {
+        uint64_t idle = 0;
+        return candidate.epoch.compare_exchange_strong(idle, store.epoch.load());
+    };
+    size_t hint = readerHint();
+    for (size_t i = 0; i < kReaderRecords; ++i) {
+        ReaderRecord& candidate = store.readers[(hint + i) % kReaderRecords];
+        if (claim(candidate)) {
+            record = &candidate;
+            return;
+        }
+    }
+    for (ReaderRecord* candidate = store.overflowReaders.load(); candidate; candidate = candidate->next) {
+        if (claim(*candidate)) {
+            record = candidate;
+            return;
+        }
+    }
+    // Every record is busy: announce on a new one. Pushing it is the
+    // announcement, so a writer that misses it retired nothing this read
+    // can reach
+    record = new ReaderRecord;
+    record->epoch.store(store.epoch.load(), std::memory_order_relaxed);
+    record->next = store.overflowReaders.load();
+    while (!store.overflowReaders.compare_exchange_weak(record->next, record)) {
+    }
+    store.overflowCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetadataStore::ReadGuard::~ReadGuard() {
+    record->epoch.store(0, std::memory_order_release);
+}
+
+MetadataStore::Slot* MetadataStore::probe(const Table& table, int64_t rowId, SymbolId name) {
+    // The table is at most half full, so an empty slot ends every probe
+    for (size_t i = slotHash(rowId, name) & table.mask;; i = (i + 1) & table.mask) {
+        Slot& slot = table.slots[i];
+        if (!slot.used.load(std::memory_order_acquire)) {
+            return &slot;
+        }
+        if (slot.rowId == rowId && slot.name == name) {
+            return &slot;
+        }
+    }
+}
+
+std::optional<MetadataValue> MetadataStore::find(int64_t rowId, SymbolId name) const {
+    ReadGuard guard(*this);
+    const Slot* slot = probe(*table.load(), rowId, name);
+    if (!slot->used.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    return *slot->value.load();
+}
+
+Column MetadataStore::gather(SymbolId name, PhysicalType type, const Column& rowIds) const {
+    Column ids = rowIds.decoded();
+    size_t rows = ids.size();
+    Column out;
+    out.type = type;
+    std::vector<bool> found(rows, false);
+    {
+        ReadGuard guard(*this);
+        const Table& current = *table.load();
+        for (size_t r = 0; r < rows; ++r) {
+            const Slot* slot = ids.isValid(r) ? probe(current, ids.ints[r], name) : nullptr;
+            const MetadataValue* value =
+                slot && slot->used.load(std::memory_order_acquire) ? slot->value.load() : nullptr;
+            if (value && (value->type != type || (type == PhysicalType::Vector && out.dimension &&
+                                                  value->vectorValue.size() != out.dimension))) {
+                value = nullptr;
+            }
+            found[r] = value && value->valid;
+            switch (type) {
+                case PhysicalType::Bool: out.bools.push_back(value ? value->boolValue : 0); break;
+                case PhysicalType::Int64: out.ints.push_back(value ? value->intValue : 0); break;
+                case PhysicalType::Double: out.doubles.push_back(value ? value->doubleValue : 0); break;
+                case PhysicalType::String: out.strings.push_back(value ? value->stringValue : std::string()); break;
+                case PhysicalType::Vector:
+                    if (value && !out.dimension) {
+                        out.dimension = static_cast<uint32_t>(value->vectorValue.size());
+                        out.floats.resize(r * out.dimension, 0.0f);
+                    }
+                    if (value) {
+                        out.floats.insert(out.floats.end(), value->vectorValue.begin(), value->vectorValue.end());
+                    } else {
+                        out.floats.resize(out.floats.size() + out.dimension, 0.0f);
+                    }
+                    break;
+            }
+        }
+    }
+    if (type == PhysicalType::Vector && !out.dimension) {
+        out.dimension = 1;  // No row had a value; keep size() == rows
+        out.floats.assign(rows, 0.0f);
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        if (!found[r]) out.setValid(r, false);
+    }
+    return out;
+}
+
+void MetadataStore::insert(SymbolId name, const Column& rowIds, const Column& values) {
+    Column ids = rowIds.decoded();
+    Column plain = values.decoded();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    uint64_t retireEpoch = epoch.load();
+    for (size_t r = 0; r < ids.size(); ++r) {
+        if (!ids.isValid(r)) continue;
+        if (2 * (used + 1) > table.load()->mask + 1) {
+            grow();
+        }
+        Slot* slot = probe(*table.load(), ids.ints[r], name);
+        auto* value = new MetadataValue(valueAt(plain, r));
+        if (slot->used.load(std::memory_order_relaxed)) {
+            // seq_cst like the reader records, so a reader that reclaim()
+            // finds idle and that starts afterwards sees the new value
+            const MetadataValue* old = slot->value.exchange(value);
+            retiredValues.emplace_back(retireEpoch, old);
+            continue;
+        }
+        slot->rowId = ids.ints[r];
+        slot->name = name;
+        slot->value.store(value, std::memory_order_relaxed);
+        slot->used.store(true, std::memory_order_release);
+        ++used;
+    }
+    // Readers that start from here on cannot reach what this batch retired
+    epoch.fetch_add(1);
+    reclaim();
+}
+
+void MetadataStore::grow() {
+    Table* old = table.load();
+    auto grown = std::make_unique<Table>(2 * (old->mask + 1));
+    for (size_t i = 0; i <= old->mask; ++i) {
+        const Slot& from = old->slots[i];
+        if (!from.used.load(std::memory_order_relaxed)) continue;
+        Slot* to = probe(*grown, from.rowId, from.name);
+        to->rowId = from.rowId;
+        to->name = from.name;
+        to->value.store(from.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to->used.store(true, std::memory_order_relaxed);
+    }
+    // Values move to the new table; the old one only holds their pointers
+    table.store(grown.release());
+    retiredTables.emplace_back(epoch.load(), old);
+}
+
+void MetadataStore::reclaim() {
+    uint64_t oldestReader = std::numeric_limits<uint64_t>::max();
+    for (const auto& reader : readers) {
+        if (uint64_t e = reader.epoch.load()) oldestReader = std::min(oldestReader, e);
+    }
+    for (const ReaderRecord* reader = overflowReaders.load(); reader; reader = reader->next) {
+        if (uint64_t e = reader->epoch.load()) oldestReader = std::min(oldestReader, e);
+    }
+    // A reader in epoch e may hold anything retired in epoch e or later
+    auto freeable = [&](const auto& retired) { return retired.first < oldestReader; };
+    std::erase_if(retiredValues, freeable);
+    std::erase_if(retiredTables, freeable);
+}
+
+size_t MetadataStore::size() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return used;
+}
+
+size_t MetadataStore::capacity() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return table.load()->mask + 1;
+}
+
+size_t MetadataStore::readerRecords() const {
+    return kReaderRecords + overflowCount.load(std::memory_order_relaxed);
+}
+
+size_t MetadataStore::retired() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return retiredValues.size() + retiredTables.size();
+}
@@ -6,6 +6,13 @@
 #include "src/ast_nodes/limit_ast_node.h"
 #include "src/ast_nodes/sort_ast_node.h"
 #include "src/ast_nodes/set_metadata_ast_node.h"
+#include "src/ast_nodes/group_ast_node.h"
+#include "src/ast_nodes/match_ast_node.h"
+#include "src/ast_nodes/project_ast_node.h"
+#include "src/ast_nodes/join_ast_node.h"
+#include "src/ast_nodes/window_ast_node.h"
+#include "src/ast_nodes/distinct_ast_node.h"
+#include <type_traits>
 #include <variant>
 
 // Generate createAstNode specializations for all node types
@@ -29,3 +36,101 @@ std::unique_ptr<AstNode> parseToAst(const ParseNode& parseNode) {
         return createAstNode(p);
     }, params);
 }
+
+// Per-type interning. Param types without field names use the no-op fallback.
+template <typename T>
+static void internFields(T&, SymbolTable&) {}
+
+static void internFields(SortParams& params, SymbolTable& symbols) {
+    params.sortKeyIds.clear();
+    params.sortKeyIds.reserve(params.sortKeys.size());
+    for (const auto& key : params.sortKeys) {
+        params.sortKeyIds.push_back(symbols.intern(key));
+    }
+}
+
+static void internFields(SetMetadataParams& params, SymbolTable& symbols) {
+    params.metaNameId = symbols.intern(params.metaName);
+}
+
+static void internFields(GroupParams& params, SymbolTable& symbols) {
+    params.groupKeyIds.clear();
+    params.groupKeyIds.reserve(params.groupKeys.size());
+    for (const auto& key : params.groupKeys) {
+        params.groupKeyIds.push_back(symbols.intern(key));
+    }
+    for (auto& agg : params.aggregates) {
+        agg.nameId = symbols.intern(agg.name);
+    }
+}
+
+static void internFields(ProjectParams& params, SymbolTable& symbols) {
+    params.fieldIds.clear();
+    params.fieldIds.reserve(params.fields.size());
+    for (const auto& field : params.fields) {
+        params.fieldIds.push_back(symbols.intern(field));
+    }
+}
+
+static void internFields(JoinParams& params, SymbolTable& symbols) {
+    params.probeKeyId = symbols.intern(params.probeKey);
+    params.buildKeyId = symbols.intern(params.buildKey);
+}
+
+static void internFields(WindowParams& params, SymbolTable& symbols) {
+    params.partitionKeyIds.clear();
+    for (const auto& key : params.partitionKeys) {
+        params.partitionKeyIds.push_back(symbols.intern(key));
+    }
+    params.orderKeyIds.clear();
+    for (const auto& key : params.orderKeys) {
+        params.orderKeyIds.push_back(symbols.intern(key));
+    }
+    for (auto& fn : params.functions) {
+        fn.nameId = symbols.intern(fn.name);
+    }
+}
+
+static void internFields(DistinctParams& params, SymbolTable& symbols) {
+    params.keyIds.clear();
+    params.keyIds.reserve(params.keys.size());
+    for (const auto& key : params.keys) {
+        params.keyIds.push_back(symbols.intern(key));
+    }
+    params.approxCountNameId = params.approxCountName.empty() ? kInvalidSymbol
+                                                              : symbols.intern(params.approxCountName);
+}
+
+void internSymbols(AstParams& params, SymbolTable& symbols) {
+    std::visit([&symbols](auto& p) { internFields(p, symbols); }, params);
+}
+
+static std::expected<std::unique_ptr<AstNode>, Diagnostic> tryCreateAstNode(const AstParams& params) {
+    return std::visit([](const auto& p) -> std::expected<std::unique_ptr<AstNode>, Diagnostic> {
+        using T = std::decay_t<decltype(p)>;
+        if constexpr (std::is_same_v<T, __AstParams_TrailingComma_Sentinel>) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnsupportedParams});
+        } else {
+            return createAstNode(p);
+        }
+    }, params);
+}
+
+std::expected<std::unique_ptr<AstNode>, Diagnostic> tryParseToAst(const ParseNode& parseNode) {
+    return tryCreateAstNode(parseNode.astParams());
+}
+
+std::unique_ptr<AstNode> parseToAst(const ParseNode& parseNode, Catalog& catalog) {
+    AstParams params = parseNode.astParams();
+    internSymbols(params, catalog.symbols);
+    return std::visit([](const auto& p) {
+        return createAstNode(p);
+    }, params);
+}
+
+std::expected<std::unique_ptr<AstNode>, Diagnostic> tryParseToAst(const ParseNode& parseNode,
+                                                                   Catalog& catalog) {
+    AstParams params = parseNode.astParams();
+    internSymbols(params, catalog.symbols);
+    return tryCreateAstNode(params);
+}
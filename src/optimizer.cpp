@@ -0,0 +1,17 @@
+#include "optimizer.h"
+#include "catalog.h"
+#include "column_pruning.h"
+#include "expression_optimizer.h"
+#include "pipeline.h"
+#include "predicate_pushdown.h"
+#include "sorted_input.h"
+#include "top_k_fusion.h"
+
+void optimizePipeline(Pipeline& pipeline, Catalog& catalog) {
+    pushDownMatches(pipeline);
+    optimizeSetMetadataExpressions(pipeline, catalog.symbols);
+    pushDownJoinFilters(pipeline);
+    pruneColumns(pipeline);
+    fuseScoreTopK(pipeline);
+    markSortedInputs(pipeline);
+}
@@ -0,0 +1,143 @@
+#include "packed_ints.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <utility>
+
+namespace {
+
+size_t blockCount(size_t rows) {
+    return (rows + kPackedBlockRows - 1) / kPackedBlockRows;
+}
+
+// Unpacks one full block of 64 deltas. W is a compile-time constant, so the
+// shifts and word indexes are constants after unrolling.
+template <unsigned W>
+void unpackBlock(const uint64_t* in, uint64_t* out) {
+    if constexpr (W == 0) {
+        std::fill(out, out + kPackedBlockRows, 0);
+    } else if constexpr (W == 64) {
+        std::copy(in, in + kPackedBlockRows, out);
+    } else {
+        constexpr uint64_t mask = (uint64_t{1} << W) - 1;
+        for (unsigned j = 0; j < kPackedBlockRows; ++j) {
+            unsigned bit = j * W;
+            unsigned word = bit / 64;
+            unsigned shift = bit % 64;
+            uint64_t value = in[word] >> shift;
+            if (shift + W > 64) {
+                value |= in[word + 1] << (64 - shift);
+            }
+            out[j] = value & mask;
+        }
+    }
+}
+
+using UnpackBlockFn = void (*)(const uint64_t*, uint64_t*);
+
+template <size_t... W>
+constexpr std::array<UnpackBlockFn, sizeof...(W)> makeUnpackTable(std::index_sequence<W...>) {
+    return {&unpackBlock<W>...};
+}
+
+constexpr auto kUnpackBlock = makeUnpackTable(std::make_index_sequence<65>{});
+
+} // namespace
+
+PackedInts PackedInts::pack(const std::vector<int64_t>& values) {
+    if (values.empty()) {
+        return {};
+    }
+    auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+    uint64_t range = static_cast<uint64_t>(*hi) - static_cast<uint64_t>(*lo);
+    return packWithFrame(values.data(), values.size(), *lo, static_cast<uint8_t>(std::bit_width(range)));
+}
+
+PackedInts PackedInts::packWithFrame(const int64_t* values, size_t count, int64_t base, uint8_t bitWidth) {
+    PackedInts packed;
+    packed.base = base;
+    packed.bitWidth = bitWidth;
+    packed.count = count;
+    packed.words.assign(blockCount(count) * bitWidth, 0);
+    if (bitWidth == 0) {
+        return packed;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t delta = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(base);
+        size_t bit = (i / kPackedBlockRows) * kPackedBlockRows * bitWidth + (i % kPackedBlockRows) * bitWidth;
+        size_t word = bit / 64;
+        unsigned shift = bit % 64;
+        packed.words[word] |= delta << shift;
+        if (shift + bitWidth > 64) {
+            packed.words[word + 1] |= delta >> (64 - shift);
+        }
+    }
+    return packed;
+}
+
+uint64_t PackedInts::deltaAt(size_t row) const {
+    if (bitWidth == 0) {
+        return 0;
+    }
+    size_t bit = (row / kPackedBlockRows) * kPackedBlockRows * bitWidth + (row % kPackedBlockRows) * bitWidth;
+    size_t word = bit / 64;
+    unsigned shift = bit % 64;
+    uint64_t value = words[word] >> shift;
+    if (shift + bitWidth > 64) {
+        value |= words[word + 1] << (64 - shift);
+    }
+    return value & maxDelta();
+}
+
+void PackedInts::unpackDeltas(size_t begin, size_t n, uint64_t* out) const {
+    UnpackBlockFn unpackFn = kUnpackBlock[bitWidth];
+    uint64_t scratch[kPackedBlockRows];
+    size_t end = begin + n;
+    size_t row = begin;
+    while (row < end) {
+        size_t block = row / kPackedBlockRows;
+        size_t offset = row % kPackedBlockRows;
+        size_t take = std::min(kPackedBlockRows - offset, end - row);
+        const uint64_t* in = words.data() + block * bitWidth;
+        if (offset == 0 && take == kPackedBlockRows) {
+            unpackFn(in, out);  // Whole block straight into the output
+        } else {
+            unpackFn(in, scratch);
+            std::copy(scratch + offset, scratch + offset + take, out);
+        }
+        out += take;
+        row += take;
+    }
+}
+
+void PackedInts::unpack(size_t begin, size_t n, int64_t* out) const {
+    // Unpack deltas in place, then add the frame; both loops vectorize
+    auto* deltas = reinterpret_cast<uint64_t*>(out);
+    unpackDeltas(begin, n, deltas);
+    uint64_t frame = static_cast<uint64_t>(base);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<int64_t>(frame + deltas[i]);
+    }
+}
+
+std::vector<int64_t> PackedInts::unpackAll() const {
+    std::vector<int64_t> values(count);
+    unpack(0, count, values.data());
+    return values;
+}
+
+PackedInts PackedInts::select(const std::vector<uint32_t>& rows) const {
+    std::vector<int64_t> values(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        values[i] = at(rows[i]);
+    }
+    return packWithFrame(values.data(), values.size(), base, bitWidth);
+}
+
+void PackedInts::truncate(size_t rows) {
+    if (rows >= count) {
+        return;
+    }
+    count = rows;
+    words.resize(blockCount(rows) * bitWidth);
+}
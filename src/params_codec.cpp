@@ -0,0 +1,304 @@
+#include "params_codec.h"
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+struct Writer {
+    std::string out;
+
+    void u8(uint8_t v) { out.push_back(static_cast<char>(v)); }
+
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+        }
+    }
+
+    void i64(int64_t v) {
+        auto u = static_cast<uint64_t>(v);
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((u >> (8 * i)) & 0xff));
+        }
+    }
+
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        out.append(s);
+    }
+};
+
+struct Reader {
+    std::string_view in;
+    bool ok = true;
+
+    bool need(size_t n) {
+        if (in.size() < n) {
+            ok = false;
+        }
+        return ok;
+    }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        uint8_t v = static_cast<uint8_t>(in[0]);
+        in.remove_prefix(1);
+        return v;
+    }
+
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            v |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        }
+        in.remove_prefix(4);
+        return v;
+    }
+
+    int64_t i64() {
+        if (!need(8)) return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        }
+        in.remove_prefix(8);
+        return static_cast<int64_t>(v);
+    }
+
+    std::string str() {
+        uint32_t len = u32();
+        if (!need(len)) return {};
+        std::string s(in.substr(0, len));
+        in.remove_prefix(len);
+        return s;
+    }
+};
+
+// Per-type field encoding. Adding a node type to ast_node_types.def
+// requires a matching encode/decode pair here.
+void encodeFields(Writer& w, const LimitParams& p) {
+    w.i64(p.limitValue);
+    w.i64(p.offset);
+}
+
+void decodeFields(Reader& r, LimitParams& p) {
+    p.limitValue = static_cast<int>(r.i64());
+    p.offset = static_cast<int>(r.i64());
+}
+
+void encodeFields(Writer& w, const SortParams& p) {
+    w.u32(static_cast<uint32_t>(p.sortKeys.size()));
+    for (const auto& key : p.sortKeys) {
+        w.str(key);
+    }
+    w.u8(p.ascending ? 1 : 0);
+    w.u8(p.nullsFirst ? 1 : 0);
+}
+
+void decodeFields(Reader& r, SortParams& p) {
+    uint32_t count = r.u32();
+    // Each key needs at least its 4-byte length prefix
+    if (!r.need(static_cast<size_t>(count) * 4)) return;
+    p.sortKeys.reserve(count);
+    for (uint32_t i = 0; i < count && r.ok; ++i) {
+        p.sortKeys.push_back(r.str());
+    }
+    p.ascending = r.u8() != 0;
+    p.nullsFirst = r.u8() != 0;
+}
+
+void encodeFields(Writer& w, const SetMetadataParams& p) {
+    w.str(p.metaName);
+    w.str(p.expression);
+}
+
+void decodeFields(Reader& r, SetMetadataParams& p) {
+    p.metaName = r.str();
+    p.expression = r.str();
+}
+
+void encodeFields(Writer& w, const GroupParams& p) {
+    w.u32(static_cast<uint32_t>(p.groupKeys.size()));
+    for (const auto& key : p.groupKeys) {
+        w.str(key);
+    }
+    w.u32(static_cast<uint32_t>(p.aggregates.size()));
+    for (const auto& agg : p.aggregates) {
+        w.str(agg.name);
+        w.u8(static_cast<uint8_t>(agg.op));
+        w.str(agg.argument);
+    }
+}
+
+void decodeFields(Reader& r, GroupParams& p) {
+    uint32_t keyCount = r.u32();
+    if (!r.need(static_cast<size_t>(keyCount) * 4)) return;
+    p.groupKeys.reserve(keyCount);
+    for (uint32_t i = 0; i < keyCount && r.ok; ++i) {
+        p.groupKeys.push_back(r.str());
+    }
+    uint32_t aggCount = r.u32();
+    // Each aggregate needs two length prefixes and its op byte
+    if (!r.need(static_cast<size_t>(aggCount) * 9)) return;
+    p.aggregates.reserve(aggCount);
+    for (uint32_t i = 0; i < aggCount && r.ok; ++i) {
+        AggregateSpec agg;
+        agg.name = r.str();
+        uint8_t op = r.u8();
+        if (op > static_cast<uint8_t>(AggregateOp::Avg)) {
+            r.ok = false;
+            return;
+        }
+        agg.op = static_cast<AggregateOp>(op);
+        agg.argument = r.str();
+        p.aggregates.push_back(std::move(agg));
+    }
+}
+
+void encodeFields(Writer& w, const MatchParams& p) {
+    w.str(p.predicate);
+}
+
+void decodeFields(Reader& r, MatchParams& p) {
+    p.predicate = r.str();
+}
+
+void encodeFields(Writer& w, const ProjectParams& p) {
+    w.u32(static_cast<uint32_t>(p.fields.size()));
+    for (const auto& field : p.fields) {
+        w.str(field);
+    }
+    w.u8(p.inputOrder ? 1 : 0);
+}
+
+void decodeFields(Reader& r, ProjectParams& p) {
+    uint32_t count = r.u32();
+    if (!r.need(static_cast<size_t>(count) * 4)) return;
+    p.fields.reserve(count);
+    for (uint32_t i = 0; i < count && r.ok; ++i) {
+        p.fields.push_back(r.str());
+    }
+    p.inputOrder = r.u8() != 0;
+}
+
+void encodeFields(Writer& w, const JoinParams& p) {
+    w.str(p.table);
+    w.str(p.probeKey);
+    w.str(p.buildKey);
+}
+
+void decodeFields(Reader& r, JoinParams& p) {
+    p.table = r.str();
+    p.probeKey = r.str();
+    p.buildKey = r.str();
+}
+
+void encodeFields(Writer& w, const WindowParams& p) {
+    for (const auto* keys : {&p.partitionKeys, &p.orderKeys}) {
+        w.u32(static_cast<uint32_t>(keys->size()));
+        for (const auto& key : *keys) {
+            w.str(key);
+        }
+    }
+    w.u8(p.ascending ? 1 : 0);
+    w.u32(static_cast<uint32_t>(p.functions.size()));
+    for (const auto& fn : p.functions) {
+        w.str(fn.name);
+        w.u8(static_cast<uint8_t>(fn.op));
+        w.str(fn.argument);
+        w.u8(static_cast<uint8_t>((fn.startUnbounded ? 1 : 0) | (fn.endUnbounded ? 2 : 0)));
+        w.i64(fn.frameStart);
+        w.i64(fn.frameEnd);
+    }
+}
+
+void decodeFields(Reader& r, WindowParams& p) {
+    for (auto* keys : {&p.partitionKeys, &p.orderKeys}) {
+        uint32_t count = r.u32();
+        if (!r.need(static_cast<size_t>(count) * 4)) return;
+        keys->reserve(count);
+        for (uint32_t i = 0; i < count && r.ok; ++i) {
+            keys->push_back(r.str());
+        }
+    }
+    p.ascending = r.u8() != 0;
+    uint32_t fnCount = r.u32();
+    // Each function needs two length prefixes, two bytes and two offsets
+    if (!r.need(static_cast<size_t>(fnCount) * 26)) return;
+    p.functions.reserve(fnCount);
+    for (uint32_t i = 0; i < fnCount && r.ok; ++i) {
+        WindowFunctionSpec fn;
+        fn.name = r.str();
+        uint8_t op = r.u8();
+        if (op > static_cast<uint8_t>(WindowOp::Avg)) {
+            r.ok = false;
+            return;
+        }
+        fn.op = static_cast<WindowOp>(op);
+        fn.argument = r.str();
+        uint8_t unbounded = r.u8();
+        fn.startUnbounded = (unbounded & 1) != 0;
+        fn.endUnbounded = (unbounded & 2) != 0;
+        fn.frameStart = r.i64();
+        fn.frameEnd = r.i64();
+        p.functions.push_back(std::move(fn));
+    }
+}
+
+void encodeFields(Writer& w, const DistinctParams& p) {
+    w.u32(static_cast<uint32_t>(p.keys.size()));
+    for (const auto& key : p.keys) {
+        w.str(key);
+    }
+    w.str(p.approxCountName);
+}
+
+void decodeFields(Reader& r, DistinctParams& p) {
+    uint32_t count = r.u32();
+    if (!r.need(static_cast<size_t>(count) * 4)) return;
+    p.keys.reserve(count);
+    for (uint32_t i = 0; i < count && r.ok; ++i) {
+        p.keys.push_back(r.str());
+    }
+    p.approxCountName = r.str();
+}
+
+void encodeFields(Writer&, const __AstParams_TrailingComma_Sentinel&) {}
+void decodeFields(Reader& r, __AstParams_TrailingComma_Sentinel&) { r.ok = false; }
+
+template <size_t I>
+bool decodeAlternative(size_t index, Reader& r, AstParams& out) {
+    if constexpr (I < std::variant_size_v<AstParams>) {
+        if (index == I) {
+            std::variant_alternative_t<I, AstParams> params;
+            decodeFields(r, params);
+            out = std::move(params);
+            return r.ok;
+        }
+        return decodeAlternative<I + 1>(index, r, out);
+    } else {
+        return false;
+    }
+}
+
+} // namespace
+
+std::string encodeParams(const AstParams& params) {
+    Writer w;
+    w.u8(static_cast<uint8_t>(params.index()));
+    std::visit([&w](const auto& p) { encodeFields(w, p); }, params);
+    return std::move(w.out);
+}
+
+std::optional<AstParams> decodeParams(std::string_view bytes) {
+    Reader r{bytes};
+    size_t index = r.u8();
+    AstParams params;
+    if (!r.ok || !decodeAlternative<0>(index, r, params) || !r.in.empty()) {
+        return std::nullopt;
+    }
+    return params;
+}
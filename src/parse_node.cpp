@@ -1,10 +1,11 @@
 #include "parse_node.h"
 #include <map>
 #include <iostream>
+#include <stdexcept>
 
 // Function-local static to guarantee initialization order
-std::map<std::string, ParseNodeFactory>& getParserMap() {
-    static std::map<std::string, ParseNodeFactory> parserMap;
+std::map<std::string, ParseNodeFactory, std::less<>>& getParserMap() {
+    static std::map<std::string, ParseNodeFactory, std::less<>> parserMap;
     return parserMap;
 }
 
@@ -13,11 +14,85 @@ void registerParseNode(std::string name, ParseNodeFactory factory) {
     getParserMap().emplace(name, factory);
 }
 
-std::unique_ptr<ParseNode> createParseNodeFromInput(std::string name, std::string argString) {
+ParseNodeResult tryCreateParseNodeFromInput(std::string_view name, std::string_view argString) {
     auto& parserMap = getParserMap();
     auto it = parserMap.find(name);
     if (it == parserMap.end()) {
-        throw std::runtime_error("Unknown parse node type: " + name);
+        return std::unexpected(Diagnostic{DiagnosticCode::UnknownNodeType, 0,
+                                          static_cast<uint32_t>(name.size())});
     }
     return it->second(argString);
 }
+
+std::unique_ptr<ParseNode> createParseNodeFromInput(std::string name, std::string argString) {
+    auto result = tryCreateParseNodeFromInput(name, argString);
+    if (!result) {
+        if (result.error().code == DiagnosticCode::UnknownNodeType) {
+            throw std::runtime_error("Unknown parse node type: " + name);
+        }
+        throw std::runtime_error(formatDiagnostic(result.error(), argString));
+    }
+    return std::move(*result);
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Position of the next stage separator: a '|' outside string literals,
+// parentheses and brackets. An unterminated literal or bracket runs to the
+// end, for the stage's own parser to report.
+static size_t findStageEnd(std::string_view text, size_t from) {
+    bool quoted = false;
+    size_t depth = 0;
+    for (size_t i = from; i < text.size(); ++i) {
+        char c = text[i];
+        if (quoted) {
+            if (c == '\\') ++i;
+            else if (c == '"') quoted = false;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if (c == '|' && depth == 0) {
+            return i;
+        }
+    }
+    return text.size();
+}
+
+std::expected<std::vector<std::unique_ptr<ParseNode>>, Diagnostic>
+tryParsePipeline(std::string_view text) {
+    std::vector<std::unique_ptr<ParseNode>> stages;
+    size_t stageBegin = 0;
+    while (stageBegin <= text.size()) {
+        size_t stageEnd = findStageEnd(text, stageBegin);
+
+        // Trim the stage and split "<name> <args>"
+        size_t begin = stageBegin;
+        size_t end = stageEnd;
+        while (begin < end && isSpace(text[begin])) ++begin;
+        while (end > begin && isSpace(text[end - 1])) --end;
+        if (begin == end) {
+            return std::unexpected(Diagnostic{DiagnosticCode::EmptyStage,
+                                              static_cast<uint32_t>(stageBegin), 0});
+        }
+        size_t nameEnd = begin;
+        while (nameEnd < end && !isSpace(text[nameEnd])) ++nameEnd;
+        size_t argBegin = nameEnd;
+        while (argBegin < end && isSpace(text[argBegin])) ++argBegin;
+
+        auto node = tryCreateParseNodeFromInput(text.substr(begin, nameEnd - begin),
+                                                text.substr(argBegin, end - argBegin));
+        if (!node) {
+            // Unknown node types point at the name, everything else at the arguments
+            size_t offset = node.error().code == DiagnosticCode::UnknownNodeType ? begin : argBegin;
+            return std::unexpected(offsetBy(node.error(), offset));
+        }
+        stages.push_back(std::move(*node));
+        stageBegin = stageEnd + 1;
+    }
+    return stages;
+}
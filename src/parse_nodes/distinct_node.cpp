@@ -0,0 +1,8 @@
+#include "distinct_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the distinct node factory at startup
+REGISTER_PARSE_NODE(distinct, [](std::string_view argString) {
+    return toParseNodeResult(DistinctNode::tryParse(argString));
+});
@@ -0,0 +1,104 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "src/ast_params/distinct_params.h"
+
+struct DistinctNode : public ParseNode {
+    std::vector<std::string> keys;
+    std::string approxCountName;
+
+    DistinctNode(std::vector<std::string> keys, std::string approxCountName)
+        : keys(std::move(keys)), approxCountName(std::move(approxCountName)) {}
+
+    // Parses input like "country, city" (one row per distinct key) or
+    // "n:approx_count(country, city)" (one row holding an estimate of the
+    // number of distinct keys) without throwing
+    static std::expected<DistinctNode, Diagnostic> tryParse(std::string_view arg) {
+        size_t pos = skipSpaces(arg, 0);
+        size_t nameEnd = pos;
+        while (nameEnd < arg.size() && isFieldNameChar(arg[nameEnd])) ++nameEnd;
+        if (nameEnd == pos || nameEnd == arg.size() || arg[nameEnd] != ':') {
+            std::vector<std::string> keys;
+            if (auto error = parseKeys(arg, 0, arg.size(), keys)) {
+                return std::unexpected(*error);
+            }
+            return DistinctNode(std::move(keys), "");
+        }
+
+        std::string name(arg.substr(pos, nameEnd - pos));
+        size_t fnBegin = nameEnd + 1;
+        size_t open = arg.find('(', fnBegin);
+        std::string_view fn = arg.substr(fnBegin, (open == std::string_view::npos ? arg.size() : open) - fnBegin);
+        if (fn != "approx_count") {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownFunction,
+                                              static_cast<uint32_t>(fnBegin),
+                                              static_cast<uint32_t>(fn.size())});
+        }
+        size_t close = arg.find(')', open);
+        if (open == std::string_view::npos || close == std::string_view::npos) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedClosingParen,
+                                              static_cast<uint32_t>(arg.size()), 1});
+        }
+        if (size_t rest = skipSpaces(arg, close + 1); rest != arg.size()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(rest), 1});
+        }
+        std::vector<std::string> keys;
+        if (auto error = parseKeys(arg, open + 1, close, keys)) {
+            return std::unexpected(*error);
+        }
+        return DistinctNode(std::move(keys), std::move(name));
+    }
+
+    std::string get_shape() const override {
+        return "distinct_shape";
+    }
+
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        DistinctParams params;
+        params.keys = keys;
+        params.approxCountName = approxCountName;
+        return params;
+    }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    static size_t skipSpaces(std::string_view text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    }
+
+    // One or more comma-separated field names in text[begin, end)
+    static std::optional<Diagnostic> parseKeys(std::string_view text, size_t begin, size_t end,
+                                               std::vector<std::string>& keys) {
+        std::string_view section = text.substr(0, end);
+        size_t pos = skipSpaces(section, begin);
+        while (true) {
+            size_t nameBegin = pos;
+            while (pos < section.size() && isFieldNameChar(section[pos])) ++pos;
+            if (pos == nameBegin) {
+                return Diagnostic{DiagnosticCode::ExpectedFieldName, static_cast<uint32_t>(pos), 1};
+            }
+            keys.emplace_back(section.substr(nameBegin, pos - nameBegin));
+            pos = skipSpaces(section, pos);
+            if (pos == section.size()) {
+                return std::nullopt;
+            }
+            if (section[pos] != ',') {
+                return Diagnostic{DiagnosticCode::UnexpectedCharacter, static_cast<uint32_t>(pos), 1};
+            }
+            pos = skipSpaces(section, pos + 1);
+        }
+    }
+};
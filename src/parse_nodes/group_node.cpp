@@ -0,0 +1,8 @@
+#include "group_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the group node factory at startup
+REGISTER_PARSE_NODE(group, [](std::string_view argString) {
+    return toParseNodeResult(GroupNode::tryParse(argString));
+});
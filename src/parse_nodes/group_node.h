@@ -0,0 +1,162 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "src/ast_params/group_params.h"
+
+struct GroupNode : public ParseNode {
+    std::vector<std::string> keys;
+    std::vector<AggregateSpec> aggregates;
+
+    GroupNode(std::vector<std::string> keys, std::vector<AggregateSpec> aggregates)
+        : keys(std::move(keys)), aggregates(std::move(aggregates)) {}
+
+    // Parses input like "country,status; total:sum(score), n:count()" without
+    // throwing. Keys may be empty (one group over all rows); the aggregate
+    // list after ';' is optional.
+    static std::expected<GroupNode, Diagnostic> tryParse(std::string_view arg) {
+        size_t split = arg.find(';');
+        std::string_view keyText = arg.substr(0, split);
+
+        std::vector<std::string> keys;
+        size_t pos = skipSpaces(keyText, 0);
+        while (pos < keyText.size()) {
+            size_t begin = pos;
+            while (pos < keyText.size() && isFieldNameChar(keyText[pos])) ++pos;
+            if (pos == begin) {
+                return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                                  static_cast<uint32_t>(pos), 1});
+            }
+            keys.emplace_back(keyText.substr(begin, pos - begin));
+            pos = skipSpaces(keyText, pos);
+            if (pos < keyText.size()) {
+                if (keyText[pos] != ',') {
+                    return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                                      static_cast<uint32_t>(pos), 1});
+                }
+                pos = skipSpaces(keyText, pos + 1);
+                if (pos == keyText.size()) {
+                    return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                                      static_cast<uint32_t>(pos), 1});
+                }
+            }
+        }
+
+        std::vector<AggregateSpec> aggregates;
+        if (split != std::string_view::npos) {
+            size_t begin = split + 1;
+            while (begin <= arg.size()) {
+                size_t end = topLevelComma(arg, begin);
+                auto spec = parseAggregate(arg, begin, end);
+                if (!spec) {
+                    return std::unexpected(spec.error());
+                }
+                aggregates.push_back(std::move(*spec));
+                begin = end + 1;
+            }
+        }
+        if (keys.empty() && aggregates.empty()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName, 0,
+                                              static_cast<uint32_t>(arg.size())});
+        }
+        return GroupNode(std::move(keys), std::move(aggregates));
+    }
+
+    std::string get_shape() const override {
+        return "group_shape";
+    }
+
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        GroupParams params;
+        params.groupKeys = keys;
+        params.aggregates = aggregates;
+        return params;
+    }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    static size_t skipSpaces(std::string_view text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    }
+
+    // End of the aggregate starting at begin: the next comma outside
+    // parentheses and string literals, or the end of the text
+    static size_t topLevelComma(std::string_view text, size_t begin) {
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = begin; i < text.size(); ++i) {
+            char c = text[i];
+            if (inString) {
+                if (c == '\\') ++i;
+                else if (c == '"') inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                --depth;
+            } else if (c == ',' && depth == 0) {
+                return i;
+            }
+        }
+        return text.size();
+    }
+
+    // "<name>:<fn>(<expression>)" within text[begin, end)
+    static std::expected<AggregateSpec, Diagnostic> parseAggregate(std::string_view text, size_t begin,
+                                                                   size_t end) {
+        size_t pos = skipSpaces(text, begin);
+        while (end > pos && text[end - 1] == ' ') --end;
+        size_t nameBegin = pos;
+        while (pos < end && isFieldNameChar(text[pos])) ++pos;
+        if (pos == nameBegin || pos == end || text[pos] != ':') {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        AggregateSpec spec;
+        spec.name = std::string(text.substr(nameBegin, pos - nameBegin));
+
+        size_t fnBegin = ++pos;
+        while (pos < end && text[pos] != '(') ++pos;
+        std::string_view fn = text.substr(fnBegin, pos - fnBegin);
+        static constexpr std::pair<std::string_view, AggregateOp> kOps[] = {
+            {"count", AggregateOp::Count}, {"sum", AggregateOp::Sum}, {"min", AggregateOp::Min},
+            {"max", AggregateOp::Max},     {"avg", AggregateOp::Avg},
+        };
+        bool known = false;
+        for (const auto& [opName, op] : kOps) {
+            if (fn == opName) {
+                spec.op = op;
+                known = true;
+            }
+        }
+        if (!known) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownFunction,
+                                              static_cast<uint32_t>(fnBegin),
+                                              static_cast<uint32_t>(fn.size())});
+        }
+        if (pos == end || text[end - 1] != ')') {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedClosingParen,
+                                              static_cast<uint32_t>(end), 1});
+        }
+        spec.argument = std::string(text.substr(pos + 1, end - pos - 2));
+        if (spec.argument.find_first_not_of(' ') == std::string::npos) {
+            spec.argument.clear();
+            if (spec.op != AggregateOp::Count) {
+                return std::unexpected(Diagnostic{DiagnosticCode::EmptyExpression,
+                                                  static_cast<uint32_t>(pos + 1), 0});
+            }
+        }
+        return spec;
+    }
+};
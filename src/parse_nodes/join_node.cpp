@@ -0,0 +1,8 @@
+#include "join_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the join node factory at startup
+REGISTER_PARSE_NODE(join, [](std::string_view argString) {
+    return toParseNodeResult(JoinNode::tryParse(argString));
+});
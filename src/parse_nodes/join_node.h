@@ -0,0 +1,89 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "src/ast_params/join_params.h"
+
+struct JoinNode : public ParseNode {
+    std::string table;
+    std::string probeKey;
+    std::string buildKey;
+
+    JoinNode(std::string table, std::string probeKey, std::string buildKey)
+        : table(std::move(table)), probeKey(std::move(probeKey)), buildKey(std::move(buildKey)) {}
+
+    // Parses input like "users on user_id = id", or "users on id" when both
+    // sides name the key the same way, without throwing
+    static std::expected<JoinNode, Diagnostic> tryParse(std::string_view arg) {
+        size_t pos = skipSpaces(arg, 0);
+        auto table = readName(arg, pos);
+        if (!table) {
+            return std::unexpected(table.error());
+        }
+        size_t keywordPos = skipSpaces(arg, pos);
+        if (keywordPos == pos || arg.substr(keywordPos, 2) != "on" ||
+            (keywordPos + 2 < arg.size() && arg[keywordPos + 2] != ' ')) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(keywordPos), 1});
+        }
+        pos = skipSpaces(arg, keywordPos + 2);
+        auto probeKey = readName(arg, pos);
+        if (!probeKey) {
+            return std::unexpected(probeKey.error());
+        }
+        std::string buildKey = *probeKey;
+        pos = skipSpaces(arg, pos);
+        if (pos < arg.size() && arg[pos] == '=') {
+            pos = skipSpaces(arg, pos + 1);
+            auto named = readName(arg, pos);
+            if (!named) {
+                return std::unexpected(named.error());
+            }
+            buildKey = std::move(*named);
+            pos = skipSpaces(arg, pos);
+        }
+        if (pos != arg.size()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        return JoinNode(std::move(*table), std::move(*probeKey), std::move(buildKey));
+    }
+
+    std::string get_shape() const override {
+        return "join_shape";
+    }
+
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        JoinParams params;
+        params.table = table;
+        params.probeKey = probeKey;
+        params.buildKey = buildKey;
+        return params;
+    }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    static size_t skipSpaces(std::string_view text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    }
+
+    // Reads a name starting at pos and advances past it
+    static std::expected<std::string, Diagnostic> readName(std::string_view text, size_t& pos) {
+        size_t begin = pos;
+        while (pos < text.size() && isFieldNameChar(text[pos])) ++pos;
+        if (pos == begin) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        return std::string(text.substr(begin, pos - begin));
+    }
+};
@@ -3,6 +3,6 @@
 #include <memory>
 
 // Register the limit node factory at startup
-REGISTER_PARSE_NODE(limit, [](const std::string& argString) {
-    return std::make_unique<LimitNode>(argString);
+REGISTER_PARSE_NODE(limit, [](std::string_view argString) {
+    return toParseNodeResult(LimitNode::tryParse(argString));
 });
@@ -1,14 +1,72 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <expected>
+#include <charconv>
 #include "parse_node.h"
+#include "diagnostic.h"
 #include "src/ast_params/limit_params.h"
 
 struct LimitNode : public ParseNode {
     int limitValue;
+    int offset;
     
-    LimitNode(const std::string& arg) : limitValue(std::stoi(arg)) {}
+    explicit LimitNode(int limitValue, int offset = 0) : limitValue(limitValue), offset(offset) {}
+    
+    // Parses "<non-negative integer>" or "<n> offset <m>" (skip m rows, then
+    // keep n) without throwing
+    static std::expected<LimitNode, Diagnostic> tryParse(std::string_view arg) {
+        const char* begin = arg.data();
+        const char* end = arg.data() + arg.size();
+        int value = 0;
+        const char* ptr = begin;
+        if (auto count = parseCount(begin, ptr, end, value); !count) {
+            return std::unexpected(count.error());
+        }
+        if (ptr == end) {
+            return LimitNode(value);
+        }
+        constexpr std::string_view keyword = " offset ";
+        if (std::string_view(ptr, end - ptr).substr(0, keyword.size()) != keyword) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(ptr - begin), 1});
+        }
+        ptr += keyword.size();
+        int offset = 0;
+        if (auto count = parseCount(begin, ptr, end, offset); !count) {
+            return std::unexpected(count.error());
+        }
+        if (ptr != end) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(ptr - begin), 1});
+        }
+        return LimitNode(value, offset);
+    }
+
+    // Reads a non-negative integer at ptr and advances past it; positions
+    // are relative to begin
+    static std::expected<void, Diagnostic> parseCount(const char* begin, const char*& ptr, const char* end,
+                                                      int& value) {
+        const char* start = ptr;
+        auto [next, ec] = std::from_chars(start, end, value);
+        if (ec == std::errc::invalid_argument) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedInteger, static_cast<uint32_t>(start - begin),
+                                              static_cast<uint32_t>(end - start)});
+        }
+        if (ec == std::errc::result_out_of_range) {
+            return std::unexpected(Diagnostic{DiagnosticCode::IntegerOutOfRange,
+                                              static_cast<uint32_t>(start - begin),
+                                              static_cast<uint32_t>(next - start)});
+        }
+        if (value < 0) {
+            return std::unexpected(Diagnostic{DiagnosticCode::NegativeLimit, static_cast<uint32_t>(start - begin),
+                                              static_cast<uint32_t>(next - start)});
+        }
+        ptr = next;
+        return {};
+    }
     
     std::string get_shape() const override {
         return "limit_shape";
@@ -18,6 +76,7 @@ struct LimitNode : public ParseNode {
     AstParams astParams() const override {
         LimitParams params;
         params.limitValue = limitValue;
+        params.offset = offset;
         return params;
     }
 };
@@ -0,0 +1,8 @@
+#include "match_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the match node factory at startup
+REGISTER_PARSE_NODE(match, [](std::string_view argString) {
+    return toParseNodeResult(MatchNode::tryParse(argString));
+});
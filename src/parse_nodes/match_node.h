@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "expression.h"
+#include "src/ast_params/match_params.h"
+
+struct MatchNode : public ParseNode {
+    std::string predicate;
+    
+    explicit MatchNode(std::string predicate)
+        : predicate(std::move(predicate)) {}
+    
+    // Parses input like "score > 10 and country == \"us\"" without throwing.
+    // The predicate is syntax-checked here; types are checked at bind time.
+    static std::expected<MatchNode, Diagnostic> tryParse(std::string_view arg) {
+        if (arg.find_first_not_of(' ') == std::string_view::npos) {
+            return std::unexpected(Diagnostic{DiagnosticCode::EmptyExpression, 0, 0});
+        }
+        auto parsed = parseExpression(arg);
+        if (!parsed) {
+            return std::unexpected(parsed.error());
+        }
+        return MatchNode(std::string(arg));
+    }
+    
+    std::string get_shape() const override {
+        return "match_shape";
+    }
+    
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        MatchParams params;
+        params.predicate = predicate;
+        return params;
+    }
+};
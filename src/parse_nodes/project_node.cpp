@@ -0,0 +1,8 @@
+#include "project_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the project node factory at startup
+REGISTER_PARSE_NODE(project, [](std::string_view argString) {
+    return toParseNodeResult(ProjectNode::tryParse(argString));
+});
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <vector>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "src/ast_params/project_params.h"
+
+struct ProjectNode : public ParseNode {
+    std::vector<std::string> fields;
+    
+    explicit ProjectNode(std::vector<std::string> fields)
+        : fields(std::move(fields)) {}
+    
+    // Parses input like "country, score" without throwing
+    static std::expected<ProjectNode, Diagnostic> tryParse(std::string_view arg) {
+        std::vector<std::string> fields;
+        size_t pos = skipSpaces(arg, 0);
+        while (true) {
+            size_t begin = pos;
+            while (pos < arg.size() && isFieldNameChar(arg[pos])) ++pos;
+            if (pos == begin) {
+                return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                                  static_cast<uint32_t>(pos), 1});
+            }
+            fields.emplace_back(arg.substr(begin, pos - begin));
+            pos = skipSpaces(arg, pos);
+            if (pos == arg.size()) {
+                break;
+            }
+            if (arg[pos] != ',') {
+                return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                                  static_cast<uint32_t>(pos), 1});
+            }
+            pos = skipSpaces(arg, pos + 1);
+        }
+        return ProjectNode(std::move(fields));
+    }
+    
+    std::string get_shape() const override {
+        return "project_shape";
+    }
+    
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        ProjectParams params;
+        params.fields = fields;
+        return params;
+    }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    static size_t skipSpaces(std::string_view text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    }
+};
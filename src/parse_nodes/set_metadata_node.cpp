@@ -3,7 +3,6 @@
 #include <memory>
 
 // Register the set_metadata node factory at startup
-REGISTER_PARSE_NODE(set_metadata, [](const std::string& argString) {
-    return std::make_unique<SetMetadataNode>(argString);
+REGISTER_PARSE_NODE(set_metadata, [](std::string_view argString) {
+    return toParseNodeResult(SetMetadataNode::tryParse(argString));
 });
-
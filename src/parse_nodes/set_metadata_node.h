@@ -1,23 +1,38 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
+#include <expected>
 #include "parse_node.h"
+#include "diagnostic.h"
 #include "src/ast_params/set_metadata_params.h"
 
 struct SetMetadataNode : public ParseNode {
     std::string metaName;
     std::string expression;
     
-    SetMetadataNode(const std::string& arg) {
-        // Parse input like "name:expression" or just use defaults
+    SetMetadataNode(std::string metaName, std::string expression)
+        : metaName(std::move(metaName)), expression(std::move(expression)) {}
+    
+    // Parses input like "name:expression" or just an expression (stored under
+    // "default_meta") without throwing
+    static std::expected<SetMetadataNode, Diagnostic> tryParse(std::string_view arg) {
         size_t colonPos = arg.find(':');
-        if (colonPos != std::string::npos) {
-            metaName = arg.substr(0, colonPos);
-            expression = arg.substr(colonPos + 1);
-        } else {
-            metaName = "default_meta";
-            expression = arg;
+        if (colonPos == std::string_view::npos) {
+            if (arg.empty()) {
+                return std::unexpected(Diagnostic{DiagnosticCode::EmptyExpression, 0, 0});
+            }
+            return SetMetadataNode("default_meta", std::string(arg));
+        }
+        if (colonPos == 0) {
+            return std::unexpected(Diagnostic{DiagnosticCode::EmptyMetadataName, 0, 1});
         }
+        if (colonPos + 1 == arg.size()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::EmptyExpression,
+                                              static_cast<uint32_t>(colonPos + 1), 0});
+        }
+        return SetMetadataNode(std::string(arg.substr(0, colonPos)),
+                               std::string(arg.substr(colonPos + 1)));
     }
     
     std::string get_shape() const override {
@@ -32,4 +47,3 @@ struct SetMetadataNode : public ParseNode {
         return params;
     }
 };
-
@@ -3,6 +3,6 @@
 #include <memory>
 
 // Register the sort node factory at startup
-REGISTER_PARSE_NODE(sort, [](const std::string& argString) {
-    return std::make_unique<SortNode>(argString);
+REGISTER_PARSE_NODE(sort, [](std::string_view argString) {
+    return toParseNodeResult(SortNode::tryParse(argString));
 });
@@ -1,23 +1,63 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
+#include <expected>
 #include "parse_node.h"
+#include "diagnostic.h"
 #include "src/ast_params/sort_params.h"
 
 struct SortNode : public ParseNode {
     std::vector<std::string> keys;
-    bool asc;
+    bool asc = true;
+    bool nullsFirst = false;
     
-    SortNode(const std::string& arg) {
-        // Parse input like "field1,field2:desc" or "field1:asc"
-        if (arg.find(":desc") != std::string::npos) {
-            asc = false;
-        } else {
-            asc = true;
+    SortNode(std::vector<std::string> keys, bool asc, bool nullsFirst = false)
+        : keys(std::move(keys)), asc(asc), nullsFirst(nullsFirst) {}
+    
+    // Parses input like "field1,field2:desc" or "field1:asc:nulls_first"
+    // without throwing. The options are optional and default to ascending
+    // with nulls last.
+    static std::expected<SortNode, Diagnostic> tryParse(std::string_view arg) {
+        std::vector<std::string> keys;
+        size_t pos = 0;
+        while (true) {
+            size_t begin = pos;
+            while (pos < arg.size() && isFieldNameChar(arg[pos])) ++pos;
+            if (pos == begin) {
+                return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                                  static_cast<uint32_t>(pos), 1});
+            }
+            keys.emplace_back(arg.substr(begin, pos - begin));
+            if (pos < arg.size() && arg[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            break;
+        }
+
+        bool asc = true;
+        bool nullsFirst = false;
+        while (pos < arg.size() && arg[pos] == ':') {
+            size_t begin = ++pos;
+            while (pos < arg.size() && arg[pos] != ':') ++pos;
+            std::string_view option = arg.substr(begin, pos - begin);
+            if (option == "asc" || option == "desc") {
+                asc = option == "asc";
+            } else if (option == "nulls_first" || option == "nulls_last") {
+                nullsFirst = option == "nulls_first";
+            } else {
+                return std::unexpected(Diagnostic{DiagnosticCode::UnknownSortDirection,
+                                                  static_cast<uint32_t>(begin),
+                                                  static_cast<uint32_t>(option.size())});
+            }
         }
-        // For simplicity, just use two example keys
-        keys = {"field1", "field2"};
+        if (pos < arg.size()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        return SortNode(std::move(keys), asc, nullsFirst);
     }
     
     std::string get_shape() const override {
@@ -29,6 +69,13 @@ struct SortNode : public ParseNode {
         SortParams params;
         params.sortKeys = keys;
         params.ascending = asc;
+        params.nullsFirst = nullsFirst;
         return params;
     }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
 };
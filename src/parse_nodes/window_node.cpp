@@ -0,0 +1,8 @@
+#include "window_node.h"
+#include "parse_node.h"
+#include <memory>
+
+// Register the window node factory at startup
+REGISTER_PARSE_NODE(window, [](std::string_view argString) {
+    return toParseNodeResult(WindowNode::tryParse(argString));
+});
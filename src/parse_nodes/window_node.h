@@ -0,0 +1,287 @@
+#pragma once
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <expected>
+#include "parse_node.h"
+#include "diagnostic.h"
+#include "src/ast_params/window_params.h"
+
+struct WindowNode : public ParseNode {
+    std::vector<std::string> partitionKeys;
+    std::vector<std::string> orderKeys;
+    bool asc = true;
+    std::vector<WindowFunctionSpec> functions;
+
+    WindowNode(std::vector<std::string> partitionKeys, std::vector<std::string> orderKeys, bool asc,
+               std::vector<WindowFunctionSpec> functions)
+        : partitionKeys(std::move(partitionKeys)), orderKeys(std::move(orderKeys)), asc(asc),
+          functions(std::move(functions)) {}
+
+    // Parses input like
+    //   "country; ts:desc; n:row_number(), run:sum(score), moving:avg(score) rows(-2, 0)"
+    // without throwing: partition keys, order keys with an optional direction,
+    // then the functions. Either key list may be empty. A frame is
+    // "rows(<start>, <end>)" with offsets from the current row or
+    // "unbounded"; without one, aggregates run from the partition start to
+    // the current row when there are order keys, else over the partition.
+    static std::expected<WindowNode, Diagnostic> tryParse(std::string_view arg) {
+        size_t firstSplit = arg.find(';');
+        size_t secondSplit = firstSplit == std::string_view::npos ? firstSplit : arg.find(';', firstSplit + 1);
+        if (secondSplit == std::string_view::npos) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(arg.size()), 1});
+        }
+
+        std::vector<std::string> partitionKeys;
+        if (auto error = parseKeys(arg, 0, firstSplit, partitionKeys)) {
+            return std::unexpected(*error);
+        }
+
+        // Order keys, then an optional ":asc" or ":desc"
+        size_t orderEnd = secondSplit;
+        size_t colon = arg.substr(0, secondSplit).find(':', firstSplit + 1);
+        bool asc = true;
+        if (colon != std::string_view::npos) {
+            std::string_view option = trim(arg.substr(colon + 1, secondSplit - colon - 1));
+            if (option != "asc" && option != "desc") {
+                return std::unexpected(Diagnostic{DiagnosticCode::UnknownSortDirection,
+                                                  static_cast<uint32_t>(colon + 1),
+                                                  static_cast<uint32_t>(secondSplit - colon - 1)});
+            }
+            asc = option == "asc";
+            orderEnd = colon;
+        }
+        std::vector<std::string> orderKeys;
+        if (auto error = parseKeys(arg, firstSplit + 1, orderEnd, orderKeys)) {
+            return std::unexpected(*error);
+        }
+
+        std::vector<WindowFunctionSpec> functions;
+        size_t begin = secondSplit + 1;
+        while (begin <= arg.size()) {
+            size_t end = topLevelComma(arg, begin);
+            auto spec = parseFunction(arg, begin, end, !orderKeys.empty());
+            if (!spec) {
+                return std::unexpected(spec.error());
+            }
+            functions.push_back(std::move(*spec));
+            begin = end + 1;
+        }
+        return WindowNode(std::move(partitionKeys), std::move(orderKeys), asc, std::move(functions));
+    }
+
+    std::string get_shape() const override {
+        return "window_shape";
+    }
+
+    // Returns type-specific AST parameters
+    AstParams astParams() const override {
+        WindowParams params;
+        params.partitionKeys = partitionKeys;
+        params.orderKeys = orderKeys;
+        params.ascending = asc;
+        params.functions = functions;
+        return params;
+    }
+
+private:
+    static bool isFieldNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '.';
+    }
+
+    static size_t skipSpaces(std::string_view text, size_t pos) {
+        while (pos < text.size() && text[pos] == ' ') ++pos;
+        return pos;
+    }
+
+    static std::string_view trim(std::string_view text) {
+        size_t begin = skipSpaces(text, 0);
+        size_t end = text.size();
+        while (end > begin && text[end - 1] == ' ') --end;
+        return text.substr(begin, end - begin);
+    }
+
+    // Comma-separated field names in text[begin, end), possibly none
+    static std::optional<Diagnostic> parseKeys(std::string_view text, size_t begin, size_t end,
+                                               std::vector<std::string>& keys) {
+        std::string_view section = text.substr(0, end);
+        size_t pos = skipSpaces(section, begin);
+        while (pos < section.size()) {
+            size_t nameBegin = pos;
+            while (pos < section.size() && isFieldNameChar(section[pos])) ++pos;
+            if (pos == nameBegin) {
+                return Diagnostic{DiagnosticCode::ExpectedFieldName, static_cast<uint32_t>(pos), 1};
+            }
+            keys.emplace_back(section.substr(nameBegin, pos - nameBegin));
+            pos = skipSpaces(section, pos);
+            if (pos < section.size()) {
+                if (section[pos] != ',') {
+                    return Diagnostic{DiagnosticCode::UnexpectedCharacter, static_cast<uint32_t>(pos), 1};
+                }
+                pos = skipSpaces(section, pos + 1);
+                if (pos == section.size()) {
+                    return Diagnostic{DiagnosticCode::ExpectedFieldName, static_cast<uint32_t>(pos), 1};
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    // End of the function starting at begin: the next comma outside
+    // parentheses and string literals, or the end of the text
+    static size_t topLevelComma(std::string_view text, size_t begin) {
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = begin; i < text.size(); ++i) {
+            char c = text[i];
+            if (inString) {
+                if (c == '\\') ++i;
+                else if (c == '"') inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                --depth;
+            } else if (c == ',' && depth == 0) {
+                return i;
+            }
+        }
+        return text.size();
+    }
+
+    // Position of the ')' closing the '(' at open, or end if there is none
+    static size_t closingParen(std::string_view text, size_t open, size_t end) {
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = open; i < end; ++i) {
+            char c = text[i];
+            if (inString) {
+                if (c == '\\') ++i;
+                else if (c == '"') inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')' && --depth == 0) {
+                return i;
+            }
+        }
+        return end;
+    }
+
+    // One frame bound: "unbounded" or a signed row offset
+    static std::optional<Diagnostic> parseBound(std::string_view text, size_t begin, size_t end,
+                                                bool& unbounded, int64_t& offset) {
+        std::string_view bound = trim(text.substr(begin, end - begin));
+        size_t at = begin + skipSpaces(text.substr(begin, end - begin), 0);
+        if (bound == "unbounded") {
+            unbounded = true;
+            return std::nullopt;
+        }
+        const char* first = bound.data() + (!bound.empty() && bound[0] == '+');
+        auto [ptr, ec] = std::from_chars(first, bound.data() + bound.size(), offset);
+        if (bound.empty() || ec != std::errc() || ptr != bound.data() + bound.size()) {
+            return Diagnostic{ec == std::errc::result_out_of_range ? DiagnosticCode::IntegerOutOfRange
+                                                                   : DiagnosticCode::ExpectedInteger,
+                              static_cast<uint32_t>(at), static_cast<uint32_t>(bound.size())};
+        }
+        unbounded = false;
+        return std::nullopt;
+    }
+
+    // "<name>:<fn>(<expression>) [rows(<start>, <end>)]" within text[begin, end)
+    static std::expected<WindowFunctionSpec, Diagnostic> parseFunction(std::string_view text, size_t begin,
+                                                                       size_t end, bool ordered) {
+        size_t pos = skipSpaces(text, begin);
+        while (end > pos && text[end - 1] == ' ') --end;
+        size_t nameBegin = pos;
+        while (pos < end && isFieldNameChar(text[pos])) ++pos;
+        if (pos == nameBegin || pos == end || text[pos] != ':') {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedFieldName,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        WindowFunctionSpec spec;
+        spec.name = std::string(text.substr(nameBegin, pos - nameBegin));
+
+        size_t fnBegin = ++pos;
+        while (pos < end && text[pos] != '(') ++pos;
+        std::string_view fn = text.substr(fnBegin, pos - fnBegin);
+        static constexpr std::pair<std::string_view, WindowOp> kOps[] = {
+            {"row_number", WindowOp::RowNumber}, {"rank", WindowOp::Rank}, {"dense_rank", WindowOp::DenseRank},
+            {"count", WindowOp::Count},          {"sum", WindowOp::Sum},   {"min", WindowOp::Min},
+            {"max", WindowOp::Max},              {"avg", WindowOp::Avg},
+        };
+        bool known = false;
+        for (const auto& [opName, op] : kOps) {
+            if (fn == opName) {
+                spec.op = op;
+                known = true;
+            }
+        }
+        if (!known) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnknownFunction,
+                                              static_cast<uint32_t>(fnBegin),
+                                              static_cast<uint32_t>(fn.size())});
+        }
+        size_t close = closingParen(text, pos, end);
+        if (pos == end || close == end) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedClosingParen,
+                                              static_cast<uint32_t>(end), 1});
+        }
+        spec.argument = std::string(trim(text.substr(pos + 1, close - pos - 1)));
+        bool ranking = spec.op == WindowOp::RowNumber || spec.op == WindowOp::Rank ||
+                       spec.op == WindowOp::DenseRank;
+        if (ranking && !spec.argument.empty()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::WrongArgumentCount,
+                                              static_cast<uint32_t>(pos + 1),
+                                              static_cast<uint32_t>(close - pos - 1)});
+        }
+        if (!ranking && spec.op != WindowOp::Count && spec.argument.empty()) {
+            return std::unexpected(Diagnostic{DiagnosticCode::EmptyExpression,
+                                              static_cast<uint32_t>(pos + 1), 0});
+        }
+
+        spec.startUnbounded = true;
+        spec.endUnbounded = !ordered;
+        pos = skipSpaces(text, close + 1);
+        if (pos == end) {
+            return spec;
+        }
+        // Optional frame
+        if (ranking || text.substr(pos, 4) != "rows" || skipSpaces(text, pos + 4) >= end ||
+            text[skipSpaces(text, pos + 4)] != '(') {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(pos), 1});
+        }
+        size_t open = skipSpaces(text, pos + 4);
+        size_t frameClose = closingParen(text, open, end);
+        size_t comma = text.substr(0, frameClose).find(',', open);
+        if (frameClose == end) {
+            return std::unexpected(Diagnostic{DiagnosticCode::ExpectedClosingParen,
+                                              static_cast<uint32_t>(end), 1});
+        }
+        if (frameClose != end - 1 || comma == std::string_view::npos) {
+            return std::unexpected(Diagnostic{DiagnosticCode::UnexpectedCharacter,
+                                              static_cast<uint32_t>(comma == std::string_view::npos ? open
+                                                                                                    : frameClose + 1),
+                                              1});
+        }
+        if (auto error = parseBound(text, open + 1, comma, spec.startUnbounded, spec.frameStart)) {
+            return std::unexpected(*error);
+        }
+        if (auto error = parseBound(text, comma + 1, frameClose, spec.endUnbounded, spec.frameEnd)) {
+            return std::unexpected(*error);
+        }
+        if (!spec.startUnbounded && !spec.endUnbounded && spec.frameStart > spec.frameEnd) {
+            return std::unexpected(Diagnostic{DiagnosticCode::IntegerOutOfRange, static_cast<uint32_t>(open),
+                                              static_cast<uint32_t>(frameClose - open + 1)});
+        }
+        return spec;
+    }
+};
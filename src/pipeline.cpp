@@ -0,0 +1,50 @@
+#include "pipeline.h"
+#include "parse_node.h"
+#include "node_transformer.h"
+#include "ast_to_logical_transformer.h"
+#include "batch.h"
+
+std::expected<Pipeline, Diagnostic> tryBuildPipeline(std::string_view text, Catalog& catalog) {
+    auto parseNodes = tryParsePipeline(text);
+    if (!parseNodes) {
+        return std::unexpected(parseNodes.error());
+    }
+    Pipeline pipeline;
+    for (const auto& parseNode : *parseNodes) {
+        auto astNode = tryParseToAst(*parseNode, catalog);
+        if (!astNode) {
+            return std::unexpected(astNode.error());
+        }
+        pipeline.stages.push_back(astToLogical(**astNode));
+        pipeline.stages.back()->attachCatalog(catalog);
+    }
+    return pipeline;
+}
+
+std::expected<Schema, Diagnostic> bindPipeline(Pipeline& pipeline, const Schema& input,
+                                               const SymbolTable& symbols) {
+    Schema schema = input;
+    for (auto& stage : pipeline.stages) {
+        auto output = stage->bind(schema, symbols);
+        if (!output) {
+            return std::unexpected(output.error());
+        }
+        schema = std::move(*output);
+    }
+    return schema;
+}
+
+void executePipeline(const Pipeline& pipeline, Batch& batch) {
+    for (const auto& stage : pipeline.stages) {
+        stage->execute(batch);
+    }
+}
+
+std::string explainPipeline(const Pipeline& pipeline) {
+    std::string out;
+    for (size_t i = 0; i < pipeline.stages.size(); ++i) {
+        if (i > 0) out += "\n";
+        out += "[" + std::to_string(i) + "] " + pipeline.stages[i]->explain();
+    }
+    return out;
+}
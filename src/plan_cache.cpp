@@ -0,0 +1,226 @@
+#include "plan_cache.h"
+#include "parse_node.h"
+#include "logical_node.h"
+#include "params_codec.h"
+#include "fingerprint.h"
+#include "node_transformer.h"
+#include "ast_to_logical_transformer.h"
+#include "src/ast_nodes/limit_ast_node.h"
+#include "src/ast_nodes/sort_ast_node.h"
+#include "src/ast_nodes/set_metadata_ast_node.h"
+#include "src/ast_nodes/group_ast_node.h"
+#include "src/ast_nodes/match_ast_node.h"
+#include "src/ast_nodes/project_ast_node.h"
+#include "src/ast_nodes/join_ast_node.h"
+#include "src/ast_nodes/window_ast_node.h"
+#include "src/ast_nodes/distinct_ast_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <variant>
+
+// Generated by the build from a hash of every source (src/CMakeLists.txt,
+// BUILD.bazel); -DTOY_BUILD_ID="..." takes precedence
+#if !defined(TOY_BUILD_ID) && __has_include("plan_cache_build_id.h")
+#include "plan_cache_build_id.h"
+#endif
+
+namespace {
+
+constexpr uint64_t kPlanCacheMagic = 0x31434e414c50594full;  // "OYPLANC1"
+constexpr size_t kHeaderSize = 3 * sizeof(uint64_t);
+constexpr size_t kEntryHeaderSize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+template <typename T>
+T loadRaw(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template <typename T>
+void storeRaw(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+std::unique_ptr<LogicalNode> logicalNodeFromParams(const AstParams& params) {
+    return std::visit([](const auto& p) -> std::unique_ptr<LogicalNode> {
+        using T = std::decay_t<decltype(p)>;
+        if constexpr (std::is_same_v<T, __AstParams_TrailingComma_Sentinel>) {
+            return nullptr;
+        } else {
+            return createLogicalNode<T>(p);
+        }
+    }, params);
+}
+
+// The params the AST node plans its logical node from
+std::optional<AstParams> plannedParams(const AstNode& astNode) {
+#define AST_NODE_TYPE(ParamType, AstNodeType)                           \
+    if (auto* node = dynamic_cast<const AstNodeType*>(&astNode)) {      \
+        return AstParams{node->logicalParams()};                        \
+    }
+#include "ast_node_types.def"
+#undef AST_NODE_TYPE
+    return std::nullopt;
+}
+
+} // namespace
+
+uint64_t planCacheBuildId() {
+#ifdef TOY_BUILD_ID
+    static const uint64_t id = std::max<uint64_t>(fnv1a64(TOY_BUILD_ID), 1);
+    return id;
+#else
+    return 0;
+#endif
+}
+
+uint64_t planCacheKey(const ParseNode& parseNode, std::string_view encodedParams) {
+    return hashCombine(fnv1a64(parseNode.get_shape()), fnv1a64(encodedParams));
+}
+
+PlanCache::PlanCache(std::string path, uint64_t buildId)
+    : path(std::move(path)), buildId(buildId) {
+    if (buildId) {
+        mapFile();
+    }
+}
+
+PlanCache::~PlanCache() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+void PlanCache::mapFile() {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;  // No cache yet: cold start
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        close(fd);
+        return;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return;
+    }
+    mapping = addr;
+    mappingSize = st.st_size;
+
+    const char* base = static_cast<const char*>(mapping);
+    if (loadRaw<uint64_t>(base) != kPlanCacheMagic ||
+        loadRaw<uint64_t>(base + 8) != buildId) {
+        return;  // Foreign or stale cache: ignore it, persist() will replace it
+    }
+    uint64_t count = loadRaw<uint64_t>(base + 16);
+    size_t offset = kHeaderSize;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (mappingSize - offset < kEntryHeaderSize) break;
+        uint64_t key = loadRaw<uint64_t>(base + offset);
+        uint32_t inputLen = loadRaw<uint32_t>(base + offset + 8);
+        uint32_t planLen = loadRaw<uint32_t>(base + offset + 12);
+        offset += kEntryHeaderSize;
+        if (mappingSize - offset < static_cast<size_t>(inputLen) + planLen) break;
+        std::string_view input(base + offset, inputLen);
+        std::string_view plan(base + offset + inputLen, planLen);
+        offset += static_cast<size_t>(inputLen) + planLen;
+        entries.emplace(key, Entry{input, plan});
+    }
+}
+
+std::unique_ptr<LogicalNode> PlanCache::plan(const ParseNode& parseNode) {
+    std::string input = encodeParams(parseNode.astParams());
+    uint64_t key = planCacheKey(parseNode, input);
+
+    if (auto cached = lookup(key, input)) {
+        if (auto node = logicalNodeFromParams(*cached)) {
+            return node;
+        }
+    }
+
+    // Miss: run the full Parse → AST → Logical pipeline and keep what the
+    // logical node was planned from
+    auto astNode = parseToAst(parseNode);
+    auto logicalNode = astToLogical(*astNode);
+    if (auto planned = plannedParams(*astNode)) {
+        insert(key, std::move(input), encodeParams(*planned));
+    }
+    return logicalNode;
+}
+
+std::optional<AstParams> PlanCache::lookup(uint64_t key, std::string_view encodedInput) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.input != encodedInput) {
+        ++missCount;
+        return std::nullopt;
+    }
+    auto params = decodeParams(it->second.plan);
+    if (!params) {
+        ++missCount;
+        return std::nullopt;
+    }
+    ++hitCount;
+    return params;
+}
+
+void PlanCache::insert(uint64_t key, std::string encodedInput, std::string encodedPlan) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = owned[key];
+    slot = {std::move(encodedInput), std::move(encodedPlan)};
+    entries[key] = Entry{slot.first, slot.second};
+}
+
+bool PlanCache::persist() const {
+    if (!buildId) {
+        return false;
+    }
+    std::string out;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        storeRaw<uint64_t>(out, kPlanCacheMagic);
+        storeRaw<uint64_t>(out, buildId);
+        storeRaw<uint64_t>(out, entries.size());
+        for (const auto& [key, entry] : entries) {
+            storeRaw<uint64_t>(out, key);
+            storeRaw<uint32_t>(out, static_cast<uint32_t>(entry.input.size()));
+            storeRaw<uint32_t>(out, static_cast<uint32_t>(entry.plan.size()));
+            out.append(entry.input);
+            out.append(entry.plan);
+        }
+    }
+
+    // Write to a temp file and rename so concurrent readers (other workers
+    // mapping the cache) never observe a partially written file
+    std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+    FILE* f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
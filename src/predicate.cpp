@@ -0,0 +1,459 @@
+#include "predicate.h"
+#include "expression_eval.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+bool isComparison(ExprOp op) {
+    return op == ExprOp::Eq || op == ExprOp::Ne || op == ExprOp::Lt || op == ExprOp::Le ||
+           op == ExprOp::Gt || op == ExprOp::Ge;
+}
+
+// a <op> b  ==  b <flipped op> a
+ExprOp flipComparison(ExprOp op) {
+    switch (op) {
+        case ExprOp::Lt: return ExprOp::Gt;
+        case ExprOp::Le: return ExprOp::Ge;
+        case ExprOp::Gt: return ExprOp::Lt;
+        case ExprOp::Ge: return ExprOp::Le;
+        default: return op;
+    }
+}
+
+// The column behind a comparison operand: a field, or an Int64 field the
+// binder widened to Double
+const Expr* columnOperand(const Expr& expr) {
+    if (expr.kind == ExprKind::Field) {
+        return &expr;
+    }
+    if (expr.kind == ExprKind::Call && expr.op == ExprOp::ToDouble && expr.args[0]->kind == ExprKind::Field) {
+        return expr.args[0].get();
+    }
+    return nullptr;
+}
+
+// A literal operand, looking through a widening of an Int64 literal
+bool literalOperand(const Expr& expr, PredicateNode& node) {
+    const Expr* literal = &expr;
+    bool widened = false;
+    if (expr.kind == ExprKind::Call && expr.op == ExprOp::ToDouble) {
+        literal = expr.args[0].get();
+        widened = true;
+    }
+    if (literal->kind != ExprKind::Literal) {
+        return false;
+    }
+    node.type = widened ? PhysicalType::Double : literal->type;
+    node.intValue = literal->intValue;
+    node.doubleValue = widened ? static_cast<double>(literal->intValue) : literal->doubleValue;
+    node.stringValue = literal->stringValue;
+    return true;
+}
+
+PredicateNode compileNode(const ExprPtr& expr, PredicatePlan& plan) {
+    PredicateNode node;
+    node.expr = expr;
+    if (expr->kind == ExprKind::Call && (expr->op == ExprOp::And || expr->op == ExprOp::Or)) {
+        node.kind = expr->op == ExprOp::And ? PredicateNode::Kind::And : PredicateNode::Kind::Or;
+        for (const auto& arg : expr->args) {
+            PredicateNode child = compileNode(arg, plan);
+            if (child.kind == node.kind) {
+                // a and (b and c) -> one three-way and
+                for (auto& grandchild : child.children) node.children.push_back(std::move(grandchild));
+            } else {
+                node.children.push_back(std::move(child));
+            }
+        }
+        return node;
+    }
+    if (expr->kind == ExprKind::Call && isComparison(expr->op) && expr->args.size() == 2) {
+        const Expr* lhs = expr->args[0].get();
+        const Expr* rhs = expr->args[1].get();
+        ExprOp op = expr->op;
+        if (!columnOperand(*lhs)) {
+            std::swap(lhs, rhs);
+            op = flipComparison(op);
+        }
+        if (const Expr* column = columnOperand(*lhs)) {
+            node.op = op;
+            node.slot = static_cast<uint32_t>(column->slot);
+            if (literalOperand(*rhs, node)) {
+                node.kind = PredicateNode::Kind::Compare;
+                ++plan.kernelLeaves;
+                return node;
+            }
+            if (lhs->kind == ExprKind::Field && rhs->kind == ExprKind::Field && lhs->type == rhs->type &&
+                isNumeric(lhs->type)) {
+                node.kind = PredicateNode::Kind::CompareFields;
+                node.otherSlot = static_cast<uint32_t>(rhs->slot);
+                node.type = lhs->type;
+                ++plan.kernelLeaves;
+                return node;
+            }
+        }
+    }
+    node = PredicateNode{};
+    node.expr = expr;
+    ++plan.interpretedLeaves;
+    return node;
+}
+
+// Runs cmp over n values against a literal, writing 0/1 bytes. With the GCC
+// vector extension a 16-byte vector (the SSE2/NEON baseline, so the lambdas
+// can take vectors by value without an ABI change) is compared per step,
+// and the lane masks are narrowed straight to bytes.
+template <typename T, typename Cmp>
+void compareKernel(const T* values, size_t n, T literal, uint8_t* out, Cmp cmp) {
+    size_t i = 0;
+#if defined(__GNUC__)
+    constexpr size_t kLanes = 16 / sizeof(T);
+    typedef T Lanes __attribute__((vector_size(16)));
+    typedef int8_t Bytes __attribute__((vector_size(kLanes)));
+    Lanes broadcast = Lanes{} + literal;
+    for (; i + kLanes <= n; i += kLanes) {
+        Lanes v;
+        std::memcpy(&v, values + i, sizeof(v));
+        Bytes mask = __builtin_convertvector(cmp(v, broadcast), Bytes) & 1;
+        std::memcpy(out + i, &mask, sizeof(mask));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<uint8_t>(cmp(values[i], literal));
+    }
+}
+
+// Same as compareKernel, against a second column
+template <typename T, typename Cmp>
+void compareColumnsKernel(const T* lhs, const T* rhs, size_t n, uint8_t* out, Cmp cmp) {
+    size_t i = 0;
+#if defined(__GNUC__)
+    constexpr size_t kLanes = 16 / sizeof(T);
+    typedef T Lanes __attribute__((vector_size(16)));
+    typedef int8_t Bytes __attribute__((vector_size(kLanes)));
+    for (; i + kLanes <= n; i += kLanes) {
+        Lanes a, b;
+        std::memcpy(&a, lhs + i, sizeof(a));
+        std::memcpy(&b, rhs + i, sizeof(b));
+        Bytes mask = __builtin_convertvector(cmp(a, b), Bytes) & 1;
+        std::memcpy(out + i, &mask, sizeof(mask));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<uint8_t>(cmp(lhs[i], rhs[i]));
+    }
+}
+
+// Picks the comparison functor once per call; the lambdas work on scalars
+// and on vector-extension lanes alike
+template <typename Fn>
+void withComparison(ExprOp op, Fn fn) {
+    switch (op) {
+        case ExprOp::Eq: fn([](auto a, auto b) { return a == b; }); break;
+        case ExprOp::Ne: fn([](auto a, auto b) { return a != b; }); break;
+        case ExprOp::Lt: fn([](auto a, auto b) { return a < b; }); break;
+        case ExprOp::Le: fn([](auto a, auto b) { return a <= b; }); break;
+        case ExprOp::Gt: fn([](auto a, auto b) { return a > b; }); break;
+        default: fn([](auto a, auto b) { return a >= b; }); break;
+    }
+}
+
+template <typename T>
+void compareToLiteral(ExprOp op, const T* values, size_t n, T literal, uint8_t* out) {
+    withComparison(op, [&](auto cmp) { compareKernel(values, n, literal, out, cmp); });
+}
+
+// dst &= src (or dst |= src) over byte masks, 32 rows per step
+void combineMasks(uint8_t* dst, const uint8_t* src, size_t n, bool isAnd) {
+    size_t i = 0;
+#if defined(__GNUC__)
+    typedef uint8_t Bytes32 __attribute__((vector_size(32)));
+    for (; i + 32 <= n; i += 32) {
+        Bytes32 a, b;
+        std::memcpy(&a, dst + i, sizeof(a));
+        std::memcpy(&b, src + i, sizeof(b));
+        a = isAnd ? (a & b) : (a | b);
+        std::memcpy(dst + i, &a, sizeof(a));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = isAnd ? (dst[i] & src[i]) : (dst[i] | src[i]);
+    }
+}
+
+void clearNullRows(const Column& column, size_t begin, size_t n, uint8_t* out) {
+    if (!column.hasNulls()) {
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[i] &= static_cast<uint8_t>(column.isValid(begin + i));
+    }
+}
+
+struct RangeEvaluator {
+    const Batch& batch;
+
+    // Interpreter fallback: evaluates the subtree over just the range's rows
+    void interpret(const PredicateNode& node, size_t begin, size_t n, uint8_t* out) const {
+        SelectionVector rows(n);
+        std::iota(rows.begin(), rows.end(), static_cast<uint32_t>(begin));
+        Column result = evaluateExpression(*node.expr, batch, &rows);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<uint8_t>(result.bools[i] != 0 && result.isValid(i));
+        }
+    }
+
+    // Returns false when the column's encoding has no kernel
+    bool compare(const PredicateNode& node, size_t begin, size_t n, uint8_t* out) const {
+        const Column& column = batch.columns[node.slot];
+        if (node.type == PhysicalType::String) {
+            if (column.type != PhysicalType::String) return false;
+            if (column.isDictionary()) {
+                compareCodes(node, column, begin, n, out);
+            } else {
+                const auto& values = column.strings;
+                const std::string& literal = node.stringValue;
+                withComparison(node.op, [&](auto cmp) {
+                    for (size_t i = 0; i < n; ++i) out[i] = static_cast<uint8_t>(cmp(values[begin + i], literal));
+                });
+            }
+        } else if (node.type == PhysicalType::Bool) {
+            if (column.type != PhysicalType::Bool) return false;
+            compareToLiteral(node.op, column.bools.data() + begin, n, static_cast<uint8_t>(node.intValue != 0), out);
+        } else if (column.type == PhysicalType::Int64) {
+            std::vector<int64_t> unpacked;
+            const int64_t* values = column.ints.data() + begin;
+            if (column.isPacked()) {
+                unpacked.resize(n);
+                column.packed->unpack(begin, n, unpacked.data());
+                values = unpacked.data();
+            }
+            if (node.type == PhysicalType::Int64) {
+                compareToLiteral(node.op, values, n, node.intValue, out);
+            } else {
+                std::vector<double> widened(values, values + n);
+                compareToLiteral(node.op, widened.data(), n, node.doubleValue, out);
+            }
+        } else if (column.type == PhysicalType::Double && node.type == PhysicalType::Double) {
+            compareToLiteral(node.op, column.doubles.data() + begin, n, node.doubleValue, out);
+        } else {
+            return false;
+        }
+        clearNullRows(column, begin, n, out);
+        return true;
+    }
+
+    // The dictionary is sorted, so every comparison with a literal is a code
+    // range [lo, hi) (complemented for !=)
+    static void compareCodes(const PredicateNode& node, const Column& column, size_t begin, size_t n,
+                             uint8_t* out) {
+        const StringDictionary& dict = *column.dictionary;
+        auto lower = static_cast<uint32_t>(
+            std::lower_bound(dict.begin(), dict.end(), node.stringValue) - dict.begin());
+        bool found = lower < dict.size() && dict[lower] == node.stringValue;
+        uint32_t upper = lower + (found ? 1 : 0);  // First code above the literal
+        auto size = static_cast<uint32_t>(dict.size());
+        uint32_t lo = 0, hi = 0;
+        bool negate = false;
+        switch (node.op) {
+            case ExprOp::Eq: lo = lower; hi = upper; break;
+            case ExprOp::Ne: lo = lower; hi = upper; negate = true; break;
+            case ExprOp::Lt: lo = 0; hi = lower; break;
+            case ExprOp::Le: lo = 0; hi = upper; break;
+            case ExprOp::Gt: lo = upper; hi = size; break;
+            default: lo = lower; hi = size; break;
+        }
+        const uint32_t* codes = column.codes.data() + begin;
+        uint32_t width = hi - lo;
+        uint8_t flip = negate ? 1 : 0;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<uint8_t>((codes[i] - lo) < width) ^ flip;
+        }
+    }
+
+    bool compareFields(const PredicateNode& node, size_t begin, size_t n, uint8_t* out) const {
+        const Column& lhs = batch.columns[node.slot];
+        const Column& rhs = batch.columns[node.otherSlot];
+        if (lhs.isPacked() || rhs.isPacked() || lhs.type != node.type || rhs.type != node.type) {
+            return false;
+        }
+        withComparison(node.op, [&](auto cmp) {
+            if (node.type == PhysicalType::Int64) {
+                compareColumnsKernel(lhs.ints.data() + begin, rhs.ints.data() + begin, n, out, cmp);
+            } else {
+                compareColumnsKernel(lhs.doubles.data() + begin, rhs.doubles.data() + begin, n, out, cmp);
+            }
+        });
+        clearNullRows(lhs, begin, n, out);
+        clearNullRows(rhs, begin, n, out);
+        return true;
+    }
+
+    void eval(const PredicateNode& node, size_t begin, size_t n, uint8_t* out) const {
+        switch (node.kind) {
+            case PredicateNode::Kind::Compare:
+                if (!compare(node, begin, n, out)) interpret(node, begin, n, out);
+                return;
+            case PredicateNode::Kind::CompareFields:
+                if (!compareFields(node, begin, n, out)) interpret(node, begin, n, out);
+                return;
+            case PredicateNode::Kind::And:
+            case PredicateNode::Kind::Or: {
+                bool isAnd = node.kind == PredicateNode::Kind::And;
+                eval(node.children[0], begin, n, out);
+                std::vector<uint8_t> scratch(n);
+                for (size_t c = 1; c < node.children.size(); ++c) {
+                    // Stop once the result can no longer change
+                    bool settled = isAnd ? std::none_of(out, out + n, [](uint8_t v) { return v; })
+                                         : std::all_of(out, out + n, [](uint8_t v) { return v; });
+                    if (settled) break;
+                    eval(node.children[c], begin, n, scratch.data());
+                    combineMasks(out, scratch.data(), n, isAnd);
+                }
+                return;
+            }
+            case PredicateNode::Kind::Interpreted:
+                interpret(node, begin, n, out);
+                return;
+        }
+    }
+};
+
+enum class ZoneResult : uint8_t { None, Some, All };
+
+// What a block with values in [lo, hi] can give for `value <op> literal`.
+// exact means every row of the block is a valid, ordered value.
+template <typename T>
+ZoneResult checkRange(ExprOp op, T lo, T hi, T literal, bool exact) {
+    if (lo > hi) {
+        return ZoneResult::None;  // No valid rows at all
+    }
+    bool none = false;
+    bool all = false;
+    switch (op) {
+        case ExprOp::Eq: none = literal < lo || literal > hi; all = lo == literal && hi == literal; break;
+        case ExprOp::Ne: none = exact && lo == literal && hi == literal; all = literal < lo || literal > hi; break;
+        case ExprOp::Lt: none = lo >= literal; all = hi < literal; break;
+        case ExprOp::Le: none = lo > literal; all = hi <= literal; break;
+        case ExprOp::Gt: none = hi <= literal; all = lo > literal; break;
+        default: none = hi < literal; all = lo >= literal; break;
+    }
+    if (none) return ZoneResult::None;
+    return all && exact ? ZoneResult::All : ZoneResult::Some;
+}
+
+const ZoneMap* zonesFor(const PredicateNode& node, const Batch& batch) {
+    if (node.kind != PredicateNode::Kind::Compare || node.slot >= batch.columns.size()) {
+        return nullptr;
+    }
+    const Column& column = batch.columns[node.slot];
+    size_t blocks = (column.size() + ZoneMap::kBlockRows - 1) / ZoneMap::kBlockRows;
+    if (!column.zones || column.zones->blocks() != blocks) {
+        return nullptr;
+    }
+    if (column.type == PhysicalType::Int64 && isNumeric(node.type)) return column.zones.get();
+    if (column.type == PhysicalType::Double && node.type == PhysicalType::Double) return column.zones.get();
+    return nullptr;
+}
+
+bool usesZones(const PredicateNode& node, const Batch& batch) {
+    if (zonesFor(node, batch)) {
+        return true;
+    }
+    return std::any_of(node.children.begin(), node.children.end(),
+                       [&batch](const PredicateNode& child) { return usesZones(child, batch); });
+}
+
+ZoneResult classifyBlock(const PredicateNode& node, const Batch& batch, size_t block) {
+    switch (node.kind) {
+        case PredicateNode::Kind::Compare: {
+            const ZoneMap* zones = zonesFor(node, batch);
+            if (!zones) return ZoneResult::Some;
+            bool exact = zones->exact[block] != 0;
+            if (batch.columns[node.slot].type == PhysicalType::Double) {
+                return checkRange(node.op, zones->doubleMin[block], zones->doubleMax[block], node.doubleValue, exact);
+            }
+            if (node.type == PhysicalType::Int64) {
+                return checkRange(node.op, zones->intMin[block], zones->intMax[block], node.intValue, exact);
+            }
+            return checkRange(node.op, static_cast<double>(zones->intMin[block]),
+                              static_cast<double>(zones->intMax[block]), node.doubleValue, exact);
+        }
+        case PredicateNode::Kind::And: {
+            ZoneResult result = ZoneResult::All;
+            for (const auto& child : node.children) {
+                ZoneResult r = classifyBlock(child, batch, block);
+                if (r == ZoneResult::None) return r;
+                if (r == ZoneResult::Some) result = r;
+            }
+            return result;
+        }
+        case PredicateNode::Kind::Or: {
+            ZoneResult result = ZoneResult::None;
+            for (const auto& child : node.children) {
+                ZoneResult r = classifyBlock(child, batch, block);
+                if (r == ZoneResult::All) return r;
+                if (r == ZoneResult::Some) result = r;
+            }
+            return result;
+        }
+        default:
+            return ZoneResult::Some;
+    }
+}
+
+} // namespace
+
+PredicatePlan compilePredicate(const ExprPtr& bound) {
+    PredicatePlan plan;
+    plan.root = compileNode(bound, plan);
+    return plan;
+}
+
+SelectionVector PredicatePlan::select(const Batch& batch, FilterStats* stats) const {
+    size_t rows = batch.rowCount();
+    std::vector<uint8_t> mask(rows, 0);
+    RangeEvaluator evaluator{batch};
+    auto evalRange = [&](size_t begin, size_t end) {
+        if (end > begin) {
+            evaluator.eval(root, begin, end - begin, mask.data() + begin);
+            if (stats) stats->rowsEvaluated += end - begin;
+        }
+    };
+
+    if (!usesZones(root, batch)) {
+        evalRange(0, rows);
+    } else {
+        // Consecutive undecided blocks are evaluated as one range
+        size_t blocks = (rows + ZoneMap::kBlockRows - 1) / ZoneMap::kBlockRows;
+        size_t runBegin = 0;
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t begin = b * ZoneMap::kBlockRows;
+            size_t end = std::min(rows, begin + ZoneMap::kBlockRows);
+            ZoneResult result = classifyBlock(root, batch, b);
+            if (result == ZoneResult::Some) {
+                continue;
+            }
+            evalRange(runBegin, begin);
+            runBegin = end;
+            if (result == ZoneResult::All) {
+                std::fill(mask.begin() + begin, mask.begin() + end, 1);
+                if (stats) ++stats->blocksAccepted;
+            } else if (stats) {
+                ++stats->blocksSkipped;
+            }
+        }
+        evalRange(runBegin, rows);
+    }
+
+    // Branch-free compaction: every row index is written, only selected ones advance
+    SelectionVector selection(rows);
+    size_t count = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        selection[count] = static_cast<uint32_t>(r);
+        count += mask[r];
+    }
+    selection.resize(count);
+    return selection;
+}
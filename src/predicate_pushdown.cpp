@@ -0,0 +1,81 @@
+#include "predicate_pushdown.h"
+#include "expression_optimizer.h"
+#include "pipeline.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include <algorithm>
+
+// True if a match reading `fields` can run before stage instead of after it
+static bool canMoveAbove(const LogicalNode& stage, const std::vector<std::string>& fields) {
+    if (dynamic_cast<const SortLogicalNode*>(&stage)) {
+        return true;
+    }
+    if (auto* setMetadata = dynamic_cast<const SetMetadataLogicalNode*>(&stage)) {
+        // A sink must still see every row that reached the stage
+        return !setMetadata->hasSideEffects() && std::find(fields.begin(), fields.end(), setMetadata->params.metaName) == fields.end();
+    }
+    return false;
+}
+
+void pushDownMatches(Pipeline& pipeline) {
+    auto& stages = pipeline.stages;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        auto* match = dynamic_cast<MatchLogicalNode*>(stages[i].get());
+        if (!match) {
+            continue;
+        }
+        auto parsed = match->parsedExpression();
+        if (!parsed) {
+            continue;  // Reported when the pipeline is bound
+        }
+        match->expression = simplifyExpression(*parsed);
+        std::vector<std::string> fields;
+        collectFieldNames(*match->expression, fields);
+
+        size_t target = i;
+        while (target > 0 && canMoveAbove(*stages[target - 1], fields)) {
+            --target;
+        }
+        // Stages [target, i) shift down by one, keeping their order
+        std::rotate(stages.begin() + target, stages.begin() + i, stages.begin() + i + 1);
+    }
+}
+
+// True if a filter on key can run before stage: besides the stages a match
+// can move above, filters commute with other filters, and a project keeps
+// the key's values
+static bool canFilterAbove(const LogicalNode& stage, const std::string& key) {
+    if (dynamic_cast<const MatchLogicalNode*>(&stage) || dynamic_cast<const RuntimeFilterLogicalNode*>(&stage)) {
+        return true;
+    }
+    if (auto* project = dynamic_cast<const ProjectLogicalNode*>(&stage)) {
+        const auto& fields = project->params.fields;
+        return std::find(fields.begin(), fields.end(), key) != fields.end();
+    }
+    return canMoveAbove(stage, {key});
+}
+
+void pushDownJoinFilters(Pipeline& pipeline) {
+    auto& stages = pipeline.stages;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        auto* join = dynamic_cast<JoinLogicalNode*>(stages[i].get());
+        if (!join || join->filterPushedDown) {
+            continue;
+        }
+        size_t target = i;
+        while (target > 0 && canFilterAbove(*stages[target - 1], join->params.probeKey)) {
+            --target;
+        }
+        if (target == i) {
+            continue;  // The join applies the filter itself
+        }
+        join->filterPushedDown = true;
+        stages.insert(stages.begin() + target,
+                      std::make_unique<RuntimeFilterLogicalNode>(join->params.probeKey, join->params.probeKeyId,
+                                                                 join->runtimeFilter));
+        ++i;
+    }
+}
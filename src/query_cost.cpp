@@ -0,0 +1,112 @@
+#include "query_cost.h"
+#include "batch.h"
+#include "pipeline.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include "src/logical_nodes/window_logical_node.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// As in the group and join stages: fewer rows than this per thread are not
+// worth another thread
+constexpr size_t kMinRowsPerThread = 8192;
+// Group state per distinct key: entry, a few aggregates and the probe slot
+constexpr size_t kGroupEntryBytes = 64;
+// A degraded group still keeps this much state before spilling
+constexpr size_t kMinGroupBudget = size_t{4} << 20;
+
+uint32_t threadsFor(size_t rows, uint32_t maxThreads) {
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<uint32_t>(std::clamp<size_t>(rows / kMinRowsPerThread, 1, maxThreads ? maxThreads : hardware));
+}
+
+double sortWork(size_t rows) {
+    return static_cast<double>(rows) * std::log2(static_cast<double>(std::max<size_t>(rows, 2)));
+}
+
+} // namespace
+
+QueryCost estimatePipelineCost(const Pipeline& pipeline, const Batch& input) {
+    size_t rows = input.rowCount();
+    size_t inputBytes = input.byteSize();
+    size_t rowBytes = rows ? (inputBytes + rows - 1) / rows : 0;
+
+    QueryCost cost;
+    size_t peakExtra = 0;
+    size_t minPeakExtra = 0;
+    auto working = [&](size_t bytes, size_t minBytes) {
+        peakExtra = std::max(peakExtra, bytes);
+        minPeakExtra = std::max(minPeakExtra, minBytes);
+    };
+    for (const auto& stage : pipeline.stages) {
+        const LogicalNode* node = stage.get();
+        if (auto* limit = dynamic_cast<const LimitLogicalNode*>(node)) {
+            rows = std::min(rows, limit->params.rowsNeeded());
+            cost.work += static_cast<double>(rows);
+        } else if (auto* topK = dynamic_cast<const TopKLogicalNode*>(node)) {
+            size_t k = topK->limit->params.rowsNeeded();
+            cost.work += static_cast<double>(rows) * std::log2(static_cast<double>(k) + 2);
+            rows = std::min(rows, k);
+            working(rows * rowBytes, rows * rowBytes);
+        } else if (dynamic_cast<const SortLogicalNode*>(node)) {
+            // Permutation plus the gathered copy
+            cost.work += sortWork(rows);
+            working(rows * (rowBytes + sizeof(uint32_t)), rows * (rowBytes + sizeof(uint32_t)));
+        } else if (auto* group = dynamic_cast<const GroupLogicalNode*>(node)) {
+            size_t state = rows * kGroupEntryBytes;
+            cost.work += static_cast<double>(rows);
+            cost.threads = std::max(cost.threads, threadsFor(rows, group->maxThreads));
+            working(std::min(state, group->memoryBudget), std::min(state, kMinGroupBudget));
+        } else if (auto* join = dynamic_cast<const JoinLogicalNode*>(node)) {
+            // The build side's hash table is built once at bind() and shared
+            size_t buildRows = join->buildSide ? join->buildSide->rowCount() : 0;
+            size_t buildBytes = join->buildSide ? join->buildSide->byteSize() : 0;
+            cost.work += static_cast<double>(rows + buildRows);
+            cost.threads = std::max(cost.threads, threadsFor(rows, join->maxThreads));
+            // Probe rows gain the build side's columns
+            if (buildRows) rowBytes += (buildBytes + buildRows - 1) / buildRows;
+            working(rows * rowBytes, rows * rowBytes);
+        } else if (auto* window = dynamic_cast<const WindowLogicalNode*>(node)) {
+            cost.work += sortWork(rows) + static_cast<double>(rows);
+            cost.threads = std::max(cost.threads, threadsFor(rows, window->maxThreads));
+            working(rows * (rowBytes + sizeof(uint32_t)), rows * (rowBytes + sizeof(uint32_t)));
+        } else if (auto* distinct = dynamic_cast<const DistinctLogicalNode*>(node)) {
+            // Beyond its budget the stage sorts instead, needing a permutation
+            size_t table = std::min(rows * rowBytes, distinct->hashTableBudget);
+            cost.work += static_cast<double>(rows);
+            working(table + rows * sizeof(uint32_t), table + rows * sizeof(uint32_t));
+        } else {
+            // Matches, projects, set_metadata and runtime filters: one pass and
+            // a selection vector or one new column
+            cost.work += static_cast<double>(rows);
+            working(rows * sizeof(uint64_t), rows * sizeof(uint64_t));
+        }
+    }
+    cost.memoryBytes = inputBytes + peakExtra;
+    cost.minMemoryBytes = inputBytes + minPeakExtra;
+    return cost;
+}
+
+QueryCost degradePipeline(Pipeline& pipeline, const Batch& input, size_t memoryBytes) {
+    size_t inputBytes = input.byteSize();
+    size_t groupBudget = std::max(memoryBytes > inputBytes ? memoryBytes - inputBytes : 0, kMinGroupBudget);
+    for (auto& stage : pipeline.stages) {
+        LogicalNode* node = stage.get();
+        if (auto* group = dynamic_cast<GroupLogicalNode*>(node)) {
+            group->maxThreads = 1;
+            group->memoryBudget = std::min(group->memoryBudget, groupBudget);
+        } else if (auto* join = dynamic_cast<JoinLogicalNode*>(node)) {
+            join->maxThreads = 1;
+        } else if (auto* window = dynamic_cast<WindowLogicalNode*>(node)) {
+            window->maxThreads = 1;
+        }
+    }
+    return estimatePipelineCost(pipeline, input);
+}
@@ -0,0 +1,333 @@
+#include "query_server.h"
+#include "batch.h"
+#include "catalog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kMaxRequestBytes = size_t{1} << 20;
+
+// A coalesced follower runs nothing and shares the leader's result
+constexpr QueryCost kFollowerCost{0, 0, 0, 0};
+
+// Tabs and newlines would break the line protocol
+void appendEscaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\\': out += "\\\\"; break;
+            default: out += c;
+        }
+    }
+}
+
+void appendCell(std::string& out, const Column& column, size_t row) {
+    if (!column.isValid(row)) {
+        out += "null";
+        return;
+    }
+    std::ostringstream oss;
+    switch (column.type) {
+        case PhysicalType::Bool: out += column.bools[row] ? "true" : "false"; return;
+        case PhysicalType::Int64: out += std::to_string(column.ints[row]); return;
+        case PhysicalType::Double: oss << column.doubles[row]; break;
+        case PhysicalType::String: appendEscaped(out, column.strings[row]); return;
+        case PhysicalType::Vector:
+            oss << "[";
+            for (uint32_t d = 0; d < column.dimension; ++d) {
+                oss << (d ? "," : "") << column.floats[size_t{row} * column.dimension + d];
+            }
+            oss << "]";
+            break;
+    }
+    out += oss.str();
+}
+
+// "<status> <rows> <columns>[ <message>]", the header line, then the rows
+std::string formatBatch(const char* status, const Batch& batch, std::string_view message) {
+    std::string out = std::string(status) + " " + std::to_string(batch.rowCount()) + " " +
+                      std::to_string(batch.columns.size());
+    if (!message.empty()) {
+        out += " ";
+        appendEscaped(out, message);
+    }
+    out += "\n";
+    for (size_t c = 0; c < batch.schema.fields.size(); ++c) {
+        if (c) out += "\t";
+        appendEscaped(out, batch.schema.fields[c].name);
+    }
+    std::vector<Column> columns;
+    for (const auto& column : batch.columns) columns.push_back(column.decoded());
+    for (size_t row = 0; row < batch.rowCount(); ++row) {
+        out += "\n";
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c) out += "\t";
+            appendCell(out, columns[c], row);
+        }
+    }
+    return out;
+}
+
+// First line only: the protocol answers errors on one line
+std::string describe(const Diagnostic& diag) {
+    return std::string(diag.message()) + " at position " + std::to_string(diag.position);
+}
+
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+} // namespace
+
+QueryServer::QueryServer(Catalog& catalog, QueryServerOptions options)
+    : catalog(catalog), maxConnections(options.maxConnections), admissionControl(options.admission) {
+    uint32_t count = options.workers ? options.workers : admissionControl.options().threads;
+    for (uint32_t i = 0; i < count; ++i) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+QueryServer::~QueryServer() {
+    stop();
+}
+
+void QueryServer::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            poolChanged.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void QueryServer::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        tasks.push_back(std::move(task));
+    }
+    poolChanged.notify_one();
+}
+
+QueryResponse QueryServer::run(std::string_view table, std::string_view pipelineText) {
+    QueryResponse response;
+    auto turnAway = [&](QueryOutcome outcome, std::string message) {
+        ++(outcome == QueryOutcome::Rejected ? rejectedCount : failedCount);
+        response.outcome = outcome;
+        response.message = std::move(message);
+        return response;
+    };
+
+    auto input = catalog.findTable(table);
+    if (!input) {
+        return turnAway(QueryOutcome::Failed, "unknown table " + std::string(table));
+    }
+    auto pipeline = tryBuildPipeline(pipelineText, catalog);
+    if (!pipeline) {
+        return turnAway(QueryOutcome::Failed, describe(pipeline.error()));
+    }
+    optimizePipeline(*pipeline, catalog);
+    if (auto bound = bindPipeline(*pipeline, input->schema, catalog.symbols); !bound) {
+        return turnAway(QueryOutcome::Failed, describe(bound.error()));
+    }
+
+    // Identical to a query running right now: wait for its result on this
+    // thread. Should it land (or fail) first, this query runs normally.
+    uint64_t version = catalog.tableVersion(table);
+    uint64_t plan = planFingerprint(*pipeline);
+    if (plan && subplans.computing(plan, version)) {
+        if (auto acquired = admissionControl.acquire(kFollowerCost); !acquired) {
+            return turnAway(QueryOutcome::Rejected, std::move(acquired.error()));
+        }
+        response.result = subplans.join(plan, version);
+        admissionControl.release(kFollowerCost);
+        if (response.result) {
+            response.cost = kFollowerCost;
+            ++completedCount;
+            return response;
+        }
+    }
+
+    Admission admission = admissionControl.admit(estimatePipelineCost(*pipeline, *input));
+    if (admission.decision == AdmissionDecision::Reject) {
+        return turnAway(QueryOutcome::Rejected, std::move(admission.reason));
+    }
+    if (admission.decision == AdmissionDecision::Degrade) {
+        admission.cost = degradePipeline(*pipeline, *input, admission.cost.memoryBytes);
+        response.outcome = QueryOutcome::Degraded;
+        response.message = std::move(admission.reason);
+    }
+    if (auto acquired = admissionControl.acquire(admission.cost); !acquired) {
+        return turnAway(QueryOutcome::Rejected, std::move(acquired.error()));
+    }
+    response.cost = admission.cost;
+
+    std::promise<void> done;
+    std::string error;
+    submit([&] {
+        try {
+            response.result = executePipelineCoalesced(*pipeline, *input, version, subplans);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        admissionControl.release(admission.cost);
+        done.set_value();
+    });
+    done.get_future().wait();
+    if (!response.result) {
+        return turnAway(QueryOutcome::Failed, error);
+    }
+    ++(response.outcome == QueryOutcome::Degraded ? degradedCount : completedCount);
+    return response;
+}
+
+std::string QueryServer::handleRequest(std::string_view line) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+    while (!line.empty() && line.front() == ' ') line.remove_prefix(1);
+    if (line == "stats") {
+        Batch stats;
+        std::vector<std::pair<const char*, size_t>> values = {
+            {"running", admissionControl.running()},   {"queued", admissionControl.queued()},
+            {"completed", completedCount},             {"degraded", degradedCount},
+            {"rejected", rejectedCount},               {"failed", failedCount},
+            {"memory_bytes", admissionControl.memoryInUse()},
+        };
+        for (const auto& [name, value] : values) {
+            stats.schema.fields.push_back(Field{name, kInvalidSymbol, PhysicalType::Int64});
+            stats.columns.push_back(Column::ofInts({static_cast<int64_t>(value)}));
+        }
+        return formatBatch("ok", stats, "");
+    }
+
+    size_t space = line.find(' ');
+    if (space == std::string_view::npos) {
+        return "error expected \"<table> <pipeline>\" or \"stats\"";
+    }
+    QueryResponse response = run(line.substr(0, space), line.substr(space + 1));
+    std::string out;
+    switch (response.outcome) {
+        case QueryOutcome::Ok: return formatBatch("ok", *response.result, "");
+        case QueryOutcome::Degraded: return formatBatch("degraded", *response.result, response.message);
+        case QueryOutcome::Rejected: out = "rejected "; break;
+        case QueryOutcome::Failed: out = "error "; break;
+    }
+    appendEscaped(out, response.message);
+    return out;
+}
+
+bool QueryServer::listen(const std::string& path) {
+    sockaddr_un address{};
+    if (listenFd >= 0 || path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    // A socket left behind by a server that died; anything else stays
+    struct stat status;
+    if (::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 128) != 0) {
+        ::close(fd);
+        return false;
+    }
+    socketPath = path;
+    listenFd = fd;
+    acceptor = std::thread([this] { acceptConnections(); });
+    return true;
+}
+
+void QueryServer::acceptConnections() {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;  // stop() shut the socket down
+        }
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        if (connectionFds.size() >= maxConnections) {
+            ++rejectedCount;
+            sendAll(fd, "rejected too many connections\n");
+            ::close(fd);
+            continue;
+        }
+        connectionFds.push_back(fd);
+        std::thread([this, fd] { serveConnection(fd); }).detach();
+    }
+}
+
+void QueryServer::serveConnection(int fd) {
+    std::string buffer;
+    char chunk[4096];
+    bool open = true;
+    while (open) {
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(received));
+        size_t start = 0;
+        for (size_t newline; open && (newline = buffer.find('\n', start)) != std::string::npos; start = newline + 1) {
+            std::string_view line(buffer.data() + start, newline - start);
+            if (line.find_first_not_of(" \r") == std::string_view::npos) continue;
+            open = sendAll(fd, handleRequest(line) + "\n");
+        }
+        buffer.erase(0, start);
+        if (buffer.size() > kMaxRequestBytes) {
+            sendAll(fd, "error request too long\n");
+            open = false;
+        }
+    }
+    // Closed under the lock, so stop() never shuts down a reused descriptor
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    connectionFds.erase(std::find(connectionFds.begin(), connectionFds.end(), fd));
+    ::close(fd);
+    connectionClosed.notify_all();
+}
+
+size_t QueryServer::connections() const {
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    return connectionFds.size();
+}
+
+void QueryServer::stop() {
+    if (int fd = listenFd.exchange(-1); fd >= 0) {
+        ::shutdown(fd, SHUT_RDWR);
+        acceptor.join();
+        ::close(fd);
+        ::unlink(socketPath.c_str());
+    }
+    {
+        // Wakes connections blocked in recv(); one running a query finishes it first
+        std::unique_lock<std::mutex> lock(connectionMutex);
+        for (int fd : connectionFds) ::shutdown(fd, SHUT_RDWR);
+        connectionClosed.wait(lock, [&] { return connectionFds.empty(); });
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    poolChanged.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
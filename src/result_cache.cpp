@@ -0,0 +1,278 @@
+#include "result_cache.h"
+#include "batch.h"
+#include "fingerprint.h"
+#include "params_codec.h"
+#include "pipeline.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include "src/logical_nodes/window_logical_node.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace {
+
+// The encoding starts with the variant index, so it covers the stage kind
+uint64_t paramsFingerprint(const AstParams& params) {
+    return fnv1a64(encodeParams(params));
+}
+
+uint64_t nodeFingerprint(const LogicalNode& node) {
+    if (auto* limit = dynamic_cast<const LimitLogicalNode*>(&node)) return paramsFingerprint(limit->params);
+    if (auto* sort = dynamic_cast<const SortLogicalNode*>(&node)) return paramsFingerprint(sort->params);
+    if (auto* setMetadata = dynamic_cast<const SetMetadataLogicalNode*>(&node)) {
+        // Writes to a sink must happen on every run
+        return setMetadata->hasSideEffects() ? 0 : paramsFingerprint(setMetadata->params);
+    }
+    if (auto* group = dynamic_cast<const GroupLogicalNode*>(&node)) return paramsFingerprint(group->params);
+    if (auto* match = dynamic_cast<const MatchLogicalNode*>(&node)) return paramsFingerprint(match->params);
+    if (auto* project = dynamic_cast<const ProjectLogicalNode*>(&node)) return paramsFingerprint(project->params);
+    if (auto* window = dynamic_cast<const WindowLogicalNode*>(&node)) return paramsFingerprint(window->params);
+    if (auto* distinct = dynamic_cast<const DistinctLogicalNode*>(&node)) return paramsFingerprint(distinct->params);
+    if (auto* join = dynamic_cast<const JoinLogicalNode*>(&node)) {
+        // A table replaced in the catalog changes the result
+        return join->buildVersion ? hashCombine(paramsFingerprint(join->params), join->buildVersion) : 0;
+    }
+    if (auto* topK = dynamic_cast<const TopKLogicalNode*>(&node)) {
+        // Same rows as the three stages it fused
+        uint64_t hash = fnv1a64("top_k");
+        for (const LogicalNode* part : {static_cast<const LogicalNode*>(topK->score.get()),
+                                        static_cast<const LogicalNode*>(topK->sort.get()),
+                                        static_cast<const LogicalNode*>(topK->limit.get())}) {
+            hash = hashCombine(hash, nodeFingerprint(*part));
+        }
+        return hash;
+    }
+    return 0;
+}
+
+// Windows live beside full results of the same subplan
+uint64_t windowKey(uint64_t fingerprint) {
+    return hashCombine(fingerprint, fnv1a64("top_n"));
+}
+
+// A stage that keeps leading rows of an ordered subplan: a limit, or the
+// limit inside a fused top-k (whose subplan then ends with its score and
+// sort, fingerprinted as if they were separate stages)
+struct RowWindow {
+    uint64_t fingerprint = 0;  // Of the ordered subplan; 0 when none
+    const LimitLogicalNode* limit = nullptr;
+    const TopKLogicalNode* fused = nullptr;  // The top-k, when the limit is inside one
+};
+
+RowWindow rowWindow(const LogicalNode& stage, uint64_t prefix) {
+    if (!prefix) {
+        return {};
+    }
+    if (auto* limit = dynamic_cast<const LimitLogicalNode*>(&stage)) {
+        return {prefix, limit, nullptr};
+    }
+    if (auto* topK = dynamic_cast<const TopKLogicalNode*>(&stage)) {
+        uint64_t score = nodeFingerprint(*topK->score);
+        uint64_t sort = nodeFingerprint(*topK->sort);
+        if (score && sort) {
+            return {hashCombine(hashCombine(prefix, score), sort), topK->limit.get(), topK};
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+uint64_t stageFingerprint(const Pipeline& pipeline, size_t stage) {
+    const auto& stages = pipeline.stages;
+    if (auto* filter = dynamic_cast<const RuntimeFilterLogicalNode*>(stages[stage].get())) {
+        // The Bloom filter comes from a later join's build side
+        for (size_t i = stage + 1; i < stages.size(); ++i) {
+            auto* join = dynamic_cast<const JoinLogicalNode*>(stages[i].get());
+            if (join && join->runtimeFilter == filter->filter) {
+                uint64_t joined = nodeFingerprint(*join);
+                return joined ? hashCombine(fnv1a64("runtime_filter"), joined) : 0;
+            }
+        }
+        return 0;
+    }
+    return nodeFingerprint(*stages[stage]);
+}
+
+uint64_t subplanFingerprint(const Pipeline& pipeline, size_t end) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (size_t i = 0; i < end; ++i) {
+        uint64_t stage = stageFingerprint(pipeline, i);
+        if (stage == 0) {
+            return 0;
+        }
+        hash = hashCombine(hash, stage);
+    }
+    return hash;
+}
+
+std::optional<ResultCache::Hit> ResultCache::lookup(uint64_t fingerprint, uint64_t inputVersion) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find({fingerprint, inputVersion});
+    if (it == entries.end()) {
+        ++missCount;
+        return std::nullopt;
+    }
+    ++hitCount;
+    Entry& entry = it->second;
+    ++entry.frequency;
+    setPriority(it->first, entry);
+    return Hit{entry.result, entry.cost};
+}
+
+std::optional<ResultCache::Hit> ResultCache::lookupRows(uint64_t fingerprint, uint64_t inputVersion, size_t rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find({windowKey(fingerprint), inputVersion});
+    if (it == entries.end() ||
+        (rows > it->second.windowRows && it->second.result->rowCount() >= it->second.windowRows)) {
+        ++missCount;
+        return std::nullopt;
+    }
+    ++hitCount;
+    Entry& entry = it->second;
+    ++entry.frequency;
+    setPriority(it->first, entry);
+    return Hit{entry.result, entry.cost};
+}
+
+bool ResultCache::insert(uint64_t fingerprint, uint64_t inputVersion, std::shared_ptr<const Batch> result,
+                         double cost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return store({fingerprint, inputVersion}, std::move(result), cost, 0);
+}
+
+bool ResultCache::insertRows(uint64_t fingerprint, uint64_t inputVersion, std::shared_ptr<const Batch> firstRows,
+                             size_t rows, double cost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Key key{windowKey(fingerprint), inputVersion};
+    if (auto it = entries.find(key); it != entries.end()) {
+        const Entry& cached = it->second;
+        if (cached.windowRows >= rows || cached.result->rowCount() < cached.windowRows) {
+            return true;  // Already answers everything this one would
+        }
+    }
+    return store(key, std::move(firstRows), cost, rows);
+}
+
+bool ResultCache::store(const Key& key, std::shared_ptr<const Batch> result, double cost, size_t windowRows) {
+    size_t resultBytes = std::max<size_t>(result->byteSize(), 1);
+    if (auto it = entries.find(key); it != entries.end()) {
+        erase(it);
+    }
+    if (resultBytes > capacityBytes) {
+        return false;
+    }
+    while (usedBytes + resultBytes > capacityBytes) {
+        auto [priority, victimFingerprint, victimVersion] = *byPriority.begin();
+        clock = priority;
+        erase(entries.find({victimFingerprint, victimVersion}));
+        ++evictionCount;
+    }
+    Entry& entry = entries[key];
+    entry.result = std::move(result);
+    entry.bytes = resultBytes;
+    entry.cost = cost;
+    entry.windowRows = windowRows;
+    usedBytes += resultBytes;
+    setPriority(key, entry);
+    return true;
+}
+
+void ResultCache::invalidate(uint64_t inputVersion) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+        if (it->first.second == inputVersion) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t ResultCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+void ResultCache::setPriority(const Key& key, Entry& entry) {
+    byPriority.erase({entry.priority, key.first, key.second});
+    entry.priority = clock + static_cast<double>(entry.frequency) * entry.cost / static_cast<double>(entry.bytes);
+    byPriority.insert({entry.priority, key.first, key.second});
+}
+
+void ResultCache::erase(std::unordered_map<Key, Entry, KeyHash>::iterator it) {
+    byPriority.erase({it->second.priority, it->first.first, it->first.second});
+    usedBytes -= it->second.bytes;
+    entries.erase(it);
+}
+
+void executePipelineCached(const Pipeline& pipeline, Batch& batch, uint64_t inputVersion, ResultCache& cache) {
+    const auto& stages = pipeline.stages;
+    // prefixes[i]: fingerprint of stages [0, i)
+    std::vector<uint64_t> prefixes(stages.size() + 1, 0);
+    prefixes[0] = kFnvOffsetBasis;
+    for (size_t i = 0; i < stages.size() && prefixes[i]; ++i) {
+        uint64_t stage = stageFingerprint(pipeline, i);
+        prefixes[i + 1] = stage ? hashCombine(prefixes[i], stage) : 0;
+    }
+
+    size_t start = 0;
+    double cost = 0;  // Time to compute the current batch from the input
+    for (size_t end = stages.size(); end > 0; --end) {
+        if (!prefixes[end]) continue;
+        if (auto hit = cache.lookup(prefixes[end], inputVersion)) {
+            batch = *hit->result;
+            start = end;
+            cost = hit->cost;
+            break;
+        }
+        RowWindow window = rowWindow(*stages[end - 1], prefixes[end - 1]);
+        if (!window.fingerprint) continue;
+        if (auto hit = cache.lookupRows(window.fingerprint, inputVersion, window.limit->params.rowsNeeded())) {
+            batch = *hit->result;
+            window.limit->execute(batch);
+            start = end;
+            cost = hit->cost;
+            break;
+        }
+    }
+
+    for (size_t i = start; i < stages.size(); ++i) {
+        RowWindow window = rowWindow(*stages[i], prefixes[i]);
+        size_t rows = window.limit ? window.limit->params.rowsNeeded() : 0;
+        if (window.fingerprint && !window.fused && cost >= cache.minStageCost) {
+            // The ordered input is all here: keep its leading rows
+            auto firstRows = std::make_shared<Batch>(batch);
+            for (auto& column : firstRows->columns) column.truncate(rows);
+            cache.insertRows(window.fingerprint, inputVersion, std::move(firstRows), rows, cost);
+        }
+
+        auto began = std::chrono::steady_clock::now();
+        stages[i]->execute(batch);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+        cost += elapsed;
+        if (window.fingerprint && window.fused && window.limit->params.offset == 0 && cost >= cache.minStageCost &&
+            !window.fused->lastUsedIndex) {
+            // A fused top-k with no offset outputs exactly the leading rows,
+            // unless the HNSW index answered it: those are only approximate,
+            // and the window is keyed like the exact score and sort
+            cache.insertRows(window.fingerprint, inputVersion, std::make_shared<const Batch>(batch), rows, cost);
+        }
+        if (prefixes[i + 1] && elapsed >= cache.minStageCost) {
+            cache.insert(prefixes[i + 1], inputVersion, std::make_shared<const Batch>(batch), cost);
+        }
+    }
+}
@@ -0,0 +1,170 @@
+#include "shared_subplans.h"
+#include "batch.h"
+#include "fingerprint.h"
+#include "pipeline.h"
+#include "result_cache.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include <algorithm>
+
+std::shared_ptr<const Batch> SharedSubplans::share(uint64_t fingerprint, uint64_t inputVersion,
+                                                   const std::function<Batch()>& compute) {
+    Key key{fingerprint, inputVersion};
+    std::shared_ptr<Flight> flight;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = flights.find(key);
+        if (it != flights.end()) {
+            flight = it->second;
+            ++waitingCount;
+            landed.wait(lock, [&] { return flight->done; });
+            --waitingCount;
+            if (flight->result) {
+                ++followerCount;
+                return flight->result;
+            }
+            // The leader failed; compute on our own, without a flight
+            lock.unlock();
+            return std::make_shared<const Batch>(compute());
+        }
+        flight = std::make_shared<Flight>();
+        flights.emplace(key, flight);
+        ++leaderCount;
+    }
+
+    auto land = [&](std::shared_ptr<const Batch> result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        flight->result = std::move(result);
+        flight->done = true;
+        flights.erase(key);
+        landed.notify_all();
+    };
+    try {
+        auto result = std::make_shared<const Batch>(compute());
+        land(result);
+        return result;
+    } catch (...) {
+        land(nullptr);
+        throw;
+    }
+}
+
+std::shared_ptr<const Batch> SharedSubplans::join(uint64_t fingerprint, uint64_t inputVersion) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = flights.find({fingerprint, inputVersion});
+    if (it == flights.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<Flight> flight = it->second;
+    ++waitingCount;
+    landed.wait(lock, [&] { return flight->done; });
+    --waitingCount;
+    if (flight->result) {
+        ++followerCount;
+    }
+    return flight->result;
+}
+
+bool SharedSubplans::computing(uint64_t fingerprint, uint64_t inputVersion) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flights.count({fingerprint, inputVersion}) > 0;
+}
+
+size_t SharedSubplans::leaders() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return leaderCount;
+}
+
+size_t SharedSubplans::followers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return followerCount;
+}
+
+size_t SharedSubplans::waiting() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waitingCount;
+}
+
+size_t sharedPrefixLength(const Pipeline& pipeline) {
+    const auto& stages = pipeline.stages;
+    size_t afterSort = 0;
+    size_t scanEnd = 0;
+    bool scanning = true;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const LogicalNode* stage = stages[i].get();
+        if (dynamic_cast<const LimitLogicalNode*>(stage) || dynamic_cast<const TopKLogicalNode*>(stage) ||
+            !stageFingerprint(pipeline, i)) {
+            break;
+        }
+        scanning = scanning && (dynamic_cast<const MatchLogicalNode*>(stage) ||
+                                dynamic_cast<const ProjectLogicalNode*>(stage) ||
+                                dynamic_cast<const RuntimeFilterLogicalNode*>(stage));
+        if (scanning) scanEnd = i + 1;
+        if (dynamic_cast<const SortLogicalNode*>(stage)) afterSort = i + 1;
+    }
+    return afterSort ? afterSort : scanEnd;
+}
+
+void executePipelineShared(const Pipeline& pipeline, Batch& batch, uint64_t inputVersion, SharedSubplans& subplans) {
+    const auto& stages = pipeline.stages;
+    size_t end = sharedPrefixLength(pipeline);
+    if (end == 0) {
+        executePipeline(pipeline, batch);
+        return;
+    }
+
+    auto shared = subplans.share(subplanFingerprint(pipeline, end), inputVersion, [&] {
+        Batch prefix = std::move(batch);
+        for (size_t i = 0; i < end; ++i) stages[i]->execute(prefix);
+        return prefix;
+    });
+
+    size_t next = end;
+    if (end < stages.size()) {
+        if (auto* limit = dynamic_cast<const LimitLogicalNode*>(stages[end].get())) {
+            // Fan out: copy just this query's rows of the shared result
+            size_t rows = shared->rowCount();
+            SelectionVector kept;
+            for (size_t row = std::min<size_t>(limit->params.offset, rows);
+                 row < std::min(rows, limit->params.rowsNeeded()); ++row) {
+                kept.push_back(static_cast<uint32_t>(row));
+            }
+            batch.schema = shared->schema;
+            batch.columns.clear();
+            for (const auto& column : shared->columns) batch.columns.push_back(column.select(kept));
+            next = end + 1;
+        }
+    }
+    if (next == end) {
+        batch = *shared;
+    }
+    for (size_t i = next; i < stages.size(); ++i) {
+        stages[i]->execute(batch);
+    }
+}
+
+uint64_t planFingerprint(const Pipeline& pipeline) {
+    // A pipeline that is all prefix shares it under its plain fingerprint
+    // from inside executePipelineShared(), and would wait on itself
+    uint64_t plan = subplanFingerprint(pipeline, pipeline.stages.size());
+    return plan ? hashCombine(plan, fnv1a64("pipeline")) : 0;
+}
+
+std::shared_ptr<const Batch> executePipelineCoalesced(const Pipeline& pipeline, const Batch& input,
+                                                      uint64_t inputVersion, SharedSubplans& subplans) {
+    // Only the run that executes copies the input; subscribers never do
+    auto run = [&] {
+        Batch batch = input;
+        executePipelineShared(pipeline, batch, inputVersion, subplans);
+        return batch;
+    };
+    uint64_t plan = planFingerprint(pipeline);
+    if (!plan) {
+        return std::make_shared<const Batch>(run());
+    }
+    return subplans.share(plan, inputVersion, run);
+}
@@ -0,0 +1,65 @@
+#include "sorted_input.h"
+#include "pipeline.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include "src/logical_nodes/window_logical_node.h"
+#include <algorithm>
+
+// Keeps the longest prefix of order whose fields are all in kept
+static void truncateOrder(std::vector<std::string>& order, const std::vector<std::string>& kept) {
+    auto lost = std::find_if(order.begin(), order.end(), [&](const std::string& key) {
+        return std::find(kept.begin(), kept.end(), key) == kept.end();
+    });
+    order.erase(lost, order.end());
+}
+
+// True if keys are the first keys.size() entries of order, in any sequence
+static bool groupsEqualKeys(const std::vector<std::string>& order, const std::vector<std::string>& keys) {
+    if (keys.empty() || keys.size() > order.size()) {
+        return false;
+    }
+    return std::all_of(keys.begin(), keys.end(), [&](const std::string& key) {
+        return std::find(order.begin(), order.begin() + keys.size(), key) != order.begin() + keys.size();
+    }) && std::all_of(order.begin(), order.begin() + keys.size(), [&](const std::string& key) {
+        return std::find(keys.begin(), keys.end(), key) != keys.end();
+    });
+}
+
+void markSortedInputs(Pipeline& pipeline) {
+    std::vector<std::string> order;  // Sort keys the current rows are ordered by
+    for (auto& stage : pipeline.stages) {
+        LogicalNode* node = stage.get();
+        if (auto* sort = dynamic_cast<SortLogicalNode*>(node)) {
+            order = sort->params.sortKeys;
+        } else if (auto* topK = dynamic_cast<TopKLogicalNode*>(node)) {
+            order = topK->sort->params.sortKeys;
+        } else if (auto* window = dynamic_cast<WindowLogicalNode*>(node)) {
+            order = window->sorter.params.sortKeys;
+            std::vector<std::string> written;
+            for (const auto& fn : window->params.functions) written.push_back(fn.name);
+            auto overwritten = std::find_first_of(order.begin(), order.end(), written.begin(), written.end());
+            order.erase(overwritten, order.end());
+        } else if (auto* distinct = dynamic_cast<DistinctLogicalNode*>(node)) {
+            distinct->sortedInput = !distinct->approximate() && groupsEqualKeys(order, distinct->params.keys);
+            if (distinct->approximate()) {
+                order.clear();
+            } else {
+                truncateOrder(order, distinct->params.keys);  // First occurrences keep their order
+            }
+        } else if (auto* project = dynamic_cast<ProjectLogicalNode*>(node)) {
+            truncateOrder(order, project->params.fields);
+        } else if (auto* setMetadata = dynamic_cast<SetMetadataLogicalNode*>(node)) {
+            auto overwritten = std::find(order.begin(), order.end(), setMetadata->params.metaName);
+            order.erase(overwritten, order.end());
+        } else if (!dynamic_cast<MatchLogicalNode*>(node) && !dynamic_cast<LimitLogicalNode*>(node) &&
+                   !dynamic_cast<RuntimeFilterLogicalNode*>(node) && !dynamic_cast<JoinLogicalNode*>(node)) {
+            order.clear();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#include "symbol_table.h"
+#include <mutex>
+
+SymbolId SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock lock(mutex);
+    // Another thread may have interned it between the two locks
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    auto id = static_cast<SymbolId>(names.size());
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+std::optional<SymbolId> SymbolTable::find(std::string_view name) const {
+    std::shared_lock lock(mutex);
+    auto it = ids.find(name);
+    if (it == ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::string_view SymbolTable::name(SymbolId id) const {
+    std::shared_lock lock(mutex);
+    return id < names.size() ? std::string_view(names[id]) : std::string_view();
+}
+
+size_t SymbolTable::size() const {
+    std::shared_lock lock(mutex);
+    return names.size();
+}
@@ -0,0 +1,31 @@
+#include "top_k_fusion.h"
+#include "pipeline.h"
+#include "src/logical_nodes/limit_logical_node.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+
+// Takes ownership of a stage already known to be a T
+template <typename T>
+static std::unique_ptr<T> takeStage(std::unique_ptr<LogicalNode>& stage) {
+    return std::unique_ptr<T>(static_cast<T*>(stage.release()));
+}
+
+void fuseScoreTopK(Pipeline& pipeline) {
+    auto& stages = pipeline.stages;
+    for (size_t i = 0; i + 2 < stages.size(); ++i) {
+        auto* score = dynamic_cast<SetMetadataLogicalNode*>(stages[i].get());
+        auto* sort = dynamic_cast<SortLogicalNode*>(stages[i + 1].get());
+        auto* limit = dynamic_cast<LimitLogicalNode*>(stages[i + 2].get());
+        // A top-k scores only the rows it needs, which a sink would miss
+        if (!score || !sort || !limit || score->hasSideEffects() || sort->params.sortKeys.size() != 1 ||
+            sort->params.sortKeys.front() != score->params.metaName) {
+            continue;
+        }
+        auto fused = std::make_unique<TopKLogicalNode>(takeStage<SetMetadataLogicalNode>(stages[i]),
+                                                       takeStage<SortLogicalNode>(stages[i + 1]),
+                                                       takeStage<LimitLogicalNode>(stages[i + 2]));
+        stages[i] = std::move(fused);
+        stages.erase(stages.begin() + static_cast<ptrdiff_t>(i) + 1, stages.begin() + static_cast<ptrdiff_t>(i) + 3);
+    }
+}
@@ -0,0 +1,150 @@
+#include "vector_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+float dotF32(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+    float sum = 0;
+#if defined(__GNUC__)
+    // Four independent accumulators hide the add latency
+    typedef float Lanes __attribute__((vector_size(16)));
+    Lanes acc0{}, acc1{}, acc2{}, acc3{};
+    for (; i + 16 <= n; i += 16) {
+        Lanes x[4], y[4];
+        std::memcpy(x, a + i, sizeof(x));
+        std::memcpy(y, b + i, sizeof(y));
+        acc0 += x[0] * y[0];
+        acc1 += x[1] * y[1];
+        acc2 += x[2] * y[2];
+        acc3 += x[3] * y[3];
+    }
+    for (; i + 4 <= n; i += 4) {
+        Lanes x, y;
+        std::memcpy(&x, a + i, sizeof(x));
+        std::memcpy(&y, b + i, sizeof(y));
+        acc0 += x * y;
+    }
+    Lanes acc = (acc0 + acc1) + (acc2 + acc3);
+    sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void dotAndSquaredNormF32(const float* row, const float* query, size_t n, float& dot, float& rowNorm2) {
+    size_t i = 0;
+    float d = 0;
+    float r = 0;
+#if defined(__GNUC__)
+    typedef float Lanes __attribute__((vector_size(16)));
+    Lanes dot0{}, dot1{}, norm0{}, norm1{};
+    for (; i + 8 <= n; i += 8) {
+        Lanes x[2], y[2];
+        std::memcpy(x, row + i, sizeof(x));
+        std::memcpy(y, query + i, sizeof(y));
+        dot0 += x[0] * y[0];
+        dot1 += x[1] * y[1];
+        norm0 += x[0] * x[0];
+        norm1 += x[1] * x[1];
+    }
+    Lanes dots = dot0 + dot1;
+    Lanes norms = norm0 + norm1;
+    d = (dots[0] + dots[1]) + (dots[2] + dots[3]);
+    r = (norms[0] + norms[1]) + (norms[2] + norms[3]);
+#endif
+    for (; i < n; ++i) {
+        d += row[i] * query[i];
+        r += row[i] * row[i];
+    }
+    dot = d;
+    rowNorm2 = r;
+}
+
+int32_t dotI8(const int8_t* a, const int8_t* b, size_t n) {
+    size_t i = 0;
+    int32_t sum = 0;
+#if defined(__GNUC__)
+    // 8 codes per step: widened to int16 (products fit), then pairs of
+    // products are added into int32 lanes
+    typedef int8_t Bytes8 __attribute__((vector_size(8)));
+    typedef int16_t Shorts8 __attribute__((vector_size(16)));
+    typedef int32_t Ints4 __attribute__((vector_size(16)));
+    Ints4 acc{};
+    for (; i + 8 <= n; i += 8) {
+        Bytes8 x, y;
+        std::memcpy(&x, a + i, sizeof(x));
+        std::memcpy(&y, b + i, sizeof(y));
+        Shorts8 p = __builtin_convertvector(x, Shorts8) * __builtin_convertvector(y, Shorts8);
+        Ints4 lo = {p[0], p[2], p[4], p[6]};
+        Ints4 hi = {p[1], p[3], p[5], p[7]};
+        acc += lo + hi;
+    }
+    sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+    for (; i < n; ++i) {
+        sum += int32_t{a[i]} * int32_t{b[i]};
+    }
+    return sum;
+}
+
+void QuantizedVectors::quantizeOne(const float* values, size_t n, int8_t* codes, float& scale) {
+    float maxAbs = 0;
+    for (size_t j = 0; j < n; ++j) {
+        maxAbs = std::max(maxAbs, std::fabs(values[j]));
+    }
+    scale = maxAbs > 0 ? maxAbs / 127.0f : 1.0f;
+    for (size_t j = 0; j < n; ++j) {
+        codes[j] = static_cast<int8_t>(std::clamp(std::lround(values[j] / scale), -127L, 127L));
+    }
+}
+
+QuantizedVectors QuantizedVectors::quantize(uint32_t dimension, const std::vector<float>& values) {
+    QuantizedVectors out;
+    out.dimension = dimension;
+    size_t rows = dimension ? values.size() / dimension : 0;
+    out.codes.resize(rows * dimension);
+    out.scales.resize(rows);
+    out.norms.resize(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        int8_t* codes = out.codes.data() + i * dimension;
+        quantizeOne(values.data() + i * dimension, dimension, codes, out.scales[i]);
+        out.norms[i] = std::sqrt(static_cast<float>(dotI8(codes, codes, dimension))) * out.scales[i];
+    }
+    return out;
+}
+
+std::vector<float> QuantizedVectors::dequantize() const {
+    std::vector<float> values(codes.size());
+    for (size_t i = 0; i < count(); ++i) {
+        for (size_t j = 0; j < dimension; ++j) {
+            values[i * dimension + j] = codes[i * dimension + j] * scales[i];
+        }
+    }
+    return values;
+}
+
+QuantizedVectors QuantizedVectors::select(const std::vector<uint32_t>& rows) const {
+    QuantizedVectors out;
+    out.dimension = dimension;
+    out.codes.resize(rows.size() * dimension);
+    out.scales.reserve(rows.size());
+    out.norms.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        std::memcpy(out.codes.data() + i * dimension, row(rows[i]), dimension);
+        out.scales.push_back(scales[rows[i]]);
+        out.norms.push_back(norms[rows[i]]);
+    }
+    return out;
+}
+
+void QuantizedVectors::truncate(size_t rows) {
+    if (rows >= count()) {
+        return;
+    }
+    codes.resize(rows * dimension);
+    scales.resize(rows);
+    norms.resize(rows);
+}
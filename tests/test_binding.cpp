@@ -0,0 +1,179 @@
+#include "pipeline.h"
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "src/logical_nodes/sort_logical_node.h"
+#include <gtest/gtest.h>
+#include <limits>
+
+static size_t countTrue(const std::vector<uint8_t>& values) {
+    size_t count = 0;
+    for (uint8_t v : values) count += v != 0;
+    return count;
+}
+
+static Batch scoresBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"user", PhysicalType::String},
+                                       {"user_score", PhysicalType::Int64},
+                                       {"daily_bonus", PhysicalType::Double}});
+    batch.columns = {Column::ofStrings({"ann", "bob", "cat", "dan"}),
+                     Column::ofInts({10, 40, 20, 30}),
+                     Column::ofDoubles({0.5, 1.5, 30.0, 2.5})};
+    return batch;
+}
+
+TEST(ExpressionTest, ParsesAndPrintsCanonically) {
+    auto expr = parseExpression("sum(user_score, daily_bonus) * 2 - -1");
+    ASSERT_TRUE(expr.has_value());
+    EXPECT_EQ(toString(**expr), "((sum(user_score, daily_bonus) * 2) - -(1))");
+    auto reparsed = parseExpression(toString(**expr));
+    ASSERT_TRUE(reparsed.has_value());
+    EXPECT_EQ(toString(**reparsed), toString(**expr));
+}
+
+TEST(ExpressionTest, ReportsParsePositions) {
+    auto unknown = parseExpression("a + frob(b)");
+    ASSERT_FALSE(unknown.has_value());
+    EXPECT_EQ(unknown.error().code, DiagnosticCode::UnknownFunction);
+    EXPECT_EQ(unknown.error().position, 4u);
+
+    auto unclosed = parseExpression("sum(a, b");
+    ASSERT_FALSE(unclosed.has_value());
+    EXPECT_EQ(unclosed.error().code, DiagnosticCode::ExpectedClosingParen);
+
+    EXPECT_EQ(parseExpression("if(a, b)").error().code, DiagnosticCode::WrongArgumentCount);
+}
+
+TEST(ExpressionTest, BindingResolvesSlotsAndPromotesTypes) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    auto expr = parseExpression("user_score + daily_bonus");
+    auto bound = bindExpression(*expr, batch.schema, catalog.symbols);
+    ASSERT_TRUE(bound.has_value());
+    EXPECT_EQ((*bound)->type, PhysicalType::Double);
+    EXPECT_EQ(toString(**bound), "(to_double(user_score) + daily_bonus)");
+    EXPECT_EQ((*bound)->args[1]->slot, 2);
+
+    auto missing = bindExpression(*parseExpression("user_score + nope"), batch.schema, catalog.symbols);
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().code, DiagnosticCode::UnknownField);
+    EXPECT_EQ(missing.error().position, 13u);
+
+    auto mismatch = bindExpression(*parseExpression("user + 1"), batch.schema, catalog.symbols);
+    ASSERT_FALSE(mismatch.has_value());
+    EXPECT_EQ(mismatch.error().code, DiagnosticCode::TypeMismatch);
+}
+
+TEST(ExpressionTest, EvaluatesTypedKernels) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    auto bound = bindExpression(*parseExpression("if(user_score >= 30, user_score * 2, 0)"),
+                                batch.schema, catalog.symbols);
+    ASSERT_TRUE(bound.has_value());
+    Column result = evaluateExpression(**bound, batch);
+    EXPECT_EQ(result.type, PhysicalType::Int64);
+    EXPECT_EQ(result.ints, (std::vector<int64_t>{0, 80, 0, 60}));
+}
+
+TEST(ExpressionTest, IntegerKernelsWrapAround) {
+    Catalog catalog;
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"a", PhysicalType::Int64}});
+    constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+    constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+    batch.columns = {Column::ofInts({kMax, kMin})};
+    auto eval = [&](const char* text) {
+        auto bound = bindExpression(*parseExpression(text), batch.schema, catalog.symbols);
+        EXPECT_TRUE(bound.has_value()) << text;
+        return evaluateExpression(**bound, batch).ints;
+    };
+    EXPECT_EQ(eval("a + 1"), (std::vector<int64_t>{kMin, kMin + 1}));
+    EXPECT_EQ(eval("a - 1"), (std::vector<int64_t>{kMax - 1, kMax}));
+    EXPECT_EQ(eval("a * 2"), (std::vector<int64_t>{-2, 0}));
+    EXPECT_EQ(eval("sum(a, a, 2)"), (std::vector<int64_t>{0, 2}));
+    EXPECT_EQ(eval("-a"), (std::vector<int64_t>{kMin + 1, kMin}));
+    EXPECT_EQ(eval("abs(a)"), (std::vector<int64_t>{kMax, kMin}));
+}
+
+TEST(ExpressionTest, ConditionalsEvaluateBranchesOnlyForSelectedRows) {
+    Catalog catalog;
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"x", PhysicalType::Int64}});
+    std::vector<int64_t> xs(100);
+    for (int64_t i = 0; i < 100; ++i) xs[i] = i;
+    batch.columns = {Column::ofInts(xs)};
+
+    // 5 rows take the expensive branch, 95 the cheap one
+    auto bound = bindExpression(*parseExpression("if(x >= 95, (x * 3) + (x * 5), x - 1)"),
+                                batch.schema, catalog.symbols);
+    ASSERT_TRUE(bound.has_value());
+    EvalStats stats;
+    Column result = evaluateExpression(**bound, batch, nullptr, &stats);
+    EXPECT_EQ(result.ints[10], 9);
+    EXPECT_EQ(result.ints[99], 99 * 8);
+    EXPECT_EQ(stats.selectionBranches, 1u);
+    EXPECT_EQ(stats.denseBranches, 1u);
+    // x >= 95 and x - 1 over 100 rows; *, *, + over the 5 selected rows
+    EXPECT_EQ(stats.rowsComputed, 100u + 100u + 3 * 5u);
+
+    // `and` skips its right side where the left is already false
+    auto conjunction = bindExpression(*parseExpression("x > 97 and (x * 2) > 197"), batch.schema, catalog.symbols);
+    ASSERT_TRUE(conjunction.has_value());
+    stats = {};
+    result = evaluateExpression(**conjunction, batch, nullptr, &stats);
+    EXPECT_EQ(countTrue(result.bools), 1u);  // only x == 99
+    EXPECT_EQ(stats.rowsComputed, 100u + 2 * 2u);
+
+    // Explicit selections produce one result row per selected row
+    SelectionVector rows = {3, 50, 99};
+    result = evaluateExpression(**bound, batch, &rows);
+    EXPECT_EQ(result.ints, (std::vector<int64_t>{2, 49, 99 * 8}));
+}
+
+TEST(PipelineTest, BindsAndExecutesScoreSortLimit) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    auto pipeline = tryBuildPipeline(
+        "set_metadata score:sum(user_score, daily_bonus) | sort score:desc | limit 2", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    ASSERT_TRUE(output.has_value());
+    ASSERT_EQ(output->fields.size(), 4u);
+    EXPECT_EQ(output->fields[3].name, "score");
+    EXPECT_EQ(output->fields[3].type, PhysicalType::Double);
+
+    const auto& sort = dynamic_cast<const SortLogicalNode&>(*pipeline->stages[1]);
+    ASSERT_EQ(sort.boundKeys.size(), 1u);
+    EXPECT_EQ(sort.boundKeys[0].slot, 3u);
+    EXPECT_EQ(sort.boundKeys[0].type, PhysicalType::Double);
+
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.columns[0].strings, (std::vector<std::string>{"cat", "bob"}));
+    EXPECT_EQ(batch.columns[3].doubles, (std::vector<double>{50.0, 41.5}));
+}
+
+TEST(PipelineTest, MultiKeySortUsesBoundComparators) {
+    Catalog catalog;
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"country", PhysicalType::String}, {"age", PhysicalType::Int64}});
+    batch.columns = {Column::ofStrings({"us", "fr", "us", "fr"}), Column::ofInts({30, 20, 10, 40})};
+    auto pipeline = tryBuildPipeline("sort country,age:asc", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.columns[0].strings, (std::vector<std::string>{"fr", "fr", "us", "us"}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{20, 40, 10, 30}));
+}
+
+TEST(PipelineTest, BindingReportsUnknownSortKey) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    auto pipeline = tryBuildPipeline("sort missing", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    ASSERT_FALSE(output.has_value());
+    EXPECT_EQ(output.error().code, DiagnosticCode::UnknownField);
+}
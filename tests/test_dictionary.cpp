@@ -0,0 +1,78 @@
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "pipeline.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+// Executes a one-stage pipeline over a copy of `input`
+Batch run(const std::string& text, const Batch& input, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    return batch;
+}
+
+} // namespace
+
+TEST(DictionaryTest, EncodesWithOrderPreservingCodes) {
+    Column column = Column::dictionaryEncode({"us", "fr", "us", "de", "fr"});
+    ASSERT_TRUE(column.isDictionary());
+    EXPECT_EQ(*column.dictionary, (StringDictionary{"de", "fr", "us"}));
+    EXPECT_EQ(column.codes, (std::vector<uint32_t>{2, 1, 2, 0, 1}));
+    EXPECT_EQ(column.decoded().strings, (std::vector<std::string>{"us", "fr", "us", "de", "fr"}));
+}
+
+TEST(DictionaryTest, AppendMergesDictionaries) {
+    Column column = Column::dictionaryEncode({"us", "fr"});
+    Column other = Column::dictionaryEncode({"de", "us", "it"});
+    other.setValid(2, false);
+    column.append(other);
+    EXPECT_EQ(*column.dictionary, (StringDictionary{"de", "fr", "it", "us"}));
+    EXPECT_EQ(column.codes, (std::vector<uint32_t>{3, 1, 0, 3, 2}));
+    EXPECT_FALSE(column.isValid(4));
+    EXPECT_TRUE(column.isValid(1));
+
+    // Plain strings appended to a dictionary column are encoded first
+    column.append(Column::ofStrings({"at"}));
+    EXPECT_EQ(column.dictionary->front(), "at");
+    EXPECT_EQ(column.decoded().strings.back(), "at");
+}
+
+TEST(DictionaryTest, SortsByCodesLikeStrings) {
+    // More than 256 distinct values, so the radix sort needs two passes
+    std::vector<std::string> countries;
+    std::vector<int64_t> ids;
+    for (int64_t i = 0; i < 2000; ++i) {
+        countries.push_back("c" + std::to_string((i * 7919) % 300));
+        ids.push_back(i);
+    }
+    Catalog catalog;
+    Batch plain;
+    plain.schema = catalog.makeSchema({{"country", PhysicalType::String}, {"id", PhysicalType::Int64}});
+    plain.columns = {Column::ofStrings(countries), Column::ofInts(ids)};
+    Batch encoded = plain;
+    encoded.columns[0] = Column::dictionaryEncode(countries);
+
+    for (const char* text : {"sort country", "sort country:desc", "sort country,id:desc"}) {
+        Batch expected = run(text, plain, catalog);
+        Batch actual = run(text, encoded, catalog);
+        ASSERT_TRUE(actual.columns[0].isDictionary()) << text;
+        EXPECT_EQ(actual.columns[0].decoded().strings, expected.columns[0].strings) << text;
+        EXPECT_EQ(actual.columns[1].ints, expected.columns[1].ints) << text;
+    }
+}
+
+TEST(DictionaryTest, ExpressionsReadDictionaryColumns) {
+    Catalog catalog;
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"status", PhysicalType::String}});
+    batch.columns = {Column::dictionaryEncode({"open", "closed", "open"})};
+    auto bound = bindExpression(*parseExpression("status == \"open\""), batch.schema, catalog.symbols);
+    ASSERT_TRUE(bound.has_value());
+    EXPECT_EQ(evaluateExpression(**bound, batch).bools, (std::vector<uint8_t>{1, 0, 1}));
+}
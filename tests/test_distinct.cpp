@@ -0,0 +1,159 @@
+#include "batch.h"
+#include "catalog.h"
+#include "hyperloglog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "src/logical_nodes/distinct_logical_node.h"
+#include "src/parse_nodes/distinct_node.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <set>
+#include <utility>
+
+namespace {
+
+// country: us, fr, us, null, fr, us, null    city: a, b, a, c, b, d, c
+Batch placesBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"country", PhysicalType::String},
+                                       {"city", PhysicalType::String},
+                                       {"pop", PhysicalType::Int64}});
+    Column country = Column::dictionaryEncode({"us", "fr", "us", "", "fr", "us", ""});
+    country.setValid(3, false);
+    country.setValid(6, false);
+    batch.columns = {std::move(country), Column::ofStrings({"a", "b", "a", "c", "b", "d", "c"}),
+                     Column::ofInts({1, 2, 3, 4, 5, 6, 7})};
+    return batch;
+}
+
+std::unique_ptr<Pipeline> optimizedPipeline(const char* text, const Schema& schema, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, schema, catalog.symbols).has_value()) << text;
+    return std::make_unique<Pipeline>(std::move(*pipeline));
+}
+
+DistinctLogicalNode& distinctStage(Pipeline& pipeline) {
+    for (auto& stage : pipeline.stages) {
+        if (auto* distinct = dynamic_cast<DistinctLogicalNode*>(stage.get())) return *distinct;
+    }
+    throw std::runtime_error("no distinct stage");
+}
+
+} // namespace
+
+TEST(DistinctTest, ParsesKeysAndApproximateCount) {
+    auto exact = DistinctNode::tryParse("country, city");
+    ASSERT_TRUE(exact.has_value());
+    EXPECT_EQ(exact->keys, (std::vector<std::string>{"country", "city"}));
+    EXPECT_TRUE(exact->approxCountName.empty());
+
+    auto approx = DistinctNode::tryParse("n:approx_count(country, city)");
+    ASSERT_TRUE(approx.has_value());
+    EXPECT_EQ(approx->keys, (std::vector<std::string>{"country", "city"}));
+    EXPECT_EQ(approx->approxCountName, "n");
+
+    EXPECT_EQ(DistinctNode::tryParse("").error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(DistinctNode::tryParse("a b").error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(DistinctNode::tryParse("n:count(a)").error().code, DiagnosticCode::UnknownFunction);
+    EXPECT_EQ(DistinctNode::tryParse("n:approx_count(a").error().code, DiagnosticCode::ExpectedClosingParen);
+    EXPECT_EQ(DistinctNode::tryParse("n:approx_count()").error().code, DiagnosticCode::ExpectedFieldName);
+}
+
+TEST(DistinctTest, KeepsFirstOccurrencesWithEveryStrategy) {
+    Catalog catalog;
+    Batch input = placesBatch(catalog);
+
+    // Hash, then sorting once the table would exceed the budget
+    for (size_t budget : {size_t{32} << 20, size_t{0}}) {
+        auto pipeline = optimizedPipeline("distinct country, city", input.schema, catalog);
+        auto& distinct = distinctStage(*pipeline);
+        distinct.hashTableBudget = budget;
+        Batch batch = input;
+        executePipeline(*pipeline, batch);
+        EXPECT_EQ(distinct.lastStrategy.load(),
+                  static_cast<uint8_t>(budget ? DistinctStrategy::Hash : DistinctStrategy::Sort));
+        ASSERT_EQ(batch.schema.fields.size(), 2u);
+        EXPECT_EQ(batch.columns[1].strings, (std::vector<std::string>{"a", "b", "c", "d"}));
+        EXPECT_FALSE(batch.columns[0].isValid(2));  // Nulls are one key
+        EXPECT_EQ(distinct.lastEstimate.load(), 4u);
+    }
+
+    // An earlier sort on the keys is reused
+    auto sorted = optimizedPipeline("sort city,country | distinct country, city", input.schema, catalog);
+    auto& distinct = distinctStage(*sorted);
+    EXPECT_TRUE(distinct.sortedInput);
+    EXPECT_NE(distinct.explain().find("Streaming"), std::string::npos);
+    Batch batch = input;
+    executePipeline(*sorted, batch);
+    EXPECT_EQ(distinct.lastStrategy.load(), static_cast<uint8_t>(DistinctStrategy::Streaming));
+    EXPECT_EQ(batch.columns[1].strings, (std::vector<std::string>{"a", "b", "c", "d"}));
+
+    // A sort that does not group equal keys together is not
+    for (const char* text : {"sort city,pop,country | distinct country, city", "sort city | distinct country, city",
+                             "sort city,country | set_metadata country:pop + 1 | distinct country, city",
+                             "sort country,city | group country; n:count() | distinct country, city"}) {
+        auto pipeline = tryBuildPipeline(text, catalog);
+        ASSERT_TRUE(pipeline.has_value()) << text;
+        optimizePipeline(*pipeline, catalog);
+        EXPECT_FALSE(distinctStage(*pipeline).sortedInput) << text;
+    }
+    auto kept = tryBuildPipeline("sort city,country,pop | match pop > 1 | limit 5 | distinct city, country", catalog);
+    optimizePipeline(*kept, catalog);
+    EXPECT_TRUE(distinctStage(*kept).sortedInput);
+}
+
+TEST(DistinctTest, HashAndSortAgreeOnLargeInputs) {
+    Catalog catalog;
+    constexpr size_t kRows = 200000;
+    std::vector<int64_t> ids(kRows);
+    std::vector<double> values(kRows);
+    for (size_t r = 0; r < kRows; ++r) {
+        ids[r] = static_cast<int64_t>((r * 7919) % 50021);
+        values[r] = (r % 3 == 0) ? std::nan("") : static_cast<double>(r % 7);
+    }
+    Batch input;
+    input.schema = catalog.makeSchema({{"id", PhysicalType::Int64}, {"v", PhysicalType::Double}});
+    input.columns = {Column::packInts(ids), Column::ofDoubles(values)};
+
+    std::set<std::pair<int64_t, double>> expected;
+    for (size_t r = 0; r < kRows; ++r) expected.emplace(ids[r], values[r] != values[r] ? -1.0 : values[r]);
+
+    std::vector<std::vector<int64_t>> results;
+    for (size_t budget : {size_t{1} << 30, size_t{1} << 10}) {
+        auto pipeline = optimizedPipeline("distinct id, v", input.schema, catalog);
+        auto& distinct = distinctStage(*pipeline);
+        distinct.hashTableBudget = budget;
+        Batch batch = input;
+        executePipeline(*pipeline, batch);
+        EXPECT_EQ(batch.rowCount(), expected.size());
+        EXPECT_NEAR(static_cast<double>(distinct.lastEstimate.load()), static_cast<double>(expected.size()),
+                    expected.size() * 0.03);
+        results.push_back(batch.columns[0].decoded().ints);
+    }
+    EXPECT_EQ(results[0], results[1]);  // Same rows in the same (first seen) order
+}
+
+TEST(DistinctTest, ApproximateCountSkipsNullKeys) {
+    Catalog catalog;
+    Batch batch = placesBatch(catalog);
+    auto pipeline = optimizedPipeline("distinct n:approx_count(country, city)", batch.schema, catalog);
+    executePipeline(*pipeline, batch);
+    ASSERT_EQ(batch.schema.fields.size(), 1u);
+    EXPECT_EQ(batch.schema.fields[0].name, "n");
+    EXPECT_EQ(batch.columns[0].ints, (std::vector<int64_t>{3}));
+
+    // Error stays within a few percent at larger cardinalities
+    HyperLogLog sketch;
+    HyperLogLog half;
+    for (uint64_t i = 0; i < 1000000; ++i) {
+        uint64_t h = i * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 29;
+        (i % 2 ? sketch : half).insert(h);
+    }
+    sketch.merge(half);
+    EXPECT_NEAR(sketch.estimate(), 1000000.0, 30000.0);
+}
@@ -0,0 +1,158 @@
+#include "expression_jit.h"
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "pipeline.h"
+#include <cstdlib>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+namespace {
+
+bool compilerAvailable() {
+    return std::system("c++ --version > /dev/null 2>&1") == 0;
+}
+
+Batch numbersBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"a", PhysicalType::Int64},
+                                       {"b", PhysicalType::Double},
+                                       {"name", PhysicalType::String}});
+    // INT64_MAX: integer arithmetic wraps in both tiers
+    batch.columns = {Column::ofInts({1, -7, 40, INT64_MAX}),
+                     Column::ofDoubles({0.1, 2.5, -3.0, 1e300}),
+                     Column::ofStrings({"w", "x", "y", "z"})};
+    return batch;
+}
+
+// Restores the default (disabled) configuration after each test
+struct JitTest : ::testing::Test {
+    void TearDown() override { ExpressionJit::instance().configure({}); }
+};
+
+} // namespace
+
+TEST_F(JitTest, GeneratesKernelForNumericExpressions) {
+    Catalog catalog;
+    Batch batch = numbersBatch(catalog);
+    auto bound = bindExpression(*parseExpression("if(a > 2, a * 3, abs(a)) + b * 0.5"),
+                                batch.schema, catalog.symbols);
+    ASSERT_TRUE(bound.has_value());
+
+    std::vector<int32_t> slots;
+    auto source = generateKernelSource(**bound, slots);
+    ASSERT_TRUE(source.has_value());
+    EXPECT_EQ(slots, (std::vector<int32_t>{0, 1}));
+    EXPECT_NE(source->find("toy_expr_kernel"), std::string::npos);
+
+    auto strings = bindExpression(*parseExpression("name == \"x\""), batch.schema, catalog.symbols);
+    ASSERT_TRUE(strings.has_value());
+    EXPECT_FALSE(generateKernelSource(**strings, slots).has_value());
+}
+
+TEST_F(JitTest, CompilesAfterThresholdAndMatchesInterpreter) {
+    if (!compilerAvailable()) {
+        GTEST_SKIP() << "no C++ compiler on PATH";
+    }
+    auto cacheDir = std::filesystem::path(::testing::TempDir()) / "toy_expr_jit_test";
+    std::filesystem::remove_all(cacheDir);
+
+    JitOptions options;
+    options.enabled = true;
+    options.compileThreshold = 2;
+    options.compileInBackground = false;
+    options.cacheDir = cacheDir.string();
+    ExpressionJit::instance().configure(options);
+
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata score:sum(a, b, 1) * 2 - min(a, 3) / 4 | set_metadata big:a + 1 > 10 and b < 2.0",
+        catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    Batch input = numbersBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value());
+
+    Batch interpreted = input;
+    executePipeline(*pipeline, interpreted);  // 1st run: interpreted
+    EXPECT_NE(pipeline->stages[0]->explain().find("interpreted"), std::string::npos);
+
+    Batch native = input;
+    executePipeline(*pipeline, native);       // 2nd run reaches the threshold and compiles
+    EXPECT_NE(pipeline->stages[0]->explain().find("Execution Tier: native"), std::string::npos);
+    EXPECT_EQ(native.columns[3].doubles, interpreted.columns[3].doubles);
+    EXPECT_EQ(native.columns[4].bools, interpreted.columns[4].bools);
+
+    // The shared objects are cached on disk by expression hash
+    size_t libraries = 0;
+    for (const auto& file : std::filesystem::directory_iterator(cacheDir)) {
+        libraries += file.path().extension() == ".so";
+    }
+    EXPECT_EQ(libraries, 2u);
+}
+
+TEST_F(JitTest, SameShapeOverOtherColumnsGetsItsOwnKernel) {
+    if (!compilerAvailable()) {
+        GTEST_SKIP() << "no C++ compiler on PATH";
+    }
+    auto cacheDir = std::filesystem::path(::testing::TempDir()) / "toy_expr_jit_slots";
+    std::filesystem::remove_all(cacheDir);
+
+    JitOptions options;
+    options.enabled = true;
+    options.compileThreshold = 1;
+    options.compileInBackground = false;
+    options.cacheDir = cacheDir.string();
+    ExpressionJit::instance().configure(options);
+
+    Catalog catalog;
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"a", PhysicalType::Int64},
+                                       {"b", PhysicalType::Int64},
+                                       {"c", PhysicalType::Int64},
+                                       {"d", PhysicalType::Int64}});
+    batch.columns = {Column::ofInts({1, 2}), Column::ofInts({10, 20}), Column::ofInts({100, 200}),
+                     Column::ofInts({1000, 2000})};
+    // Identical generated source: in0[i] + in1[i]
+    auto pipeline = tryBuildPipeline("set_metadata x:a + b | set_metadata y:c + d", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    executePipeline(*pipeline, batch);
+
+    EXPECT_NE(pipeline->stages[0]->explain().find("Execution Tier: native"), std::string::npos);
+    EXPECT_NE(pipeline->stages[1]->explain().find("Execution Tier: native"), std::string::npos);
+    EXPECT_EQ(batch.columns[4].ints, (std::vector<int64_t>{11, 22}));
+    EXPECT_EQ(batch.columns[5].ints, (std::vector<int64_t>{1100, 2200}));
+    std::filesystem::remove_all(cacheDir);
+}
+
+TEST_F(JitTest, RefusesCacheDirectoryOthersCanWrite) {
+    if (!compilerAvailable()) {
+        GTEST_SKIP() << "no C++ compiler on PATH";
+    }
+    auto cacheDir = std::filesystem::path(::testing::TempDir()) / "toy_expr_jit_shared";
+    std::filesystem::remove_all(cacheDir);
+    std::filesystem::create_directories(cacheDir);
+    ::chmod(cacheDir.c_str(), 0777);
+
+    JitOptions options;
+    options.enabled = true;
+    options.compileThreshold = 1;
+    options.compileInBackground = false;
+    options.cacheDir = cacheDir.string();
+    ExpressionJit::instance().configure(options);
+
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline("set_metadata c:a * 5 - 3", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    Batch input = numbersBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value());
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+
+    // Nothing is compiled into, or loaded from, a directory others could plant in
+    EXPECT_NE(pipeline->stages[0]->explain().find("interpreted"), std::string::npos);
+    EXPECT_TRUE(std::filesystem::is_empty(cacheDir));
+    std::filesystem::remove_all(cacheDir);
+}
@@ -0,0 +1,132 @@
+#include "expression_optimizer.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "batch.h"
+#include "catalog.h"
+#include "src/logical_nodes/set_metadata_logical_node.h"
+#include <gtest/gtest.h>
+
+static std::string simplified(const std::string& text) {
+    auto expr = parseExpression(text);
+    EXPECT_TRUE(expr.has_value()) << text;
+    return toString(*simplifyExpression(*expr));
+}
+
+static std::vector<std::string> setMetadataStages(const Pipeline& pipeline) {
+    std::vector<std::string> stages;
+    for (const auto& stage : pipeline.stages) {
+        if (auto* node = dynamic_cast<const SetMetadataLogicalNode*>(stage.get())) {
+            stages.push_back(node->params.metaName + ":" + node->params.expression);
+        }
+    }
+    return stages;
+}
+
+TEST(ExpressionOptimizerTest, FoldsConstants) {
+    EXPECT_EQ(simplified("1 + 2 * 3"), "7");
+    EXPECT_EQ(simplified("10 / 4"), "2.5");
+    EXPECT_EQ(simplified("sum(x, 1, 2)"), "sum(x, 3)");
+    EXPECT_EQ(simplified("sum(x, 1, -1)"), "x");
+    EXPECT_EQ(simplified("if(2 > 1, a, 7)"), "a");
+    EXPECT_EQ(simplified("\"us\" == \"us\" and not(false)"), "true");
+}
+
+TEST(ExpressionOptimizerTest, AppliesIdentitiesWithoutChangingTypes) {
+    EXPECT_EQ(simplified("x * 1"), "x");
+    EXPECT_EQ(simplified("0 + x"), "x");
+    EXPECT_EQ(simplified("x - 0"), "x");
+    EXPECT_EQ(simplified("--x"), "x");
+    EXPECT_EQ(simplified("not(not(flag))"), "flag");
+    EXPECT_EQ(simplified("flag and true"), "flag");
+    // Dropping a double operand must keep the result a double
+    EXPECT_EQ(simplified("x * 1.0"), "to_double(x)");
+    EXPECT_EQ(simplified("x / 1"), "to_double(x)");
+    EXPECT_EQ(simplified("if(true, x, 2.5)"), "to_double(x)");
+    // The result type of if(true, x, y) depends on y's column type
+    EXPECT_EQ(simplified("if(true, x, y)"), "if(true, x, y)");
+}
+
+TEST(ExpressionOptimizerTest, ReusesColumnsComputedByEarlierStages) {
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata score:sum(user_score, daily_bonus) | sort score:desc | "
+        "set_metadata boosted:sum(user_score, daily_bonus) * 2", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_EQ(setMetadataStages(*pipeline),
+              (std::vector<std::string>{"score:sum(user_score, daily_bonus)", "boosted:(score * 2)"}));
+}
+
+TEST(ExpressionOptimizerTest, HoistsRepeatedSubexpressions) {
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata a:sum(user_score, daily_bonus) * 2 + 0 | "
+        "set_metadata b:sum(user_score, daily_bonus) * 3 | project a, b", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_EQ(setMetadataStages(*pipeline),
+              (std::vector<std::string>{"__cse0:sum(user_score, daily_bonus)", "a:(__cse0 * 2)",
+                                        "b:(__cse0 * 3)"}));
+    EXPECT_TRUE(catalog.symbols.find("__cse0").has_value());
+}
+
+TEST(ExpressionOptimizerTest, HoistsNothingThatWouldChangeTheOutput) {
+    Catalog catalog;
+    // Nothing would drop the hoisted column
+    auto unprojected = tryBuildPipeline("set_metadata x:(a + b) * 2 | set_metadata y:(a + b) * 3", catalog);
+    ASSERT_TRUE(unprojected.has_value());
+    optimizePipeline(*unprojected, catalog);
+    EXPECT_EQ(setMetadataStages(*unprojected), (std::vector<std::string>{"x:((a + b) * 2)", "y:((a + b) * 3)"}));
+
+    // Branches only run for some rows; hoisting would run them for all
+    auto branches = tryBuildPipeline(
+        "set_metadata x:if(a > 0, (a + b) * 2, 0) | set_metadata y:coalesce(c, (a + b) * 2) | project x, y",
+        catalog);
+    ASSERT_TRUE(branches.has_value());
+    optimizePipeline(*branches, catalog);
+    EXPECT_EQ(setMetadataStages(*branches), (std::vector<std::string>{"x:if((a > 0), ((a + b) * 2), 0)",
+                                                                      "y:coalesce(c, ((a + b) * 2))"}));
+}
+
+TEST(ExpressionOptimizerTest, DoesNotShareAcrossOverwrittenInputs) {
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata a:sum(x, y) | set_metadata x:1 | set_metadata b:sum(x, y)", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_EQ(setMetadataStages(*pipeline),
+              (std::vector<std::string>{"a:sum(x, y)", "x:1", "b:sum(x, y)"}));
+}
+
+TEST(ExpressionOptimizerTest, OptimizedPipelineComputesSameResults) {
+    const std::string text =
+        "set_metadata a:sum(s, b) * 2 | set_metadata c:if(sum(s, b) > 3, sum(s, b) * 1, 0) | sort c:desc";
+    Catalog catalog;
+    Batch input;
+    input.schema = catalog.makeSchema({{"s", PhysicalType::Int64}, {"b", PhysicalType::Int64}});
+    input.columns = {Column::ofInts({1, 2, 3, 4}), Column::ofInts({0, 5, 1, 1})};
+
+    // Without and with a project that lets sum(s, b) be hoisted
+    for (const std::string& variant : {text, text + " | project c, a"}) {
+        auto plain = tryBuildPipeline(variant, catalog);
+        auto optimized = tryBuildPipeline(variant, catalog);
+        ASSERT_TRUE(plain && optimized);
+        optimizePipeline(*optimized, catalog);
+        EXPECT_EQ(setMetadataStages(*optimized).front().starts_with("__cse0:"), variant != text);
+
+        Batch expected = input;
+        Batch actual = input;
+        ASSERT_TRUE(bindPipeline(*plain, input.schema, catalog.symbols));
+        ASSERT_TRUE(bindPipeline(*optimized, input.schema, catalog.symbols));
+        executePipeline(*plain, expected);
+        executePipeline(*optimized, actual);
+
+        ASSERT_EQ(actual.schema.fields.size(), expected.schema.fields.size()) << variant;
+        for (size_t c = 0; c < expected.schema.fields.size(); ++c) {
+            EXPECT_EQ(actual.schema.fields[c].name, expected.schema.fields[c].name) << variant;
+            EXPECT_EQ(actual.schema.fields[c].type, expected.schema.fields[c].type) << variant;
+            EXPECT_EQ(actual.columns[c].decoded().ints, expected.columns[c].decoded().ints)
+                << variant << ": " << expected.schema.fields[c].name;
+        }
+    }
+}
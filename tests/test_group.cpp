@@ -0,0 +1,117 @@
+#include "batch.h"
+#include "catalog.h"
+#include "pipeline.h"
+#include "src/logical_nodes/group_logical_node.h"
+#include "src/parse_nodes/group_node.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+// country: us, fr, us, de, fr, us    score: 10, 20, null, 40, 50, 60
+Batch scoresBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"country", PhysicalType::String}, {"score", PhysicalType::Int64}});
+    Column score = Column::ofInts({10, 20, 0, 40, 50, 60});
+    score.setValid(2, false);
+    batch.columns = {Column::ofStrings({"us", "fr", "us", "de", "fr", "us"}), std::move(score)};
+    return batch;
+}
+
+Schema runPipeline(const char* text, Batch& batch, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    EXPECT_TRUE(output.has_value()) << text;
+    executePipeline(*pipeline, batch);
+    return *output;
+}
+
+} // namespace
+
+TEST(GroupTest, ParsesKeysAndAggregates) {
+    auto node = GroupNode::tryParse("country, status; total:sum(score * 2), n:count(), m:max(if(a, b, c))");
+    ASSERT_TRUE(node.has_value());
+    EXPECT_EQ(node->keys, (std::vector<std::string>{"country", "status"}));
+    ASSERT_EQ(node->aggregates.size(), 3u);
+    EXPECT_EQ(node->aggregates[0].argument, "score * 2");
+    EXPECT_EQ(node->aggregates[1].op, AggregateOp::Count);
+    EXPECT_EQ(node->aggregates[2].argument, "if(a, b, c)");
+
+    auto unknown = GroupNode::tryParse("a; x:median(b)");
+    ASSERT_FALSE(unknown.has_value());
+    EXPECT_EQ(unknown.error().code, DiagnosticCode::UnknownFunction);
+    EXPECT_EQ(unknown.error().position, 5u);
+    EXPECT_EQ(GroupNode::tryParse("a; sum(b)").error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(GroupNode::tryParse("a; x:sum()").error().code, DiagnosticCode::EmptyExpression);
+}
+
+TEST(GroupTest, AggregatesPerKeyInFirstSeenOrder) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    Schema output = runPipeline(
+        "group country; n:count(), scored:count(score), total:sum(score), best:max(score), mean:avg(score)",
+        batch, catalog);
+    ASSERT_EQ(output.fields.size(), 6u);
+    EXPECT_EQ(output.fields[5].type, PhysicalType::Double);
+    EXPECT_EQ(batch.columns[0].strings, (std::vector<std::string>{"us", "fr", "de"}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{3, 2, 1}));
+    EXPECT_EQ(batch.columns[2].ints, (std::vector<int64_t>{2, 2, 1}));
+    EXPECT_EQ(batch.columns[3].ints, (std::vector<int64_t>{70, 70, 40}));
+    EXPECT_EQ(batch.columns[4].ints, (std::vector<int64_t>{60, 50, 40}));
+    EXPECT_EQ(batch.columns[5].doubles, (std::vector<double>{35, 35, 40}));
+}
+
+TEST(GroupTest, NullKeysGroupTogetherAndEmptyInputsAreNull) {
+    Catalog catalog;
+    Batch batch = scoresBatch(catalog);
+    runPipeline("group score; n:count(), low:min(country)", batch, catalog);
+    ASSERT_EQ(batch.rowCount(), 6u);
+    EXPECT_FALSE(batch.columns[0].isValid(2));
+
+    Batch global = scoresBatch(catalog);
+    global.columns[1] = Column::ofInts({0, 0, 0, 0, 0, 0});
+    for (size_t r = 0; r < 6; ++r) global.columns[1].setValid(r, false);
+    runPipeline("group ; n:count(), total:sum(score)", global, catalog);
+    ASSERT_EQ(global.rowCount(), 1u);
+    EXPECT_EQ(global.columns[0].ints[0], 6);
+    EXPECT_FALSE(global.columns[1].isValid(0));
+}
+
+TEST(GroupTest, ParallelPartitionedAndSpilledMatchSerial) {
+    Catalog catalog;
+    constexpr size_t kRows = 60000;
+    std::vector<int64_t> keys(kRows);
+    std::vector<int64_t> values(kRows);
+    for (size_t r = 0; r < kRows; ++r) {
+        keys[r] = static_cast<int64_t>((r * 7919) % 5000);
+        values[r] = static_cast<int64_t>(r % 13);
+    }
+    auto makeBatch = [&] {
+        Batch batch;
+        batch.schema = catalog.makeSchema({{"k", PhysicalType::Int64}, {"v", PhysicalType::Int64}});
+        batch.columns = {Column::packInts(keys), Column::ofInts(values)};
+        return batch;
+    };
+    auto run = [&](uint32_t threads, size_t budget) {
+        auto pipeline = tryBuildPipeline("group k; n:count(), total:sum(v), low:min(v)", catalog);
+        Batch batch = makeBatch();
+        EXPECT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+        auto& group = dynamic_cast<GroupLogicalNode&>(*pipeline->stages[0]);
+        group.maxThreads = threads;
+        group.memoryBudget = budget;
+        executePipeline(*pipeline, batch);
+        return std::make_pair(std::move(batch), group.lastSpills.load());
+    };
+
+    auto [serial, serialSpills] = run(1, size_t{1} << 30);
+    auto [parallel, parallelSpills] = run(4, 4096);
+    EXPECT_EQ(serialSpills, 0u);
+    EXPECT_GT(parallelSpills, 0u);
+    ASSERT_EQ(serial.rowCount(), 5000u);
+    ASSERT_EQ(parallel.rowCount(), 5000u);
+    EXPECT_EQ(serial.columns[0].decoded().ints, parallel.columns[0].decoded().ints);
+    for (size_t c = 1; c < 4; ++c) {
+        EXPECT_EQ(serial.columns[c].ints, parallel.columns[c].ints) << c;
+    }
+    EXPECT_EQ(serial.columns[1].ints[0], 12);
+}
@@ -0,0 +1,193 @@
+#include "batch.h"
+#include "catalog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "src/logical_nodes/join_logical_node.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/parse_nodes/join_node.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace {
+
+// user_id: 2, 9, null, 1, 2    score: 10, 20, 30, 40, 50
+Batch ordersBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"user_id", PhysicalType::Int64}, {"score", PhysicalType::Int64}});
+    Column userId = Column::ofInts({2, 9, 0, 1, 2});
+    userId.setValid(2, false);
+    batch.columns = {std::move(userId), Column::ofInts({10, 20, 30, 40, 50})};
+    return batch;
+}
+
+// id 2 appears twice; the null id never matches
+void addUsers(Catalog& catalog) {
+    auto users = std::make_shared<Batch>();
+    users->schema = catalog.makeSchema({{"id", PhysicalType::Int64}, {"name", PhysicalType::String}});
+    Column id = Column::ofInts({1, 2, 3, 2, 0});
+    id.setValid(4, false);
+    users->columns = {std::move(id), Column::dictionaryEncode({"ann", "bob", "cy", "bo", "nul"})};
+    catalog.addTable("users", users);
+}
+
+std::vector<std::string> stageNames(const Pipeline& pipeline) {
+    std::vector<std::string> names;
+    for (const auto& stage : pipeline.stages) names.push_back(stage->debugName());
+    return names;
+}
+
+} // namespace
+
+TEST(JoinTest, ParsesTableAndKeys) {
+    auto node = JoinNode::tryParse("users on user_id = id");
+    ASSERT_TRUE(node.has_value());
+    EXPECT_EQ(node->table, "users");
+    EXPECT_EQ(node->probeKey, "user_id");
+    EXPECT_EQ(node->buildKey, "id");
+    auto same = JoinNode::tryParse(" users  on id ");
+    ASSERT_TRUE(same.has_value());
+    EXPECT_EQ(same->buildKey, "id");
+
+    EXPECT_EQ(JoinNode::tryParse("users id").error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(JoinNode::tryParse("users on").error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(JoinNode::tryParse("users on a =").error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(JoinNode::tryParse("users on a = b c").error().position, 15u);
+}
+
+TEST(JoinTest, JoinsInProbeOrderWithDuplicatesAndNulls) {
+    Catalog catalog;
+    addUsers(catalog);
+    Batch batch = ordersBatch(catalog);
+    auto pipeline = tryBuildPipeline("join users on user_id = id", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    ASSERT_TRUE(output.has_value());
+    ASSERT_EQ(output->fields.size(), 3u);
+    EXPECT_EQ(output->fields[2].name, "name");
+    executePipeline(*pipeline, batch);
+
+    EXPECT_EQ(batch.columns[0].ints, (std::vector<int64_t>{2, 2, 1, 2, 2}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{10, 10, 40, 50, 50}));
+    EXPECT_EQ(batch.columns[2].decoded().strings, (std::vector<std::string>{"bob", "bo", "ann", "bob", "bo"}));
+    auto& join = dynamic_cast<JoinLogicalNode&>(*pipeline->stages[0]);
+    EXPECT_EQ(join.lastRowsOutput.load(), 5u);
+    EXPECT_GE(join.lastRowsFiltered.load(), 1u);  // At least the null key
+
+    // Dictionary-encoded string keys match plain ones
+    auto names = std::make_shared<Batch>();
+    names->schema = catalog.makeSchema({{"name", PhysicalType::String}, {"age", PhysicalType::Int64}});
+    names->columns = {Column::ofStrings({"bo", "ann"}), Column::ofInts({30, 40})};
+    catalog.addTable("ages", names);
+    auto byName = tryBuildPipeline("join ages on name", catalog);
+    ASSERT_TRUE(bindPipeline(*byName, batch.schema, catalog.symbols).has_value());
+    executePipeline(*byName, batch);
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{10, 40, 50}));
+    EXPECT_EQ(batch.columns[3].ints, (std::vector<int64_t>{30, 40, 30}));
+}
+
+TEST(JoinTest, RebuildsTheHashTableWhenTheCatalogReplacesTheTable) {
+    Catalog catalog;
+    addUsers(catalog);
+    auto pipeline = tryBuildPipeline("join users on user_id = id", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    Batch orders = ordersBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, orders.schema, catalog.symbols).has_value());
+
+    auto users = std::make_shared<Batch>();
+    users->schema = catalog.makeSchema({{"id", PhysicalType::Int64}, {"name", PhysicalType::String}});
+    users->columns = {Column::ofInts({9}), Column::ofStrings({"zed"})};
+    catalog.addTable("users", users);
+    auto& join = dynamic_cast<JoinLogicalNode&>(*pipeline->stages[0]);
+    join.attachCatalog(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, orders.schema, catalog.symbols).has_value());
+    Batch batch = ordersBatch(catalog);
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.columns[0].ints, (std::vector<int64_t>{9}));
+    EXPECT_EQ(batch.columns[2].decoded().strings, (std::vector<std::string>{"zed"}));
+}
+
+TEST(JoinTest, ReportsBindErrors) {
+    Catalog catalog;
+    addUsers(catalog);
+    Batch batch = ordersBatch(catalog);
+    auto bindError = [&](const char* text) {
+        auto pipeline = tryBuildPipeline(text, catalog);
+        EXPECT_TRUE(pipeline.has_value()) << text;
+        return bindPipeline(*pipeline, batch.schema, catalog.symbols).error().code;
+    };
+    EXPECT_EQ(bindError("join nope on user_id = id"), DiagnosticCode::UnknownTable);
+    EXPECT_EQ(bindError("join users on user = id"), DiagnosticCode::UnknownField);
+    EXPECT_EQ(bindError("join users on user_id = nope"), DiagnosticCode::UnknownField);
+    EXPECT_EQ(bindError("join users on user_id = name"), DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(bindError("join users on user_id = id | join users on user_id = id"),
+              DiagnosticCode::DuplicateField);
+}
+
+TEST(JoinTest, PartitionedParallelProbeMatchesSerial) {
+    Catalog catalog;
+    constexpr size_t kBuildRows = 20000;
+    constexpr size_t kProbeRows = 60000;
+    auto table = std::make_shared<Batch>();
+    table->schema = catalog.makeSchema({{"k", PhysicalType::Int64}, {"v", PhysicalType::Int64}});
+    std::vector<int64_t> buildKeys(kBuildRows), values(kBuildRows);
+    for (size_t r = 0; r < kBuildRows; ++r) {
+        buildKeys[r] = static_cast<int64_t>(r * 3);  // Every third key
+        values[r] = static_cast<int64_t>(r);
+    }
+    table->columns = {Column::ofInts(buildKeys), Column::ofInts(values)};
+    catalog.addTable("t", table);
+    std::vector<int64_t> probeKeys(kProbeRows);
+    for (size_t r = 0; r < kProbeRows; ++r) probeKeys[r] = static_cast<int64_t>((r * 7919) % kProbeRows);
+
+    auto run = [&](uint32_t threads, size_t partitionBytes) {
+        auto pipeline = tryBuildPipeline("join t on k", catalog);
+        Batch batch;
+        batch.schema = catalog.makeSchema({{"k", PhysicalType::Int64}});
+        batch.columns = {Column::packInts(probeKeys)};
+        auto& join = dynamic_cast<JoinLogicalNode&>(*pipeline->stages[0]);
+        join.maxThreads = threads;
+        join.partitionBytes = partitionBytes;
+        EXPECT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+        executePipeline(*pipeline, batch);
+        return std::make_tuple(std::move(batch), join.partitions(), join.lastRowsFiltered.load());
+    };
+
+    auto [serial, serialPartitions, serialFiltered] = run(1, size_t{1} << 30);
+    auto [parallel, parallelPartitions, parallelFiltered] = run(4, 4096);
+    EXPECT_EQ(serialPartitions, 1u);
+    EXPECT_GT(parallelPartitions, 1u);
+    ASSERT_EQ(serial.rowCount(), kProbeRows / 3);
+    EXPECT_EQ(serial.columns[0].decoded().ints, parallel.columns[0].decoded().ints);
+    EXPECT_EQ(serial.columns[1].ints, parallel.columns[1].ints);
+    EXPECT_EQ(serial.columns[1].ints[0], 0);
+    // About 1% false positives get past the filter
+    EXPECT_GT(serialFiltered, kProbeRows / 2);
+}
+
+TEST(JoinTest, OptimizerRunsTheBloomFilterBeforeEarlierStages) {
+    Catalog catalog;
+    addUsers(catalog);
+    auto pipeline = tryBuildPipeline(
+        "set_metadata bonus:score * 2 | sort score | join users on user_id = id | project name, bonus", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_EQ(stageNames(*pipeline),
+              (std::vector<std::string>{"ProjectLogicalNode", "RuntimeFilterLogicalNode", "SetMetadataLogicalNode",
+                                        "SortLogicalNode", "JoinLogicalNode", "ProjectLogicalNode"}));
+    EXPECT_EQ(dynamic_cast<ProjectLogicalNode&>(*pipeline->stages[0]).params.fields,
+              (std::vector<std::string>{"user_id", "score"}));
+
+    Batch batch = ordersBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    executePipeline(*pipeline, batch);
+    auto& filter = dynamic_cast<RuntimeFilterLogicalNode&>(*pipeline->stages[1]);
+    EXPECT_EQ(filter.lastRowsIn.load(), 5u);
+    EXPECT_GE(filter.lastRowsDropped.load(), 1u);
+    EXPECT_EQ(batch.columns[0].decoded().strings, (std::vector<std::string>{"bob", "bo", "ann", "bob", "bo"}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{20, 20, 80, 100, 100}));
+
+    // Rows may not be dropped ahead of a limit
+    auto limited = tryBuildPipeline("limit 2 | join users on user_id = id", catalog);
+    optimizePipeline(*limited, catalog);
+    EXPECT_EQ(stageNames(*limited), (std::vector<std::string>{"LimitLogicalNode", "JoinLogicalNode"}));
+}
@@ -0,0 +1,139 @@
+#include "batch.h"
+#include "catalog.h"
+#include "expression_eval.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "predicate.h"
+#include "src/logical_nodes/match_logical_node.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+// score: 0..n-1 with every 7th row null; price: score / 4; country: dictionary
+Batch mixedBatch(Catalog& catalog, size_t rows) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"score", PhysicalType::Int64},
+                                       {"price", PhysicalType::Double},
+                                       {"country", PhysicalType::String}});
+    std::vector<int64_t> scores(rows);
+    std::vector<double> prices(rows);
+    std::vector<std::string> countries(rows);
+    const char* names[] = {"de", "fr", "us"};
+    for (size_t r = 0; r < rows; ++r) {
+        scores[r] = static_cast<int64_t>(r);
+        prices[r] = static_cast<double>(r) / 4;
+        countries[r] = names[r % 3];
+    }
+    Column score = Column::ofInts(scores);
+    for (size_t r = 0; r < rows; r += 7) score.setValid(r, false);
+    batch.columns = {std::move(score), Column::ofDoubles(prices), Column::dictionaryEncode(countries)};
+    return batch;
+}
+
+// Rows where the interpreter says the predicate is true
+SelectionVector interpretedRows(const char* text, const Batch& batch, Catalog& catalog) {
+    auto bound = bindExpression(*parseExpression(text), batch.schema, catalog.symbols);
+    Column result = evaluateExpression(**bound, batch);
+    SelectionVector rows;
+    for (uint32_t r = 0; r < result.size(); ++r) {
+        if (result.isValid(r) && result.bools[r]) rows.push_back(r);
+    }
+    return rows;
+}
+
+std::vector<std::string> stageNames(const Pipeline& pipeline) {
+    std::vector<std::string> names;
+    for (const auto& stage : pipeline.stages) names.push_back(stage->debugName());
+    return names;
+}
+
+} // namespace
+
+TEST(MatchTest, KernelsAgreeWithTheInterpreter) {
+    Catalog catalog;
+    Batch batch = mixedBatch(catalog, 300);
+    for (const char* text : {"score > 100", "score >= 7 and price < 40.5", "country == \"fr\" or score < 10",
+                             "country >= \"e\" and country != \"us\"", "price > score", "score > 20.5",
+                             "not(score > 10) or is_null(score)"}) {
+        auto bound = bindExpression(*parseExpression(text), batch.schema, catalog.symbols);
+        ASSERT_TRUE(bound.has_value()) << text;
+        EXPECT_EQ(compilePredicate(*bound).select(batch), interpretedRows(text, batch, catalog)) << text;
+    }
+
+    auto mixed = compilePredicate(*bindExpression(*parseExpression("score > 1 and (price < 3 or not(score == 2))"),
+                                                  batch.schema, catalog.symbols));
+    EXPECT_EQ(mixed.kernelLeaves, 2u);
+    EXPECT_EQ(mixed.interpretedLeaves, 1u);
+}
+
+TEST(MatchTest, ZoneMapsSkipAndAcceptWholeBlocks) {
+    Catalog catalog;
+    constexpr size_t kRows = 10 * ZoneMap::kBlockRows;
+    Batch batch = mixedBatch(catalog, kRows);
+    batch.columns[1].buildZoneMap();
+    Batch packed = batch;
+    std::vector<int64_t> scores(kRows);
+    for (size_t r = 0; r < kRows; ++r) scores[r] = static_cast<int64_t>(r);
+    packed.columns[0] = Column::packInts(scores);
+    packed.columns[0].buildZoneMap();
+
+    auto pipeline = tryBuildPipeline("match price >= 1024 and price < 1536", catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    executePipeline(*pipeline, batch);
+    auto& match = dynamic_cast<MatchLogicalNode&>(*pipeline->stages[0]);
+    // price = row / 4: blocks 4 and 5 match entirely, the rest not at all
+    EXPECT_EQ(batch.rowCount(), 2048u);
+    EXPECT_EQ(match.lastBlocksAccepted.load(), 2u);
+    EXPECT_EQ(match.lastBlocksSkipped.load(), 8u);
+    EXPECT_EQ(match.lastRowsEvaluated.load(), 0u);
+
+    auto onPacked = tryBuildPipeline("match score > 5000", catalog);
+    ASSERT_TRUE(bindPipeline(*onPacked, packed.schema, catalog.symbols).has_value());
+    executePipeline(*onPacked, packed);
+    auto& packedMatch = dynamic_cast<MatchLogicalNode&>(*onPacked->stages[0]);
+    EXPECT_EQ(packed.rowCount(), kRows - 5001);
+    EXPECT_EQ(packed.columns[0].decoded().ints.front(), 5001);
+    EXPECT_EQ(packedMatch.lastRowsEvaluated.load(), ZoneMap::kBlockRows);
+
+    // Reordered columns lose their zone maps
+    Column sorted = batch.columns[1];
+    sorted.gather({1, 0});
+    EXPECT_EQ(sorted.zones, nullptr);
+}
+
+TEST(MatchTest, OptimizerMovesMatchesBeforeSortAndUnrelatedStages) {
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata bonus:score * 2 | sort price | set_metadata tag:price + 1 | limit 50 | "
+        "match score > 3 + 4 | sort score | match bonus > 10",
+        catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    // The first match stops at the limit; the second at the stage writing bonus
+    EXPECT_EQ(stageNames(*pipeline),
+              (std::vector<std::string>{"SetMetadataLogicalNode", "SortLogicalNode", "SetMetadataLogicalNode",
+                                        "LimitLogicalNode", "MatchLogicalNode", "MatchLogicalNode",
+                                        "SortLogicalNode"}));
+    auto& first = dynamic_cast<MatchLogicalNode&>(*pipeline->stages[4]);
+    EXPECT_EQ(toString(*first.expression), toString(**parseExpression("score > 7")));
+
+    auto early = tryBuildPipeline("sort price | set_metadata tag:price + 1 | match score > 3", catalog);
+    optimizePipeline(*early, catalog);
+    EXPECT_EQ(stageNames(*early), (std::vector<std::string>{"MatchLogicalNode", "SortLogicalNode",
+                                                            "SetMetadataLogicalNode"}));
+    Batch batch = mixedBatch(catalog, 20);
+    ASSERT_TRUE(bindPipeline(*early, batch.schema, catalog.symbols).has_value());
+    executePipeline(*early, batch);
+    EXPECT_EQ(batch.rowCount(), 14u);  // 4..19 minus the null rows 7 and 14
+}
+
+TEST(MatchTest, RejectsNonBoolPredicates) {
+    Catalog catalog;
+    Batch batch = mixedBatch(catalog, 4);
+    auto pipeline = tryBuildPipeline("match score + 1", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    auto bound = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    ASSERT_FALSE(bound.has_value());
+    EXPECT_EQ(bound.error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_FALSE(tryBuildPipeline("match score >", catalog).has_value());
+}
@@ -0,0 +1,227 @@
+#include "batch.h"
+#include "catalog.h"
+#include "metadata_sink.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+std::string tempLogPath(const std::string& name) {
+    std::string path = ::testing::TempDir() + "/" + name + "." + std::to_string(getpid());
+    std::remove(path.c_str());
+    return path;
+}
+
+// Latest value of every (name, row id) in the log's Int64 frames
+std::map<std::pair<std::string, int64_t>, int64_t> latestInts(const std::string& path) {
+    std::map<std::pair<std::string, int64_t>, int64_t> latest;
+    auto log = readMetadataLog(path);
+    EXPECT_TRUE(log.has_value());
+    for (const auto& frame : log->frames) {
+        if (frame.values.type != PhysicalType::Int64) continue;
+        for (size_t r = 0; r < frame.rowIds.size(); ++r) {
+            latest[{frame.name, frame.rowIds[r]}] = frame.values.ints[r];
+        }
+    }
+    return latest;
+}
+
+MetadataSinkOptions testOptions() {
+    MetadataSinkOptions options;
+    options.sync = false;
+    return options;
+}
+
+} // namespace
+
+TEST(MetadataSinkTest, GroupCommitsWritesFromParallelWorkers) {
+    std::string path = tempLogPath("group_commit.log");
+    MetadataSinkOptions options = testOptions();
+    options.maxBatchRows = 2000;
+    options.maxLatency = std::chrono::milliseconds(20);
+    constexpr int kWorkers = 8, kBatches = 50, kRows = 20;
+    {
+        MetadataSink sink(path, options);
+        std::vector<std::thread> workers;
+        for (int w = 0; w < kWorkers; ++w) {
+            workers.emplace_back([&, w] {
+                for (int b = 0; b < kBatches; ++b) {
+                    std::vector<int64_t> ids, values;
+                    for (int r = 0; r < kRows; ++r) {
+                        ids.push_back((w * kBatches + b) * kRows + r);
+                        values.push_back(ids.back() * 3);
+                    }
+                    sink.write("score", Column::packInts(ids), Column::ofInts(values));
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        ASSERT_TRUE(sink.flush());
+        EXPECT_EQ(sink.rowsCommitted(), size_t{kWorkers * kBatches * kRows});
+        EXPECT_LT(sink.commits(), size_t{kWorkers * kBatches} / 4);
+    }
+    auto latest = latestInts(path);
+    ASSERT_EQ(latest.size(), size_t{kWorkers * kBatches * kRows});
+    for (const auto& [key, value] : latest) EXPECT_EQ(value, key.second * 3);
+
+    // The latency bound commits a small group without a flush
+    options.maxBatchRows = 1 << 20;
+    options.maxLatency = std::chrono::milliseconds(2);
+    MetadataSink sink(path, options);
+    sink.write("score", Column::ofInts({1}), Column::ofInts({7}));
+    for (int i = 0; i < 2000 && sink.commits() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(sink.commits(), 1u);
+    EXPECT_EQ((latestInts(path)[{"score", 1}]), 7);
+    std::remove(path.c_str());
+}
+
+TEST(MetadataSinkTest, CompactsToLatestValuesAndRecoversTornTail) {
+    std::string path = tempLogPath("compact.log");
+    MetadataSinkOptions options = testOptions();
+    options.compactBytes = 1 << 30;
+    {
+        MetadataSink sink(path, options);
+        for (int64_t round = 0; round < 10; ++round) {
+            sink.write("rank", Column::ofInts({1, 2, 3}), Column::ofInts({round, round * 2, round * 3}));
+            sink.write("label", Column::ofInts({1}), Column::ofStrings({"r" + std::to_string(round)}));
+        }
+        Column maybe = Column::ofDoubles({0.5, 1.5});
+        maybe.setValid(1, false);
+        Column ids = Column::ofInts({4, 5});
+        sink.write("half", ids, maybe);
+        ASSERT_TRUE(sink.flush());
+        size_t before = sink.logBytes();
+        ASSERT_TRUE(sink.compact());
+        EXPECT_EQ(sink.compactions(), 1u);
+        EXPECT_LT(sink.logBytes(), before / 4);
+
+        // Writes after a compaction land in the new file
+        sink.write("rank", Column::ofInts({2}), Column::ofInts({-2}));
+    }
+    auto log = readMetadataLog(path);
+    ASSERT_TRUE(log.has_value());
+    std::map<std::pair<std::string, int64_t>, std::string> latest;
+    size_t nulls = 0;
+    for (const auto& frame : log->frames) {
+        for (size_t r = 0; r < frame.rowIds.size(); ++r) {
+            const Column& v = frame.values;
+            nulls += !v.isValid(r);
+            latest[{frame.name, frame.rowIds[r]}] = v.type == PhysicalType::String ? v.strings[r]
+                                                    : v.type == PhysicalType::Int64 ? std::to_string(v.ints[r])
+                                                                                    : std::to_string(v.doubles[r]);
+        }
+    }
+    EXPECT_EQ(latest.size(), 6u);
+    EXPECT_EQ((latest[{"rank", 1}]), "9");
+    EXPECT_EQ((latest[{"rank", 2}]), "-2");
+    EXPECT_EQ((latest[{"rank", 3}]), "27");
+    EXPECT_EQ((latest[{"label", 1}]), "r9");
+    EXPECT_EQ(nulls, 1u);
+
+    // A crash mid-commit leaves a torn frame: readers stop before it and a
+    // new sink truncates it away
+    size_t intact = log->validBytes;
+    FILE* f = std::fopen(path.c_str(), "ab");
+    std::fwrite("\x40\x00\x00\x00garbage", 1, 11, f);
+    std::fclose(f);
+    EXPECT_EQ(readMetadataLog(path)->validBytes, intact);
+    {
+        MetadataSink sink(path, options);
+        sink.write("rank", Column::ofInts({3}), Column::ofInts({-3}));
+        ASSERT_TRUE(sink.flush());
+    }
+    EXPECT_EQ((latestInts(path)[{"rank", 3}]), -3);
+
+    // A file that is not a metadata log is never appended to
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite("not a log", 1, 9, f);
+    std::fclose(f);
+    {
+        MetadataSink sink(path, options);
+        sink.write("rank", Column::ofInts({1}), Column::ofInts({1}));
+        EXPECT_FALSE(sink.flush());
+    }
+    EXPECT_FALSE(readMetadataLog(path).has_value());
+    std::remove(path.c_str());
+}
+
+TEST(MetadataSinkTest, FailedCompactionNeverFailsCommits) {
+    std::string path = tempLogPath("failing_compact.log");
+    std::string blocker = path + ".compact";
+    std::filesystem::remove_all(blocker);
+    std::filesystem::create_directory(blocker);  // The compacted copy cannot be written
+    MetadataSinkOptions options = testOptions();
+    options.compactBytes = 1;
+    MetadataSink sink(path, options);
+    auto commit = [&](int64_t value) {
+        sink.write("rank", Column::ofInts({1, 2}), Column::ofInts({value, value}));
+        return sink.flush();
+    };
+
+    for (int64_t round = 0; sink.compactionFailures() == 0 && round < 100; ++round) {
+        ASSERT_TRUE(commit(round));
+    }
+    EXPECT_EQ(sink.compactionFailures(), 1u);
+    EXPECT_EQ(sink.compactions(), 0u);
+    ASSERT_TRUE(commit(-1));
+
+    // Retried once the log has doubled again
+    std::filesystem::remove_all(blocker);
+    for (int64_t round = 0; sink.compactions() == 0 && round < 100; ++round) {
+        ASSERT_TRUE(commit(round));
+    }
+    EXPECT_EQ(sink.compactions(), 1u);
+    EXPECT_EQ(sink.compactionFailures(), 1u);
+    ASSERT_TRUE(commit(7));
+    EXPECT_EQ((latestInts(path)[{"rank", 2}]), 7);
+    std::remove(path.c_str());
+}
+
+TEST(MetadataSinkTest, SetMetadataStagesWriteEveryRowTheySee) {
+    std::string path = tempLogPath("pipeline.log");
+    Catalog catalog;
+    catalog.metadataSink = std::make_shared<MetadataSink>(path, testOptions());
+    Batch input;
+    input.schema = catalog.makeSchema({{"id", PhysicalType::Int64}, {"a", PhysicalType::Int64}});
+    std::vector<int64_t> ids, a;
+    for (int64_t r = 0; r < 100; ++r) {
+        ids.push_back(1000 + r);
+        a.push_back(r % 10);
+    }
+    input.columns = {Column::ofInts(ids), Column::ofInts(a)};
+
+    // Without the sink this would be fused into a top-k, the match pushed
+    // above it, and the unread stage pruned
+    auto pipeline = tryBuildPipeline("set_metadata unused:a + 1 | set_metadata s:a * 2 | match a > 5 | sort s | limit 3",
+                                     catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_NE(explainPipeline(*pipeline).find("group-committed to the metadata sink"), std::string::npos);
+    ASSERT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value());
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.rowCount(), 3u);
+    ASSERT_TRUE(catalog.metadataSink->flush());
+
+    auto latest = latestInts(path);
+    EXPECT_EQ(latest.size(), 200u);
+    for (int64_t r = 0; r < 100; ++r) {
+        EXPECT_EQ((latest[{"s", 1000 + r}]), (r % 10) * 2);
+        EXPECT_EQ((latest[{"unused", 1000 + r}]), r % 10 + 1);
+    }
+
+    // The sink's row id field must be there
+    Batch noIds;
+    noIds.schema = catalog.makeSchema({{"a", PhysicalType::Int64}});
+    auto missing = tryBuildPipeline("set_metadata s:a * 2", catalog);
+    EXPECT_EQ(bindPipeline(*missing, noIds.schema, catalog.symbols).error().code, DiagnosticCode::UnknownField);
+    catalog.metadataSink.reset();
+    std::remove(path.c_str());
+}
@@ -0,0 +1,161 @@
+#include "batch.h"
+#include "catalog.h"
+#include "metadata_store.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+TEST(MetadataStoreTest, InsertsReplacesAndGathers) {
+    MetadataStore store(16);
+    SymbolId score = 3, label = 4;
+    Column ids = Column::ofInts({10, 11, 12, 13});
+    ids.setValid(3, false);
+    Column values = Column::ofDoubles({1.5, 2.5, 3.5, 4.5});
+    values.setValid(1, false);
+    store.insert(score, ids, values);
+    store.insert(label, Column::packInts({10, 12}), Column::dictionaryEncode({"ten", "twelve"}));
+    EXPECT_EQ(store.size(), 5u);
+
+    EXPECT_EQ(store.find(10, score)->doubleValue, 1.5);
+    EXPECT_FALSE(store.find(11, score)->valid);
+    EXPECT_FALSE(store.find(13, score).has_value());  // Null row id
+    EXPECT_FALSE(store.find(10, 5).has_value());
+    EXPECT_EQ(store.find(12, label)->stringValue, "twelve");
+
+    // Replacing keeps one entry per key and retires the old value
+    store.insert(score, Column::ofInts({10}), Column::ofDoubles({-1}));
+    EXPECT_EQ(store.size(), 5u);
+    EXPECT_EQ(store.find(10, score)->doubleValue, -1);
+    EXPECT_EQ(store.retired(), 0u);  // No reader was in progress
+
+    Column gathered = store.gather(score, PhysicalType::Double, Column::ofInts({12, 99, 10, 11}));
+    ASSERT_EQ(gathered.size(), 4u);
+    EXPECT_EQ(gathered.doubles[0], 3.5);
+    EXPECT_EQ(gathered.doubles[2], -1);
+    EXPECT_FALSE(gathered.isValid(1));
+    EXPECT_FALSE(gathered.isValid(3));
+    EXPECT_FALSE(store.gather(label, PhysicalType::Int64, Column::ofInts({10})).isValid(0));  // Other type
+
+    // Growing keeps every entry reachable
+    std::vector<int64_t> many(5000);
+    for (size_t i = 0; i < many.size(); ++i) many[i] = static_cast<int64_t>(i) * 7;
+    store.insert(score, Column::ofInts(many), Column::ofDoubles(std::vector<double>(many.begin(), many.end())));
+    EXPECT_GE(store.capacity(), 2 * store.size());
+    for (int64_t id : {0, 7, 70, 34993}) EXPECT_EQ(store.find(id, score)->doubleValue, static_cast<double>(id));
+    EXPECT_EQ(store.find(12, label)->stringValue, "twelve");
+}
+
+TEST(MetadataStoreTest, ReadsNeverWaitForAFreeReaderRecord) {
+    MetadataStore store(16);
+    SymbolId score = 3;
+    store.insert(score, Column::ofInts({1}), Column::ofDoubles({1}));
+
+    // More reads in progress than fixed records: the extra ones overflow
+    // instead of spinning, and still hold back reclamation
+    constexpr size_t kExtra = 8;
+    std::vector<std::unique_ptr<MetadataStore::ReadGuard>> guards;
+    for (size_t i = 0; i < MetadataStore::kReaderRecords + kExtra; ++i) {
+        guards.push_back(std::make_unique<MetadataStore::ReadGuard>(store));
+    }
+    EXPECT_EQ(store.readerRecords(), MetadataStore::kReaderRecords + kExtra);
+    EXPECT_EQ(store.find(1, score)->doubleValue, 1);  // Needs one more record
+    EXPECT_EQ(store.readerRecords(), MetadataStore::kReaderRecords + kExtra + 1);
+
+    guards.erase(guards.begin(), guards.begin() + MetadataStore::kReaderRecords);
+    store.insert(score, Column::ofInts({1}), Column::ofDoubles({2}));
+    EXPECT_EQ(store.retired(), 1u);  // An overflow reader is still in progress
+
+    // Idle overflow records are reused rather than allocated again
+    guards.clear();
+    for (size_t i = 0; i < MetadataStore::kReaderRecords + kExtra; ++i) {
+        guards.push_back(std::make_unique<MetadataStore::ReadGuard>(store));
+    }
+    EXPECT_EQ(store.readerRecords(), MetadataStore::kReaderRecords + kExtra + 1);
+    guards.clear();
+    store.insert(score, Column::ofInts({1}), Column::ofDoubles({3}));
+    EXPECT_EQ(store.retired(), 0u);
+    EXPECT_EQ(store.find(1, score)->doubleValue, 3);
+}
+
+TEST(MetadataStoreTest, ReadersNeverSeeTornOrFreedValues) {
+    MetadataStore store(16);
+    constexpr int64_t kRows = 2000;
+    constexpr int kRounds = 200;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> reads{0};
+
+    // Round r stores the string "r:<id>" for every id, growing the table early on
+    std::thread writer([&] {
+        for (int round = 1; round <= kRounds; ++round) {
+            std::vector<int64_t> ids;
+            std::vector<std::string> values;
+            for (int64_t id = round % 2; id < kRows; id += 2) {
+                ids.push_back(id);
+                values.push_back(std::to_string(round) + ":" + std::to_string(id));
+            }
+            store.insert(1, Column::ofInts(std::move(ids)), Column::ofStrings(std::move(values)));
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    std::atomic<bool> consistent{true};
+    for (int t = 0; t < 6; ++t) {
+        readers.emplace_back([&, t] {
+            std::vector<int> lastRound(kRows, 0);
+            while (!done) {
+                for (int64_t id = t; id < kRows; id += 37) {
+                    auto value = store.find(id, 1);
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                    if (!value) continue;
+                    size_t colon = value->stringValue.find(':');
+                    int round = std::stoi(value->stringValue.substr(0, colon));
+                    // Well formed, for this id, and never older than a value already seen
+                    if (value->stringValue.substr(colon + 1) != std::to_string(id) || round < lastRound[id] ||
+                        round % 2 != id % 2) {
+                        consistent = false;
+                    }
+                    lastRound[id] = round;
+                }
+                Column batch = store.gather(1, PhysicalType::String, Column::ofInts({t, t + 1, kRows + 1}));
+                if (batch.isValid(2)) consistent = false;
+            }
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) reader.join();
+    EXPECT_TRUE(consistent.load());
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(store.size(), static_cast<size_t>(kRows));
+    EXPECT_EQ(store.find(0, 1)->stringValue, std::to_string(kRounds) + ":0");
+
+    // With the readers gone, the next batch frees everything retired
+    store.insert(1, Column::ofInts({0}), Column::ofStrings({"last"}));
+    EXPECT_EQ(store.retired(), 0u);
+}
+
+TEST(MetadataStoreTest, SetMetadataPublishesValuesForLaterQueries) {
+    Catalog catalog;
+    catalog.metadataStore = std::make_shared<MetadataStore>();
+    catalog.metadataRowIdField = "key";
+    Batch input;
+    input.schema = catalog.makeSchema({{"key", PhysicalType::Int64}, {"a", PhysicalType::Int64}});
+    input.columns = {Column::ofInts({5, 6, 7, 8}), Column::ofInts({1, 2, 3, 4})};
+
+    auto pipeline = tryBuildPipeline("set_metadata doubled:a * 2 | match a > 2", catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_NE(explainPipeline(*pipeline).find("published to the metadata store"), std::string::npos);
+    ASSERT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value());
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.rowCount(), 2u);
+
+    // Every row reached the stage, including those the match dropped later
+    SymbolId doubled = *catalog.symbols.find("doubled");
+    Column values = catalog.metadataStore->gather(doubled, PhysicalType::Int64, Column::ofInts({5, 6, 7, 8, 9}));
+    EXPECT_EQ(values.ints, (std::vector<int64_t>{2, 4, 6, 8, 0}));
+    EXPECT_FALSE(values.isValid(4));
+}
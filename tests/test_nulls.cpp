@@ -0,0 +1,112 @@
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "pipeline.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+// Rows whose validity bit is clear, as indexes
+std::vector<size_t> nullRows(const Column& column) {
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < column.size(); ++i) {
+        if (!column.isValid(i)) rows.push_back(i);
+    }
+    return rows;
+}
+
+// a: 1, null, 3, null, 5    b: null, 20, 30, null, 50
+Batch sparseBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"a", PhysicalType::Int64}, {"b", PhysicalType::Int64}});
+    Column a = Column::ofInts({1, 0, 3, 0, 5});
+    a.setValid(1, false);
+    a.setValid(3, false);
+    Column b = Column::ofInts({0, 20, 30, 0, 50});
+    b.setValid(0, false);
+    b.setValid(3, false);
+    batch.columns = {std::move(a), std::move(b)};
+    return batch;
+}
+
+Column evaluate(const char* text, const Batch& batch, Catalog& catalog) {
+    auto bound = bindExpression(*parseExpression(text), batch.schema, catalog.symbols);
+    EXPECT_TRUE(bound.has_value()) << text;
+    return evaluateExpression(**bound, batch);
+}
+
+} // namespace
+
+TEST(NullsTest, AndValidityCombinesWholeWords) {
+    Column column = Column::ofInts(std::vector<int64_t>(300, 7));
+    column.setValid(5, false);
+    column.setValid(299, false);
+    ValidityBitmap combined;
+    andValidity(combined, column.validity, 300);  // Empty destination takes a copy
+    Column other = Column::ofInts(std::vector<int64_t>(300, 1));
+    other.setValid(130, false);
+    andValidity(combined, other.validity, 300);
+    column.validity = combined;
+    EXPECT_EQ(nullRows(column), (std::vector<size_t>{5, 130, 299}));
+}
+
+TEST(NullsTest, StrictKernelsPropagateNulls) {
+    Catalog catalog;
+    Batch batch = sparseBatch(catalog);
+    Column sum = evaluate("a + b * 2", batch, catalog);
+    EXPECT_EQ(nullRows(sum), (std::vector<size_t>{0, 1, 3}));
+    EXPECT_EQ(sum.ints[2], 63);
+
+    Column isNull = evaluate("is_null(a)", batch, catalog);
+    EXPECT_FALSE(isNull.hasNulls());
+    EXPECT_EQ(isNull.bools, (std::vector<uint8_t>{0, 1, 0, 1, 0}));
+}
+
+TEST(NullsTest, CoalesceAndConditionalsUseValidity) {
+    Catalog catalog;
+    Batch batch = sparseBatch(catalog);
+    Column first = evaluate("coalesce(a, b, -1)", batch, catalog);
+    EXPECT_FALSE(first.hasNulls());
+    EXPECT_EQ(first.ints, (std::vector<int64_t>{1, 20, 3, -1, 5}));
+
+    Column partial = evaluate("coalesce(b, a)", batch, catalog);
+    EXPECT_EQ(nullRows(partial), (std::vector<size_t>{3}));
+
+    // A null condition takes the else branch
+    Column chosen = evaluate("if(a > 2, 1, 0)", batch, catalog);
+    EXPECT_FALSE(chosen.hasNulls());
+    EXPECT_EQ(chosen.ints, (std::vector<int64_t>{0, 0, 1, 0, 1}));
+
+    // Three-valued logic: null and false is false, false or null is null
+    Column conj = evaluate("a > 2 and b > 25", batch, catalog);
+    EXPECT_EQ(nullRows(conj), (std::vector<size_t>{3}));
+    EXPECT_EQ(conj.bools[1], 0);  // null and false
+    Column disj = evaluate("a > 2 or b > 25", batch, catalog);
+    EXPECT_EQ(nullRows(disj), (std::vector<size_t>{0, 1, 3}));
+    EXPECT_EQ(disj.bools[2], 1);
+}
+
+TEST(NullsTest, SortPlacesNullsFirstOrLast) {
+    Catalog catalog;
+    for (const char* keys : {"a", "a,b"}) {
+        Batch last = sparseBatch(catalog);
+        auto pipeline = tryBuildPipeline(std::string("sort ") + keys + ":desc", catalog);
+        ASSERT_TRUE(pipeline.has_value());
+        ASSERT_TRUE(bindPipeline(*pipeline, last.schema, catalog.symbols).has_value());
+        executePipeline(*pipeline, last);
+        EXPECT_EQ(last.columns[0].ints[0], 5) << keys;
+        EXPECT_EQ(nullRows(last.columns[0]), (std::vector<size_t>{3, 4})) << keys;
+        // Ties among nulls keep input order (b: 20 then null)
+        EXPECT_EQ(last.columns[1].ints[3], 20) << keys;
+
+        Batch first = sparseBatch(catalog);
+        pipeline = tryBuildPipeline(std::string("sort ") + keys + ":asc:nulls_first", catalog);
+        ASSERT_TRUE(pipeline.has_value());
+        ASSERT_TRUE(bindPipeline(*pipeline, first.schema, catalog.symbols).has_value());
+        executePipeline(*pipeline, first);
+        EXPECT_EQ(nullRows(first.columns[0]), (std::vector<size_t>{0, 1})) << keys;
+        EXPECT_EQ(first.columns[0].ints[2], 1) << keys;
+        EXPECT_EQ(first.columns[0].ints[4], 5) << keys;
+    }
+}
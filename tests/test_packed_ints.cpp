@@ -0,0 +1,96 @@
+#include "packed_ints.h"
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "pipeline.h"
+#include <climits>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<int64_t> sampleValues(size_t n, int64_t base, int64_t spread) {
+    std::vector<int64_t> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = base + static_cast<int64_t>((i * 2654435761u) % static_cast<uint64_t>(spread));
+    }
+    return values;
+}
+
+Batch run(const std::string& text, const Batch& input, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    return batch;
+}
+
+} // namespace
+
+TEST(PackedIntsTest, RoundTripsAcrossWidths) {
+    std::vector<std::vector<int64_t>> cases = {
+        std::vector<int64_t>(100, 42),              // width 0
+        sampleValues(130, -5, 2),                   // width 1
+        sampleValues(1000, 1000, 100),              // width 7
+        sampleValues(200, -(int64_t{1} << 40), int64_t{1} << 33),
+        {INT64_MIN, INT64_MAX, 0, -1, 1},           // width 64
+    };
+    for (const auto& values : cases) {
+        PackedInts packed = PackedInts::pack(values);
+        EXPECT_EQ(packed.unpackAll(), values) << int(packed.bitWidth);
+        for (size_t i = 0; i < values.size(); i += 7) {
+            EXPECT_EQ(packed.at(i), values[i]);
+        }
+        // Ranges that start and end inside blocks
+        if (values.size() > 70) {
+            std::vector<int64_t> middle(60);
+            packed.unpack(10, middle.size(), middle.data());
+            EXPECT_TRUE(std::equal(middle.begin(), middle.end(), values.begin() + 10));
+        }
+    }
+    EXPECT_EQ(PackedInts::pack(sampleValues(1000, 1000, 100)).bitWidth, 7);
+    EXPECT_EQ(PackedInts::pack(sampleValues(1024, 1000, 100)).byteSize(), 1024 * 7 / 8);
+}
+
+TEST(PackedIntsTest, ComparisonsRunOnCompressedData) {
+    Catalog catalog;
+    std::vector<int64_t> values = sampleValues(500, 100, 50);
+    Batch plain;
+    plain.schema = catalog.makeSchema({{"x", PhysicalType::Int64}});
+    plain.columns = {Column::ofInts(values)};
+    Batch packed = plain;
+    packed.columns[0] = Column::packInts(values);
+    packed.columns[0].setValid(3, false);
+    plain.columns[0].setValid(3, false);
+
+    for (const char* text : {"x > 120", "x <= 100", "x == 149", "x != 130", "99 < x", "x >= 50",
+                             "x < 1000", "x * 2 + 1", "if(x > 140, x, 0)"}) {
+        auto bound = bindExpression(*parseExpression(text), plain.schema, catalog.symbols);
+        ASSERT_TRUE(bound.has_value()) << text;
+        Column expected = evaluateExpression(**bound, plain);
+        Column actual = evaluateExpression(**bound, packed);
+        EXPECT_EQ(actual.bools, expected.bools) << text;
+        EXPECT_EQ(actual.ints, expected.ints) << text;
+        EXPECT_EQ(actual.validity, expected.validity) << text;
+    }
+}
+
+TEST(PackedIntsTest, SortsOnPackedKeys) {
+    Catalog catalog;
+    Batch plain;
+    plain.schema = catalog.makeSchema({{"x", PhysicalType::Int64}, {"id", PhysicalType::Int64}});
+    std::vector<int64_t> ids(700);
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<int64_t>(i);
+    plain.columns = {Column::ofInts(sampleValues(700, -300, 1000)), Column::ofInts(ids)};
+    Batch packed = plain;
+    packed.columns[0] = Column::packInts(plain.columns[0].ints);
+
+    for (const char* text : {"sort x", "sort x:desc", "sort x,id:desc", "sort x | limit 5"}) {
+        Batch expected = run(text, plain, catalog);
+        Batch actual = run(text, packed, catalog);
+        ASSERT_TRUE(actual.columns[0].isPacked()) << text;
+        EXPECT_EQ(actual.columns[0].decoded().ints, expected.columns[0].ints) << text;
+        EXPECT_EQ(actual.columns[1].ints, expected.columns[1].ints) << text;
+    }
+}
@@ -0,0 +1,120 @@
+#include "parse_node.h"
+#include "node_transformer.h"
+#include "diagnostic.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(ParseDiagnosticsTest, LimitReportsPositionOfBadCharacter) {
+    auto result = tryCreateParseNodeFromInput("limit", "10x");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(result.error().position, 2u);
+}
+
+TEST(ParseDiagnosticsTest, LimitRejectsNonNumbersAndOverflow) {
+    EXPECT_EQ(tryCreateParseNodeFromInput("limit", "abc").error().code,
+              DiagnosticCode::ExpectedInteger);
+    EXPECT_EQ(tryCreateParseNodeFromInput("limit", "99999999999").error().code,
+              DiagnosticCode::IntegerOutOfRange);
+    EXPECT_EQ(tryCreateParseNodeFromInput("limit", "-1").error().code,
+              DiagnosticCode::NegativeLimit);
+}
+
+TEST(ParseDiagnosticsTest, LimitOffsetReportsPositions) {
+    ASSERT_TRUE(tryCreateParseNodeFromInput("limit", "20 offset 40").has_value());
+    auto word = tryCreateParseNodeFromInput("limit", "20 skip 40");
+    EXPECT_EQ(word.error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(word.error().position, 2u);
+    auto negative = tryCreateParseNodeFromInput("limit", "20 offset -4");
+    EXPECT_EQ(negative.error().code, DiagnosticCode::NegativeLimit);
+    EXPECT_EQ(negative.error().position, 10u);
+    EXPECT_EQ(tryCreateParseNodeFromInput("limit", "20 offset ").error().code, DiagnosticCode::ExpectedInteger);
+    EXPECT_EQ(tryCreateParseNodeFromInput("limit", "20 offset 4x").error().position, 11u);
+}
+
+TEST(ParseDiagnosticsTest, UnknownNodeTypeIsNotAnException) {
+    auto result = tryCreateParseNodeFromInput("nope", "1");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, DiagnosticCode::UnknownNodeType);
+    // The throwing API keeps its original message
+    EXPECT_THROW(createParseNodeFromInput("nope", "1"), std::runtime_error);
+}
+
+TEST(ParseDiagnosticsTest, SortParsesKeysAndDirection) {
+    auto result = tryCreateParseNodeFromInput("sort", "country,score:desc");
+    ASSERT_TRUE(result.has_value());
+    auto params = std::get<SortParams>((*result)->astParams());
+    EXPECT_EQ(params.sortKeys, (std::vector<std::string>{"country", "score"}));
+    EXPECT_FALSE(params.ascending);
+
+    auto bad = tryCreateParseNodeFromInput("sort", "a,,b");
+    ASSERT_FALSE(bad.has_value());
+    EXPECT_EQ(bad.error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(bad.error().position, 2u);
+
+    auto direction = tryCreateParseNodeFromInput("sort", "a:sideways");
+    ASSERT_FALSE(direction.has_value());
+    EXPECT_EQ(direction.error().code, DiagnosticCode::UnknownSortDirection);
+    EXPECT_EQ(direction.error().position, 2u);
+
+    auto nulls = tryCreateParseNodeFromInput("sort", "a:desc:nulls_first");
+    ASSERT_TRUE(nulls.has_value());
+    params = std::get<SortParams>((*nulls)->astParams());
+    EXPECT_FALSE(params.ascending);
+    EXPECT_TRUE(params.nullsFirst);
+
+    auto option = tryCreateParseNodeFromInput("sort", "a:asc:nulls_sideways");
+    ASSERT_FALSE(option.has_value());
+    EXPECT_EQ(option.error().position, 6u);
+}
+
+TEST(ParseDiagnosticsTest, PipelinePositionsIndexIntoWholeText) {
+    std::string text = "sort score:desc | limit 1O";
+    auto result = tryParsePipeline(text);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(result.error().position, text.find('O'));
+
+    auto unknown = tryParsePipeline("limit 5 | frobnicate x");
+    ASSERT_FALSE(unknown.has_value());
+    EXPECT_EQ(unknown.error().code, DiagnosticCode::UnknownNodeType);
+    EXPECT_EQ(unknown.error().position, 10u);
+    EXPECT_EQ(unknown.error().length, 10u);
+
+    EXPECT_EQ(tryParsePipeline("limit 5 |").error().code, DiagnosticCode::EmptyStage);
+}
+
+TEST(ParseDiagnosticsTest, PipelineSplitsOnlyOnTopLevelBars) {
+    auto stages = tryParsePipeline(R"(match name == "a|b" | set_metadata s:coalesce(t, "\"|") | limit 2)");
+    ASSERT_TRUE(stages.has_value());
+    ASSERT_EQ(stages->size(), 3u);
+    EXPECT_EQ(std::get<MatchParams>((*stages)[0]->astParams()).predicate, R"(name == "a|b")");
+    EXPECT_EQ(std::get<SetMetadataParams>((*stages)[1]->astParams()).expression, R"(coalesce(t, "\"|"))");
+
+    // Positions after a quoted bar still index into the whole text
+    std::string_view text = R"(match name == "x|y" | frobnicate)";
+    auto unknown = tryParsePipeline(text);
+    ASSERT_FALSE(unknown.has_value());
+    EXPECT_EQ(unknown.error().code, DiagnosticCode::UnknownNodeType);
+    EXPECT_EQ(unknown.error().position, text.find("frobnicate"));
+    EXPECT_EQ(tryParsePipeline(R"(match name == "a|b" |)").error().code, DiagnosticCode::EmptyStage);
+}
+
+TEST(ParseDiagnosticsTest, PipelineAndTransformSucceedWithoutThrowing) {
+    auto stages = tryParsePipeline("set_metadata score:sum(a, b) | sort score:desc | limit 10");
+    ASSERT_TRUE(stages.has_value());
+    ASSERT_EQ(stages->size(), 3u);
+    for (const auto& stage : *stages) {
+        auto astNode = tryParseToAst(*stage);
+        ASSERT_TRUE(astNode.has_value());
+        EXPECT_NE(*astNode, nullptr);
+    }
+}
+
+TEST(ParseDiagnosticsTest, FormatPointsAtTheError) {
+    std::string text = "limit 1O";
+    auto result = tryParsePipeline(text);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(formatDiagnostic(result.error(), text),
+              "unexpected character at position 7\n  limit 1O\n         ^");
+}
@@ -0,0 +1,105 @@
+#include "plan_cache.h"
+#include "params_codec.h"
+#include "parse_node.h"
+#include "logical_node.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+static std::string tempCachePath(const std::string& name) {
+    return ::testing::TempDir() + "/" + name + "." + std::to_string(getpid());
+}
+
+TEST(ParamsCodecTest, RoundTripsEveryNodeType) {
+    SortParams sort;
+    sort.sortKeys = {"country", "score"};
+    sort.ascending = false;
+    GroupParams group;
+    group.groupKeys = {"country"};
+    group.aggregates = {AggregateSpec{"total", AggregateOp::Sum, "score * 2"}};
+    WindowParams window;
+    window.partitionKeys = {"country"};
+    window.orderKeys = {"ts"};
+    window.functions = {WindowFunctionSpec{"moving", WindowOp::Avg, "score", false, false, -2, 0}};
+    for (AstParams params : {AstParams{LimitParams{42}}, AstParams{sort},
+                             AstParams{SetMetadataParams{"score", "sum(a, b)"}}, AstParams{group},
+                             AstParams{MatchParams{"score > 10"}}, AstParams{ProjectParams{{"a", "b"}, true}},
+                             AstParams{JoinParams{"users", "user_id", "id"}}, AstParams{window},
+                             AstParams{DistinctParams{{"country", "city"}, "n"}}}) {
+        auto decoded = decodeParams(encodeParams(params));
+        ASSERT_TRUE(decoded.has_value());
+        EXPECT_EQ(encodeParams(*decoded), encodeParams(params));
+    }
+}
+
+TEST(ParamsCodecTest, RejectsTruncatedInput) {
+    std::string bytes = encodeParams(SetMetadataParams{"score", "sum(a, b)"});
+    EXPECT_FALSE(decodeParams(bytes.substr(0, bytes.size() - 1)).has_value());
+    EXPECT_FALSE(decodeParams("").has_value());
+}
+
+TEST(PlanCacheTest, PersistedPlansSurviveRestart) {
+    std::string path = tempCachePath("plan_cache_restart");
+    auto parseNode = createParseNodeFromInput("limit", "25");
+    {
+        PlanCache cache(path);
+        auto plan = cache.plan(*parseNode);
+        EXPECT_EQ(plan->debugName(), "LimitLogicalNode");
+        EXPECT_EQ(cache.misses(), 1u);
+        ASSERT_TRUE(cache.persist());
+    }
+    {
+        // A "fresh worker" serves the shape from the mapped file
+        PlanCache cache(path);
+        EXPECT_EQ(cache.size(), 1u);
+        auto plan = cache.plan(*parseNode);
+        EXPECT_EQ(cache.hits(), 1u);
+        EXPECT_EQ(cache.misses(), 0u);
+        EXPECT_NE(plan->explain().find("Row Limit: 25"), std::string::npos);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(PlanCacheTest, SameShapeDifferentParamsDoNotCollide) {
+    std::string path = tempCachePath("plan_cache_params");
+    PlanCache cache(path);
+    cache.plan(*createParseNodeFromInput("limit", "10"));
+    auto plan = cache.plan(*createParseNodeFromInput("limit", "20"));
+    EXPECT_EQ(cache.hits(), 0u);
+    EXPECT_NE(plan->explain().find("Row Limit: 20"), std::string::npos);
+}
+
+TEST(PlanCacheTest, IgnoresCacheFromAnotherBuild) {
+    std::string path = tempCachePath("plan_cache_build");
+    auto parseNode = createParseNodeFromInput("set_metadata", "score:sum(a, b)");
+    {
+        PlanCache cache(path, /*buildId=*/1);
+        cache.plan(*parseNode);
+        ASSERT_TRUE(cache.persist());
+    }
+    PlanCache cache(path, /*buildId=*/2);
+    EXPECT_EQ(cache.size(), 0u);
+    cache.plan(*parseNode);
+    EXPECT_EQ(cache.hits(), 0u);
+    std::remove(path.c_str());
+}
+
+TEST(PlanCacheTest, PersistsNothingWithoutABuildId) {
+    std::string path = tempCachePath("plan_cache_no_build");
+    auto parseNode = createParseNodeFromInput("limit", "5");
+    {
+        PlanCache cache(path, /*buildId=*/1);
+        cache.plan(*parseNode);
+        ASSERT_TRUE(cache.persist());
+    }
+    // Plans still come from memory, but no file is trusted or written
+    PlanCache cache(path, /*buildId=*/0);
+    EXPECT_EQ(cache.size(), 0u);
+    cache.plan(*parseNode);
+    cache.plan(*parseNode);
+    EXPECT_EQ(cache.hits(), 1u);
+    EXPECT_FALSE(cache.persist());
+    EXPECT_NE(planCacheBuildId(), 0u);  // The build always sets one
+    std::remove(path.c_str());
+}
@@ -0,0 +1,99 @@
+#include "batch.h"
+#include "catalog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "src/logical_nodes/project_logical_node.h"
+#include "src/parse_nodes/project_node.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+Batch wideBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"score", PhysicalType::Int64},
+                                       {"payload", PhysicalType::String},
+                                       {"price", PhysicalType::Double},
+                                       {"country", PhysicalType::String}});
+    batch.columns = {Column::ofInts({3, 1, 2}), Column::ofStrings({"x", "y", "z"}),
+                     Column::ofDoubles({1.5, 2.5, 3.5}), Column::ofStrings({"us", "de", "fr"})};
+    return batch;
+}
+
+std::vector<std::string> stageNames(const Pipeline& pipeline) {
+    std::vector<std::string> names;
+    for (const auto& stage : pipeline.stages) names.push_back(stage->debugName());
+    return names;
+}
+
+std::vector<std::string> fieldNames(const Schema& schema) {
+    std::vector<std::string> names;
+    for (const auto& field : schema.fields) names.push_back(field.name);
+    return names;
+}
+
+} // namespace
+
+TEST(ProjectTest, KeepsListedFieldsInOrder) {
+    auto node = ProjectNode::tryParse("country, score,score");
+    ASSERT_TRUE(node.has_value());
+    EXPECT_EQ(node->fields, (std::vector<std::string>{"country", "score", "score"}));
+    EXPECT_EQ(ProjectNode::tryParse("a,,b").error().code, DiagnosticCode::ExpectedFieldName);
+    EXPECT_EQ(ProjectNode::tryParse("a b").error().code, DiagnosticCode::UnexpectedCharacter);
+
+    Catalog catalog;
+    Batch batch = wideBatch(catalog);
+    auto pipeline = tryBuildPipeline("project country, score, score", catalog);
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    ASSERT_TRUE(output.has_value());
+    EXPECT_EQ(fieldNames(*output), (std::vector<std::string>{"country", "score", "score"}));
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(batch.columns[0].strings, (std::vector<std::string>{"us", "de", "fr"}));
+    EXPECT_EQ(batch.columns[2].ints, (std::vector<int64_t>{3, 1, 2}));
+
+    auto missing = tryBuildPipeline("project nope", catalog);
+    EXPECT_EQ(bindPipeline(*missing, batch.schema, catalog.symbols).error().code, DiagnosticCode::UnknownField);
+}
+
+TEST(ProjectTest, PruningProjectsTheSourceAndDropsDeadStages) {
+    Catalog catalog;
+    auto pipeline = tryBuildPipeline(
+        "set_metadata bonus:score * 2 | set_metadata unused:price + 1 | sort country | project country, bonus",
+        catalog);
+    ASSERT_TRUE(pipeline.has_value());
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_EQ(stageNames(*pipeline), (std::vector<std::string>{"ProjectLogicalNode", "SetMetadataLogicalNode",
+                                                               "SortLogicalNode", "ProjectLogicalNode"}));
+    auto& source = dynamic_cast<ProjectLogicalNode&>(*pipeline->stages[0]);
+    EXPECT_TRUE(source.params.inputOrder);
+
+    Batch batch = wideBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    EXPECT_EQ(fieldNames(source.outputSchema), (std::vector<std::string>{"score", "country"}));
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(fieldNames(batch.schema), (std::vector<std::string>{"country", "bonus"}));
+    EXPECT_EQ(batch.columns[0].strings, (std::vector<std::string>{"de", "fr", "us"}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{2, 4, 6}));
+}
+
+TEST(ProjectTest, PruningNeedsADefinedOutput) {
+    Catalog catalog;
+    auto open = tryBuildPipeline("set_metadata unused:price + 1 | sort country", catalog);
+    optimizePipeline(*open, catalog);
+    EXPECT_EQ(stageNames(*open), (std::vector<std::string>{"SetMetadataLogicalNode", "SortLogicalNode"}));
+
+    // A keyless count reads no field, but the sort still needs its key
+    auto counted = tryBuildPipeline("sort price | group ; n:count()", catalog);
+    optimizePipeline(*counted, catalog);
+    ASSERT_EQ(counted->stages.size(), 3u);
+    EXPECT_EQ(dynamic_cast<ProjectLogicalNode&>(*counted->stages[0]).params.fields,
+              (std::vector<std::string>{"price"}));
+    Batch batch = wideBatch(catalog);
+    ASSERT_TRUE(bindPipeline(*counted, batch.schema, catalog.symbols).has_value());
+    executePipeline(*counted, batch);
+    EXPECT_EQ(batch.columns[0].ints, (std::vector<int64_t>{3}));
+
+    auto narrowed = tryBuildPipeline("project score, price, country | limit 2 | project price", catalog);
+    optimizePipeline(*narrowed, catalog);
+    EXPECT_EQ(dynamic_cast<ProjectLogicalNode&>(*narrowed->stages[0]).params.fields,
+              (std::vector<std::string>{"price"}));
+}
@@ -0,0 +1,277 @@
+#include "admission_control.h"
+#include "batch.h"
+#include "catalog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "query_cost.h"
+#include "query_server.h"
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// id: r   a: r % 13   b: r * 7919 % 10007   kind: one of 5 strings
+std::shared_ptr<const Batch> events(Catalog& catalog, size_t rows) {
+    auto batch = std::make_shared<Batch>();
+    batch->schema = catalog.makeSchema({{"id", PhysicalType::Int64},
+                                        {"a", PhysicalType::Int64},
+                                        {"b", PhysicalType::Int64},
+                                        {"kind", PhysicalType::String}});
+    std::vector<int64_t> id(rows), a(rows), b(rows);
+    std::vector<std::string> kind(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        id[r] = static_cast<int64_t>(r);
+        a[r] = static_cast<int64_t>(r % 13);
+        b[r] = static_cast<int64_t>(r * 7919 % 10007);
+        kind[r] = "kind" + std::to_string(r % 5);
+    }
+    batch->columns = {Column::ofInts(std::move(id)), Column::ofInts(std::move(a)), Column::ofInts(std::move(b)),
+                      Column::dictionaryEncode(kind)};
+    return batch;
+}
+
+Pipeline build(const std::string& text, const Batch& input, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    return std::move(*pipeline);
+}
+
+QueryCost costOf(size_t memoryBytes, size_t minMemoryBytes, uint32_t threads, double work = 1) {
+    QueryCost cost;
+    cost.memoryBytes = memoryBytes;
+    cost.minMemoryBytes = minMemoryBytes;
+    cost.threads = threads;
+    cost.work = work;
+    return cost;
+}
+
+class Client {
+public:
+    explicit Client(const std::string& path) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        connected = ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    ~Client() { ::close(fd); }
+
+    // The status line, then the header and row lines when it has any
+    std::vector<std::string> request(const std::string& line) {
+        std::string out = line + "\n";
+        EXPECT_EQ(::send(fd, out.data(), out.size(), MSG_NOSIGNAL), static_cast<ssize_t>(out.size()));
+        std::vector<std::string> lines = {readLine()};
+        if (lines[0].starts_with("ok ") || lines[0].starts_with("degraded ")) {
+            size_t rows = std::stoul(lines[0].substr(lines[0].find(' ') + 1));
+            for (size_t i = 0; i <= rows; ++i) lines.push_back(readLine());
+        }
+        return lines;
+    }
+
+    // The server hung up
+    bool closed() {
+        char byte;
+        return ::recv(fd, &byte, 1, 0) == 0;
+    }
+
+    std::string readLine() {
+        size_t newline;
+        while ((newline = buffer.find('\n')) == std::string::npos) {
+            char chunk[4096];
+            ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) return "";
+            buffer.append(chunk, static_cast<size_t>(received));
+        }
+        std::string line = buffer.substr(0, newline);
+        buffer.erase(0, newline + 1);
+        return line;
+    }
+
+    bool connected = false;
+
+private:
+    int fd = -1;
+    std::string buffer;
+};
+
+} // namespace
+
+TEST(QueryServerTest, CostsFollowTheStagesAndDegradingKeepsResults) {
+    Catalog catalog;
+    auto input = events(catalog, 100000);
+    QueryCost scan = estimatePipelineCost(build("match a > 2", *input, catalog), *input);
+    QueryCost sort = estimatePipelineCost(build("match a > 2 | sort b", *input, catalog), *input);
+    QueryCost limited = estimatePipelineCost(build("limit 10 | sort b", *input, catalog), *input);
+    EXPECT_GE(scan.memoryBytes, input->byteSize());
+    EXPECT_GT(sort.work, 10 * scan.work);
+    EXPECT_GT(sort.memoryBytes, scan.memoryBytes);
+    EXPECT_LT(limited.work, scan.work);
+
+    // Groups are the stage that can shrink: they spill and run on one thread
+    Pipeline group = build("group kind; n:count(), s:sum(b)", *input, catalog);
+    QueryCost full = estimatePipelineCost(group, *input);
+    EXPECT_LT(full.minMemoryBytes, full.memoryBytes);
+    Batch expected = *input;
+    executePipeline(group, expected);
+
+    QueryCost degraded = degradePipeline(group, *input, full.minMemoryBytes);
+    EXPECT_EQ(degraded.threads, 1u);
+    EXPECT_LE(degraded.memoryBytes, full.minMemoryBytes);
+    Batch batch = *input;
+    executePipeline(group, batch);
+    ASSERT_EQ(batch.rowCount(), expected.rowCount());
+    for (size_t c = 0; c < expected.columns.size(); ++c) {
+        EXPECT_EQ(batch.columns[c].decoded().ints, expected.columns[c].decoded().ints);
+    }
+}
+
+TEST(QueryServerTest, AdmissionRunsDegradesQueuesAndRejects) {
+    AdmissionOptions options;
+    options.memoryBytes = 1000;
+    options.threads = 4;
+    options.maxWork = 100;
+    options.maxQueued = 1;
+    options.maxQueueWait = std::chrono::seconds(30);
+    AdmissionController admission(options);
+
+    QueryCost big = costOf(600, 300, 2);
+    EXPECT_EQ(admission.admit(big).decision, AdmissionDecision::Run);
+    ASSERT_TRUE(admission.acquire(big).has_value());
+
+    // Busy: the degraded footprint fits in what is left
+    Admission busy = admission.admit(big);
+    EXPECT_EQ(busy.decision, AdmissionDecision::Degrade);
+    EXPECT_EQ(busy.cost.memoryBytes, 400u);
+    EXPECT_EQ(busy.cost.threads, 1u);
+
+    // No smaller footprint: wait, in arrival order, behind a bounded queue
+    QueryCost rigid = costOf(600, 600, 1);
+    EXPECT_EQ(admission.admit(rigid).decision, AdmissionDecision::Queue);
+    std::thread waiter([&] {
+        EXPECT_TRUE(admission.acquire(rigid).has_value());
+        admission.release(rigid);
+    });
+    while (admission.queued() == 0) std::this_thread::yield();
+    EXPECT_EQ(admission.admit(rigid).decision, AdmissionDecision::Reject);
+    EXPECT_EQ(admission.acquire(costOf(10, 10, 1)).error(), "the queue is full");
+    admission.release(big);
+    waiter.join();
+    EXPECT_EQ(admission.running(), 0u);
+    EXPECT_EQ(admission.memoryInUse(), 0u);
+
+    // Never fits: degraded to the whole budget when it can be, rejected otherwise
+    Admission huge = admission.admit(costOf(5000, 800, 8));
+    EXPECT_EQ(huge.decision, AdmissionDecision::Degrade);
+    EXPECT_EQ(huge.cost.memoryBytes, 1000u);
+    EXPECT_EQ(admission.admit(costOf(5000, 2000, 1)).decision, AdmissionDecision::Reject);
+    EXPECT_EQ(admission.admit(costOf(10, 10, 1, 1000)).decision, AdmissionDecision::Reject);
+
+    // A bounded wait
+    options.maxQueueWait = std::chrono::milliseconds(20);
+    AdmissionController impatient(options);
+    ASSERT_TRUE(impatient.acquire(rigid).has_value());
+    auto timedOut = impatient.acquire(rigid);
+    ASSERT_FALSE(timedOut.has_value());
+    EXPECT_NE(timedOut.error().find("waited 20 ms"), std::string::npos);
+    EXPECT_EQ(impatient.queued(), 0u);
+}
+
+TEST(QueryServerTest, ServesConcurrentClientsOverAUnixSocket) {
+    Catalog catalog;
+    auto input = events(catalog, 100000);
+    catalog.addTable("events", input);
+    QueryServerOptions options;
+    // Enough for one sort at a time, or a group once it spills early
+    options.admission.memoryBytes =
+        estimatePipelineCost(build("group kind; n:count()", *input, catalog), *input).minMemoryBytes;
+    options.admission.maxWork = 5e6;
+    options.admission.maxQueueWait = std::chrono::seconds(60);
+    options.workers = 2;
+    QueryServer server(catalog, options);
+    std::string path = "/tmp/toy_query_server_" + std::to_string(::getpid()) + ".sock";
+    ASSERT_TRUE(server.listen(path));
+
+    // Top b values among rows with a > 2
+    std::vector<int64_t> top;
+    for (size_t r = 0; r < input->rowCount(); ++r) {
+        if (input->columns[1].ints[r] > 2) top.push_back(input->columns[2].ints[r]);
+    }
+    std::sort(top.rbegin(), top.rend());
+
+    constexpr int kClients = 6;
+    std::vector<std::thread> clients;
+    for (int c = 0; c < kClients; ++c) {
+        clients.emplace_back([&, c] {
+            Client client(path);
+            ASSERT_TRUE(client.connected);
+            for (int q = 0; q < 4; ++q) {
+                size_t k = 1 + (c + q) % 3;
+                auto lines = client.request("events match a > 2 | sort b:desc | limit " + std::to_string(k));
+                ASSERT_EQ(lines[0], "ok " + std::to_string(k) + " 4");
+                EXPECT_EQ(lines[1], "id\ta\tb\tkind");
+                for (size_t row = 0; row < k; ++row) {
+                    std::string line = lines[2 + row];
+                    size_t b = line.find('\t', line.find('\t') + 1) + 1;
+                    EXPECT_EQ(std::stoll(line.substr(b)), top[row]) << line;
+                }
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+
+    Client client(path);
+    auto grouped = client.request("events group kind; n:count()");
+    ASSERT_TRUE(grouped[0].starts_with("degraded 5 2 ")) << grouped[0];
+    EXPECT_EQ(grouped[1], "kind\tn");
+    EXPECT_EQ(grouped[2], "kind0\t20000");
+    EXPECT_TRUE(client.request("events sort b | sort a | sort b | sort a")[0].starts_with("rejected estimated"));
+    EXPECT_EQ(client.request("nowhere limit 1")[0], "error unknown table nowhere");
+    EXPECT_TRUE(client.request("events sort nope")[0].starts_with("error "));
+    EXPECT_EQ(client.request("events")[0], "error expected \"<table> <pipeline>\" or \"stats\"");
+
+    auto stats = client.request("stats");
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[1], "running\tqueued\tcompleted\tdegraded\trejected\tfailed\tmemory_bytes");
+    EXPECT_EQ(stats[2], "0\t0\t" + std::to_string(kClients * 4) + "\t1\t1\t2\t0");
+    EXPECT_EQ(server.completed(), size_t{kClients * 4});
+
+    // Stopping closes open connections and removes the socket
+    server.stop();
+    EXPECT_TRUE(client.closed());
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+}
+
+TEST(QueryServerTest, TurnsAwayConnectionsOverTheLimit) {
+    Catalog catalog;
+    catalog.addTable("events", events(catalog, 100));
+    QueryServerOptions options;
+    options.maxConnections = 1;
+    options.workers = 1;
+    QueryServer server(catalog, options);
+    std::string path = "/tmp/toy_query_server_limit_" + std::to_string(::getpid()) + ".sock";
+    ASSERT_TRUE(server.listen(path));
+
+    {
+        Client first(path);
+        ASSERT_EQ(first.request("stats")[0], "ok 1 7");  // Served, so it holds the one slot
+        Client second(path);
+        ASSERT_TRUE(second.connected);
+        EXPECT_EQ(second.readLine(), "rejected too many connections");
+        EXPECT_TRUE(second.closed());
+        EXPECT_EQ(first.request("events limit 1")[0], "ok 1 4");
+    }
+    EXPECT_EQ(server.rejected(), 1u);
+
+    // The slot frees up once the first client hangs up
+    while (server.connections() > 0) std::this_thread::yield();
+    Client again(path);
+    EXPECT_EQ(again.request("events limit 2")[0], "ok 2 4");
+    server.stop();
+}
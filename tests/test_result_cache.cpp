@@ -0,0 +1,232 @@
+#include "batch.h"
+#include "catalog.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "result_cache.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace {
+
+// a: r % 7   b: r * 31 % 101   name: dictionary of r % 5
+Batch inputBatch(Catalog& catalog, size_t rows) {
+    Batch batch;
+    batch.schema = catalog.makeSchema(
+        {{"a", PhysicalType::Int64}, {"b", PhysicalType::Int64}, {"name", PhysicalType::String}});
+    std::vector<int64_t> a(rows);
+    std::vector<int64_t> b(rows);
+    std::vector<std::string> names(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        a[r] = static_cast<int64_t>(r % 7);
+        b[r] = static_cast<int64_t>(r * 31 % 101);
+        names[r] = "n" + std::to_string(r % 5);
+    }
+    batch.columns = {Column::ofInts(std::move(a)), Column::ofInts(std::move(b)), Column::dictionaryEncode(names)};
+    return batch;
+}
+
+Pipeline build(const std::string& text, const Batch& input, Catalog& catalog, bool optimize = true) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    if (optimize) optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    return std::move(*pipeline);
+}
+
+std::shared_ptr<const Batch> rowsOf(size_t rows) {
+    auto batch = std::make_shared<Batch>();
+    batch->columns = {Column::ofInts(std::vector<int64_t>(rows, 1))};
+    return batch;
+}
+
+} // namespace
+
+TEST(ResultCacheTest, FingerprintsFollowStructure) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 10);
+    Pipeline first = build("sort a,b | limit 5", input, catalog);
+    Pipeline second = build("sort a,b | limit 7", input, catalog);
+    Pipeline unoptimized = build("sort a,b | limit 7", input, catalog, false);
+    EXPECT_NE(subplanFingerprint(first, 1), 0u);
+    EXPECT_EQ(subplanFingerprint(first, 1), subplanFingerprint(second, 1));
+    EXPECT_NE(subplanFingerprint(first, 2), subplanFingerprint(second, 2));
+    EXPECT_EQ(subplanFingerprint(second, 2), subplanFingerprint(unoptimized, 2));
+    EXPECT_NE(subplanFingerprint(build("sort a,b:desc | limit 5", input, catalog), 1), subplanFingerprint(first, 1));
+    EXPECT_NE(subplanFingerprint(build("sort b,a | limit 5", input, catalog), 1), subplanFingerprint(first, 1));
+
+    // A fused top-k and a join depend on what they absorb and read
+    Pipeline topK = build("set_metadata s:a * 2 | sort s | limit 3", input, catalog);
+    ASSERT_EQ(topK.stages.size(), 1u);
+    EXPECT_NE(subplanFingerprint(topK, 1), 0u);
+    EXPECT_NE(subplanFingerprint(topK, 1), subplanFingerprint(build("set_metadata s:a * 3 | sort s | limit 3", input,
+                                                                     catalog), 1));
+
+    auto table = std::make_shared<Batch>();
+    table->schema = catalog.makeSchema({{"key", PhysicalType::Int64}, {"label", PhysicalType::Int64}});
+    table->columns = {Column::ofInts({0, 1, 2}), Column::ofInts({10, 11, 12})};
+    catalog.addTable("labels", table);
+    uint64_t joined = subplanFingerprint(build("join labels on a = key", input, catalog), 1);
+    EXPECT_EQ(joined, subplanFingerprint(build("join labels on a = key", input, catalog), 1));
+    catalog.addTable("labels", table);
+    EXPECT_NE(joined, subplanFingerprint(build("join labels on a = key", input, catalog), 1));
+}
+
+TEST(ResultCacheTest, EvictsByCostPerByteAndFrequency) {
+    ResultCache cache(1000 * sizeof(int64_t));
+    ASSERT_TRUE(cache.insert(1, 0, rowsOf(400), 4.0));   // 0.01 per 8 bytes
+    ASSERT_TRUE(cache.insert(2, 0, rowsOf(400), 0.4));   // Cheap for its size
+    ASSERT_TRUE(cache.insert(3, 0, rowsOf(100), 0.4));   // Cheap but small
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_EQ(cache.bytes(), 900 * sizeof(int64_t));
+
+    ASSERT_TRUE(cache.insert(4, 0, rowsOf(300), 1.0));
+    EXPECT_FALSE(cache.lookup(2, 0).has_value());
+    EXPECT_TRUE(cache.lookup(1, 0).has_value());
+    EXPECT_TRUE(cache.lookup(3, 0).has_value());
+    EXPECT_EQ(cache.evictions(), 1u);
+
+    // Hits raise an entry's priority; the clock ages the rest
+    for (int i = 0; i < 10; ++i) cache.lookup(3, 0);
+    ASSERT_TRUE(cache.insert(5, 0, rowsOf(500), 100.0));
+    EXPECT_TRUE(cache.lookup(3, 0).has_value());
+    EXPECT_TRUE(cache.lookup(5, 0).has_value());
+    EXPECT_LE(cache.bytes(), cache.capacity());
+
+    EXPECT_FALSE(cache.insert(6, 0, rowsOf(2000), 1e9));  // Larger than the cache
+    EXPECT_FALSE(cache.lookup(5, 1).has_value());         // Other input version
+    cache.invalidate(0);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.bytes(), 0u);
+}
+
+TEST(ResultCacheTest, PipelinesResumeFromCachedPrefixes) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 3000);
+    ResultCache cache(64 << 20);
+    cache.minStageCost = 0;
+
+    auto runCached = [&](const std::string& text, uint64_t version) {
+        Pipeline pipeline = build(text, input, catalog);
+        Batch batch = input;
+        executePipelineCached(pipeline, batch, version, cache);
+        return batch;
+    };
+    auto runPlain = [&](const std::string& text) {
+        Pipeline pipeline = build(text, input, catalog);
+        Batch batch = input;
+        executePipeline(pipeline, batch);
+        return batch;
+    };
+    auto expectSame = [](const Batch& actual, const Batch& expected) {
+        ASSERT_EQ(actual.rowCount(), expected.rowCount());
+        for (size_t c = 0; c < actual.columns.size(); ++c) {
+            Column a = actual.columns[c].decoded();
+            Column b = expected.columns[c].decoded();
+            EXPECT_EQ(a.ints, b.ints) << c;
+            EXPECT_EQ(a.strings, b.strings) << c;
+        }
+    };
+
+    expectSame(runCached("sort a,b:desc | limit 10", 1), runPlain("sort a,b:desc | limit 10"));
+    EXPECT_EQ(cache.hits(), 0u);
+    EXPECT_EQ(cache.size(), 3u);  // Sorted, its first 10 rows, limited
+
+    // Same sort, other limit: resumes after the sort
+    expectSame(runCached("sort a,b:desc | limit 25", 1), runPlain("sort a,b:desc | limit 25"));
+    EXPECT_EQ(cache.hits(), 1u);
+
+    // The whole pipeline again is a single hit
+    size_t misses = cache.misses();
+    expectSame(runCached("sort a,b:desc | limit 25", 1), runPlain("sort a,b:desc | limit 25"));
+    EXPECT_EQ(cache.hits(), 2u);
+    EXPECT_EQ(cache.misses(), misses);
+
+    // Deeper pipelines reuse the shared prefix too
+    expectSame(runCached("sort a,b:desc | set_metadata c:a + b", 1), runPlain("sort a,b:desc | set_metadata c:a + b"));
+    EXPECT_EQ(cache.hits(), 3u);
+
+    // A new input version recomputes
+    runCached("sort a,b:desc | limit 25", 2);
+    EXPECT_EQ(cache.hits(), 3u);
+    cache.invalidate(1);
+    runCached("sort a,b:desc | limit 25", 1);
+    EXPECT_EQ(cache.hits(), 3u);
+}
+
+TEST(ResultCacheTest, LimitsReadFromTopNWindows) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 3000);
+    ResultCache cache(64 << 20);
+    cache.minStageCost = 0;
+
+    auto run = [&](const std::string& text, ResultCache* cached, bool optimize = true) {
+        Pipeline pipeline = build(text, input, catalog, optimize);
+        Batch batch = input;
+        if (cached) {
+            executePipelineCached(pipeline, batch, 1, *cached);
+        } else {
+            executePipeline(pipeline, batch);
+        }
+        return batch;
+    };
+    auto expectSame = [](const Batch& actual, const Batch& expected) {
+        ASSERT_EQ(actual.rowCount(), expected.rowCount());
+        for (size_t c = 0; c < actual.columns.size(); ++c) {
+            Column a = actual.columns[c].decoded();
+            Column b = expected.columns[c].decoded();
+            EXPECT_EQ(a.ints, b.ints) << c;
+            EXPECT_EQ(a.doubles, b.doubles) << c;
+            EXPECT_EQ(a.strings, b.strings) << c;
+        }
+    };
+
+    // Offsets on their own, and fused into a top-k
+    Batch paged = run("sort b | limit 20 offset 40", nullptr);
+    Batch page = run("sort b | limit 60", nullptr);
+    ASSERT_EQ(paged.rowCount(), 20u);
+    EXPECT_EQ(paged.columns[1].ints, std::vector<int64_t>(page.columns[1].ints.begin() + 40, page.columns[1].ints.end()));
+    EXPECT_EQ(run("sort b | limit 5 offset 2999", nullptr).rowCount(), 1u);
+    EXPECT_EQ(run("sort b | limit 5 offset 4000", nullptr).rowCount(), 0u);
+    for (const char* text : {"set_metadata s:b * 3 | sort s:desc | limit 20 offset 40",
+                             "set_metadata s:b * 3 | sort s | limit 7 offset 2995"}) {
+        expectSame(run(text, nullptr), run(text, nullptr, false));
+    }
+
+    // A wide window answers narrower limits and pages over the same sort
+    run("sort a,b:desc | limit 1000", &cache);
+    size_t sortHits = cache.hits();
+    for (const char* text : {"sort a,b:desc | limit 50", "sort a,b:desc | limit 20 offset 40",
+                             "sort a,b:desc | limit 1 offset 999"}) {
+        size_t entries = cache.size();
+        size_t hits = cache.hits();
+        expectSame(run(text, &cache), run(text, nullptr));
+        EXPECT_EQ(cache.hits(), hits + 1) << text;
+        EXPECT_EQ(cache.size(), entries) << text;  // Nothing left to run or cache
+    }
+    EXPECT_EQ(cache.hits(), sortHits + 3);
+
+    // Past the window needs the sorted rows, which then leave a wider window
+    expectSame(run("sort a,b:desc | limit 10 offset 995", &cache), run("sort a,b:desc | limit 10 offset 995", nullptr));
+    expectSame(run("sort a,b:desc | limit 1005", &cache), run("sort a,b:desc | limit 1005", nullptr));
+    size_t hits = cache.hits();
+    size_t misses = cache.misses();
+    run("sort a,b:desc | limit 3 offset 1001", &cache);
+    EXPECT_EQ(cache.hits(), hits + 1);
+    EXPECT_EQ(cache.misses(), misses + 1);  // The full result of this limit
+
+    // A window shorter than it asked for holds every row, so any limit fits
+    run("sort b | match a == 3 | limit 1000", &cache);
+    hits = cache.hits();
+    expectSame(run("sort b | match a == 3 | limit 2000", &cache), run("sort b | match a == 3 | limit 2000", nullptr));
+    EXPECT_EQ(cache.hits(), hits + 1);
+
+    // A fused top-k leaves a window for the unfused score and sort, and reads
+    // one; unoptimized, the score is spelled the way the optimizer prints it
+    run("set_metadata s:a * b | sort s:desc | limit 100", &cache);
+    hits = cache.hits();
+    expectSame(run("set_metadata s:a * b | sort s:desc | limit 10 offset 30", &cache),
+               run("set_metadata s:a * b | sort s:desc | limit 10 offset 30", nullptr, false));
+    expectSame(run("set_metadata s:(a * b) | sort s:desc | limit 60", &cache, false),
+               run("set_metadata s:a * b | sort s:desc | limit 60", nullptr, false));
+    EXPECT_EQ(cache.hits(), hits + 2);
+}
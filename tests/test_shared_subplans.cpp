@@ -0,0 +1,203 @@
+#include "batch.h"
+#include "catalog.h"
+#include "metadata_store.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "shared_subplans.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// a: r % 13   b: r * 7919 % 10007
+Batch inputBatch(Catalog& catalog, size_t rows) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"a", PhysicalType::Int64}, {"b", PhysicalType::Int64}});
+    std::vector<int64_t> a(rows), b(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        a[r] = static_cast<int64_t>(r % 13);
+        b[r] = static_cast<int64_t>(r * 7919 % 10007);
+    }
+    batch.columns = {Column::ofInts(std::move(a)), Column::ofInts(std::move(b))};
+    return batch;
+}
+
+Pipeline build(const std::string& text, const Batch& input, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    return std::move(*pipeline);
+}
+
+Batch single(size_t rows) {
+    Batch batch;
+    batch.columns = {Column::ofInts(std::vector<int64_t>(rows, 1))};
+    return batch;
+}
+
+} // namespace
+
+TEST(SharedSubplansTest, FollowersWaitForOneComputation) {
+    SharedSubplans subplans;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> computed{0};
+    auto compute = [&] {
+        ++computed;
+        released.wait();
+        return single(5);
+    };
+
+    constexpr int kQueries = 6;
+    std::vector<std::future<std::shared_ptr<const Batch>>> results;
+    results.push_back(std::async(std::launch::async, [&] { return subplans.share(1, 1, compute); }));
+    while (subplans.leaders() == 0) std::this_thread::yield();
+    for (int i = 1; i < kQueries; ++i) {
+        results.push_back(std::async(std::launch::async, [&] { return subplans.share(1, 1, compute); }));
+    }
+    // join() subscribes without ever computing
+    EXPECT_TRUE(subplans.computing(1, 1));
+    EXPECT_EQ(subplans.join(1, 3), nullptr);
+    results.push_back(std::async(std::launch::async, [&] { return subplans.join(1, 1); }));
+    while (subplans.waiting() < kQueries) std::this_thread::yield();
+    // Another input version is its own flight
+    EXPECT_EQ(subplans.share(1, 2, [] { return single(2); })->rowCount(), 2u);
+    release.set_value();
+
+    auto first = results.front().get();
+    for (auto& result : results) {
+        if (result.valid()) {
+            EXPECT_EQ(result.get(), first);
+        }
+    }
+    EXPECT_EQ(computed.load(), 1);
+    EXPECT_EQ(subplans.leaders(), 2u);
+    EXPECT_EQ(subplans.followers(), size_t{kQueries});
+    EXPECT_FALSE(subplans.computing(1, 1));
+
+    // Nothing is kept once it landed
+    EXPECT_NE(subplans.share(1, 1, [] { return single(5); }), first);
+
+    // A failed leader hands its followers back their own computation
+    std::promise<void> fail;
+    std::shared_future<void> failing = fail.get_future().share();
+    auto leader = std::async(std::launch::async, [&] {
+        return subplans.share(3, 1, [&]() -> Batch {
+            failing.wait();
+            throw std::runtime_error("scan failed");
+        });
+    });
+    while (subplans.leaders() < 4) std::this_thread::yield();
+    auto follower = std::async(std::launch::async, [&] { return subplans.share(3, 1, [] { return single(3); }); });
+    while (subplans.waiting() < 1) std::this_thread::yield();
+    fail.set_value();
+    EXPECT_THROW(leader.get(), std::runtime_error);
+    EXPECT_EQ(follower.get()->rowCount(), 3u);
+}
+
+TEST(SharedSubplansTest, PrefixStopsAtTheLastSortBeforeALimit) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 10);
+    EXPECT_EQ(sharedPrefixLength(build("match a > 2 | sort b:desc | limit 5", input, catalog)), 2u);
+    EXPECT_EQ(sharedPrefixLength(build("sort b | limit 5 | sort a", input, catalog)), 1u);
+    EXPECT_EQ(sharedPrefixLength(build("match a > 2 | set_metadata c:a + 1", input, catalog)), 1u);
+    EXPECT_EQ(sharedPrefixLength(build("limit 5 | sort b", input, catalog)), 0u);
+    // Fused into a top-k: nothing left to share ahead of the limit
+    EXPECT_EQ(sharedPrefixLength(build("set_metadata s:a * b | sort s | limit 5", input, catalog)), 0u);
+}
+
+TEST(SharedSubplansTest, ConcurrentDashboardQueriesMatchIndependentRuns) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 200000);
+    SharedSubplans subplans;
+    std::vector<std::string> texts;
+    for (int i = 0; i < 20; ++i) {
+        texts.push_back("match a > 2 | sort b:desc | limit " + std::to_string(5 + i * 3) +
+                        (i % 3 == 0 ? " offset " + std::to_string(i) : "") + (i % 4 == 1 ? " | sort a" : ""));
+    }
+    texts.push_back("match a > 2 | sort b:desc");
+
+    std::vector<Batch> shared(texts.size());
+    std::vector<std::thread> queries;
+    std::atomic<size_t> ready{0};
+    for (size_t q = 0; q < texts.size(); ++q) {
+        queries.emplace_back([&, q] {
+            Pipeline pipeline = build(texts[q], input, catalog);
+            Batch batch = input;
+            ++ready;
+            while (ready < texts.size()) std::this_thread::yield();
+            executePipelineShared(pipeline, batch, 1, subplans);
+            shared[q] = std::move(batch);
+        });
+    }
+    for (auto& query : queries) query.join();
+    EXPECT_EQ(subplans.leaders() + subplans.followers(), texts.size());
+
+    for (size_t q = 0; q < texts.size(); ++q) {
+        Pipeline pipeline = build(texts[q], input, catalog);
+        Batch expected = input;
+        executePipeline(pipeline, expected);
+        ASSERT_EQ(shared[q].rowCount(), expected.rowCount()) << texts[q];
+        for (size_t c = 0; c < expected.columns.size(); ++c) {
+            EXPECT_EQ(shared[q].columns[c].decoded().ints, expected.columns[c].decoded().ints) << texts[q];
+        }
+    }
+}
+
+TEST(SharedSubplansTest, IdenticalPipelinesSubscribeToTheRunningOne) {
+    Catalog catalog;
+    Batch input = inputBatch(catalog, 1000);
+    SharedSubplans subplans;
+    const std::string text = "match a > 2 | sort b:desc | limit 10";
+    Pipeline running = build(text, input, catalog);
+    uint64_t plan = planFingerprint(running);
+    ASSERT_NE(plan, 0u);
+    EXPECT_EQ(planFingerprint(build(text, input, catalog)), plan);
+    EXPECT_NE(planFingerprint(build("match a > 2 | sort b:desc | limit 11", input, catalog)), plan);
+
+    // Hold the first run open so the identical arrivals find it in flight
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto first = std::async(std::launch::async, [&] {
+        return subplans.share(plan, 1, [&] {
+            released.wait();
+            Batch batch = input;
+            executePipeline(running, batch);
+            return batch;
+        });
+    });
+    while (subplans.leaders() == 0) std::this_thread::yield();
+    constexpr int kArrivals = 4;
+    std::vector<std::future<std::shared_ptr<const Batch>>> arrivals;
+    for (int i = 0; i < kArrivals; ++i) {
+        arrivals.push_back(std::async(std::launch::async, [&] {
+            return executePipelineCoalesced(build(text, input, catalog), input, 1, subplans);
+        }));
+    }
+    while (subplans.waiting() < kArrivals) std::this_thread::yield();
+    release.set_value();
+    auto result = first.get();
+    EXPECT_EQ(result->rowCount(), 10u);
+    for (auto& arrival : arrivals) EXPECT_EQ(arrival.get(), result);
+    EXPECT_EQ(subplans.leaders(), 1u);
+
+    // Alone, a pipeline that is all prefix still runs (and doesn't wait on itself)
+    Pipeline sort = build("match a > 2 | sort b:desc", input, catalog);
+    Batch expected = input;
+    executePipeline(sort, expected);
+    auto sorted = executePipelineCoalesced(sort, input, 1, subplans);
+    EXPECT_EQ(sorted->columns[1].decoded().ints, expected.columns[1].decoded().ints);
+    EXPECT_EQ(subplans.leaders(), 3u);
+
+    // Side effects are never coalesced
+    catalog.metadataStore = std::make_shared<MetadataStore>();
+    catalog.metadataRowIdField = "a";
+    Pipeline sinking = build("set_metadata c:b + 1", input, catalog);
+    EXPECT_EQ(planFingerprint(sinking), 0u);
+    EXPECT_EQ(executePipelineCoalesced(sinking, input, 1, subplans)->rowCount(), 1000u);
+    EXPECT_EQ(subplans.leaders(), 3u);
+}
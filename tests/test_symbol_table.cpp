@@ -0,0 +1,55 @@
+#include "symbol_table.h"
+#include "catalog.h"
+#include "parse_node.h"
+#include "node_transformer.h"
+#include "src/ast_nodes/sort_ast_node.h"
+#include "src/ast_nodes/set_metadata_ast_node.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(SymbolTableTest, InternsToDenseStableIds) {
+    SymbolTable symbols;
+    SymbolId country = symbols.intern("country");
+    SymbolId score = symbols.intern("score");
+    EXPECT_EQ(country, 0u);
+    EXPECT_EQ(score, 1u);
+    EXPECT_EQ(symbols.intern("country"), country);
+    EXPECT_EQ(symbols.name(score), "score");
+    EXPECT_EQ(symbols.find("score"), score);
+    EXPECT_FALSE(symbols.find("missing").has_value());
+    EXPECT_EQ(symbols.size(), 2u);
+}
+
+TEST(SymbolTableTest, ConcurrentInterningAgreesOnIds) {
+    SymbolTable symbols;
+    std::vector<std::vector<SymbolId>> seen(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&symbols, &ids = seen[t]] {
+            for (int i = 0; i < 200; ++i) {
+                ids.push_back(symbols.intern("field" + std::to_string(i % 50)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(symbols.size(), 50u);
+    for (const auto& ids : seen) {
+        EXPECT_EQ(ids, seen[0]);
+    }
+}
+
+TEST(SymbolTableTest, ParseToAstInternsFieldNamesIntoTheCatalog) {
+    Catalog catalog;
+    auto metadata = parseToAst(*createParseNodeFromInput("set_metadata", "score:sum(a, b)"), catalog);
+    auto sort = parseToAst(*createParseNodeFromInput("sort", "country,score:desc"), catalog);
+
+    const auto& sortParams = dynamic_cast<const SortAstNode&>(*sort).params;
+    const auto& metaParams = dynamic_cast<const SetMetadataAstNode&>(*metadata).params;
+    ASSERT_EQ(sortParams.sortKeyIds.size(), 2u);
+    EXPECT_EQ(sortParams.sortKeyIds[0], catalog.symbols.find("country"));
+    // The sort key and the metadata name refer to the same field
+    EXPECT_EQ(sortParams.sortKeyIds[1], metaParams.metaNameId);
+}
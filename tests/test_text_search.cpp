@@ -0,0 +1,168 @@
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "inverted_index.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// id: 0..rows-1   body: random words with a skewed distribution, "needle"
+// every 97th row, null every 11th row
+Batch documentsBatch(Catalog& catalog, size_t rows, bool dictionary = false) {
+    static const char* const kWords[] = {"the",   "query", "engine", "Index",  "vector", "scan",  "join",
+                                         "sort",  "limit", "batch",  "column", "filter", "block", "rank",
+                                         "heap",  "tree",  "graph",  "cache",  "token",  "plan",  "wand"};
+    constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+    std::mt19937 rng(11);
+    std::geometric_distribution<size_t> word(0.15);
+    std::uniform_int_distribution<size_t> length(0, 12);
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"id", PhysicalType::Int64}, {"body", PhysicalType::String}});
+    std::vector<int64_t> ids(rows);
+    std::vector<std::string> bodies(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        ids[r] = static_cast<int64_t>(r);
+        for (size_t n = length(rng); n > 0; --n) {
+            bodies[r] += kWords[std::min(word(rng), kWordCount - 1)];
+            bodies[r] += n % 3 == 0 ? ", " : " ";
+        }
+        if (r % 97 == 5) bodies[r] += "needle";
+    }
+    Column body = dictionary ? Column::dictionaryEncode(bodies) : Column::ofStrings(std::move(bodies));
+    for (size_t r = 0; r < rows; r += 11) body.setValid(r, false);
+    batch.columns = {Column::ofInts(std::move(ids)), std::move(body)};
+    return batch;
+}
+
+Column score(const std::string& text, const Batch& batch, Catalog& catalog, const SelectionVector* rows = nullptr) {
+    auto bound = bindExpression(*parseExpression(text), batch.schema, catalog.symbols);
+    EXPECT_TRUE(bound.has_value()) << text;
+    return evaluateExpression(**bound, batch, rows);
+}
+
+Batch run(const std::string& text, const Batch& input, Catalog& catalog, bool optimize,
+          std::unique_ptr<Pipeline>* kept = nullptr) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    if (optimize) optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    if (kept) *kept = std::make_unique<Pipeline>(std::move(*pipeline));
+    return batch;
+}
+
+} // namespace
+
+TEST(TextSearchTest, TokenizesAndBindsBm25) {
+    EXPECT_EQ(tokenize("Block-max WAND, v2!  café"), (std::vector<std::string>{"block", "max", "wand", "v2", "café"}));
+    EXPECT_TRUE(tokenize(" ,.; ").empty());
+    EXPECT_EQ(queryTerms("sort the SORT index"), (std::vector<std::string>{"index", "sort", "the"}));
+
+    auto parsed = parseExpression("bm25(body, \"query engine\")");
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(toString(**parsed), "bm25(body, \"query engine\")");
+
+    Catalog catalog;
+    Batch batch = documentsBatch(catalog, 4);
+    auto bind = [&](const char* text) { return bindExpression(*parseExpression(text), batch.schema, catalog.symbols); };
+    EXPECT_EQ((*bind("bm25(body, \"scan\") * 2"))->type, PhysicalType::Double);
+    EXPECT_EQ(bind("bm25(body, body)").error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(bind("bm25(\"scan\", body)").error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(bind("bm25(id, \"scan\")").error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(parseExpression("bm25(body)").error().code, DiagnosticCode::WrongArgumentCount);
+}
+
+TEST(TextSearchTest, IndexScoresMatchScan) {
+    Catalog catalog;
+    Batch plain = documentsBatch(catalog, 500);
+    Batch encoded = documentsBatch(catalog, 500, true);
+    Batch indexed = plain;
+    indexed.columns[1].textIndex = buildInvertedIndex(indexed.columns[1]);
+    EXPECT_EQ(indexed.columns[1].textIndex->documents, 500u - 46u);
+
+    SelectionVector rows{499, 0, 7, 250};
+    for (const char* text : {"bm25(body, \"query engine\")", "bm25(body, \"wand wand Rank\")", "bm25(body, \"missing\")",
+                             "bm25(body, \"\")"}) {
+        Column scanned = score(text, plain, catalog);
+        EXPECT_EQ(score(text, indexed, catalog).doubles, scanned.doubles) << text;
+        EXPECT_EQ(score(text, encoded, catalog).doubles, scanned.doubles) << text;
+        Column selected = score(text, indexed, catalog, &rows);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            EXPECT_EQ(selected.isValid(i), plain.columns[1].isValid(rows[i])) << text;
+            EXPECT_EQ(selected.doubles[i], scanned.doubles[rows[i]]) << text;
+        }
+        EXPECT_FALSE(scanned.isValid(0));
+        EXPECT_TRUE(scanned.isValid(1));
+    }
+
+    // Rarer terms weigh more; repeating a term saturates
+    Batch tiny;
+    tiny.schema = plain.schema;
+    tiny.columns = {Column::ofInts({0, 1, 2, 3}),
+                    Column::ofStrings({"common rare", "common", "common common common common", "other"})};
+    Column scores = score("bm25(body, \"common rare\")", tiny, catalog);
+    EXPECT_GT(scores.doubles[0], scores.doubles[1]);
+    EXPECT_GT(scores.doubles[2], scores.doubles[1]);
+    EXPECT_LT(scores.doubles[2], 4 * scores.doubles[1]);
+    EXPECT_EQ(scores.doubles[3], 0);
+}
+
+TEST(TextSearchTest, WandTopKMatchesSortAndLimit) {
+    Catalog catalog;
+    constexpr size_t kRows = 5000;
+    Batch input = documentsBatch(catalog, kRows);
+    Batch indexed = input;
+    indexed.columns[1].textIndex = buildInvertedIndex(indexed.columns[1]);
+
+    for (const std::string& text : std::vector<std::string>{
+             "set_metadata s:bm25(body, \"graph cache\") | sort s:desc | limit 10",
+             "set_metadata s:bm25(body, \"the wand\") | sort s:desc | limit 25",
+             "set_metadata s:bm25(body, \"token plan rank heap\") | sort s:desc | limit 1",
+             "set_metadata s:bm25(body, \"wand\") | sort s:desc | limit 4000",
+             "set_metadata s:bm25(body, \"missing\") | sort s:desc | limit 3",
+             "set_metadata s:bm25(body, \"the needle\") | sort s:desc | limit 10",
+             "set_metadata s:bm25(body, \"graph\") | sort s | limit 5"}) {
+        std::unique_ptr<Pipeline> pipeline;
+        Batch actual = run(text, indexed, catalog, true, &pipeline);
+        Batch expected = run(text, input, catalog, false);
+        ASSERT_EQ(actual.rowCount(), expected.rowCount()) << text;
+        EXPECT_EQ(actual.columns[0].ints, expected.columns[0].ints) << text;
+        EXPECT_EQ(actual.columns[2].doubles, expected.columns[2].doubles) << text;
+        ASSERT_NE(dynamic_cast<TopKLogicalNode*>(pipeline->stages.front().get()), nullptr) << text;
+    }
+
+    // A rare term paired with a common one skips most rows and blocks
+    std::string text = "set_metadata s:bm25(body, \"the needle\") | sort s:desc | limit 10";
+    std::unique_ptr<Pipeline> pipeline;
+    run(text, indexed, catalog, true, &pipeline);
+    auto& topK = dynamic_cast<TopKLogicalNode&>(*pipeline->stages.front());
+    EXPECT_TRUE(topK.lastUsedTextIndex.load());
+    EXPECT_LT(topK.lastRowsScored.load(), kRows / 4);
+    EXPECT_GT(topK.lastBlocksSkipped.load(), 0u);
+    EXPECT_NE(topK.explain().find("from the inverted index"), std::string::npos);
+
+    // The index's own search agrees with a full ranking
+    const InvertedIndex& index = *indexed.columns[1].textIndex;
+    std::vector<std::string> terms = queryTerms("the graph");
+    WandStats stats;
+    auto hits = index.topK(terms, 50, &stats);
+    Column scores = score("bm25(body, \"the graph\")", input, catalog);
+    std::vector<uint32_t> order(kRows);
+    for (uint32_t r = 0; r < kRows; ++r) order[r] = r;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return scores.isValid(a) && (!scores.isValid(b) || scores.doubles[a] > scores.doubles[b]);
+    });
+    ASSERT_EQ(hits.size(), 50u);
+    for (size_t i = 0; i < hits.size(); ++i) {
+        EXPECT_EQ(hits[i].row, order[i]) << i;
+        EXPECT_EQ(hits[i].score, scores.doubles[order[i]]) << i;
+    }
+    EXPECT_LT(stats.docsScored, index.find("the")->docCount);
+}
@@ -0,0 +1,308 @@
+#include "batch.h"
+#include "catalog.h"
+#include "expression.h"
+#include "expression_eval.h"
+#include "hnsw_index.h"
+#include "optimizer.h"
+#include "pipeline.h"
+#include "result_cache.h"
+#include "vector_kernels.h"
+#include "src/logical_nodes/top_k_logical_node.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+
+namespace {
+
+std::vector<float> randomVectors(size_t rows, uint32_t dimension, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal;
+    std::vector<float> values(rows * dimension);
+    for (float& v : values) v = normal(rng);
+    return values;
+}
+
+// id: 0..rows-1   emb: random vectors   bucket: id % 4, null every 7th row
+Batch embeddingsBatch(Catalog& catalog, size_t rows, uint32_t dimension, bool quantized = false) {
+    Batch batch;
+    batch.schema = catalog.makeSchema(
+        {{"id", PhysicalType::Int64}, {"emb", PhysicalType::Vector}, {"bucket", PhysicalType::Int64}});
+    std::vector<int64_t> ids(rows);
+    std::vector<int64_t> buckets(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        ids[r] = static_cast<int64_t>(r);
+        buckets[r] = static_cast<int64_t>(r % 4);
+    }
+    std::vector<float> values = randomVectors(rows, dimension, 7);
+    Column bucket = Column::ofInts(std::move(buckets));
+    for (size_t r = 0; r < rows; r += 7) bucket.setValid(r, false);
+    batch.columns = {Column::ofInts(std::move(ids)),
+                     quantized ? Column::quantizeVectors(dimension, values)
+                               : Column::ofVectors(dimension, std::move(values)),
+                     std::move(bucket)};
+    return batch;
+}
+
+std::string queryText(const std::vector<float>& query) {
+    std::string text = "[";
+    for (size_t i = 0; i < query.size(); ++i) {
+        if (i > 0) text += ", ";
+        text += std::to_string(query[i]);
+    }
+    return text + "]";
+}
+
+Batch run(const std::string& text, const Batch& input, Catalog& catalog, bool optimize,
+          std::unique_ptr<Pipeline>* kept = nullptr) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    if (optimize) optimizePipeline(*pipeline, catalog);
+    EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value()) << text;
+    Batch batch = input;
+    executePipeline(*pipeline, batch);
+    if (kept) *kept = std::make_unique<Pipeline>(std::move(*pipeline));
+    return batch;
+}
+
+void expectSameRows(const Batch& actual, const Batch& expected) {
+    ASSERT_EQ(actual.schema.fields.size(), expected.schema.fields.size());
+    ASSERT_EQ(actual.rowCount(), expected.rowCount());
+    for (size_t c = 0; c < actual.columns.size(); ++c) {
+        Column a = actual.columns[c].decoded();
+        Column b = expected.columns[c].decoded();
+        EXPECT_EQ(a.ints, b.ints) << c;
+        EXPECT_EQ(a.doubles, b.doubles) << c;
+        EXPECT_EQ(a.floats, b.floats) << c;
+        for (size_t r = 0; r < actual.rowCount(); ++r) {
+            EXPECT_EQ(a.isValid(r), b.isValid(r)) << c << ", row " << r;
+        }
+    }
+}
+
+} // namespace
+
+TEST(VectorSearchTest, ParsesAndBindsSimilarityFunctions) {
+    auto parsed = parseExpression("cosine(emb, [1, -0.5, 2e0])");
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(toString(**parsed), "cosine(emb, [1, -0.5, 2])");
+    EXPECT_EQ(toString(**parseExpression(toString(**parsed))), toString(**parsed));
+    EXPECT_EQ(parseExpression("dot(emb, [1, 2").error().code, DiagnosticCode::ExpectedClosingBracket);
+    EXPECT_EQ(parseExpression("dot(emb, [1, x])").error().code, DiagnosticCode::ExpectedExpression);
+    EXPECT_EQ(parseExpression("dot(emb)").error().code, DiagnosticCode::WrongArgumentCount);
+
+    Catalog catalog;
+    Batch batch = embeddingsBatch(catalog, 4, 3);
+    auto bind = [&](const char* text) { return bindExpression(*parseExpression(text), batch.schema, catalog.symbols); };
+    ASSERT_TRUE(bind("dot(emb, [1, 2, 3]) * 2").has_value());
+    EXPECT_EQ((*bind("dot([1, 2, 3], emb)"))->type, PhysicalType::Double);
+    EXPECT_EQ(bind("dot(emb, id)").error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(bind("emb == emb").error().code, DiagnosticCode::TypeMismatch);
+    EXPECT_EQ(bind("if(true, emb, emb)").error().code, DiagnosticCode::TypeMismatch);
+
+    // Vectors are not keys
+    for (const char* text : {"sort emb", "group emb; n:count()", "distinct emb", "group id; m:max(emb)"}) {
+        auto pipeline = tryBuildPipeline(text, catalog);
+        ASSERT_TRUE(pipeline.has_value()) << text;
+        auto bound = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+        ASSERT_FALSE(bound.has_value()) << text;
+        EXPECT_EQ(bound.error().code, DiagnosticCode::TypeMismatch) << text;
+    }
+}
+
+TEST(VectorSearchTest, KernelsMatchScalarLoops) {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> code(-127, 127);
+    for (uint32_t n : {0u, 1u, 3u, 4u, 7u, 8u, 15u, 16u, 17u, 33u, 100u}) {
+        std::vector<float> a = randomVectors(1, n, n);
+        std::vector<float> b = randomVectors(1, n, n + 100);
+        double dot = 0;
+        double norm2 = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            dot += static_cast<double>(a[i]) * b[i];
+            norm2 += static_cast<double>(a[i]) * a[i];
+        }
+        EXPECT_NEAR(dotF32(a.data(), b.data(), n), dot, 1e-4 * (1 + n)) << n;
+        float fusedDot = 0;
+        float fusedNorm2 = 0;
+        dotAndSquaredNormF32(a.data(), b.data(), n, fusedDot, fusedNorm2);
+        EXPECT_NEAR(fusedDot, dot, 1e-4 * (1 + n)) << n;
+        EXPECT_NEAR(fusedNorm2, norm2, 1e-4 * (1 + n)) << n;
+
+        std::vector<int8_t> x(n);
+        std::vector<int8_t> y(n);
+        int32_t exact = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            x[i] = static_cast<int8_t>(code(rng));
+            y[i] = static_cast<int8_t>(code(rng));
+            exact += x[i] * y[i];
+        }
+        EXPECT_EQ(dotI8(x.data(), y.data(), n), exact) << n;
+    }
+}
+
+TEST(VectorSearchTest, QuantizedScoresTrackExactOnes) {
+    Catalog catalog;
+    constexpr uint32_t kDim = 48;
+    Batch exact = embeddingsBatch(catalog, 1000, kDim);
+    Batch quantized = embeddingsBatch(catalog, 1000, kDim, true);
+    ASSERT_TRUE(quantized.columns[1].isQuantized());
+    EXPECT_EQ(quantized.columns[1].size(), 1000u);
+    std::vector<float> query = randomVectors(1, kDim, 99);
+
+    for (const char* fn : {"dot", "cosine"}) {
+        std::string text = std::string(fn) + "(emb, " + queryText(query) + ")";
+        auto parsed = parseExpression(text);
+        ASSERT_TRUE(parsed.has_value());
+        auto bound = bindExpression(*parsed, exact.schema, catalog.symbols);
+        ASSERT_TRUE(bound.has_value());
+        Column a = evaluateExpression(**bound, exact);
+        Column b = evaluateExpression(**bound, quantized);
+        ASSERT_EQ(a.doubles.size(), b.doubles.size());
+        double tolerance = std::string(fn) == "dot" ? 0.5 : 0.02;
+        for (size_t r = 0; r < a.doubles.size(); ++r) {
+            EXPECT_NEAR(a.doubles[r], b.doubles[r], tolerance) << fn << ", row " << r;
+        }
+
+        // Selections keep the encoding and pick the same rows
+        SelectionVector rows{999, 3, 500};
+        Column selected = evaluateExpression(**bound, quantized, &rows);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            EXPECT_EQ(selected.doubles[i], b.doubles[rows[i]]);
+        }
+    }
+
+    // Null rows, other dimensions and zero vectors give null
+    Batch small;
+    small.schema = exact.schema;
+    Column emb = Column::ofVectors(2, {1, 0, 0, 0, 3, 4});
+    emb.setValid(0, false);
+    small.columns = {Column::ofInts({0, 1, 2}), std::move(emb), Column::ofInts({0, 0, 0})};
+    auto eval = [&](const char* text) {
+        return evaluateExpression(**bindExpression(*parseExpression(text), small.schema, catalog.symbols), small);
+    };
+    Column cosine = eval("cosine(emb, [1, 0])");
+    EXPECT_FALSE(cosine.isValid(0));
+    EXPECT_FALSE(cosine.isValid(1));
+    EXPECT_DOUBLE_EQ(cosine.doubles[2], 0.6);
+    Column dot = eval("dot(emb, emb)");
+    EXPECT_TRUE(dot.isValid(1));
+    EXPECT_DOUBLE_EQ(dot.doubles[2], 25);
+    Column mismatched = eval("dot(emb, [1, 2, 3])");
+    EXPECT_FALSE(mismatched.isValid(1));
+    EXPECT_FALSE(mismatched.isValid(2));
+}
+
+TEST(VectorSearchTest, FusedTopKMatchesSortAndLimit) {
+    Catalog catalog;
+    Batch input = embeddingsBatch(catalog, 3000, 24);
+    std::string query = queryText(randomVectors(1, 24, 5));
+
+    for (const std::string& text : std::vector<std::string>{"set_metadata s:cosine(emb, " + query + ") | sort s:desc | limit 10",
+                             "set_metadata s:dot(" + query + ", emb) | sort s | limit 7",
+                             "set_metadata s:bucket * 2 | sort s:desc | limit 20",
+                             "set_metadata s:bucket | sort s | limit 800",
+                             "set_metadata s:bucket | sort s | limit 0",
+                             "match id > 100 | set_metadata s:0.5 * id | sort s:desc | limit 3 | project id, s"}) {
+        std::unique_ptr<Pipeline> fused;
+        Batch actual = run(text, input, catalog, true, &fused);
+        auto topK = std::find_if(fused->stages.begin(), fused->stages.end(), [](const auto& stage) {
+            return dynamic_cast<TopKLogicalNode*>(stage.get()) != nullptr;
+        });
+        ASSERT_NE(topK, fused->stages.end()) << text;
+        EXPECT_FALSE(dynamic_cast<TopKLogicalNode&>(**topK).lastFellBack.load()) << text;
+        expectSameRows(actual, run(text, input, catalog, false));
+    }
+
+    // Only a sort on just the score is fused
+    for (const char* text : {"set_metadata s:bucket | sort s,id | limit 5", "set_metadata s:bucket | sort id | limit 5",
+                             "set_metadata s:bucket | sort s | project id, s | limit 5"}) {
+        auto pipeline = tryBuildPipeline(text, catalog);
+        optimizePipeline(*pipeline, catalog);
+        for (const auto& stage : pipeline->stages) {
+            EXPECT_EQ(dynamic_cast<TopKLogicalNode*>(stage.get()), nullptr) << text;
+        }
+    }
+}
+
+TEST(VectorSearchTest, HnswIndexFindsNearestNeighbours) {
+    Catalog catalog;
+    constexpr uint32_t kDim = 16;
+    constexpr size_t kRows = 2000;
+    Batch input = embeddingsBatch(catalog, kRows, kDim);
+    auto index = buildHnswIndex(input.columns[1], VectorMetric::Cosine);
+    ASSERT_EQ(index->size(), kRows);
+    const std::vector<float>& values = input.columns[1].floats;
+
+    constexpr size_t k = 10;
+    size_t found = 0;
+    size_t queries = 0;
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+        std::vector<float> query = randomVectors(1, kDim, 1000 + seed);
+        std::vector<std::pair<float, uint32_t>> exact;
+        float queryNorm = std::sqrt(dotF32(query.data(), query.data(), kDim));
+        for (uint32_t r = 0; r < kRows; ++r) {
+            const float* row = values.data() + r * kDim;
+            float norm = std::sqrt(dotF32(row, row, kDim));
+            exact.emplace_back(-dotF32(row, query.data(), kDim) / (norm * queryNorm), r);
+        }
+        std::partial_sort(exact.begin(), exact.begin() + k, exact.end());
+        std::set<uint32_t> truth;
+        for (size_t i = 0; i < k; ++i) truth.insert(exact[i].second);
+        auto hits = index->search(query.data(), k, 64);
+        ASSERT_GE(hits.size(), k);
+        for (size_t i = 0; i < k; ++i) found += truth.count(hits[i].row);
+        queries += k;
+    }
+    EXPECT_GE(static_cast<double>(found) / static_cast<double>(queries), 0.9);
+
+    // The fused stage scores only the index's candidates once one is attached
+    std::vector<float> query = randomVectors(1, kDim, 77);
+    std::string text = "set_metadata s:cosine(emb, " + queryText(query) + ") | sort s:desc | limit 5";
+    Batch exactTop = run(text, input, catalog, true);
+    input.columns[1].vectorIndex = index;
+    std::unique_ptr<Pipeline> pipeline;
+    Batch indexedTop = run(text, input, catalog, true, &pipeline);
+    auto& topK = dynamic_cast<TopKLogicalNode&>(*pipeline->stages.front());
+    EXPECT_TRUE(topK.lastUsedIndex.load());
+    EXPECT_LT(topK.lastRowsScored.load(), kRows / 10);
+    EXPECT_NE(topK.explain().find("from the HNSW index"), std::string::npos);
+    ASSERT_EQ(indexedTop.rowCount(), 5u);
+    EXPECT_EQ(indexedTop.columns[0].ints[0], exactTop.columns[0].ints[0]);
+    EXPECT_TRUE(std::is_sorted(indexedTop.columns[3].doubles.rbegin(), indexedTop.columns[3].doubles.rend()));
+
+    // An index for another metric is ignored
+    input.columns[1].vectorIndex = buildHnswIndex(input.columns[1], VectorMetric::Dot);
+    expectSameRows(run(text, input, catalog, true), exactTop);
+}
+
+TEST(VectorSearchTest, ApproximateTopKIsNotCachedForExactQueries) {
+    Catalog catalog;
+    constexpr uint32_t kDim = 16;
+    Batch input = embeddingsBatch(catalog, 2000, kDim);
+    input.columns[1].vectorIndex = buildHnswIndex(input.columns[1], VectorMetric::Cosine);
+    std::string text =
+        "set_metadata s:cosine(emb, " + queryText(randomVectors(1, kDim, 5)) + ") | sort s:desc | limit 5";
+    ResultCache cache(64 << 20);
+    cache.minStageCost = 0;
+    auto runCached = [&](bool optimize) {
+        auto pipeline = tryBuildPipeline(text, catalog);
+        EXPECT_TRUE(pipeline.has_value());
+        if (optimize) optimizePipeline(*pipeline, catalog);
+        EXPECT_TRUE(bindPipeline(*pipeline, input.schema, catalog.symbols).has_value());
+        Batch batch = input;
+        executePipelineCached(*pipeline, batch, 1, cache);
+        return std::make_pair(std::move(batch), std::move(*pipeline));
+    };
+
+    auto [approximate, fused] = runCached(true);
+    ASSERT_TRUE(dynamic_cast<TopKLogicalNode&>(*fused.stages.front()).lastUsedIndex.load());
+
+    // The unfused plan scores every row; its prefixes look like the top-k's
+    // score and sort, but nothing the index answered may stand in for it
+    size_t hits = cache.hits();
+    auto [exact, unfused] = runCached(false);
+    EXPECT_EQ(cache.hits(), hits);
+    expectSameRows(exact, run(text, input, catalog, false));
+}
@@ -0,0 +1,176 @@
+#include "batch.h"
+#include "catalog.h"
+#include "pipeline.h"
+#include "src/logical_nodes/window_logical_node.h"
+#include "src/parse_nodes/window_node.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <optional>
+
+namespace {
+
+// Sorted by (country, ts): de 1 2 2 | us 1 3 4 5, with a null score at us 3
+Batch eventsBatch(Catalog& catalog) {
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"country", PhysicalType::String},
+                                       {"ts", PhysicalType::Int64},
+                                       {"score", PhysicalType::Int64}});
+    Column score = Column::ofInts({5, 10, 0, 1, 2, 3, 4});
+    score.setValid(2, false);
+    batch.columns = {Column::dictionaryEncode({"us", "de", "us", "de", "de", "us", "us"}),
+                     Column::ofInts({4, 1, 3, 2, 2, 1, 5}), std::move(score)};
+    return batch;
+}
+
+Schema runPipeline(const char* text, Batch& batch, Catalog& catalog) {
+    auto pipeline = tryBuildPipeline(text, catalog);
+    EXPECT_TRUE(pipeline.has_value()) << text;
+    auto output = bindPipeline(*pipeline, batch.schema, catalog.symbols);
+    EXPECT_TRUE(output.has_value()) << text;
+    executePipeline(*pipeline, batch);
+    return *output;
+}
+
+} // namespace
+
+TEST(WindowTest, ParsesKeysFunctionsAndFrames) {
+    auto node = WindowNode::tryParse("country; ts:desc; n:row_number(), moving:avg(score) rows(-2, 0), "
+                                     "total:sum(score), ahead:max(score) rows(1, unbounded)");
+    ASSERT_TRUE(node.has_value());
+    EXPECT_EQ(node->partitionKeys, (std::vector<std::string>{"country"}));
+    EXPECT_EQ(node->orderKeys, (std::vector<std::string>{"ts"}));
+    EXPECT_FALSE(node->asc);
+    ASSERT_EQ(node->functions.size(), 4u);
+    EXPECT_EQ(node->functions[1].frameStart, -2);
+    EXPECT_FALSE(node->functions[1].startUnbounded);
+    EXPECT_TRUE(node->functions[2].startUnbounded);
+    EXPECT_FALSE(node->functions[2].endUnbounded);  // Running by default when ordered
+    EXPECT_TRUE(node->functions[3].endUnbounded);
+
+    auto unordered = WindowNode::tryParse("; ; total:sum(score)");
+    ASSERT_TRUE(unordered.has_value());
+    EXPECT_TRUE(unordered->functions[0].endUnbounded);  // Whole partition
+
+    EXPECT_EQ(WindowNode::tryParse("a; b").error().code, DiagnosticCode::UnexpectedCharacter);
+    EXPECT_EQ(WindowNode::tryParse("a; b:up; n:rank()").error().code, DiagnosticCode::UnknownSortDirection);
+    EXPECT_EQ(WindowNode::tryParse("a; b; n:ntile(4)").error().code, DiagnosticCode::UnknownFunction);
+    EXPECT_EQ(WindowNode::tryParse("a; b; n:rank(x)").error().code, DiagnosticCode::WrongArgumentCount);
+    EXPECT_EQ(WindowNode::tryParse("a; b; s:sum(x) rows(2, -2)").error().code, DiagnosticCode::IntegerOutOfRange);
+    EXPECT_EQ(WindowNode::tryParse("a; b; s:sum(x) rows(x, 0)").error().code, DiagnosticCode::ExpectedInteger);
+    EXPECT_EQ(WindowNode::tryParse("a; b; s:sum(x) range(0, 1)").error().code, DiagnosticCode::UnexpectedCharacter);
+}
+
+TEST(WindowTest, RanksAndRunningAggregatesPerPartition) {
+    Catalog catalog;
+    Batch batch = eventsBatch(catalog);
+    Schema output = runPipeline(
+        "window country; ts; n:row_number(), r:rank(), d:dense_rank(), run:sum(score), seen:count(score), "
+        "mean:avg(score) rows(unbounded, unbounded)",
+        batch, catalog);
+    ASSERT_EQ(output.fields.size(), 9u);
+    EXPECT_EQ(output.fields[8].type, PhysicalType::Double);
+    EXPECT_EQ(batch.columns[0].decoded().strings,
+              (std::vector<std::string>{"de", "de", "de", "us", "us", "us", "us"}));
+    EXPECT_EQ(batch.columns[1].ints, (std::vector<int64_t>{1, 2, 2, 1, 3, 4, 5}));
+    EXPECT_EQ(batch.columns[3].ints, (std::vector<int64_t>{1, 2, 3, 1, 2, 3, 4}));
+    EXPECT_EQ(batch.columns[4].ints, (std::vector<int64_t>{1, 2, 2, 1, 2, 3, 4}));
+    EXPECT_EQ(batch.columns[5].ints, (std::vector<int64_t>{1, 2, 2, 1, 2, 3, 4}));
+    EXPECT_EQ(batch.columns[6].ints, (std::vector<int64_t>{10, 11, 13, 3, 3, 8, 12}));
+    EXPECT_EQ(batch.columns[7].ints, (std::vector<int64_t>{1, 2, 3, 1, 1, 2, 3}));
+    EXPECT_EQ(batch.columns[8].doubles[0], 13.0 / 3);
+    EXPECT_EQ(batch.columns[8].doubles[6], 4.0);
+
+    // A frame before the first row of its partition is empty
+    Batch shifted = eventsBatch(catalog);
+    runPipeline("window country; ts; prev:max(score) rows(-1, -1), n:count() rows(-1, -1)", shifted, catalog);
+    EXPECT_FALSE(shifted.columns[3].isValid(0));
+    EXPECT_EQ(shifted.columns[3].ints[1], 10);
+    EXPECT_EQ(shifted.columns[3].ints[4], 3);
+    EXPECT_FALSE(shifted.columns[3].isValid(5));  // The previous score is null
+    EXPECT_EQ(shifted.columns[4].ints, (std::vector<int64_t>{0, 1, 1, 0, 1, 1, 1}));
+
+    // Int64 sums wrap around, like the group stage's
+    Batch big;
+    big.schema = catalog.makeSchema({{"x", PhysicalType::Int64}});
+    big.columns = {Column::ofInts({INT64_MAX, 1})};
+    runPipeline("window ; ; s:sum(x) rows(unbounded, unbounded)", big, catalog);
+    EXPECT_EQ(big.columns[1].ints, (std::vector<int64_t>{INT64_MIN, INT64_MIN}));
+
+    Batch bad = eventsBatch(catalog);
+    auto pipeline = tryBuildPipeline("window ; ts; s:sum(country)", catalog);
+    EXPECT_EQ(bindPipeline(*pipeline, bad.schema, catalog.symbols).error().code, DiagnosticCode::TypeMismatch);
+    auto unknown = tryBuildPipeline("window nope; ; n:row_number()", catalog);
+    EXPECT_EQ(bindPipeline(*unknown, bad.schema, catalog.symbols).error().code, DiagnosticCode::UnknownField);
+}
+
+TEST(WindowTest, SegmentTreeFramesMatchBruteForceInParallel) {
+    Catalog catalog;
+    constexpr size_t kRows = 40000;
+    std::vector<int64_t> keys(kRows), ts(kRows);
+    std::vector<double> values(kRows);
+    for (size_t r = 0; r < kRows; ++r) {
+        keys[r] = static_cast<int64_t>((r * 7919) % 37);
+        ts[r] = static_cast<int64_t>(r);
+        values[r] = static_cast<double>((r * 104729) % 1000) / 10;
+    }
+    Batch batch;
+    batch.schema = catalog.makeSchema({{"k", PhysicalType::Int64}, {"ts", PhysicalType::Int64},
+                                       {"v", PhysicalType::Double}});
+    batch.columns = {Column::packInts(keys), Column::ofInts(ts), Column::ofDoubles(values)};
+    for (size_t r = 0; r < kRows; r += 11) batch.columns[2].setValid(r, false);
+    Batch input = batch;
+
+    auto pipeline = tryBuildPipeline(
+        "window k; ts; lo:min(v) rows(-3, 2), hi:max(v) rows(1, 5), s:sum(v) rows(-2, unbounded), "
+        "n:count(v) rows(-4, 4)",
+        catalog);
+    ASSERT_TRUE(bindPipeline(*pipeline, batch.schema, catalog.symbols).has_value());
+    auto& window = dynamic_cast<WindowLogicalNode&>(*pipeline->stages[0]);
+    window.maxThreads = 4;
+    executePipeline(*pipeline, batch);
+    EXPECT_EQ(window.lastPartitions.load(), 37u);
+    EXPECT_EQ(window.lastSegmentTrees.load(), 37u * 4);
+    EXPECT_GT(window.lastThreads.load(), 1u);
+
+    // Brute force over each partition, in ts order
+    std::vector<std::vector<size_t>> partitions(37);
+    for (size_t r = 0; r < kRows; ++r) partitions[keys[r]].push_back(r);
+    size_t out = 0;
+    for (const auto& rows : partitions) {
+        auto frame = [&](size_t i, int64_t start, std::optional<int64_t> end, auto fn) {
+            int64_t lo = std::max<int64_t>(0, static_cast<int64_t>(i) + start);
+            int64_t hi = end ? std::min<int64_t>(static_cast<int64_t>(rows.size()) - 1, static_cast<int64_t>(i) + *end)
+                             : static_cast<int64_t>(rows.size()) - 1;
+            for (int64_t j = lo; j <= hi; ++j) {
+                if (rows[j] % 11 != 0) fn(values[rows[j]]);
+            }
+        };
+        for (size_t i = 0; i < rows.size(); ++i, ++out) {
+            ASSERT_EQ(batch.columns[1].ints[out], static_cast<int64_t>(rows[i]));
+            std::optional<double> lo, hi;
+            double sum = 0;
+            int64_t count = 0;
+            frame(i, -3, 2, [&](double v) { lo = lo ? std::min(*lo, v) : v; });
+            frame(i, 1, 5, [&](double v) { hi = hi ? std::max(*hi, v) : v; });
+            frame(i, -2, std::nullopt, [&](double v) { sum += v; });
+            frame(i, -4, 4, [&](double) { ++count; });
+            ASSERT_EQ(batch.columns[3].isValid(out), lo.has_value()) << out;
+            if (lo) {
+                EXPECT_EQ(batch.columns[3].doubles[out], *lo);
+            }
+            ASSERT_EQ(batch.columns[4].isValid(out), hi.has_value()) << out;
+            if (hi) {
+                EXPECT_EQ(batch.columns[4].doubles[out], *hi);
+            }
+            EXPECT_NEAR(batch.columns[5].doubles[out], sum, 1e-6);
+            EXPECT_EQ(batch.columns[6].ints[out], count);
+        }
+    }
+
+    // One thread gives the same result
+    window.maxThreads = 1;
+    executePipeline(*pipeline, input);
+    EXPECT_EQ(window.lastThreads.load(), 1u);
+    EXPECT_EQ(input.columns[3].doubles, batch.columns[3].doubles);
+    EXPECT_EQ(input.columns[6].ints, batch.columns[6].ints);
+}